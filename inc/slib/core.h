@@ -36,6 +36,8 @@
 #include "core/string.h"
 #include "core/string_std.h"
 #include "core/string_buffer.h"
+#include "core/string_search.h"
+#include "core/string_format.h"
 #include "core/memory.h"
 #include "core/time.h"
 #include "core/variant.h"
@@ -67,6 +69,7 @@
 #include "core/animation.h"
 
 #include "core/system.h"
+#include "core/cpu.h"
 #include "core/event.h"
 #include "core/thread.h"
 #include "core/thread_pool.h"
@@ -27,6 +27,7 @@ namespace slib
 	class Charsets
 	{
 	public:
+		// Passing a null output buffer returns the exact number of elements the conversion writes
 		static sl_size utf8ToUtf16(const sl_char8* utf8, sl_reg lenUtf8, sl_char16* utf16, sl_reg lenUtf16Buffer);
 
 		static sl_size utf8ToUtf32(const sl_char8* utf8, sl_reg lenUtf8, sl_char32* utf32, sl_reg lenUtf32Buffer);
@@ -39,6 +40,10 @@ namespace slib
 
 		static sl_size utf32ToUtf16(const sl_char32* utf32, sl_reg lenUtf32, sl_char16* utf16, sl_reg lenUtf16Buffer);
 
+
+		// strict validation (RFC 3629): rejects overlong forms, surrogates and code points above U+10FFFF
+		static sl_bool checkUtf8(const sl_char8* utf8, sl_size len);
+
 	};
 
 }
@@ -0,0 +1,90 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CHECKHEADER_SLIB_CORE_CPU
+#define CHECKHEADER_SLIB_CORE_CPU
+
+#include "definition.h"
+
+/*
+	SIMD code paths are compiled in per function and selected at runtime by the `Cpu` queries.
+
+	SLIB_CPU_TARGET(...) enables an instruction set for a single function on GCC/Clang,
+	so that the library itself does not need to be built with -mavx2, -maes, ...
+*/
+
+#if defined(SLIB_ARCH_IS_X64) || (defined(SLIB_ARCH_IS_X86) && (defined(SLIB_COMPILER_IS_VC) || defined(__SSE2__)))
+#	define SLIB_CPU_USE_SSE2
+#endif
+
+#if defined(SLIB_CPU_USE_SSE2) && (defined(SLIB_COMPILER_IS_VC) || (defined(SLIB_COMPILER_IS_GCC) && (defined(__clang__) || __GNUC__ >= 5)))
+#	define SLIB_CPU_USE_X86_EXTENSIONS // SSSE3, SSE4, AVX2, AES-NI, PCLMULQDQ, SHA
+#endif
+
+#if defined(SLIB_ARCH_IS_ARM) && (defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(SLIB_ARCH_IS_ARM64))
+#	define SLIB_CPU_USE_NEON
+#	if defined(__ARM_FEATURE_CRYPTO) || defined(__ARM_FEATURE_AES)
+#		define SLIB_CPU_USE_ARMV8_CRYPTO
+#	endif
+#	if defined(__ARM_FEATURE_CRC32)
+#		define SLIB_CPU_USE_ARMV8_CRC32
+#	endif
+#endif
+
+#if defined(SLIB_COMPILER_IS_GCC)
+#	define SLIB_CPU_TARGET(NAMES) __attribute__((target(NAMES)))
+#else
+#	define SLIB_CPU_TARGET(NAMES)
+#endif
+
+namespace slib
+{
+
+	class SLIB_EXPORT Cpu
+	{
+	public:
+		static sl_bool isSSE2Supported();
+
+		static sl_bool isSSSE3Supported();
+
+		static sl_bool isSSE41Supported();
+
+		static sl_bool isSSE42Supported();
+
+		static sl_bool isAVX2Supported();
+
+		static sl_bool isAESNISupported();
+
+		static sl_bool isPCLMULQDQSupported();
+
+		static sl_bool isSHANISupported();
+
+
+		static sl_bool isNEONSupported();
+
+		static sl_bool isARMv8AESSupported();
+
+		static sl_bool isARMv8PMULLSupported();
+
+		static sl_bool isARMv8SHA1Supported();
+
+		static sl_bool isARMv8SHA2Supported();
+
+		static sl_bool isARMv8CRC32Supported();
+
+
+		// number of logical processors available to the process
+		static sl_uint32 getCoresCount();
+
+	};
+
+}
+
+#endif
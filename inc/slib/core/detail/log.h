@@ -23,6 +23,20 @@ namespace slib
 		print(content);
 	}
 
+	template <class... ARGS>
+	void Console::print(const StringFormat& format, ARGS&&... args)
+	{
+		String content = format.format(Forward<ARGS>(args)...);
+		print(content);
+	}
+
+	template <sl_uint32 ARGS_COUNT, class... ARGS>
+	void Console::print(const StaticStringFormat<ARGS_COUNT>& format, ARGS&&... args)
+	{
+		String content = format.format(Forward<ARGS>(args)...);
+		print(content);
+	}
+
 	template <class... ARGS>
 	void Console::println(const String& format, ARGS&&... args)
 	{
@@ -30,6 +44,20 @@ namespace slib
 		println(content);
 	}
 
+	template <class... ARGS>
+	void Console::println(const StringFormat& format, ARGS&&... args)
+	{
+		String content = format.format(Forward<ARGS>(args)...);
+		println(content);
+	}
+
+	template <sl_uint32 ARGS_COUNT, class... ARGS>
+	void Console::println(const StaticStringFormat<ARGS_COUNT>& format, ARGS&&... args)
+	{
+		String content = format.format(Forward<ARGS>(args)...);
+		println(content);
+	}
+
 	template <class... ARGS>
 	void Log(const String& tag, const String& format, ARGS&&... args)
 	{
@@ -37,12 +65,40 @@ namespace slib
 		Logger::logGlobal(tag, content);
 	}
 	
+	template <class... ARGS>
+	void Log(const String& tag, const StringFormat& format, ARGS&&... args)
+	{
+		String content = format.format(Forward<ARGS>(args)...);
+		Logger::logGlobal(tag, content);
+	}
+
+	template <sl_uint32 ARGS_COUNT, class... ARGS>
+	void Log(const String& tag, const StaticStringFormat<ARGS_COUNT>& format, ARGS&&... args)
+	{
+		String content = format.format(Forward<ARGS>(args)...);
+		Logger::logGlobal(tag, content);
+	}
+
 	template <class... ARGS>
 	void LogError(const String& tag, const String& format, ARGS&&... args)
 	{
 		String content = String::format(format, args...);
 		Logger::logGlobalError(tag, content);
 	}
+
+	template <class... ARGS>
+	void LogError(const String& tag, const StringFormat& format, ARGS&&... args)
+	{
+		String content = format.format(Forward<ARGS>(args)...);
+		Logger::logGlobalError(tag, content);
+	}
+
+	template <sl_uint32 ARGS_COUNT, class... ARGS>
+	void LogError(const String& tag, const StaticStringFormat<ARGS_COUNT>& format, ARGS&&... args)
+	{
+		String content = format.format(Forward<ARGS>(args)...);
+		Logger::logGlobalError(tag, content);
+	}
 	
 }
 
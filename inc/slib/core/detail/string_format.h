@@ -0,0 +1,262 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CHECKHEADER_SLIB_CORE_DETAIL_STRING_FORMAT
+#define CHECKHEADER_SLIB_CORE_DETAIL_STRING_FORMAT
+
+#include "../string_format.h"
+
+namespace slib
+{
+
+	/*
+		Compile-time counterpart of StringFormat::_parse(), counting the arguments referred by the format.
+		'%' is located by bisection, so that the recursion depth depends on the number of conversions rather than on the length of the format.
+	*/
+
+	constexpr sl_size _StringFormat_findPercent(const sl_char8* s, sl_size begin, sl_size end);
+
+	constexpr sl_size _StringFormat_findPercentRight(const sl_char8* s, sl_size posLeft, sl_size mid, sl_size end)
+	{
+		return posLeft != mid ? posLeft : _StringFormat_findPercent(s, mid, end);
+	}
+
+	constexpr sl_size _StringFormat_findPercent(const sl_char8* s, sl_size begin, sl_size end)
+	{
+		return end - begin > 1 ? _StringFormat_findPercentRight(s, _StringFormat_findPercent(s, begin, (begin + end) / 2), (begin + end) / 2, end) : (begin < end && s[begin] == '%' ? begin : end);
+	}
+
+	constexpr sl_uint32 _StringFormat_max(sl_uint32 a, sl_uint32 b)
+	{
+		return a > b ? a : b;
+	}
+
+	constexpr sl_bool _StringFormat_isDigit(sl_char8 ch)
+	{
+		return ch >= '0' && ch <= '9';
+	}
+
+	constexpr sl_bool _StringFormat_isSpecChar(sl_char8 ch)
+	{
+		return _StringFormat_isDigit(ch) || ch == '-' || ch == '+' || ch == ' ' || ch == ',' || ch == '(' || ch == '.';
+	}
+
+	// returns the position next to the conversion character, or `len + 1` for an incomplete specifier
+	constexpr sl_size _StringFormat_skipSpec(const sl_char8* s, sl_size pos, sl_size len)
+	{
+		return pos < len ? (_StringFormat_isSpecChar(s[pos]) ? _StringFormat_skipSpec(s, pos + 1, len) : pos + 1) : len + 1;
+	}
+
+	constexpr sl_uint32 _StringFormat_countText(const sl_char8* s, sl_size pos, sl_size len, sl_uint32 nAuto, sl_uint32 nIndexed);
+
+	constexpr sl_uint32 _StringFormat_countNext(const sl_char8* s, sl_size pos, sl_size len, sl_uint32 nAuto, sl_uint32 nIndexed, sl_uint32 nAutoPrev, sl_uint32 nIndexedPrev)
+	{
+		return pos > len ? _StringFormat_max(nAutoPrev, nIndexedPrev) : _StringFormat_countText(s, pos, len, nAuto, nIndexed);
+	}
+
+	constexpr sl_uint32 _StringFormat_countIndex(const sl_char8* s, sl_size start, sl_size pos, sl_size len, sl_uint32 index, sl_uint32 nAuto, sl_uint32 nIndexed)
+	{
+		return pos >= len ? _StringFormat_max(nAuto, nIndexed) :
+			_StringFormat_isDigit(s[pos]) ? _StringFormat_countIndex(s, start, pos + 1, len, index * 10 + (s[pos] - '0'), nAuto, nIndexed) :
+			(pos > start && s[pos] == '$') ? _StringFormat_countNext(s, _StringFormat_skipSpec(s, pos + 1, len), len, nAuto, _StringFormat_max(nIndexed, index > 0 ? index : 1), nAuto, nIndexed) :
+			_StringFormat_countNext(s, _StringFormat_skipSpec(s, start, len), len, nAuto + 1, nIndexed, nAuto, nIndexed);
+	}
+
+	// `pos` is next to '%'
+	constexpr sl_uint32 _StringFormat_countSpec(const sl_char8* s, sl_size pos, sl_size len, sl_uint32 nAuto, sl_uint32 nIndexed)
+	{
+		return pos >= len ? _StringFormat_max(nAuto, nIndexed) :
+			(s[pos] == '%' || s[pos] == 'n') ? _StringFormat_countText(s, pos + 1, len, nAuto, nIndexed) :
+			s[pos] == '<' ? _StringFormat_countNext(s, _StringFormat_skipSpec(s, pos + 1, len), len, nAuto, nIndexed, nAuto, nIndexed) :
+			_StringFormat_countIndex(s, pos, pos, len, 0, nAuto, nIndexed);
+	}
+
+	constexpr sl_uint32 _StringFormat_countPercent(const sl_char8* s, sl_size posPercent, sl_size len, sl_uint32 nAuto, sl_uint32 nIndexed)
+	{
+		return posPercent < len ? _StringFormat_countSpec(s, posPercent + 1, len, nAuto, nIndexed) : _StringFormat_max(nAuto, nIndexed);
+	}
+
+	constexpr sl_uint32 _StringFormat_countText(const sl_char8* s, sl_size pos, sl_size len, sl_uint32 nAuto, sl_uint32 nIndexed)
+	{
+		return _StringFormat_countPercent(s, _StringFormat_findPercent(s, pos, len), len, nAuto, nIndexed);
+	}
+
+	template <sl_size N>
+	constexpr sl_uint32 StringFormat::countArguments(const sl_char8 (&format)[N])
+	{
+		return _StringFormat_countText(format, 0, N - 1, 0, 0);
+	}
+
+
+	template <class T>
+	SLIB_INLINE void _StringFormat_writeArgument(_StringFormatOutput& output, const _StringFormatItem& item, const T& arg)
+	{
+		output.writeArgument(item, Variant(arg));
+	}
+
+	SLIB_INLINE void _StringFormat_writeArgument(_StringFormatOutput& output, const _StringFormatItem& item, short arg)
+	{
+		output.writeArgument(item, (sl_int64)arg);
+	}
+
+	SLIB_INLINE void _StringFormat_writeArgument(_StringFormatOutput& output, const _StringFormatItem& item, unsigned short arg)
+	{
+		output.writeArgument(item, (sl_uint64)arg);
+	}
+
+	SLIB_INLINE void _StringFormat_writeArgument(_StringFormatOutput& output, const _StringFormatItem& item, int arg)
+	{
+		output.writeArgument(item, (sl_int64)arg);
+	}
+
+	SLIB_INLINE void _StringFormat_writeArgument(_StringFormatOutput& output, const _StringFormatItem& item, unsigned int arg)
+	{
+		output.writeArgument(item, (sl_uint64)arg);
+	}
+
+	SLIB_INLINE void _StringFormat_writeArgument(_StringFormatOutput& output, const _StringFormatItem& item, long arg)
+	{
+		output.writeArgument(item, (sl_int64)arg);
+	}
+
+	SLIB_INLINE void _StringFormat_writeArgument(_StringFormatOutput& output, const _StringFormatItem& item, unsigned long arg)
+	{
+		output.writeArgument(item, (sl_uint64)arg);
+	}
+
+	SLIB_INLINE void _StringFormat_writeArgument(_StringFormatOutput& output, const _StringFormatItem& item, sl_int64 arg)
+	{
+		output.writeArgument(item, arg);
+	}
+
+	SLIB_INLINE void _StringFormat_writeArgument(_StringFormatOutput& output, const _StringFormatItem& item, sl_uint64 arg)
+	{
+		output.writeArgument(item, arg);
+	}
+
+	SLIB_INLINE void _StringFormat_writeArgument(_StringFormatOutput& output, const _StringFormatItem& item, float arg)
+	{
+		output.writeArgument(item, arg);
+	}
+
+	SLIB_INLINE void _StringFormat_writeArgument(_StringFormatOutput& output, const _StringFormatItem& item, double arg)
+	{
+		output.writeArgument(item, arg);
+	}
+
+	SLIB_INLINE void _StringFormat_writeArgument(_StringFormatOutput& output, const _StringFormatItem& item, const sl_char8* arg)
+	{
+		output.writeArgument(item, arg);
+	}
+
+	SLIB_INLINE void _StringFormat_writeArgument(_StringFormatOutput& output, const _StringFormatItem& item, sl_char8* arg)
+	{
+		output.writeArgument(item, (const sl_char8*)arg);
+	}
+
+	SLIB_INLINE void _StringFormat_writeArgument(_StringFormatOutput& output, const _StringFormatItem& item, const String& arg)
+	{
+		output.writeArgument(item, arg);
+	}
+
+	SLIB_INLINE void _StringFormat_writeArgumentAt(_StringFormatOutput& output, const _StringFormatItem& item, sl_uint32 index)
+	{
+	}
+
+	template <class T, class... ARGS>
+	SLIB_INLINE void _StringFormat_writeArgumentAt(_StringFormatOutput& output, const _StringFormatItem& item, sl_uint32 index, const T& arg, const ARGS&... args)
+	{
+		if (index) {
+			_StringFormat_writeArgumentAt(output, item, index - 1, args...);
+		} else {
+			_StringFormat_writeArgument(output, item, arg);
+		}
+	}
+
+	template <class... ARGS>
+	void StringFormat::_write(_StringFormatOutput& output, ARGS&&... args) const
+	{
+		sl_uint32 nArgs = sizeof...(args);
+		if (nArgs == 0) {
+			output.write(m_format.getData(), m_format.getLength());
+			return;
+		}
+		_StringFormatItem* items = m_items.getData();
+		sl_size nItems = m_items.getCount();
+		for (sl_size i = 0; i < nItems; i++) {
+			_StringFormatItem& item = items[i];
+			output.write(item.text, item.lenText);
+			sl_uint32 indexArg = item.indexArg;
+			if (indexArg != (sl_uint32)-1) {
+				if (indexArg >= nArgs) {
+					indexArg = nArgs - 1;
+				}
+				_StringFormat_writeArgumentAt(output, item, indexArg, args...);
+			}
+		}
+	}
+
+	template <class... ARGS>
+	String StringFormat::format(ARGS&&... args) const
+	{
+		_StringFormatOutput output(sl_null);
+		_write(output, Forward<ARGS>(args)...);
+		return output.finishString();
+	}
+
+	template <class... ARGS>
+	sl_size StringFormat::formatTo(sl_char8* buf, sl_size size, ARGS&&... args) const
+	{
+		_StringFormatOutput output(buf, size);
+		_write(output, Forward<ARGS>(args)...);
+		return output.finish();
+	}
+
+	template <class... ARGS>
+	void StringFormat::formatTo(StringBuffer& sb, ARGS&&... args) const
+	{
+		_StringFormatOutput output(&sb);
+		_write(output, Forward<ARGS>(args)...);
+		output.finish();
+	}
+
+
+	template <sl_uint32 ARGS_COUNT>
+	StaticStringFormat<ARGS_COUNT>::StaticStringFormat(const sl_char8* format) : StringFormat(format)
+	{
+	}
+
+	template <sl_uint32 ARGS_COUNT>
+	template <class... ARGS>
+	String StaticStringFormat<ARGS_COUNT>::format(ARGS&&... args) const
+	{
+		static_assert(sizeof...(args) >= ARGS_COUNT, "Too few arguments for the format string");
+		return StringFormat::format(Forward<ARGS>(args)...);
+	}
+
+	template <sl_uint32 ARGS_COUNT>
+	template <class... ARGS>
+	sl_size StaticStringFormat<ARGS_COUNT>::formatTo(sl_char8* buf, sl_size size, ARGS&&... args) const
+	{
+		static_assert(sizeof...(args) >= ARGS_COUNT, "Too few arguments for the format string");
+		return StringFormat::formatTo(buf, size, Forward<ARGS>(args)...);
+	}
+
+	template <sl_uint32 ARGS_COUNT>
+	template <class... ARGS>
+	void StaticStringFormat<ARGS_COUNT>::formatTo(StringBuffer& sb, ARGS&&... args) const
+	{
+		static_assert(sizeof...(args) >= ARGS_COUNT, "Too few arguments for the format string");
+		StringFormat::formatTo(sb, Forward<ARGS>(args)...);
+	}
+
+}
+
+#endif
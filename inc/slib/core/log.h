@@ -17,6 +17,7 @@
 #include "object.h"
 #include "list.h"
 #include "variant.h"
+#include "string_format.h"
 
 namespace slib
 {
@@ -30,11 +31,23 @@ namespace slib
 
 		template <class... ARGS>
 		static void print(const String& format, ARGS&&... args);
+
+		template <class... ARGS>
+		static void print(const StringFormat& format, ARGS&&... args);
+
+		template <sl_uint32 ARGS_COUNT, class... ARGS>
+		static void print(const StaticStringFormat<ARGS_COUNT>& format, ARGS&&... args);
 	
 		static void println(const String& s);
 
 		template <class... ARGS>
 		static void println(const String& format, ARGS&&... args);
+
+		template <class... ARGS>
+		static void println(const StringFormat& format, ARGS&&... args);
+
+		template <sl_uint32 ARGS_COUNT, class... ARGS>
+		static void println(const StaticStringFormat<ARGS_COUNT>& format, ARGS&&... args);
 	
 		static String readLine();
 
@@ -61,6 +74,8 @@ namespace slib
 
 		static Ref<Logger> createFileLogger(const String& fileName);
 
+		static Ref<Logger> createAsyncFileLogger(const String& fileName);
+
 		static void logGlobal(const String& tag, const String& content);
 
 		static void logGlobalError(const String& tag, const String& content);
@@ -85,6 +100,75 @@ namespace slib
 	
 	};
 	
+	enum class LoggerOverflowPolicy
+	{
+		Drop = 0, // the lines are dropped while the buffer is full
+		Block = 1 // the logging thread waits for the writer thread
+	};
+	
+	class SLIB_EXPORT AsyncFileLoggerParam
+	{
+	public:
+		String fileName;
+		
+		// milliseconds between the periodic flushes of the writer thread
+		sl_uint32 flushInterval;
+		
+		// the writer thread is woken up before the interval when a thread buffer holds this many bytes
+		sl_uint32 flushSize;
+		
+		// capacity of the buffer of each logging thread
+		sl_uint32 bufferSize;
+		
+		LoggerOverflowPolicy overflowPolicy;
+		
+		// the file is rotated before it grows over this size (0: disabled)
+		sl_uint64 maxFileSize;
+		
+		// the file is rotated at every multiple of this interval in seconds, such as 86400 (0: disabled)
+		sl_uint32 rotationInterval;
+		
+		// rotated files are kept as `fileName.1` (latest), ..., `fileName.N`
+		sl_uint32 maxBackupFiles;
+		
+	public:
+		AsyncFileLoggerParam();
+		
+		~AsyncFileLoggerParam();
+		
+	};
+	
+	/*
+		Each logging thread appends to its own lock-free ring buffer, and a background thread
+		writes the buffered lines to the file in batches, with one write call per flush.
+		Lines of the same thread keep their order.
+	*/
+	class SLIB_EXPORT AsyncFileLogger : public Logger
+	{
+		SLIB_DECLARE_OBJECT
+		
+	protected:
+		AsyncFileLogger();
+		
+		~AsyncFileLogger();
+		
+	public:
+		static Ref<AsyncFileLogger> create(const AsyncFileLoggerParam& param);
+		
+		static Ref<AsyncFileLogger> create(const String& fileName);
+		
+	public:
+		// writes all the lines logged before this call
+		virtual void flush() = 0;
+		
+		// flushes the buffers and stops the writer thread
+		virtual void close() = 0;
+		
+		// number of the lines dropped on full buffers
+		virtual sl_uint64 getDroppedLinesCount() = 0;
+		
+	};
+	
 	class SLIB_EXPORT LoggerSet : public Logger
 	{
 	public:
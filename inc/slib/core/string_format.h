@@ -0,0 +1,185 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CHECKHEADER_SLIB_CORE_STRING_FORMAT
+#define CHECKHEADER_SLIB_CORE_STRING_FORMAT
+
+#include "definition.h"
+
+#include "string.h"
+#include "string_buffer.h"
+#include "variant.h"
+#include "array.h"
+
+/*
+	Pre-parsed format string, using the same syntax as String::format.
+
+	The format is parsed once, and the arguments are written by their types
+	without being boxed into a Variant array: integers, floating point numbers and
+	8-bit strings are written directly, other types (Time, String16, ...) fall back
+	to the Variant conversion of String::format.
+
+	SLIB_FORMAT("...") keeps the parsed format in static storage at the call site,
+	and fails to compile when fewer arguments are passed than the format refers to.
+
+		Log("Server", SLIB_FORMAT("%s:%d connected (%.2fms)"), host, port, elapsed);
+*/
+
+#define SLIB_FORMAT(FORMAT) \
+	([]() -> const slib::StaticStringFormat<slib::StringFormat::countArguments(FORMAT)>& { \
+		static const slib::StaticStringFormat<slib::StringFormat::countArguments(FORMAT)> format(FORMAT); \
+		return format; \
+	}())
+
+namespace slib
+{
+
+	struct SLIB_EXPORT _StringFormatItem
+	{
+		// literal text preceding the conversion, pointing into the format string
+		const sl_char8* text;
+		sl_size lenText;
+
+		// -1 for the items having only literal text
+		sl_uint32 indexArg;
+
+		// source of the conversion, used for Variant conversions
+		const sl_char8* spec;
+		sl_size lenSpec;
+
+		sl_char8 conversion;
+		sl_bool flagAlignLeft;
+		sl_bool flagSignPositive;
+		sl_bool flagLeadingSpacePositive;
+		sl_bool flagZeroPadded;
+		sl_bool flagGroupingDigits;
+		sl_bool flagEncloseNegative;
+		sl_bool flagUsePrecision;
+		sl_uint32 minWidth;
+		sl_uint32 precision;
+	};
+
+	class SLIB_EXPORT _StringFormatOutput
+	{
+	public:
+		// writes into the fixed buffer, truncating the output
+		_StringFormatOutput(sl_char8* buf, sl_size size);
+
+		// appends to the string buffer, or creates a string when `sb` is null
+		_StringFormatOutput(StringBuffer* sb);
+
+		~_StringFormatOutput();
+
+	public:
+		void write(const sl_char8* data, sl_size len);
+
+		void writeArgument(const _StringFormatItem& item, sl_int64 value);
+
+		void writeArgument(const _StringFormatItem& item, sl_uint64 value);
+
+		void writeArgument(const _StringFormatItem& item, float value);
+
+		void writeArgument(const _StringFormatItem& item, double value);
+
+		void writeArgument(const _StringFormatItem& item, const sl_char8* sz);
+
+		void writeArgument(const _StringFormatItem& item, const String& str);
+
+		void writeArgument(const _StringFormatItem& item, const Variant& var);
+
+		// returns the length of the whole output (the length before truncation for the fixed buffer)
+		sl_size finish();
+
+		String finishString();
+
+	private:
+		void _writePadded(const _StringFormatItem& item, const sl_char8* content, sl_size len);
+
+		void _writeSpaces(sl_size n);
+
+		void _flush();
+
+	private:
+		sl_char8* m_buf;
+		sl_size m_size;
+		sl_size m_pos;
+		sl_size m_length;
+		sl_bool m_flagFixed;
+		StringBuffer* m_sb;
+		sl_bool m_flagOwnStringBuffer;
+		sl_char8 m_chunk[256];
+
+	};
+
+	class SLIB_EXPORT StringFormat
+	{
+	public:
+		explicit StringFormat(const sl_char8* format);
+
+		explicit StringFormat(const String& format);
+
+		~StringFormat();
+
+	public:
+		const String& getFormat() const;
+
+		// number of arguments referred by the format
+		sl_uint32 getArgumentsCount() const;
+
+		template <class... ARGS>
+		String format(ARGS&&... args) const;
+
+		// returns the length of the whole output, which is equal to or greater than `size` when the output is truncated. `buf` is always null-terminated when `size` is not zero.
+		template <class... ARGS>
+		sl_size formatTo(sl_char8* buf, sl_size size, ARGS&&... args) const;
+
+		template <class... ARGS>
+		void formatTo(StringBuffer& sb, ARGS&&... args) const;
+
+	public:
+		template <sl_size N>
+		static constexpr sl_uint32 countArguments(const sl_char8 (&format)[N]);
+
+	protected:
+		void _parse();
+
+		template <class... ARGS>
+		void _write(_StringFormatOutput& output, ARGS&&... args) const;
+
+	protected:
+		String m_format;
+		Array<_StringFormatItem> m_items;
+		sl_uint32 m_nArgs;
+
+	};
+
+	template <sl_uint32 ARGS_COUNT>
+	class SLIB_EXPORT StaticStringFormat : public StringFormat
+	{
+	public:
+		explicit StaticStringFormat(const sl_char8* format);
+
+	public:
+		template <class... ARGS>
+		String format(ARGS&&... args) const;
+
+		template <class... ARGS>
+		sl_size formatTo(sl_char8* buf, sl_size size, ARGS&&... args) const;
+
+		template <class... ARGS>
+		void formatTo(StringBuffer& sb, ARGS&&... args) const;
+
+	};
+
+}
+
+#include "detail/string_format.h"
+
+#endif
@@ -0,0 +1,102 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CHECKHEADER_SLIB_CORE_STRING_SEARCH
+#define CHECKHEADER_SLIB_CORE_STRING_SEARCH
+
+#include "definition.h"
+
+#include "string.h"
+
+/*
+	Substring search engine used by String::indexOf/lastIndexOf and String16.
+
+	Short patterns are located by SIMD filtering on their first and last characters,
+	long patterns by the Two-Way algorithm (linear worst case, with a last-character
+	shift table for sublinear skipping on typical input).
+*/
+
+namespace slib
+{
+
+	struct SLIB_EXPORT _StringSearchTable
+	{
+		sl_size criticalPosition;
+		sl_size period;
+		sl_size memoryPeriodic;
+		sl_size shift[256];
+		sl_uint8 charset[32];
+	};
+
+	class SLIB_EXPORT StringSearcher
+	{
+	public:
+		StringSearcher();
+
+		StringSearcher(const String& pattern);
+
+		~StringSearcher();
+
+	public:
+		const String& getPattern() const;
+
+		void setPattern(const String& pattern);
+
+		// returns the index of the first occurrence at or after `start`, or -1 when not found
+		sl_reg indexOf(const sl_char8* text, sl_size len, sl_reg start = 0) const;
+
+		sl_reg indexOf(const String& text, sl_reg start = 0) const;
+
+		// searches binary data, such as multipart boundaries in a request body
+		const void* findMemory(const void* mem, sl_size size) const;
+
+	public:
+		static sl_reg search(const sl_char8* text, sl_size len, const sl_char8* pattern, sl_size lenPattern);
+
+		static sl_reg searchReverse(const sl_char8* text, sl_size len, const sl_char8* pattern, sl_size lenPattern);
+
+	private:
+		String m_pattern;
+		_StringSearchTable m_table;
+
+	};
+
+	class SLIB_EXPORT StringSearcher16
+	{
+	public:
+		StringSearcher16();
+
+		StringSearcher16(const String16& pattern);
+
+		~StringSearcher16();
+
+	public:
+		const String16& getPattern() const;
+
+		void setPattern(const String16& pattern);
+
+		sl_reg indexOf(const sl_char16* text, sl_size len, sl_reg start = 0) const;
+
+		sl_reg indexOf(const String16& text, sl_reg start = 0) const;
+
+	public:
+		static sl_reg search(const sl_char16* text, sl_size len, const sl_char16* pattern, sl_size lenPattern);
+
+		static sl_reg searchReverse(const sl_char16* text, sl_size len, const sl_char16* pattern, sl_size lenPattern);
+
+	private:
+		String16 m_pattern;
+		_StringSearchTable m_table;
+
+	};
+
+}
+
+#endif
@@ -32,6 +32,17 @@ namespace slib
 	public:
 		static Ref<ThreadPool> create(sl_uint32 minThreads = 0, sl_uint32 maxThreads = 30);
 	
+		// shared pool for the CPU-bound computations of the library, up to one thread per core
+		static Ref<ThreadPool> getComputePool();
+	
+		/*
+			Calls `task(index)` for every index in [0, count) on the compute pool and the calling thread, and returns when all calls are done.
+			The calling thread works on the items as well, so that the loop completes even if no worker is available,
+			and `task` is never called after returning (it may capture the locals by reference).
+			`maxThreads`: including the calling thread, 0 for the number of the cores.
+		*/
+		static void parallelFor(sl_size count, const Function<void(sl_size index)>& task, sl_uint32 maxThreads = 0);
+	
 	public:
 		void release();
 
@@ -14,15 +14,19 @@
 #include "crypto/md5.h"
 #include "crypto/sha1.h"
 #include "crypto/sha2.h"
+#include "crypto/blake3.h"
 #include "crypto/hash.h"
 
 #include "crypto/gcm.h"
 #include "crypto/block_cipher.h"
 #include "crypto/aes.h"
 #include "crypto/blowfish.h"
+#include "crypto/chacha.h"
 
 #include "crypto/rsa.h"
 
+#include "crypto/compress.h"
 #include "crypto/zlib.h"
+#include "crypto/lz4.h"
 
 #endif
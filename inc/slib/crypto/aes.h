@@ -23,6 +23,9 @@
 
 	User Key Size - 128 bits (16 bytes), 192 bits (24 bytes), 256 bits (32 bytes)
 	Block Size - 128 bits (16 bytes)
+
+	Blocks are processed by AES-NI (x86) or ARMv8 Cryptography Extensions when the CPU supports them,
+	otherwise by the T-table implementation.
 */
 
 namespace slib
@@ -87,6 +90,10 @@ namespace slib
 		sl_uint32 m_roundKeyEnc[64];
 		sl_uint32 m_roundKeyDec[64];
 		sl_uint32 m_nCountRounds;
+		
+		// round keys in byte order, for the hardware instructions
+		sl_uint8 m_roundKeyEncHW[240];
+		sl_uint8 m_roundKeyDecHW[240];
 
 	};
 	
@@ -0,0 +1,103 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CHECKHEADER_SLIB_CRYPTO_BLAKE3
+#define CHECKHEADER_SLIB_CRYPTO_BLAKE3
+
+#include "definition.h"
+
+#include "hash.h"
+
+/*
+	BLAKE3 - tree-structured cryptographic hash
+
+	https://github.com/BLAKE3-team/BLAKE3-specs
+
+	Output:
+		256bits (32 bytes), extendable to any length by finish(output, size)
+
+	The input is split into 1KB chunks forming the leaves of a binary tree.
+	Chunks are compressed 8 at a time across the AVX2 lanes when the CPU supports it,
+	and the subtrees of large updates (512KB or more) are hashed in parallel on a shared thread pool.
+*/
+
+namespace slib
+{
+
+	class SLIB_EXPORT BLAKE3 : public CryptoHash
+	{
+	public:
+		BLAKE3();
+
+		~BLAKE3();
+
+	public:
+		// override
+		void start();
+
+		// keyed hash (MAC) mode
+		void start(const void* key /* 32 bytes */);
+
+		// override
+		void update(const void* input, sl_size n);
+
+		// override
+		void finish(void* output);
+
+		// extendable output, `size` can be any length
+		void finish(void* output, sl_size size);
+
+	public:
+		static sl_bool hashFile(const String& path, void* output);
+
+		static Memory hashFile(const String& path);
+
+	public: /* common functions for CryptoHash */
+		static void hash(const void* input, sl_size n, void* output);
+
+		static sl_uint32 getHashSize();
+
+		static void hash(const String& s, void* output);
+
+		static void hash(const Memory& data, void* output);
+
+		static Memory hash(const void* input, sl_size n);
+
+		static Memory hash(const String& s);
+
+		static Memory hash(const Memory& data);
+
+		sl_uint32 getSize() const;
+
+	protected:
+		void _pushCV(const sl_uint8* cv, sl_uint64 chunkCounter);
+
+		void _mergeCVs(sl_uint64 totalChunks);
+
+	protected:
+		sl_uint32 m_key[8];
+		sl_uint32 m_flags;
+
+		// current chunk
+		sl_uint32 m_chunkCV[8];
+		sl_uint64 m_chunkCounter;
+		sl_uint8 m_block[64];
+		sl_uint32 m_blockLen;
+		sl_uint32 m_blocksCompressed;
+
+		// chaining values of the completed subtrees (the tree is at most 54 levels deep)
+		sl_uint8 m_stackCV[55 * 32];
+		sl_uint32 m_stackLen;
+
+	};
+
+}
+
+#endif
@@ -0,0 +1,161 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CHECKHEADER_SLIB_CRYPTO_CHACHA
+#define CHECKHEADER_SLIB_CRYPTO_CHACHA
+
+#include "definition.h"
+
+#include "../core/object.h"
+#include "../core/string.h"
+
+/*
+	ChaCha20, Poly1305 and the ChaCha20-Poly1305 AEAD
+
+	https://tools.ietf.org/html/rfc8439
+
+	ChaCha20 is a stream cipher built only on 32-bit additions, rotations and XORs, so that it runs fast
+	on the CPUs without the AES instructions. Multiple blocks are generated at once in the SIMD lanes
+	(8 blocks by AVX2, 4 blocks by SSE2 and NEON).
+	Poly1305 is a one-time authenticator evaluating a polynomial modulo 2^130-5.
+	Long messages are hashed 4 blocks at once by AVX2, using the precomputed powers of the key.
+
+	ChaCha20_Poly1305 has the same shape of the functions as GCM, so that it can replace AES_GCM.
+*/
+
+namespace slib
+{
+
+	class SLIB_EXPORT ChaCha20
+	{
+	public:
+		ChaCha20();
+
+		~ChaCha20();
+
+	public:
+		void setKey(const void* key /* 32 bytes */);
+
+		// starts the key stream at the block `counter` of the 96-bit nonce
+		void start(const void* nonce /* 12 bytes */, sl_uint32 counter = 0);
+
+		// XORs the key stream, can be called multiple times after start()
+		void encrypt(const void* src, void* dst /* out */, sl_size len);
+
+		void decrypt(const void* src, void* dst /* out */, sl_size len);
+
+	protected:
+		sl_uint32 m_state[16];
+		// unused key stream of the blocks generated at once
+		sl_uint8 m_keyStream[256];
+		sl_uint32 m_posKeyStream;
+		sl_uint32 m_sizeKeyStream;
+
+	};
+
+	class SLIB_EXPORT Poly1305
+	{
+	public:
+		Poly1305();
+
+		~Poly1305();
+
+	public:
+		void start(const void* key /* 32 bytes */);
+
+		void update(const void* input, sl_size n);
+
+		void finish(void* output /* 16 bytes */);
+
+	public:
+		static void execute(const void* key /* 32 bytes */, const void* input, sl_size n, void* output /* 16 bytes */);
+
+	protected:
+		void _processBlocks(const sl_uint8* data, sl_size nBlocks, sl_uint32 hibit);
+
+	protected:
+		sl_uint32 m_r[5];
+		sl_uint32 m_h[5];
+		sl_uint32 m_pad[4];
+		// r^2, r^3, r^4 used by the vectorized blocks
+		sl_uint32 m_rPowers[3][5];
+		sl_bool m_flagPowers;
+		sl_uint8 m_buffer[16];
+		sl_uint32 m_lenBuffer;
+
+	};
+
+	class SLIB_EXPORT ChaCha20_Poly1305 : public Object
+	{
+	public:
+		ChaCha20_Poly1305();
+
+		~ChaCha20_Poly1305();
+
+	public:
+		void setKey(const void* key /* 32 bytes */);
+
+		void setKey_SHA256(const String& key);
+
+		// lenIV should be 12
+		sl_bool start(const void* IV, sl_size lenIV);
+
+		// additional authenticated data, should be put before encrypt() and decrypt()
+		void put(const void* A, sl_size lenA);
+
+		void encrypt(const void* src, void* dst /* out */, sl_size len);
+
+		void decrypt(const void* src, void* dst /* out */, sl_size len);
+
+		sl_bool finish(void* tag /* out */, sl_size lenTag = 16 /* 4 <= lenTag <= 16 */);
+
+		sl_bool finishAndCheckTag(const void* tag, sl_size lenTag = 16 /* 4 <= lenTag <= 16 */);
+
+		sl_bool encrypt(
+			const void* IV, sl_size lenIV,
+			const void* A, sl_size lenA,
+			const void* input, void* output /* out */, sl_size len,
+			void* tag /* out */, sl_size lenTag = 16 /* 4 <= lenTag <= 16 */
+		);
+
+		sl_bool decrypt(
+			const void* IV, sl_size lenIV,
+			const void* A, sl_size lenA,
+			const void* input, void* output /* out */, sl_size len,
+			const void* tag, sl_size lenTag = 16 /* 4 <= lenTag <= 16 */
+		);
+
+#ifdef check
+#undef check
+#endif
+		sl_bool check(
+			const void* IV, sl_size lenIV,
+			const void* A, sl_size lenA,
+			const void* C, sl_size lenC,
+			const void* tag, sl_size lenTag = 16 /* 4 <= lenTag <= 16 */
+		);
+
+	protected:
+		void _padAuthData();
+
+		void _finishAuth(sl_uint8* tag);
+
+	protected:
+		ChaCha20 m_cipher;
+		Poly1305 m_auth;
+		sl_uint64 m_lenA;
+		sl_uint64 m_lenC;
+		sl_bool m_flagPaddedA;
+
+	};
+
+}
+
+#endif
@@ -0,0 +1,187 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CHECKHEADER_SLIB_CRYPTO_COMPRESS
+#define CHECKHEADER_SLIB_CRYPTO_COMPRESS
+
+#include "definition.h"
+
+#include "../core/object.h"
+#include "../core/memory.h"
+#include "../core/io.h"
+#include "../core/ptr.h"
+#include "../core/async.h"
+
+/*
+	Common interface of the streaming compressors (ZlibCompress, Lz4Compress, ...)
+
+	The streams are driven by the low-level functions working on the caller's buffers,
+	with the same return values as zlib:
+		<0: Error
+		=0: Finished
+		>0: Success (more input or output space is needed)
+*/
+
+namespace slib
+{
+
+	class SLIB_EXPORT Compressor : public Object
+	{
+		SLIB_DECLARE_OBJECT
+
+	public:
+		Compressor();
+
+		~Compressor();
+
+	public:
+		virtual sl_bool isStarted() = 0;
+
+		virtual sl_int32 compress(
+			const void* input, sl_uint32 sizeInputAvailable, sl_uint32& sizeInputPassed,
+			void* output, sl_uint32 sizeOutputAvailable, sl_uint32& sizeOutputUsed,
+			sl_bool flagFinish) = 0;
+
+		/*
+			writes the pending output so that all the input passed until now can be decompressed
+			returns
+				<0: Error
+				=0: Completed
+				>0: More output is remaining
+		*/
+		virtual sl_int32 flush(void* output, sl_uint32 sizeOutputAvailable, sl_uint32& sizeOutputUsed) = 0;
+
+		virtual void abort() = 0;
+
+	public:
+		Memory compress(const void* data, sl_size size, sl_bool flagFinish);
+
+		Memory flush();
+
+	};
+
+	class SLIB_EXPORT Decompressor : public Object
+	{
+		SLIB_DECLARE_OBJECT
+
+	public:
+		Decompressor();
+
+		~Decompressor();
+
+	public:
+		virtual sl_bool isStarted() = 0;
+
+		virtual sl_int32 decompress(
+			const void* input, sl_uint32 sizeInputAvailable, sl_uint32& sizeInputPassed,
+			void* output, sl_uint32 sizeOutputAvailable, sl_uint32& sizeOutputUsed) = 0;
+
+		virtual void abort() = 0;
+
+	public:
+		Memory decompress(const void* data, sl_size size);
+
+		// returns sl_false on error, `flagFinished` is set when the end of the stream is reached
+		sl_bool decompress(const void* data, sl_size size, MemoryBuffer& output, sl_bool* flagFinished = sl_null);
+
+	};
+
+	// compresses the written data into the output writer
+	class SLIB_EXPORT CompressionWriter : public Object, public IWriter
+	{
+	public:
+		CompressionWriter();
+
+		~CompressionWriter();
+
+	public:
+		static Ref<CompressionWriter> create(const Ref<Compressor>& compressor, const Ptr<IWriter>& output);
+
+	public:
+		// override
+		sl_reg write(const void* data, sl_size size);
+
+		// writes all the pending output of the compressor
+		sl_bool flush();
+
+		// ends the compressed stream
+		sl_bool finish();
+
+	protected:
+		sl_bool _write(const void* data, sl_size size, sl_bool flagFinish);
+
+	protected:
+		Ref<Compressor> m_compressor;
+		Ptr<IWriter> m_output;
+		Memory m_bufOutput;
+		Mutex m_lock;
+
+	};
+
+	// decompresses the data read from the input reader
+	class SLIB_EXPORT DecompressionReader : public Object, public IReader
+	{
+	public:
+		DecompressionReader();
+
+		~DecompressionReader();
+
+	public:
+		static Ref<DecompressionReader> create(const Ref<Decompressor>& decompressor, const Ptr<IReader>& input);
+
+	public:
+		// override, returns 0 at the end of the compressed stream
+		sl_reg read(void* data, sl_size size);
+
+	protected:
+		Ref<Decompressor> m_decompressor;
+		Ptr<IReader> m_input;
+		Memory m_bufInput;
+		sl_uint32 m_posInput;
+		sl_uint32 m_sizeInput;
+		sl_bool m_flagEnded;
+		sl_bool m_flagError;
+		Mutex m_lock;
+
+	};
+
+	/*
+		Compresses the data written to the filter, and decompresses the data read from the source stream.
+		Every write is flushed, so that the peer can decompress it without waiting for more data.
+		Either of the compressor and the decompressor can be null, to pass the data as is.
+	*/
+	class SLIB_EXPORT AsyncCompressionFilter : public AsyncStreamFilter
+	{
+		SLIB_DECLARE_OBJECT
+
+	protected:
+		AsyncCompressionFilter();
+
+		~AsyncCompressionFilter();
+
+	public:
+		static Ref<AsyncCompressionFilter> create(const Ref<AsyncStream>& stream, const Ref<Compressor>& compressor, const Ref<Decompressor>& decompressor);
+
+	protected:
+		// override
+		Memory filterRead(void* data, sl_uint32 size, Referable* userObject);
+
+		// override
+		Memory filterWrite(void* data, sl_uint32 size, Referable* userObject);
+
+	protected:
+		Ref<Compressor> m_compressor;
+		Ref<Decompressor> m_decompressor;
+
+	};
+
+}
+
+#endif
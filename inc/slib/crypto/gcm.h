@@ -25,6 +25,10 @@
 GCM is constructed from an approved symmetric key block cipher with a block size of 128 bits,
 such as the Advanced Encryption Standard (AES) algorithm
 
+GHASH uses carry-less multiplication (PCLMULQDQ, ARMv8 PMULL) when the CPU supports it,
+reducing once per 8 blocks with the precomputed powers of H. Otherwise the 4-bit table is used.
+Bulk encryption and decryption process 8 counter blocks at once, so that the cipher can pipeline them.
+
 */
 
 namespace slib
@@ -34,6 +38,7 @@ namespace slib
 	{
 	public:
 		Uint128 M[16]; // Shoup's, 4-bit table
+		sl_uint8 HP[8][16]; // H^1 ~ H^8 in the byte-reflected form, used by the carry-less multiplication
 	
 	public:
 		void generateTable(const void* H /* 16 bytes */);
@@ -19,7 +19,7 @@
 
 /*
 	Supported Hash Functions
-		MD5, SHA1, SHA2(224, 256, 384, 512)
+		MD5, SHA1, SHA2(224, 256, 384, 512), BLAKE3
 
 	Attention: Hash classes are not thread-safe
 */
@@ -34,7 +34,8 @@ namespace slib
 		SHA224 = 102,
 		SHA256 = 103,
 		SHA384 = 104,
-		SHA512 = 105
+		SHA512 = 105,
+		BLAKE3 = 201
 	};
 	
 	class SLIB_EXPORT CryptoHash : public Object
@@ -58,6 +59,8 @@ namespace slib
 		static Ref<CryptoHash> sha384();
 
 		static Ref<CryptoHash> sha512();
+
+		static Ref<CryptoHash> blake3();
 	
 	public:
 		virtual sl_uint32 getSize() const = 0;
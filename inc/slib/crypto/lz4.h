@@ -0,0 +1,172 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CHECKHEADER_SLIB_CRYPTO_LZ4
+#define CHECKHEADER_SLIB_CRYPTO_LZ4
+
+#include "definition.h"
+
+#include "compress.h"
+
+/*
+	LZ4 - fast LZ77-class compression
+
+	https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md
+	https://github.com/lz4/lz4/blob/dev/doc/lz4_Frame_format.md
+
+	Compression trades ratio for speed: matches of 4 bytes or longer are found by a single probe of a hash table,
+	and the search skips faster through incompressible data.
+	Decompression is a simple copy loop without entropy coding.
+
+	Lz4Compress writes the LZ4 frame format with independent blocks (readable by the lz4 command-line tool),
+	and Lz4Decompress reads any LZ4 frame including the linked blocks and the checksums.
+*/
+
+namespace slib
+{
+
+	class SLIB_EXPORT Lz4Compress : public Compressor
+	{
+	public:
+		Lz4Compress();
+
+		~Lz4Compress();
+
+	public:
+		// override
+		sl_bool isStarted();
+
+		// sizeBlock: 64KB, 256KB, 1MB or 4MB
+		sl_bool start(sl_uint32 sizeBlock = 65536, sl_bool flagContentChecksum = sl_false);
+
+		// override
+		sl_int32 compress(
+			const void* input, sl_uint32 sizeInputAvailable, sl_uint32& sizeInputPassed,
+			void* output, sl_uint32 sizeOutputAvailable, sl_uint32& sizeOutputUsed,
+			sl_bool flagFinish);
+
+		Memory compress(const void* data, sl_size size, sl_bool flagFinish);
+
+		// override, ends the current block
+		sl_int32 flush(void* output, sl_uint32 sizeOutputAvailable, sl_uint32& sizeOutputUsed);
+
+		Memory flush();
+
+		// override
+		void abort();
+
+	protected:
+		void _writeHeader();
+
+		void _compressBlock(const sl_uint8* data, sl_uint32 size);
+
+		sl_uint32 _writePending(sl_uint8* output, sl_uint32 sizeOutput);
+
+	private:
+		sl_bool m_flagStarted;
+		sl_bool m_flagHeaderWritten;
+		sl_bool m_flagFinished;
+		sl_uint32 m_sizeBlock;
+		sl_bool m_flagContentChecksum;
+		sl_uint64 m_checksum[8]; // state of XXH32
+
+		Memory m_memInput;
+		sl_uint32 m_sizeInput;
+
+		Memory m_memOutput;
+		sl_uint32 m_sizeOutput;
+		sl_uint32 m_posOutput;
+
+		Memory m_memTable;
+
+	};
+
+	class SLIB_EXPORT Lz4Decompress : public Decompressor
+	{
+	public:
+		Lz4Decompress();
+
+		~Lz4Decompress();
+
+	public:
+		// override
+		sl_bool isStarted();
+
+		sl_bool start();
+
+		// override
+		sl_int32 decompress(
+			const void* input, sl_uint32 sizeInputAvailable, sl_uint32& sizeInputPassed,
+			void* output, sl_uint32 sizeOutputAvailable, sl_uint32& sizeOutputUsed);
+
+		Memory decompress(const void* data, sl_size size);
+
+		// override
+		void abort();
+
+	protected:
+		sl_bool _parseHeader();
+
+		// returns the size written to `output` directly, or -1 on error
+		sl_reg _decompressBlock(const sl_uint8* data, sl_uint32 size, sl_uint8* output, sl_uint32 sizeOutput);
+
+	private:
+		sl_bool m_flagStarted;
+		sl_uint32 m_state;
+
+		sl_uint8 m_header[20];
+		sl_uint32 m_sizeHeader;
+		sl_uint32 m_sizeHeaderNeeded;
+
+		sl_uint32 m_sizeBlockMax;
+		sl_bool m_flagLinkedBlocks;
+		sl_bool m_flagBlockChecksum;
+		sl_bool m_flagContentChecksum;
+		sl_uint64 m_checksum[8]; // state of XXH32
+
+		sl_uint32 m_sizeBlock;
+		sl_bool m_flagBlockCompressed;
+		Memory m_memInput;
+		sl_uint32 m_sizeInput;
+
+		// decoded block, preceded by the history of 64KB for the linked blocks
+		Memory m_memOutput;
+		sl_uint32 m_posOutput;
+		sl_uint32 m_endOutput;
+
+	};
+
+	class SLIB_EXPORT Lz4
+	{
+	public:
+		// maximum size of the compressed block
+		static sl_size getCompressBound(sl_size size);
+
+		/*
+			raw block format
+			`output` should be at least getCompressBound(size) bytes, returns the size of the compressed block
+		*/
+		static sl_size compressBlock(const void* input, sl_size size, void* output);
+
+		// returns the size of the decompressed data, or -1 on the corrupted input or the insufficient output
+		static sl_reg decompressBlock(const void* input, sl_size size, void* output, sl_size sizeOutput);
+
+		/*
+			frame format
+		*/
+		static Memory compress(const void* data, sl_size size);
+
+		static Memory decompress(const void* data, sl_size size);
+
+	};
+
+}
+
+#endif
@@ -61,6 +61,66 @@ namespace slib
 
 	};
 	
+	/*
+		Precomputed form of the RSA keys for the repeated operations with the same key
+
+		The Montgomery parameters (R^2 and R^3 modulo N, or modulo P and Q for the CRT)
+		are computed once by setKey(), and execute() works on the byte strings directly,
+		without heap allocation for the keys up to 4096 bits.
+		A context is not modified by execute(), so it can be shared by multiple threads.
+	*/
+	class SLIB_EXPORT RSAPublicKeyContext
+	{
+	public:
+		RSAPublicKeyContext();
+
+		~RSAPublicKeyContext();
+
+	public:
+		sl_bool setKey(const RSAPublicKey& key);
+
+		const RSAPublicKey& getKey() const;
+
+		sl_uint32 getLength() const;
+
+		sl_bool execute(const void* src, void* dst) const;
+
+	protected:
+		RSAPublicKey m_key;
+		sl_uint32 m_length;
+		Memory m_bytesN;
+		BigIntMontgomery m_montN;
+
+	};
+
+	class SLIB_EXPORT RSAPrivateKeyContext
+	{
+	public:
+		RSAPrivateKeyContext();
+
+		~RSAPrivateKeyContext();
+
+	public:
+		sl_bool setKey(const RSAPrivateKey& key);
+
+		const RSAPrivateKey& getKey() const;
+
+		sl_uint32 getLength() const;
+
+		sl_bool execute(const void* src, void* dst) const;
+
+	protected:
+		RSAPrivateKey m_key;
+		sl_uint32 m_length;
+		Memory m_bytesN;
+		// used when `flagUseOnlyD` is set
+		BigIntMontgomery m_montN;
+		// used for CRT
+		BigIntMontgomery m_montP;
+		BigIntMontgomery m_montQ;
+
+	};
+	
 	class SLIB_EXPORT RSA
 	{
 	public:
@@ -89,6 +149,40 @@ namespace slib
 		static sl_uint32 decryptPublic_oaep_v21(const RSAPublicKey& key, const Ref<CryptoHash>& hash, const void* input, void* output, sl_uint32 sizeOutputBuffer, const void* label = 0, sl_uint32 sizeLabel = 0);
 
 		static sl_uint32 decryptPrivate_oaep_v21(const RSAPrivateKey& key, const Ref<CryptoHash>& hash, const void* input, void* output, sl_uint32 sizeOutputBuffer, const void* label = 0, sl_uint32 sizeLabel = 0);
+
+	public:
+		/*
+			Operations with the precomputed key contexts
+		*/
+		static sl_bool executePublic(const RSAPublicKeyContext& context, const void* src, void* dst);
+
+		static sl_bool executePrivate(const RSAPrivateKeyContext& context, const void* src, void* dst);
+
+		static sl_bool encryptPublic_pkcs1_v15(const RSAPublicKeyContext& context, const void* input, sl_uint32 sizeInput, void* output);
+
+		static sl_bool encryptPrivate_pkcs1_v15(const RSAPrivateKeyContext& context, const void* input, sl_uint32 sizeInput, void* output);
+
+		static sl_uint32 decryptPublic_pkcs1_v15(const RSAPublicKeyContext& context, const void* input, void* output, sl_uint32 sizeOutputBuffer, sl_bool* pFlagSign = sl_null);
+
+		static sl_uint32 decryptPrivate_pkcs1_v15(const RSAPrivateKeyContext& context, const void* input, void* output, sl_uint32 sizeOutputBuffer, sl_bool* pFlagSign = sl_null);
+
+		static sl_bool encryptPublic_oaep_v21(const RSAPublicKeyContext& context, const Ref<CryptoHash>& hash, const void* input, sl_uint32 sizeInput, void* output, const void* label = 0, sl_uint32 sizeLabel = 0);
+
+		static sl_bool encryptPrivate_oaep_v21(const RSAPrivateKeyContext& context, const Ref<CryptoHash>& hash, const void* input, sl_uint32 sizeInput, void* output, const void* label = 0, sl_uint32 sizeLabel = 0);
+
+		static sl_uint32 decryptPublic_oaep_v21(const RSAPublicKeyContext& context, const Ref<CryptoHash>& hash, const void* input, void* output, sl_uint32 sizeOutputBuffer, const void* label = 0, sl_uint32 sizeLabel = 0);
+
+		static sl_uint32 decryptPrivate_oaep_v21(const RSAPrivateKeyContext& context, const Ref<CryptoHash>& hash, const void* input, void* output, sl_uint32 sizeOutputBuffer, const void* label = 0, sl_uint32 sizeLabel = 0);
+
+		/*
+			Batch operations, distributed over the shared thread pool on the multi-core systems.
+			No memory is allocated for each item, and the calling thread returns after all items are done.
+		*/
+		// results[i] = executePublic(context, inputs[i], outputs[i]), `results` can be null
+		static void executePublicBatch(const RSAPublicKeyContext& context, const void* const* inputs, void* const* outputs, sl_bool* results, sl_size count);
+
+		// results[i] is true when signatures[i] is a PKCS#1 v1.5 signature (block type 1) of messages[i]
+		static void verifyPublicBatch_pkcs1_v15(const RSAPublicKeyContext& context, const void* const* signatures, const void* const* messages, const sl_uint32* sizesMessage, sl_bool* results, sl_size count);
 	
 	};
 
@@ -19,6 +19,8 @@
 	SHA1 - Secure Hash Algorithm
 
 	Output: 160bits (20 bytes)
+
+	Uses SHA-NI (x86) or ARMv8 SHA1 instructions when the CPU supports them.
 */
 
 namespace slib
@@ -23,6 +23,8 @@
 		SHA256 - 256bits (32 bytes)
 		SHA384 - 384bits (48 bytes)
 		SHA512 - 512bits (64 bytes)
+
+	SHA224 and SHA256 use SHA-NI (x86) or ARMv8 SHA2 instructions when the CPU supports them.
 */
 
 namespace slib
@@ -103,6 +105,11 @@ namespace slib
 	public:
 		static sl_uint32 make32bitChecksum(const void* input, sl_size n);
 
+		// hashes `count` independent messages, in parallel across the AVX2 lanes when SHA-NI is not available
+		static void hashBatch(const void* const* inputs, const sl_size* sizes, void* const* outputs /* 32 bytes each */, sl_size count);
+
+		static void hashBatch(const Memory* inputs, void* outputs /* 32 * count bytes */, sl_size count);
+
 	public: /* common functions for CryptoHash */
 		static void hash(const void* input, sl_size n, void* output);
 
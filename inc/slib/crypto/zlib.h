@@ -13,9 +13,10 @@
 
 #include "definition.h"
 
-#include "../core/object.h"
-#include "../core/memory.h"
+#include "compress.h"
+
 #include "../core/string.h"
+#include "../core/queue.h"
 
 namespace slib
 {
@@ -33,7 +34,7 @@ namespace slib
 
 	};
 
-	class SLIB_EXPORT ZlibCompress : public Object
+	class SLIB_EXPORT ZlibCompress : public Compressor
 	{
 	public:
 		ZlibCompress();
@@ -41,6 +42,7 @@ namespace slib
 		~ZlibCompress();
 	
 	public:
+		// override
 		sl_bool isStarted();
 	
 		/*
@@ -70,13 +72,20 @@ namespace slib
 				=0: Finished
 				>0: Success
 		*/
+		// override
 		sl_int32 compress(
 			const void* input, sl_uint32 sizeInputAvailable, sl_uint32& sizeInputPassed,
 			void* output, sl_uint32 sizeOutputAvailable, sl_uint32& sizeOutputUsed,
 			sl_bool flagFinish);
 	
 		Memory compress(const void* data, sl_size size, sl_bool flagFinish);
+
+		// override, sync flush
+		sl_int32 flush(void* output, sl_uint32 sizeOutputAvailable, sl_uint32& sizeOutputUsed);
+
+		Memory flush();
 	
+		// override
 		void abort();
 	
 	private:
@@ -90,7 +99,7 @@ namespace slib
 
 	};
 	
-	class SLIB_EXPORT ZlibDecompress : public Object
+	class SLIB_EXPORT ZlibDecompress : public Decompressor
 	{
 	public:
 		ZlibDecompress();
@@ -98,6 +107,7 @@ namespace slib
 		~ZlibDecompress();
 
 	public:
+		// override
 		sl_bool isStarted();
 	
 		// zlib and gzip wrapper
@@ -112,12 +122,14 @@ namespace slib
 				=0: Finished
 				>0: Success
 		*/
+		// override
 		sl_int32 decompress(
 			const void* input, sl_uint32 sizeInputAvailable, sl_uint32& sizeInputPassed,
 			void* output, sl_uint32 sizeOutputAvailable, sl_uint32& sizeOutputUsed);
 
 		Memory decompress(const void* data, sl_size size);
 	
+		// override
 		void abort();
 	
 	private:
@@ -126,6 +138,66 @@ namespace slib
 
 	};
 	
+	class _ZlibParallel_Block;
+
+	/*
+		Parallel gzip compressor (pigz-style), as a streaming IWriter filter
+
+		The input is split into blocks (128KB by default) compressed concurrently on a thread pool.
+		Every block is a raw deflate stream primed by the last 32KB of the previous block,
+		and all but the last block are ended by a sync flush at a byte boundary,
+		so that the blocks are concatenated into a single deflate stream of one gzip member.
+		The CRC32 of the blocks are combined into the trailer.
+	*/
+	class SLIB_EXPORT ZlibParallelCompress : public Object, public IWriter
+	{
+	public:
+		ZlibParallelCompress();
+
+		~ZlibParallelCompress();
+
+	public:
+		sl_bool isStarted();
+
+		// the compressed stream is written to `output`, level = 0 ~ 9
+		sl_bool startGzip(const Ptr<IWriter>& output, const GzipParam& param, sl_int32 level = 6);
+
+		sl_bool startGzip(const Ptr<IWriter>& output, sl_int32 level = 6);
+
+		// should be called before start
+		void setBlockSize(sl_uint32 size);
+
+		// override
+		sl_reg write(const void* data, sl_size size);
+
+		// compresses the remaining data and writes the trailer, returns sl_false on error
+		sl_bool finish();
+
+		void abort();
+
+	protected:
+		sl_bool _dispatchBlock(sl_bool flagLast);
+
+		sl_bool _writeBlock(_ZlibParallel_Block* block);
+
+	protected:
+		Ptr<IWriter> m_output;
+		sl_int32 m_level;
+		sl_uint32 m_sizeBlock;
+		sl_uint32 m_nThreads;
+
+		Memory m_memBlock;
+		sl_uint32 m_sizeFilled;
+		Memory m_memPrevBlock;
+
+		LinkedQueue< Ref<_ZlibParallel_Block> > m_blocks;
+		sl_uint32 m_crc;
+		sl_uint64 m_sizeTotal;
+
+		sl_bool m_flagStarted;
+
+	};
+
 	class SLIB_EXPORT Zlib
 	{
 	public:
@@ -148,6 +220,22 @@ namespace slib
 
 		static sl_uint32 crc32(const Memory& mem);
 
+		// CRC32 of the concatenation, from the CRC32 of both parts and the size of the second part
+		static sl_uint32 crc32Combine(sl_uint32 crc1, sl_uint32 crc2, sl_uint64 size2);
+
+		/*
+			CRC32C (Castagnoli), used by iSCSI, SCTP, ext4, ...
+		*/
+		static sl_uint32 crc32c(sl_uint32 crc, const void* data, sl_size size);
+
+		static sl_uint32 crc32c(const void* data, sl_size size);
+
+		static sl_uint32 crc32c(sl_uint32 crc, const Memory& mem);
+
+		static sl_uint32 crc32c(const Memory& mem);
+
+		static sl_uint32 crc32cCombine(sl_uint32 crc1, sl_uint32 crc2, sl_uint64 size2);
+
 		/*
 			Compress
 		*/
@@ -158,6 +246,11 @@ namespace slib
 		static Memory compressGzip(const GzipParam& param, const void* data, sl_size size, sl_int32 level = 6);
 
 		static Memory compressGzip(const void* data, sl_size size, sl_int32 level = 6);
+
+		// compresses the blocks concurrently, see ZlibParallelCompress
+		static Memory compressGzipParallel(const GzipParam& param, const void* data, sl_size size, sl_int32 level = 6, sl_uint32 sizeBlock = 0 /* default: 128KB */);
+
+		static Memory compressGzipParallel(const void* data, sl_size size, sl_int32 level = 6, sl_uint32 sizeBlock = 0 /* default: 128KB */);
 	
 		/*
 			Decompress
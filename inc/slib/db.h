@@ -12,6 +12,10 @@
 #define CHECKHEADER_SLIB_DB_HEADER
 
 #include "db/database.h"
+#include "db/database_pool.h"
+#include "db/database_bulk_inserter.h"
+#include "db/async_database.h"
+#include "db/database_cache.h"
 
 #include "db/sqlite.h"
 #include "db/mysql.h"
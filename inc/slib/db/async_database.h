@@ -0,0 +1,168 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CHECKHEADER_SLIB_DB_ASYNC_DATABASE
+#define CHECKHEADER_SLIB_DB_ASYNC_DATABASE
+
+#include "definition.h"
+
+#include "database.h"
+
+#include "../core/array.h"
+#include "../core/dispatch.h"
+
+/*
+	AsyncDatabase
+
+	Runs the database calls on the dedicated worker threads, and delivers the results to the callbacks,
+	so that the callers (such as the handlers of HttpService) are not blocked by the database.
+
+	Each connection is owned by one worker thread, and never used by the other threads.
+	The tasks are queued to the least busy connection, so that many independent queries run in a pipeline;
+	the tasks given to the same connection index run in the order of submission.
+	The callbacks run on the dispatcher when it is given, otherwise on the worker thread.
+*/
+
+namespace slib
+{
+
+	class _AsyncDatabaseConnection;
+
+	class SLIB_EXPORT AsyncDatabaseParam
+	{
+	public:
+		// the connections to the same database, one worker thread per connection
+		List< Ref<Database> > connections;
+
+		Ref<Dispatcher> dispatcher;
+
+		// maximum number of the queued tasks, 0: unlimited
+		sl_uint32 maxQueueSize;
+
+	public:
+		AsyncDatabaseParam();
+
+		~AsyncDatabaseParam();
+
+	};
+
+	class SLIB_EXPORT AsyncDatabase : public Object
+	{
+		SLIB_DECLARE_OBJECT
+
+	protected:
+		AsyncDatabase();
+
+		~AsyncDatabase();
+
+	public:
+		static Ref<AsyncDatabase> create(const AsyncDatabaseParam& param);
+
+		static Ref<AsyncDatabase> create(const Ref<Database>& db, const Ref<Dispatcher>& dispatcher = sl_null);
+
+	public:
+		// stops the workers after running the queued tasks (the tasks still queued when the object is freed without release() are dropped)
+		void release();
+
+		sl_bool isRunning();
+
+		sl_uint32 getConnectionsCount();
+
+		/*
+			Runs the task on the worker of the connection (the least busy one when `connectionIndex` is negative).
+			Returns sl_false when the queue is full or released.
+		*/
+		sl_bool run(const Function<void(Database* db)>& task, sl_int32 connectionIndex = -1);
+
+
+		// the callback receives the result of Database::executeBy(), -1 on error
+		sl_bool executeBy(const String& sql, const Variant* params, sl_uint32 nParams, const Function<void(sl_int64 result)>& callback);
+
+		SLIB_INLINE sl_bool execute(const String& sql, const Function<void(sl_int64 result)>& callback)
+		{
+			return executeBy(sql, sl_null, 0, callback);
+		}
+
+		template <class... ARGS>
+		SLIB_INLINE sl_bool execute(const String& sql, const Function<void(sl_int64 result)>& callback, ARGS&&... args)
+		{
+			Variant params[] = {Forward<ARGS>(args)...};
+			return executeBy(sql, params, sizeof...(args), callback);
+		}
+
+		// the rows are fetched on the worker thread
+		sl_bool queryBy(const String& sql, const Variant* params, sl_uint32 nParams, const Function<void(List< Map<String, Variant> >& rows)>& callback);
+
+		SLIB_INLINE sl_bool query(const String& sql, const Function<void(List< Map<String, Variant> >& rows)>& callback)
+		{
+			return queryBy(sql, sl_null, 0, callback);
+		}
+
+		template <class... ARGS>
+		SLIB_INLINE sl_bool query(const String& sql, const Function<void(List< Map<String, Variant> >& rows)>& callback, ARGS&&... args)
+		{
+			Variant params[] = {Forward<ARGS>(args)...};
+			return queryBy(sql, params, sizeof...(args), callback);
+		}
+
+		sl_bool getValueForQueryResultBy(const String& sql, const Variant* params, sl_uint32 nParams, const Function<void(Variant& value)>& callback);
+
+		SLIB_INLINE sl_bool getValueForQueryResult(const String& sql, const Function<void(Variant& value)>& callback)
+		{
+			return getValueForQueryResultBy(sql, sl_null, 0, callback);
+		}
+
+		template <class... ARGS>
+		SLIB_INLINE sl_bool getValueForQueryResult(const String& sql, const Function<void(Variant& value)>& callback, ARGS&&... args)
+		{
+			Variant params[] = {Forward<ARGS>(args)...};
+			return getValueForQueryResultBy(sql, params, sizeof...(args), callback);
+		}
+
+	public:
+		// number of the tasks waiting in the queues
+		sl_uint32 getQueueDepth();
+
+		sl_uint64 getCompletedTasksCount();
+
+		// milliseconds from the submission to the end of the task (before the callback is dispatched)
+		double getAverageLatency();
+
+		double getMaximumLatency();
+
+		// milliseconds from the submission to the start of the task
+		double getAverageQueueTime();
+
+		void resetMetrics();
+
+	protected:
+		static void _runWorker(const WeakRef<AsyncDatabase>& weak, _AsyncDatabaseConnection* connection);
+
+		void _dispatchCallback(const Function<void()>& callback);
+
+	protected:
+		Array< Ref<_AsyncDatabaseConnection> > m_connections;
+		Ref<Dispatcher> m_dispatcher;
+		sl_uint32 m_maxQueueSize;
+		sl_bool m_flagRunning;
+
+		sl_reg m_nQueuedTasks;
+
+		Mutex m_lockMetrics;
+		sl_uint64 m_nCompletedTasks;
+		sl_int64 m_sumLatency;
+		sl_int64 m_maxLatency;
+		sl_int64 m_sumQueueTime;
+
+	};
+
+}
+
+#endif
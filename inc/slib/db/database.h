@@ -17,11 +17,119 @@
 #include "../core/list.h"
 #include "../core/map.h"
 #include "../core/variant.h"
+#include "../core/linked_list.h"
+#include "../core/mutex.h"
+#include "../core/function.h"
 
 namespace slib
 {
 	
 	class Database;
+
+	enum class DatabaseColumnType
+	{
+		Null = 0,
+		Integer = 1,
+		Float = 2,
+		Text = 3,
+		Blob = 4
+	};
+
+	/*
+		DatabaseBatch
+
+		Rows fetched at once by DatabaseCursor::fetchBatch(), stored by columns.
+		Each column is kept in the typed vectors (the types, 64-bit integers and doubles),
+		and the texts and the blobs of all cells are packed in one memory, so that reading the batch never allocates.
+	*/
+	class SLIB_EXPORT DatabaseBatch : public Referable
+	{
+	protected:
+		DatabaseBatch();
+
+		~DatabaseBatch();
+
+	public:
+		static Ref<DatabaseBatch> create(const String* columnNames, sl_uint32 nColumns, sl_uint32 nRowsCapacity);
+
+	public:
+		sl_uint32 getRowsCount();
+
+		sl_uint32 getColumnsCount();
+
+		String getColumnName(sl_uint32 column);
+
+		// returns -1 when the column name not found
+		sl_int32 getColumnIndex(const String& name);
+
+
+		DatabaseColumnType getType(sl_uint32 row, sl_uint32 column);
+
+		sl_bool isNull(sl_uint32 row, sl_uint32 column);
+
+		// the integers and the floats are converted to each other, and the others are 0
+		sl_int64 getInt64(sl_uint32 row, sl_uint32 column);
+
+		double getDouble(sl_uint32 row, sl_uint32 column);
+
+		// null-terminated UTF-8 text of the Text cell, valid while the batch is alive
+		const sl_char8* getText(sl_uint32 row, sl_uint32 column, sl_size* outLength = sl_null);
+
+		// bytes of the Text or Blob cell, valid while the batch is alive
+		const void* getBlobData(sl_uint32 row, sl_uint32 column, sl_size* outSize = sl_null);
+
+		String getString(sl_uint32 row, sl_uint32 column);
+
+		// refers the memory of the batch without copying
+		Memory getBlob(sl_uint32 row, sl_uint32 column);
+
+		Variant getValue(sl_uint32 row, sl_uint32 column);
+
+
+		// column vectors of `getRowsCount()` elements
+		const sl_uint8* getColumnTypes(sl_uint32 column);
+
+		const sl_int64* getInt64Column(sl_uint32 column);
+
+		const double* getDoubleColumn(sl_uint32 column);
+
+	public:
+		/*
+			Used by the drivers: setXXX() writes the cell of the row being added (initially Null),
+			and addRow() completes the row, which returns sl_false when the batch is full.
+		*/
+		sl_uint32 getRowsCapacity();
+
+		void setInt64(sl_uint32 column, sl_int64 value);
+
+		void setDouble(sl_uint32 column, double value);
+
+		sl_bool setText(sl_uint32 column, const void* text, sl_size length);
+
+		sl_bool setBlob(sl_uint32 column, const void* data, sl_size size);
+
+		sl_bool addRow();
+
+	protected:
+		sl_bool _addData(sl_uint32 column, sl_uint8 type, const void* data, sl_size size, sl_bool flagNullTerminated);
+
+	protected:
+		Array<String> m_columnNames;
+		sl_uint32 m_nColumns;
+		sl_uint32 m_nRows;
+		sl_uint32 m_nRowsCapacity;
+
+		Memory m_memCells;
+		sl_uint8* m_types;
+		sl_int64* m_ints;
+		double* m_doubles;
+		sl_size* m_offsets;
+		sl_size* m_sizes;
+
+		Memory m_memData;
+		sl_size m_sizeData;
+
+	};
 	
 	class SLIB_EXPORT DatabaseCursor : public Object
 	{
@@ -44,6 +152,9 @@ namespace slib
 	
 
 		virtual Map<String, Variant> getRow() = 0;
+
+		// fills the values of the current row by the column order, keeping the native types; returns the number of the filled values
+		virtual sl_uint32 getRowValues(Variant* values, sl_uint32 nValues);
 	
 
 		virtual Variant getValue(sl_uint32 index);
@@ -98,13 +209,28 @@ namespace slib
 		virtual Memory getBlob(sl_uint32 index) = 0;
 
 		virtual Memory getBlob(const String& name);
+
+
+		/*
+			Accesses the column of the current row without copying, where the drivers support.
+			The returned data is valid until moveNext() or the next access to the cursor.
+		*/
+		virtual const sl_char8* getText(sl_uint32 index, sl_size* outLength = sl_null);
+
+		virtual const void* getBlobData(sl_uint32 index, sl_size* outSize = sl_null);
 	
 
 		virtual sl_bool moveNext() = 0;
+
+		// moves forward by up to `nRows` rows and returns them, or null when no row remains
+		virtual Ref<DatabaseBatch> fetchBatch(sl_uint32 nRows);
 	
 	protected:
 		Ref<Database> m_db;
 
+		String m_strView;
+		Memory m_memView;
+
 	};
 	
 	class SLIB_EXPORT DatabaseStatement : public Object
@@ -189,6 +315,9 @@ namespace slib
 			return getValueForQueryResultBy(params, sizeof...(args));
 		}
 
+		// returns sl_true when the statement never writes to the database
+		virtual sl_bool isReadOnly();
+
 	protected:
 		Ref<Database> m_db;
 
@@ -265,7 +394,84 @@ namespace slib
 	
 		virtual String getErrorMessage() = 0;
 
-	
+	public:
+		/*
+			Transactions are not nested. By default, executes BEGIN, COMMIT and ROLLBACK.
+			When the connection is shared by the threads, use DatabaseTransaction to keep the others out of the transaction.
+		*/
+		virtual sl_bool beginTransaction();
+
+		virtual sl_bool commit();
+
+		virtual sl_bool rollback();
+
+		/*
+			The callback is called with the table name when a row is changed by this connection
+			(and again after the change is committed, where the database reports it), and with the null string on rollback.
+			Returns sl_false when the database does not report the changes.
+		*/
+		virtual sl_bool setTableChangeCallback(const Function<void(const String& table)>& callback);
+
+	public:
+		/*
+			The prepared statements used by executeBy(), queryBy(), getListForQueryResultBy(), ...
+			are kept in the per-connection LRU cache keyed by the SQL text.
+			The capacity 0 disables the cache.
+		*/
+		sl_uint32 getStatementCacheCapacity();
+
+		void setStatementCacheCapacity(sl_uint32 capacity);
+
+		sl_uint64 getStatementCacheHitsCount();
+
+		sl_uint64 getStatementCacheMissesCount();
+
+		void clearStatementCache();
+
+	protected:
+		// returns a statement reusing the cached native statement when possible, by default same as prepareStatement()
+		virtual Ref<DatabaseStatement> prepareCachedStatement(const String& sql);
+
+		// takes the native statement out of the cache, so that it is never shared by two statements
+		Ref<Referable> takeCachedStatement(const String& sql);
+
+		// gives back the native statement (already reset) to the cache, evicting the least recently used one
+		void putCachedStatement(const String& sql, const Ref<Referable>& handle);
+
+	protected:
+		struct _StatementCacheItem
+		{
+			String sql;
+			Ref<Referable> handle;
+		};
+		CLinkedList<_StatementCacheItem> m_listStatementCache;
+		HashMap< String, Link<_StatementCacheItem>* > m_mapStatementCache;
+		sl_uint32 m_capacityStatementCache;
+		sl_uint64 m_nStatementCacheHits;
+		sl_uint64 m_nStatementCacheMisses;
+		Mutex m_lockStatementCache;
+
+	};
+
+	// begins the transaction and locks the connection in the scope, and rolls back unless committed
+	class SLIB_EXPORT DatabaseTransaction
+	{
+	public:
+		DatabaseTransaction(const Ref<Database>& db);
+
+		~DatabaseTransaction();
+
+	public:
+		sl_bool isStarted();
+
+		sl_bool commit();
+
+		void rollback();
+
+	private:
+		Ref<Database> m_db;
+		sl_bool m_flagStarted;
+
 	};
 
 }
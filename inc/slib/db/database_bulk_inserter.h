@@ -0,0 +1,131 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CHECKHEADER_SLIB_DB_DATABASE_BULK_INSERTER
+#define CHECKHEADER_SLIB_DB_DATABASE_BULK_INSERTER
+
+#include "definition.h"
+
+#include "database.h"
+
+#include "../core/array.h"
+
+/*
+	DatabaseBulkInserter
+
+	Inserts many rows into a table through the prepared statements reused for all rows.
+	The rows are grouped into the multi-row statements (INSERT ... VALUES (...), (...), ...),
+	and the statements are grouped into the transactions, committed every `rowsPerTransaction` rows
+	or when `transactionInterval` passed since the transaction began (checked on each insertion).
+	Call flush() to commit the remaining rows when the input is idle; the destructor also flushes.
+
+	The transaction spans the calls, so the connection should be dedicated to the inserter while inserting
+	(for DatabasePool, the inserter uses the writer).
+*/
+
+namespace slib
+{
+
+	class SLIB_EXPORT DatabaseBulkInserterParam
+	{
+	public:
+		Ref<Database> database;
+
+		String table;
+
+		List<String> columns;
+
+		// 0: as many rows as the parameter limit of SQLite (999) allows, up to 64
+		sl_uint32 rowsPerStatement;
+
+		sl_uint32 rowsPerTransaction;
+
+		// milliseconds, 0: not committed by time
+		sl_uint32 transactionInterval;
+
+	public:
+		DatabaseBulkInserterParam();
+
+		~DatabaseBulkInserterParam();
+
+	};
+
+	class SLIB_EXPORT DatabaseBulkInserter : public Object
+	{
+		SLIB_DECLARE_OBJECT
+
+	protected:
+		DatabaseBulkInserter();
+
+		~DatabaseBulkInserter();
+
+	public:
+		static Ref<DatabaseBulkInserter> create(const DatabaseBulkInserterParam& param);
+
+	public:
+		/*
+			returns sl_false on error: the pending rows before the failed row are inserted (a failed multi-row statement is retried row by row),
+			and the failed row and the following pending rows are dropped
+		*/
+		sl_bool insertBy(const Variant* values, sl_uint32 nValues);
+
+		sl_bool insertBy(const List<Variant>& values);
+
+		template <class... ARGS>
+		SLIB_INLINE sl_bool insert(ARGS&&... args)
+		{
+			Variant values[] = {Forward<ARGS>(args)...};
+			return insertBy(values, sizeof...(args));
+		}
+
+		// executes the pending rows and commits the transaction
+		sl_bool flush();
+
+		sl_uint64 getInsertedRowsCount();
+
+		sl_uint64 getCommittedRowsCount();
+
+		// index of the last row failed to insert, counting the rows passed to insertBy() from 0; -1 when no row failed
+		sl_int64 getFailedRowIndex();
+
+	protected:
+		sl_bool _executePending();
+
+		sl_bool _commit();
+
+	protected:
+		Ref<Database> m_db;
+		sl_uint32 m_nColumns;
+		sl_uint32 m_rowsPerStatement;
+		sl_uint32 m_rowsPerTransaction;
+		sl_uint32 m_transactionInterval;
+
+		String m_sqlSingle;
+		String m_sqlMulti;
+		Ref<DatabaseStatement> m_statementSingle;
+		Ref<DatabaseStatement> m_statementMulti;
+
+		Array<Variant> m_pending;
+		sl_uint32 m_nPendingRows;
+
+		sl_bool m_flagTransaction;
+		sl_uint32 m_tickTransactionBegan;
+		sl_uint32 m_nTransactionRows;
+
+		sl_uint64 m_nQueuedRows;
+		sl_uint64 m_nInsertedRows;
+		sl_uint64 m_nCommittedRows;
+		sl_int64 m_indexFailedRow;
+
+	};
+
+}
+
+#endif
@@ -0,0 +1,184 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CHECKHEADER_SLIB_DB_DATABASE_CACHE
+#define CHECKHEADER_SLIB_DB_DATABASE_CACHE
+
+#include "definition.h"
+
+#include "database.h"
+
+/*
+	DatabaseCache
+
+	Caches the results of getListForQueryResult(), getRecordForQueryResult() and getValueForQueryResult()
+	of the underlying database, keyed by the SQL text and the parameters.
+	The results are kept in a compact serialized form, and expire after `expiringMilliseconds`
+	or when the cache exceeds `maxMemorySize` (the least recently used first).
+
+	Each result depends on the tables read by the query (parsed from the FROM and JOIN clauses, or declared by setQueryTables()),
+	and is invalidated by the writes through the cache to any of them (parsed from INSERT, UPDATE, DELETE and REPLACE;
+	the other statements invalidate all). Where the database reports the changed tables (SQLite),
+	the writes bypassing the cache, such as the prepared statements and the triggers, also invalidate the results.
+	The reports are best-effort: SQLite does not report the truncate optimization (DELETE without WHERE)
+	and the changes of the WITHOUT ROWID tables, so such writes should be run through the cache, or followed by invalidateTable().
+
+	Only SELECT (and WITH, VALUES) statements reading at least one table are cached; a query without FROM
+	(such as SELECT last_insert_rowid()) is never cached unless declared by setQueryTables().
+	The view names are not resolved: a query reading a view must declare the underlying tables by setQueryTables().
+	The queries depending on the time or the random values should not be run through the cache.
+	Use the cache as Ref<Database> to call the variadic overloads.
+*/
+
+namespace slib
+{
+
+	class SLIB_EXPORT DatabaseCacheParam
+	{
+	public:
+		Ref<Database> database;
+
+		// 0: never expire
+		sl_uint32 expiringMilliseconds;
+
+		sl_size maxMemorySize;
+
+		// larger results are not cached
+		sl_size maxResultSize;
+
+	public:
+		DatabaseCacheParam();
+
+		~DatabaseCacheParam();
+
+	};
+
+	class SLIB_EXPORT DatabaseCache : public Database
+	{
+		SLIB_DECLARE_OBJECT
+
+	protected:
+		DatabaseCache();
+
+		~DatabaseCache();
+
+	public:
+		static Ref<DatabaseCache> create(const DatabaseCacheParam& param);
+
+	public:
+		Ref<Database> getDatabase();
+
+		// declares the tables which the query depends on (the underlying tables for a view), instead of parsing the SQL
+		void setQueryTables(const String& sql, const List<String>& tables);
+
+		void invalidateTable(const String& table);
+
+		void invalidateAll();
+
+		sl_uint64 getHitsCount();
+
+		sl_uint64 getMissesCount();
+
+		sl_size getEntriesCount();
+
+		sl_size getMemorySize();
+
+	public:
+		// override, not cached
+		Ref<DatabaseStatement> prepareStatement(const String& sql);
+
+		// override
+		sl_int64 executeBy(const String& sql, const Variant* params, sl_uint32 nParams);
+
+		// override, not cached
+		Ref<DatabaseCursor> queryBy(const String& sql, const Variant* params, sl_uint32 nParams);
+
+		// override
+		List< Map<String, Variant> > getListForQueryResult(const String& sql);
+
+		// override
+		Map<String, Variant> getRecordForQueryResult(const String& sql);
+
+		// override
+		Variant getValueForQueryResult(const String& sql);
+
+		// override
+		List< Map<String, Variant> > getListForQueryResultBy(const String& sql, const Variant* params, sl_uint32 nParams);
+
+		// override
+		Map<String, Variant> getRecordForQueryResultBy(const String& sql, const Variant* params, sl_uint32 nParams);
+
+		// override
+		Variant getValueForQueryResultBy(const String& sql, const Variant* params, sl_uint32 nParams);
+
+		// override
+		String getErrorMessage();
+
+		// override
+		sl_bool beginTransaction();
+
+		// override
+		sl_bool commit();
+
+		// override, invalidates all
+		sl_bool rollback();
+
+	protected:
+		struct _Entry
+		{
+			String key;
+			Memory data;
+			sl_uint32 timeCreated;
+			sl_uint64 generationAll;
+			// pairs of the table name and the generation
+			List< Pair<String, sl_uint64> > tables;
+			sl_size size;
+		};
+
+		// returns sl_false when the statement is not cached
+		sl_bool _getQueryTables(const String& sql, List<String>& tables);
+
+		sl_bool _getCached(const String& key, Memory& data);
+
+		void _putCached(const String& key, const Memory& data, const List< Pair<String, sl_uint64> >& tables, sl_uint64 generationAll);
+
+		List< Pair<String, sl_uint64> > _getGenerations(const List<String>& tables, sl_uint64& generationAll);
+
+		sl_bool _isValid(_Entry& entry);
+
+		void _removeEntry(Link<_Entry>* link);
+
+		void _invalidateForStatement(const String& sql);
+
+		void _onTableChanged(const String& table);
+
+	protected:
+		Ref<Database> m_db;
+		sl_uint32 m_expiringMilliseconds;
+		sl_size m_maxMemorySize;
+		sl_size m_maxResultSize;
+
+		CLinkedList<_Entry> m_listEntries;
+		HashMap< String, Link<_Entry>* > m_mapEntries;
+		sl_size m_sizeMemory;
+		sl_uint64 m_nHits;
+		sl_uint64 m_nMisses;
+
+		HashMap<String, sl_uint64> m_mapTableGenerations;
+		sl_uint64 m_generationAll;
+		HashMap< String, List<String> > m_mapQueryTables;
+
+		Mutex m_lockCache;
+
+	};
+
+}
+
+#endif
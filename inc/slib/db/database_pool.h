@@ -0,0 +1,111 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CHECKHEADER_SLIB_DB_DATABASE_POOL
+#define CHECKHEADER_SLIB_DB_DATABASE_POOL
+
+#include "definition.h"
+
+#include "database.h"
+
+#include "../core/array.h"
+
+/*
+	DatabasePool
+
+	One writer connection and the reader connections to the same database, used as a single Database.
+	The statements which never write (DatabaseStatement::isReadOnly) are routed to the readers,
+	and the others to the writer, so that the readers run concurrently instead of queuing behind one connection.
+	A reader is picked for each call: the reader assigned to the current thread when it is idle, otherwise the least-referenced one.
+	The reader is not checked out exclusively, so it may be shared by the threads when all the readers are busy
+	(the calls on a connection are serialized by the connection itself).
+
+	The readers see the committed data only (for SQLite, the database should be in WAL mode),
+	so all the statements are routed to the writer while the transaction started by beginTransaction() is open;
+	use getWriter() to read the uncommitted changes of the writer without a transaction of the pool.
+*/
+
+namespace slib
+{
+
+	class SLIB_EXPORT DatabasePool : public Database
+	{
+		SLIB_DECLARE_OBJECT
+
+	protected:
+		DatabasePool();
+
+		~DatabasePool();
+
+	public:
+		static Ref<DatabasePool> create(const Ref<Database>& writer, const List< Ref<Database> >& readers);
+
+	public:
+		Ref<Database> getWriter();
+
+		// returns the least-referenced reader, which may be shared with other threads; returns the writer when no reader exists
+		Ref<Database> getReader();
+
+		sl_uint32 getReadersCount();
+
+		// returns the connection where the statement is routed
+		Ref<Database> getConnection(const String& sql);
+
+	public:
+		// override
+		Ref<DatabaseStatement> prepareStatement(const String& sql);
+
+		// override, executed by the writer
+		sl_int64 executeBy(const String& sql, const Variant* params, sl_uint32 nParams);
+
+		// override
+		Ref<DatabaseCursor> queryBy(const String& sql, const Variant* params, sl_uint32 nParams);
+
+		// override
+		List< Map<String, Variant> > getListForQueryResultBy(const String& sql, const Variant* params, sl_uint32 nParams);
+
+		// override
+		Map<String, Variant> getRecordForQueryResultBy(const String& sql, const Variant* params, sl_uint32 nParams);
+
+		// override
+		Variant getValueForQueryResultBy(const String& sql, const Variant* params, sl_uint32 nParams);
+
+		// override, returns the error message of the writer
+		String getErrorMessage();
+
+		// override, runs on the writer, and routes all the statements to the writer until commit() or rollback()
+		sl_bool beginTransaction();
+
+		// override
+		sl_bool commit();
+
+		// override
+		sl_bool rollback();
+
+		// override, reports the changes by the writer
+		sl_bool setTableChangeCallback(const Function<void(const String& table)>& callback);
+
+	protected:
+		sl_bool _isReadOnly(const Ref<Database>& reader, const String& sql);
+
+	protected:
+		Ref<Database> m_writer;
+		Array< Ref<Database> > m_readers;
+
+		sl_bool m_flagTransaction;
+
+		HashMap<String, sl_bool> m_mapReadOnly;
+		Mutex m_lockReadOnly;
+
+	};
+
+}
+
+#endif
@@ -34,6 +34,9 @@ namespace slib
 		sl_bool flagAutoReconnect;
 		sl_bool flagMultipleStatements;
 
+		// capacity of the prepared statement cache, 0 disables the cache
+		sl_uint32 statementCacheCapacity;
+
 	public:
 		MySQL_Param();
 
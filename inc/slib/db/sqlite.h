@@ -12,10 +12,48 @@
 #define CHECKHEADER_SLIB_DB_SQLITE
 
 #include "database.h"
+#include "database_pool.h"
 
 namespace slib
 {
 
+	class SLIB_EXPORT SQLite_Param
+	{
+	public:
+		// existing database file, or ":memory:" for a new in-memory database private to the connection
+		String path;
+
+		sl_bool flagReadOnly;
+
+		// journal_mode=WAL and synchronous=NORMAL
+		sl_bool flagWAL;
+
+		// PRAGMA mmap_size in bytes, 0: default
+		sl_uint64 mmapSize;
+
+		// PRAGMA cache_size in kilobytes, 0: default
+		sl_uint32 cacheSize;
+
+		// milliseconds to wait for the locked database, 0: fails immediately
+		sl_uint32 busyTimeout;
+
+		// capacity of the prepared statement cache, 0 disables the cache
+		sl_uint32 statementCacheCapacity;
+
+	public:
+		SQLite_Param();
+
+		~SQLite_Param();
+
+	};
+
+	/*
+		setTableChangeCallback() is implemented by sqlite3_update_hook() and sqlite3_wal_hook().
+		The WAL hook replaces the automatic checkpoint, which is then done by the connection at the threshold of
+		PRAGMA wal_autocheckpoint read when the callback is set. Changing wal_autocheckpoint afterwards unregisters the WAL hook,
+		so that the committed changes are not reported again; set the callback again after changing it.
+		SQLite does not call the update hook for the truncate optimization (DELETE without WHERE) and the WITHOUT ROWID tables.
+	*/
 	class SLIB_EXPORT SQLiteDatabase : public Database
 	{
 		SLIB_DECLARE_OBJECT
@@ -26,8 +64,16 @@ namespace slib
 		~SQLiteDatabase();
 
 	public:
+		static Ref<SQLiteDatabase> connect(const SQLite_Param& param);
+
 		static Ref<SQLiteDatabase> connect(const String& filePath);
 
+		/*
+			Opens a writer and `nReaders` read-only connections (0: the number of the CPU cores) in WAL mode.
+			Unless specified in `param`, the connections use mmap_size=256MB, cache_size=8MB and busy_timeout=5s.
+		*/
+		static Ref<DatabasePool> connectPool(const SQLite_Param& param, sl_uint32 nReaders = 0);
+
 	};
 
 }
@@ -959,7 +959,52 @@ namespace slib
 	BigInt operator>>(const BigInt& a, sl_size n);
 
 
+	/*
+		Montgomery context for the exponentiations modulo a fixed odd M
+
+		R^2 mod M, R^3 mod M and the Montgomery inverse of M are computed once by setModulus(),
+		so that every pow() runs only the exponentiation itself.
+		powBytesBE() works on big-endian byte strings, and does not allocate heap memory
+		for the moduli up to 4096 bits.
+	*/
+	class SLIB_EXPORT BigIntMontgomery
+	{
+	public:
+		BigIntMontgomery();
+
+		~BigIntMontgomery();
+
+	public:
+		// M - an odd value (M%2=1), M>0
+		sl_bool setModulus(const BigInt& M);
+
+		const BigInt& getModulus() const;
+
+		sl_bool isNull() const;
+
+		sl_bool isNotNull() const;
+
+		// C = A^E mod M, E >= 0
+		sl_bool pow(CBigInt& C, const CBigInt& A, const CBigInt& E) const;
+
+		BigInt pow(const BigInt& A, const BigInt& E) const;
+
+		/*
+			output = A^E mod M
+				A - big-endian bytes, less than M^2
+				output - big-endian bytes, padded with zero to `sizeOutput`
+		*/
+		sl_bool powBytesBE(const void* A, sl_size sizeA, const BigInt& E, void* output, sl_size sizeOutput) const;
+
+	protected:
+		BigInt m_M;
+		// M, R^2 mod M, R^3 mod M
+		Memory m_limbs;
+		sl_size m_nLimbs;
+		sl_uint64 m_MI;
+
+	};
+
 }
 
 #endif
-
@@ -17,6 +17,7 @@
 	
 		libpcap (unix) and winpcap (win32)
 		, raw sockets, packet sockets (linux)
+		, memory-mapped packet rings (linux, TPACKET_V3)
 		
 *****************************************************************/
 
@@ -77,6 +78,9 @@ namespace slib
 	public:
 		virtual void onCapturePacket(NetCapture* capture, NetCapturePacket* packet) = 0;
 		
+		// called by the batching engines (packet ring), default implementation calls onCapturePacket() for each packet
+		virtual void onCapturePackets(NetCapture* capture, NetCapturePacket* packets, sl_uint32 nPackets);
+		
 	};
 	
 	class SLIB_EXPORT NetCaptureParam
@@ -90,10 +94,19 @@ namespace slib
 		
 		NetworkLinkDeviceType preferedLinkDeviceType; // NetworkLinkDeviceType, used in Packet Socket mode. now supported Ethernet and Raw
 		
+		sl_uint32 ringBlockSize; // size of a block of RX ring, multiple of the page size, used in Packet Ring mode. default: 1MB
+		sl_uint32 ringBlocksCount; // number of the blocks of RX ring per thread, used in Packet Ring mode. default: 64
+		sl_uint32 ringFrameSize; // maximum size of a frame in TX ring, used in Packet Ring mode. default: 2048
+		sl_uint32 ringSendFramesCount; // number of the frames in TX ring (0: TX ring is not used), used in Packet Ring mode. default: 256
+		sl_uint32 threadsCount; // number of the capturing threads sharing a fanout group, used in Packet Ring mode. default: 1
+		sl_uint16 fanoutGroupId; // PACKET_FANOUT group (0: generated when threadsCount > 1), used in Packet Ring mode
+		
 		sl_bool flagAutoStart; // default: true
 		
 		Ptr<INetCaptureListener> listener;
 		Function<void(NetCapture*, NetCapturePacket*)> onCapturePacket;
+		// the packets point into the capture buffer, and are valid only in the callback
+		Function<void(NetCapture*, NetCapturePacket* packets, sl_uint32 nPackets)> onCapturePackets;
 		
 	public:
 		NetCaptureParam();
@@ -121,6 +134,15 @@ namespace slib
 		// raw socket
 		static Ref<NetCapture> createRawIPv4(const NetCaptureParam& param);
 		
+		/*
+			linux packet socket with memory-mapped TPACKET_V3 rings
+			
+			The packets are delivered in batches (a ring block per callback) pointing into the ring without copying.
+			When `threadsCount` is greater than 1, each thread captures on its own socket and ring joined to a PACKET_FANOUT group
+			(hashed by flow), and the callbacks are called concurrently from the threads.
+		*/
+		static Ref<NetCapture> createPacketRing(const NetCaptureParam& param);
+		
 	public:
 		virtual void release() = 0;
 		
@@ -135,6 +157,9 @@ namespace slib
 		// send a L2-packet
 		virtual sl_bool sendPacket(const void* buf, sl_uint32 size) = 0;
 		
+		// returns the number of the packets sent
+		virtual sl_uint32 sendPackets(const NetCapturePacket* packets, sl_uint32 nPackets);
+		
 		virtual String getLastErrorMessage();
 		
 		// Pcap Utiltities
@@ -147,9 +172,12 @@ namespace slib
 		
 		void _onCapturePacket(NetCapturePacket* packet);
 		
+		void _onCapturePackets(NetCapturePacket* packets, sl_uint32 nPackets);
+		
 	protected:
 		Ptr<INetCaptureListener> m_listener;
 		Function<void(NetCapture*, NetCapturePacket*)> m_onCapturePacket;
+		Function<void(NetCapture*, NetCapturePacket*, sl_uint32)> m_onCapturePackets;
 		
 	};
 	
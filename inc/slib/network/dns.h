@@ -18,6 +18,7 @@
 
 #include "../core/string.h"
 #include "../crypto/aes.h"
+#include "../crypto/chacha.h"
 
 /********************************************************************
 	DNS Specification from RFC 1035, RFC 1034, RFC 2535
@@ -546,6 +547,8 @@ namespace slib
 		
 		sl_uint16 portEncryption;
 		String encryptionKey;
+		// encrypted packets are sealed by ChaCha20-Poly1305 (nonce + ciphertext + tag) instead of AES-CBC
+		sl_bool flagUseChaCha20Poly1305;
 		
 		sl_bool flagProxy;
 		
@@ -603,6 +606,10 @@ namespace slib
 		
 		Memory _buildHostAddressAnswerPacket(sl_uint16 id, const String& hostName, const IPv4Address& hostAddress, sl_bool flagEncrypt);
 		
+		Memory _encryptPacket(const void* data, sl_size size);
+		
+		Memory _decryptPacket(const void* data, sl_size size);
+		
 	protected:
 		// override
 		virtual void onReceiveFrom(AsyncUdpSocket* socket, const SocketAddress& address, void* data, sl_uint32 sizeReceive);
@@ -620,6 +627,9 @@ namespace slib
 		
 		Ref<AsyncUdpSocket> m_udpEncrypt;
 		AES m_encrypt;
+		// ChaCha20_Poly1305 keeps the state of a message, so every packet uses its own instance with this key
+		sl_uint8 m_keyAEAD[32];
+		sl_bool m_flagUseChaCha20Poly1305;
 		
 		sl_bool m_flagProxy;
 		
@@ -518,11 +518,13 @@ namespace slib
 		
 		sl_bool setDecompressing();
 		
+		sl_bool setDecompressing(const Ref<Decompressor>& decompressor);
+		
 		Memory decompressData(void* data, sl_uint32 size, Referable* refData);
 		
 	protected:
 		sl_bool m_flagDecompressing;
-		ZlibDecompress m_zlib;
+		Ref<Decompressor> m_decompressor;
 		Ptr<IHttpContentReaderListener> m_listener;
 		
 	};
@@ -188,6 +188,12 @@ namespace slib
 		
 		sl_bool checkChecksum(sl_uint32 sizeContent) const;
 		
+		// updates the checksum for the rewritten 16-bit field, such as the echo identifier
+		void adjustChecksum(sl_uint16 valueOld, sl_uint16 valueNew);
+		
+		// checks the size without the checksum
+		sl_bool checkHeader(sl_uint32 sizeContent) const;
+		
 		sl_bool check(sl_uint32 sizeContent) const;
 		
 		sl_uint16 getEchoIdentifier() const;
@@ -20,6 +20,7 @@
 
 #include "../core/object.h"
 #include "../core/map.h"
+#include "../core/mutex.h"
 
 /*
 	If you are usiing kernel-mode NAT on linux (for example on port range 40000~60000), following configuration will avoid to conflict with kernel-networking.
@@ -31,21 +32,21 @@
 namespace slib
 {
 
-	class _NatTablePort
-	{
-	public:
-		sl_bool flagActive;
-		SocketAddress addressSource;
-		Time timeLastAccess;
-		
-	public:
-		_NatTablePort();
-		
-		~_NatTablePort();
-		
-	};
+	struct _NatTablePort;
+	struct _NatTableSlot;
 	
-	class _NatTableMapping : public Object
+	/*
+		Maps the internal IPv4 endpoints to the external ports of a protocol.
+		
+		The lookups are lock-free: the endpoints are found in an open-addressing table of 64-bit slots
+		(endpoint and port index packed in one word), and the ports in an array indexed by the port.
+		The writers (new mappings, expiration) are serialized by a mutex, allocate the ports from a FIFO free list in O(1),
+		and sweep a few ports for the expired mappings on each new mapping.
+		The slots are rebuilt when the tombstones of the removed mappings fill a quarter of the table,
+		so that the probe sequences stay short under churn (the lookups missed meanwhile are retried under the mutex).
+		setup() must not be called while translating.
+	*/
+	class _NatTableMapping
 	{
 	public:
 		_NatTableMapping();
@@ -53,21 +54,52 @@ namespace slib
 		~_NatTableMapping();
 		
 	public:
-		void setup(sl_uint16 portBegin, sl_uint16 portEnd);
+		// timeout: milliseconds, 0 for never expiring
+		void setup(sl_uint16 portBegin, sl_uint16 portEnd, sl_uint32 timeout);
 		
 		sl_bool mapToExternalPort(const SocketAddress& address, sl_uint16& port);
 		
 		sl_bool mapToInternalAddress(sl_uint16 port, SocketAddress& address);
 		
+		// releases the expired mappings in the next `nPorts` ports
+		void sweep(sl_uint32 nPorts);
+		
+		sl_uint32 getMappingsCount();
+		
 	protected:
-		HashMap< SocketAddress, sl_uint16 > m_mapPorts;
+		void _free();
 		
-		_NatTablePort* m_ports;
-		sl_uint16 m_nPorts;
-		sl_uint16 m_pos;
+		sl_bool _findSlot(sl_uint64 endpoint, sl_uint32& index);
+		
+		sl_bool _allocatePort(sl_uint64 endpoint, sl_uint32 now, sl_uint16& port);
+		
+		void _releasePort(sl_uint32 indexPort);
+		
+		void _insertSlot(sl_uint64 endpoint, sl_uint32 indexPort);
 		
+		void _rebuildSlots();
+		
+		void _sweep(sl_uint32 nPorts, sl_uint32 now);
+		
+		void _evictOldest(sl_uint32 now);
+		
+	protected:
+		_NatTablePort* m_ports;
+		sl_uint32 m_nPorts;
 		sl_uint16 m_portBegin;
 		sl_uint16 m_portEnd;
+		sl_uint32 m_timeout;
+		
+		_NatTableSlot* m_slots;
+		sl_uint32 m_maskSlots;
+		sl_uint32 m_nDeletedSlots;
+		
+		sl_uint16* m_freePorts;
+		sl_uint32 m_posFree;
+		sl_uint32 m_nFreePorts;
+		sl_uint32 m_posSweep;
+		
+		Mutex m_lockWrite;
 		
 	};
 	
@@ -84,6 +116,10 @@ namespace slib
 		
 		sl_uint16 icmpEchoIdentifier;
 		
+		// idle time in milliseconds after which the mappings are released, 0 for releasing only when the ports run out
+		sl_uint32 tcpTimeout; // default: 7440000 (2 hours 4 minutes, RFC 5382)
+		sl_uint32 udpTimeout; // default: 300000 (5 minutes, RFC 4787)
+		
 	public:
 		NatTableParam();
 		
@@ -104,12 +140,20 @@ namespace slib
 		void setup(const NatTableParam& param);
 		
 	public:
+		// can be called concurrently from the forwarding threads. fragmented packets are not translated, so reassemble them first (see NetPacketReassembleStage)
 		sl_bool translateOutgoingPacket(IPv4Packet* ipHeader, void* ipContent, sl_uint32 sizeContent);
 		
 		sl_bool translateIncomingPacket(IPv4Packet* ipHeader, void* ipContent, sl_uint32 sizeContent);
 		
 		sl_uint16 getMappedIcmpEchoSequenceNumber(const IcmpEchoAddress& address);
 		
+		// releases the expired TCP/UDP mappings, which are also released gradually by the new mappings
+		void sweep();
+		
+		sl_uint32 getTcpMappingsCount();
+		
+		sl_uint32 getUdpMappingsCount();
+		
 	protected:
 		NatTableParam m_param;
 		
@@ -0,0 +1,239 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CHECKHEADER_SLIB_NETWORK_PACKET_PIPELINE
+#define CHECKHEADER_SLIB_NETWORK_PACKET_PIPELINE
+
+#include "definition.h"
+
+#include "capture.h"
+#include "tcpip.h"
+#include "nat.h"
+
+#include "../core/object.h"
+#include "../core/list.h"
+#include "../core/memory.h"
+#include "../core/function.h"
+
+/*
+	NetPacketPipeline
+
+	Carries the captured packets through the stages in batches (up to NetPacketBatch::MaxCount packets),
+	so that each stage runs the same code over the whole batch, prefetching the next packets,
+	instead of running all the stages per packet.
+
+	Typical software gateway:
+
+		parse (NetPacketParseStage) -> reassemble (NetPacketReassembleStage) -> translate (NetPacketNatStage)
+			-> filter (NetPacketFilterStage) -> transmit (NetPacketTransmitStage)
+
+	Connect the pipeline to NetCaptureParam::onCapturePackets (or onCapturePacket), calling processPackets().
+	The stages are added before processing. processPackets() can be called concurrently (for example from the threads of
+	the packet ring), so the stages keeping state must be thread-safe.
+*/
+
+namespace slib
+{
+
+	class SLIB_EXPORT NetPacketDescriptor
+	{
+	public:
+		// link-layer frame, pointing into the capture buffer
+		sl_uint8* frame;
+		sl_uint32 sizeFrame;
+		sl_uint32 sizeLinkHeader;
+
+		// IPv4 packet (set by NetPacketParseStage), inside the frame or `memory`
+		IPv4Packet* ip;
+		sl_uint32 sizeIp;
+
+		// holds the reassembled packet
+		Memory memory;
+
+		Time time;
+
+		// the dropped (or consumed) packets are skipped by the following stages
+		sl_bool flagDropped;
+
+	public:
+		NetPacketDescriptor();
+
+		~NetPacketDescriptor();
+
+	public:
+		// returns sl_true when the IP packet is not in the captured frame
+		sl_bool isDetached() const;
+
+	};
+
+	class SLIB_EXPORT NetPacketBatch
+	{
+	public:
+		enum
+		{
+			MaxCount = 256
+		};
+
+	public:
+		NetCapture* capture;
+		NetworkLinkDeviceType linkType;
+		NetPacketDescriptor* packets;
+		sl_uint32 count;
+
+	public:
+		NetPacketBatch();
+
+		~NetPacketBatch();
+
+	public:
+		sl_uint32 getActiveCount() const;
+
+	};
+
+	class SLIB_EXPORT NetPacketStage : public Referable
+	{
+	public:
+		NetPacketStage();
+
+		~NetPacketStage();
+
+	public:
+		virtual void processBatch(NetPacketBatch& batch) = 0;
+
+	};
+
+	// finds the IPv4 packets in the frames, and drops the other packets and the invalid headers
+	class SLIB_EXPORT NetPacketParseStage : public NetPacketStage
+	{
+	public:
+		NetPacketParseStage();
+
+		~NetPacketParseStage();
+
+	public:
+		// override
+		void processBatch(NetPacketBatch& batch);
+
+	};
+
+	// holds the fragments until the whole packet is received, and replaces the last fragment with the reassembled packet
+	class SLIB_EXPORT NetPacketReassembleStage : public NetPacketStage
+	{
+	public:
+		NetPacketReassembleStage(const Ref<IPv4Fragmentation>& fragmentation);
+
+		~NetPacketReassembleStage();
+
+	public:
+		// override
+		void processBatch(NetPacketBatch& batch);
+
+	protected:
+		Ref<IPv4Fragmentation> m_fragmentation;
+
+	};
+
+	// translates the packets in place, and drops the packets not translated
+	class SLIB_EXPORT NetPacketNatStage : public NetPacketStage
+	{
+	public:
+		NetPacketNatStage(const Ref<NatTable>& nat, sl_bool flagOutgoing);
+
+		~NetPacketNatStage();
+
+	public:
+		// override
+		void processBatch(NetPacketBatch& batch);
+
+	protected:
+		Ref<NatTable> m_nat;
+		sl_bool m_flagOutgoing;
+
+	};
+
+	// keeps the packets for which the filter returns sl_true; the filter can also modify the packets (for example the MAC addresses)
+	class SLIB_EXPORT NetPacketFilterStage : public NetPacketStage
+	{
+	public:
+		NetPacketFilterStage(const Function<sl_bool(NetPacketDescriptor& packet)>& filter);
+
+		~NetPacketFilterStage();
+
+	public:
+		// override
+		void processBatch(NetPacketBatch& batch);
+
+	protected:
+		Function<sl_bool(NetPacketDescriptor&)> m_filter;
+
+	};
+
+	/*
+		Sends the remaining packets with NetCapture::sendPackets(), in chunks of the batch.
+		The reassembled packets are fragmented again by `mtu`, behind the link header of their last fragment.
+	*/
+	class SLIB_EXPORT NetPacketTransmitStage : public NetPacketStage
+	{
+	public:
+		NetPacketTransmitStage(const Ref<NetCapture>& capture, sl_uint32 mtu = 1500);
+
+		~NetPacketTransmitStage();
+
+	public:
+		// override
+		void processBatch(NetPacketBatch& batch);
+
+		sl_uint64 getSentPacketsCount();
+
+	protected:
+		Ref<NetCapture> m_capture;
+		sl_uint32 m_mtu;
+		sl_int64 m_nSentPackets;
+
+	};
+
+	class SLIB_EXPORT NetPacketPipeline : public Object
+	{
+		SLIB_DECLARE_OBJECT
+
+	public:
+		NetPacketPipeline();
+
+		~NetPacketPipeline();
+
+	public:
+		// must not be called while processing
+		void addStage(const Ref<NetPacketStage>& stage);
+
+		List< Ref<NetPacketStage> > getStages();
+
+		// splits the packets into the batches
+		void processPackets(NetCapture* capture, NetCapturePacket* packets, sl_uint32 nPackets);
+
+		void processBatch(NetPacketBatch& batch);
+
+		sl_uint64 getProcessedPacketsCount();
+
+		// the packets dropped or consumed (fragments) by any stage
+		sl_uint64 getDroppedPacketsCount();
+
+	protected:
+		void _processPackets(NetCapture* capture, NetCapturePacket* packets, sl_uint32 nPackets, NetPacketDescriptor* descriptors, sl_uint32 nDescriptors);
+
+	protected:
+		List< Ref<NetPacketStage> > m_stages;
+		sl_int64 m_nProcessedPackets;
+		sl_int64 m_nDroppedPackets;
+
+	};
+
+}
+
+#endif
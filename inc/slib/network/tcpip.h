@@ -93,10 +93,16 @@ namespace slib
 	class SLIB_EXPORT TCP_IP
 	{
 	public:
+		// sums 8 or 16 bytes per step (SSE2/NEON), the result is same as summing the big-endian 16-bit words
 		static sl_uint16 calculateOneComplementSum(const void* data, sl_size size, sl_uint32 add = 0);
 
 		static sl_uint16 calculateChecksum(const void* data, sl_size size);
 
+		// RFC 1624: returns the checksum updated for replacing a 16-bit word of the checksummed data, without summing the data
+		static sl_uint16 adjustChecksum(sl_uint16 checksum, sl_uint16 valueOld, sl_uint16 valueNew);
+
+		static sl_uint16 adjustChecksum(sl_uint16 checksum, const IPv4Address& addressOld, const IPv4Address& addressNew);
+
 	};
 
 	class SLIB_EXPORT IPv4Packet
@@ -188,6 +194,11 @@ namespace slib
 		
 		sl_bool checkChecksum() const;
 
+		// updates the header checksum for the field rewritten from `valueOld` to `valueNew`
+		void adjustChecksum(sl_uint16 valueOld, sl_uint16 valueNew);
+
+		void adjustChecksum(const IPv4Address& addressOld, const IPv4Address& addressNew);
+
 		IPv4Address getSourceAddress() const;
 		
 		void setSourceAddress(const IPv4Address& address);
@@ -325,6 +336,15 @@ namespace slib
 		
 		sl_bool checkChecksum(const IPv4Packet* ipv4, sl_uint32 sizeContent) const;
 
+		// updates the checksum for the rewritten port or the other 16-bit field
+		void adjustChecksum(sl_uint16 valueOld, sl_uint16 valueNew);
+
+		// updates the checksum for the rewritten address of the pseudo header
+		void adjustChecksum(const IPv4Address& addressOld, const IPv4Address& addressNew);
+
+		// checks the sizes without the checksum
+		sl_bool checkHeader(sl_uint32 sizeContent) const;
+
 		sl_bool check(IPv4Packet* ip, sl_uint32 sizeContent) const;
 
 		sl_uint16 getUrgentPointer() const;
@@ -384,6 +404,15 @@ namespace slib
 		
 		sl_bool checkChecksum(const IPv4Packet* ipv4) const;
 
+		// updates the checksum for the rewritten port or the other 16-bit field, unless the checksum is not used (zero)
+		void adjustChecksum(sl_uint16 valueOld, sl_uint16 valueNew);
+
+		// updates the checksum for the rewritten address of the pseudo header, unless the checksum is not used (zero)
+		void adjustChecksum(const IPv4Address& addressOld, const IPv4Address& addressNew);
+
+		// checks the sizes without the checksum
+		sl_bool checkHeader(sl_uint32 sizeContent) const;
+
 		sl_bool check(IPv4Packet* ip, sl_uint32 sizeContent) const;
 		
 		const sl_uint8* getContent() const;
@@ -12,6 +12,7 @@
 
 #include "../../../inc/slib/core/system.h"
 #include "../../../inc/slib/core/math.h"
+#include "../../../inc/slib/core/cpu.h"
 
 //#define FORCE_MEM_ALIGNED
 
@@ -23,6 +24,19 @@
 
 #include <stdio.h>
 
+#if defined(SLIB_CPU_USE_SSE2)
+#	include <emmintrin.h>
+#endif
+#if defined(SLIB_CPU_USE_X86_EXTENSIONS)
+#	include <immintrin.h>
+#endif
+#if defined(SLIB_CPU_USE_NEON)
+#	include <arm_neon.h>
+#endif
+#if defined(SLIB_COMPILER_IS_VC)
+#	include <intrin.h>
+#endif
+
 #ifdef SLIB_PLATFORM_IS_WINDOWS
 #	include "../../../inc/slib/core/platform_windows.h"
 #endif
@@ -34,6 +48,634 @@
 namespace slib
 {
 
+	/*
+		Memory kernels
+
+		Each kernel has SSE2 (always available on x86-64), AVX2 (selected at runtime)
+		and NEON (ARM64) paths, falling back to the scalar loops on other architectures.
+	*/
+
+#if defined(SLIB_CPU_USE_X86_EXTENSIONS)
+	static sl_bool _g_base_flagAVX2 = Cpu::isAVX2Supported();
+#endif
+
+	SLIB_INLINE static sl_uint32 _Base_scanBitForward(sl_uint32 mask)
+	{
+#if defined(SLIB_COMPILER_IS_VC)
+		unsigned long index;
+		_BitScanForward(&index, mask);
+		return (sl_uint32)index;
+#else
+		return (sl_uint32)(__builtin_ctz(mask));
+#endif
+	}
+
+	SLIB_INLINE static sl_uint32 _Base_scanBitReverse(sl_uint32 mask)
+	{
+#if defined(SLIB_COMPILER_IS_VC)
+		unsigned long index;
+		_BitScanReverse(&index, mask);
+		return (sl_uint32)index;
+#else
+		return 31 - (sl_uint32)(__builtin_clz(mask));
+#endif
+	}
+
+#if defined(SLIB_CPU_USE_SSE2)
+	template <sl_size K>
+	class _Base_SSE2;
+
+	template <>
+	class _Base_SSE2<1>
+	{
+	public:
+		SLIB_INLINE static __m128i set(sl_uint8 v)
+		{
+			return _mm_set1_epi8((char)v);
+		}
+
+		SLIB_INLINE static __m128i equals(__m128i a, __m128i b)
+		{
+			return _mm_cmpeq_epi8(a, b);
+		}
+	};
+
+	template <>
+	class _Base_SSE2<2>
+	{
+	public:
+		SLIB_INLINE static __m128i set(sl_uint16 v)
+		{
+			return _mm_set1_epi16((short)v);
+		}
+
+		SLIB_INLINE static __m128i equals(__m128i a, __m128i b)
+		{
+			return _mm_cmpeq_epi16(a, b);
+		}
+	};
+
+	template <>
+	class _Base_SSE2<4>
+	{
+	public:
+		SLIB_INLINE static __m128i set(sl_uint32 v)
+		{
+			return _mm_set1_epi32((int)v);
+		}
+
+		SLIB_INLINE static __m128i equals(__m128i a, __m128i b)
+		{
+			return _mm_cmpeq_epi32(a, b);
+		}
+	};
+
+	template <>
+	class _Base_SSE2<8>
+	{
+	public:
+		SLIB_INLINE static __m128i set(sl_uint64 v)
+		{
+			return _mm_set_epi32((int)(v >> 32), (int)v, (int)(v >> 32), (int)v);
+		}
+
+		SLIB_INLINE static __m128i equals(__m128i a, __m128i b)
+		{
+			// SSE2 has no 64-bit compare: both 32-bit halves must be equal
+			__m128i c = _mm_cmpeq_epi32(a, b);
+			return _mm_and_si128(c, _mm_shuffle_epi32(c, _MM_SHUFFLE(2, 3, 0, 1)));
+		}
+	};
+
+	static sl_size _Base_findMismatch_SSE2(const sl_uint8* m1, const sl_uint8* m2, sl_size count)
+	{
+		sl_size i = 0;
+		for (; i + 16 <= count; i += 16) {
+			__m128i a = _mm_loadu_si128((const __m128i*)(m1 + i));
+			__m128i b = _mm_loadu_si128((const __m128i*)(m2 + i));
+			sl_uint32 mask = (sl_uint32)(_mm_movemask_epi8(_mm_cmpeq_epi8(a, b)));
+			if (mask != 0xFFFF) {
+				return i + _Base_scanBitForward(~mask & 0xFFFF);
+			}
+		}
+		for (; i < count; i++) {
+			if (m1[i] != m2[i]) {
+				return i;
+			}
+		}
+		return count;
+	}
+
+	static sl_size _Base_findNonZero_SSE2(const sl_uint8* m, sl_size count)
+	{
+		__m128i zero = _mm_setzero_si128();
+		sl_size i = 0;
+		for (; i + 16 <= count; i += 16) {
+			__m128i v = _mm_loadu_si128((const __m128i*)(m + i));
+			sl_uint32 mask = (sl_uint32)(_mm_movemask_epi8(_mm_cmpeq_epi8(v, zero)));
+			if (mask != 0xFFFF) {
+				return i + _Base_scanBitForward(~mask & 0xFFFF);
+			}
+		}
+		for (; i < count; i++) {
+			if (m[i]) {
+				return i;
+			}
+		}
+		return count;
+	}
+
+	template <class T>
+	static const T* _Base_find_SSE2(const T* m, T pattern, sl_size count)
+	{
+		const sl_size N = 16 / sizeof(T);
+		__m128i p = _Base_SSE2<sizeof(T)>::set(pattern);
+		sl_size i = 0;
+		for (; i + N <= count; i += N) {
+			__m128i v = _mm_loadu_si128((const __m128i*)(m + i));
+			sl_uint32 mask = (sl_uint32)(_mm_movemask_epi8(_Base_SSE2<sizeof(T)>::equals(v, p)));
+			if (mask) {
+				return m + i + _Base_scanBitForward(mask) / sizeof(T);
+			}
+		}
+		for (; i < count; i++) {
+			if (m[i] == pattern) {
+				return m + i;
+			}
+		}
+		return sl_null;
+	}
+
+	template <class T>
+	static const T* _Base_findReverse_SSE2(const T* m, T pattern, sl_size count)
+	{
+		const sl_size N = 16 / sizeof(T);
+		__m128i p = _Base_SSE2<sizeof(T)>::set(pattern);
+		sl_size i = count;
+		while (i >= N) {
+			i -= N;
+			__m128i v = _mm_loadu_si128((const __m128i*)(m + i));
+			sl_uint32 mask = (sl_uint32)(_mm_movemask_epi8(_Base_SSE2<sizeof(T)>::equals(v, p)));
+			if (mask) {
+				return m + i + _Base_scanBitReverse(mask) / sizeof(T);
+			}
+		}
+		while (i > 0) {
+			i--;
+			if (m[i] == pattern) {
+				return m + i;
+			}
+		}
+		return sl_null;
+	}
+
+	template <class T>
+	static void _Base_fill_SSE2(T* dst, T value, sl_size count)
+	{
+		const sl_size N = 16 / sizeof(T);
+		__m128i v = _Base_SSE2<sizeof(T)>::set(value);
+		sl_size i = 0;
+		for (; i + N <= count; i += N) {
+			_mm_storeu_si128((__m128i*)(dst + i), v);
+		}
+		for (; i < count; i++) {
+			dst[i] = value;
+		}
+	}
+#endif
+
+#if defined(SLIB_CPU_USE_X86_EXTENSIONS)
+	template <sl_size K>
+	class _Base_AVX2;
+
+	template <>
+	class _Base_AVX2<1>
+	{
+	public:
+		SLIB_CPU_TARGET("avx2") SLIB_INLINE static __m256i set(sl_uint8 v)
+		{
+			return _mm256_set1_epi8((char)v);
+		}
+
+		SLIB_CPU_TARGET("avx2") SLIB_INLINE static __m256i equals(__m256i a, __m256i b)
+		{
+			return _mm256_cmpeq_epi8(a, b);
+		}
+	};
+
+	template <>
+	class _Base_AVX2<2>
+	{
+	public:
+		SLIB_CPU_TARGET("avx2") SLIB_INLINE static __m256i set(sl_uint16 v)
+		{
+			return _mm256_set1_epi16((short)v);
+		}
+
+		SLIB_CPU_TARGET("avx2") SLIB_INLINE static __m256i equals(__m256i a, __m256i b)
+		{
+			return _mm256_cmpeq_epi16(a, b);
+		}
+	};
+
+	template <>
+	class _Base_AVX2<4>
+	{
+	public:
+		SLIB_CPU_TARGET("avx2") SLIB_INLINE static __m256i set(sl_uint32 v)
+		{
+			return _mm256_set1_epi32((int)v);
+		}
+
+		SLIB_CPU_TARGET("avx2") SLIB_INLINE static __m256i equals(__m256i a, __m256i b)
+		{
+			return _mm256_cmpeq_epi32(a, b);
+		}
+	};
+
+	template <>
+	class _Base_AVX2<8>
+	{
+	public:
+		SLIB_CPU_TARGET("avx2") SLIB_INLINE static __m256i set(sl_uint64 v)
+		{
+			return _mm256_set1_epi64x((long long)v);
+		}
+
+		SLIB_CPU_TARGET("avx2") SLIB_INLINE static __m256i equals(__m256i a, __m256i b)
+		{
+			return _mm256_cmpeq_epi64(a, b);
+		}
+	};
+
+	SLIB_CPU_TARGET("avx2") static sl_size _Base_findMismatch_AVX2(const sl_uint8* m1, const sl_uint8* m2, sl_size count)
+	{
+		sl_size i = 0;
+		for (; i + 32 <= count; i += 32) {
+			__m256i a = _mm256_loadu_si256((const __m256i*)(m1 + i));
+			__m256i b = _mm256_loadu_si256((const __m256i*)(m2 + i));
+			sl_uint32 mask = (sl_uint32)(_mm256_movemask_epi8(_mm256_cmpeq_epi8(a, b)));
+			if (mask != 0xFFFFFFFF) {
+				return i + _Base_scanBitForward(~mask);
+			}
+		}
+		return i + _Base_findMismatch_SSE2(m1 + i, m2 + i, count - i);
+	}
+
+	SLIB_CPU_TARGET("avx2") static sl_size _Base_findNonZero_AVX2(const sl_uint8* m, sl_size count)
+	{
+		sl_size i = 0;
+		// OR four vectors together so that long zero runs cost one test per 128 bytes
+		for (; i + 128 <= count; i += 128) {
+			__m256i v0 = _mm256_loadu_si256((const __m256i*)(m + i));
+			__m256i v1 = _mm256_loadu_si256((const __m256i*)(m + i + 32));
+			__m256i v2 = _mm256_loadu_si256((const __m256i*)(m + i + 64));
+			__m256i v3 = _mm256_loadu_si256((const __m256i*)(m + i + 96));
+			__m256i v = _mm256_or_si256(_mm256_or_si256(v0, v1), _mm256_or_si256(v2, v3));
+			if (!(_mm256_testz_si256(v, v))) {
+				break;
+			}
+		}
+		__m256i zero = _mm256_setzero_si256();
+		for (; i + 32 <= count; i += 32) {
+			__m256i v = _mm256_loadu_si256((const __m256i*)(m + i));
+			sl_uint32 mask = (sl_uint32)(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, zero)));
+			if (mask != 0xFFFFFFFF) {
+				return i + _Base_scanBitForward(~mask);
+			}
+		}
+		return i + _Base_findNonZero_SSE2(m + i, count - i);
+	}
+
+	template <class T>
+	SLIB_CPU_TARGET("avx2") static const T* _Base_find_AVX2(const T* m, T pattern, sl_size count)
+	{
+		const sl_size N = 32 / sizeof(T);
+		__m256i p = _Base_AVX2<sizeof(T)>::set(pattern);
+		sl_size i = 0;
+		for (; i + N <= count; i += N) {
+			__m256i v = _mm256_loadu_si256((const __m256i*)(m + i));
+			sl_uint32 mask = (sl_uint32)(_mm256_movemask_epi8(_Base_AVX2<sizeof(T)>::equals(v, p)));
+			if (mask) {
+				return m + i + _Base_scanBitForward(mask) / sizeof(T);
+			}
+		}
+		return _Base_find_SSE2(m + i, pattern, count - i);
+	}
+
+	template <class T>
+	SLIB_CPU_TARGET("avx2") static const T* _Base_findReverse_AVX2(const T* m, T pattern, sl_size count)
+	{
+		const sl_size N = 32 / sizeof(T);
+		__m256i p = _Base_AVX2<sizeof(T)>::set(pattern);
+		sl_size i = count;
+		while (i >= N) {
+			i -= N;
+			__m256i v = _mm256_loadu_si256((const __m256i*)(m + i));
+			sl_uint32 mask = (sl_uint32)(_mm256_movemask_epi8(_Base_AVX2<sizeof(T)>::equals(v, p)));
+			if (mask) {
+				return m + i + _Base_scanBitReverse(mask) / sizeof(T);
+			}
+		}
+		return _Base_findReverse_SSE2(m, pattern, i);
+	}
+
+	template <class T>
+	SLIB_CPU_TARGET("avx2") static void _Base_fill_AVX2(T* dst, T value, sl_size count)
+	{
+		const sl_size N = 32 / sizeof(T);
+		__m256i v = _Base_AVX2<sizeof(T)>::set(value);
+		sl_size i = 0;
+		for (; i + N <= count; i += N) {
+			_mm256_storeu_si256((__m256i*)(dst + i), v);
+		}
+		for (; i < count; i++) {
+			dst[i] = value;
+		}
+	}
+#endif
+
+#if defined(SLIB_CPU_USE_NEON) && defined(SLIB_ARCH_IS_ARM64)
+#	define BASE_USE_NEON
+	template <sl_size K>
+	class _Base_NEON;
+
+	template <>
+	class _Base_NEON<1>
+	{
+	public:
+		SLIB_INLINE static uint8x16_t set(sl_uint8 v)
+		{
+			return vdupq_n_u8(v);
+		}
+
+		SLIB_INLINE static uint8x16_t equals(uint8x16_t a, uint8x16_t b)
+		{
+			return vceqq_u8(a, b);
+		}
+	};
+
+	template <>
+	class _Base_NEON<2>
+	{
+	public:
+		SLIB_INLINE static uint8x16_t set(sl_uint16 v)
+		{
+			return vreinterpretq_u8_u16(vdupq_n_u16(v));
+		}
+
+		SLIB_INLINE static uint8x16_t equals(uint8x16_t a, uint8x16_t b)
+		{
+			return vreinterpretq_u8_u16(vceqq_u16(vreinterpretq_u16_u8(a), vreinterpretq_u16_u8(b)));
+		}
+	};
+
+	template <>
+	class _Base_NEON<4>
+	{
+	public:
+		SLIB_INLINE static uint8x16_t set(sl_uint32 v)
+		{
+			return vreinterpretq_u8_u32(vdupq_n_u32(v));
+		}
+
+		SLIB_INLINE static uint8x16_t equals(uint8x16_t a, uint8x16_t b)
+		{
+			return vreinterpretq_u8_u32(vceqq_u32(vreinterpretq_u32_u8(a), vreinterpretq_u32_u8(b)));
+		}
+	};
+
+	template <>
+	class _Base_NEON<8>
+	{
+	public:
+		SLIB_INLINE static uint8x16_t set(sl_uint64 v)
+		{
+			return vreinterpretq_u8_u64(vdupq_n_u64(v));
+		}
+
+		SLIB_INLINE static uint8x16_t equals(uint8x16_t a, uint8x16_t b)
+		{
+			return vreinterpretq_u8_u64(vceqq_u64(vreinterpretq_u64_u8(a), vreinterpretq_u64_u8(b)));
+		}
+	};
+
+	static sl_size _Base_findMismatch_NEON(const sl_uint8* m1, const sl_uint8* m2, sl_size count)
+	{
+		sl_size i = 0;
+		for (; i + 16 <= count; i += 16) {
+			if (vminvq_u8(vceqq_u8(vld1q_u8(m1 + i), vld1q_u8(m2 + i))) != 0xFF) {
+				break;
+			}
+		}
+		for (; i < count; i++) {
+			if (m1[i] != m2[i]) {
+				return i;
+			}
+		}
+		return count;
+	}
+
+	static sl_size _Base_findNonZero_NEON(const sl_uint8* m, sl_size count)
+	{
+		sl_size i = 0;
+		for (; i + 16 <= count; i += 16) {
+			if (vmaxvq_u8(vld1q_u8(m + i))) {
+				break;
+			}
+		}
+		for (; i < count; i++) {
+			if (m[i]) {
+				return i;
+			}
+		}
+		return count;
+	}
+
+	template <class T>
+	static const T* _Base_find_NEON(const T* m, T pattern, sl_size count)
+	{
+		const sl_size N = 16 / sizeof(T);
+		uint8x16_t p = _Base_NEON<sizeof(T)>::set(pattern);
+		sl_size i = 0;
+		for (; i + N <= count; i += N) {
+			if (vmaxvq_u8(_Base_NEON<sizeof(T)>::equals(vld1q_u8((const sl_uint8*)(m + i)), p))) {
+				break;
+			}
+		}
+		for (; i < count; i++) {
+			if (m[i] == pattern) {
+				return m + i;
+			}
+		}
+		return sl_null;
+	}
+
+	template <class T>
+	static const T* _Base_findReverse_NEON(const T* m, T pattern, sl_size count)
+	{
+		const sl_size N = 16 / sizeof(T);
+		uint8x16_t p = _Base_NEON<sizeof(T)>::set(pattern);
+		sl_size i = count;
+		while (i >= N) {
+			if (vmaxvq_u8(_Base_NEON<sizeof(T)>::equals(vld1q_u8((const sl_uint8*)(m + i - N)), p))) {
+				break;
+			}
+			i -= N;
+		}
+		while (i > 0) {
+			i--;
+			if (m[i] == pattern) {
+				return m + i;
+			}
+		}
+		return sl_null;
+	}
+
+	template <class T>
+	static void _Base_fill_NEON(T* dst, T value, sl_size count)
+	{
+		const sl_size N = 16 / sizeof(T);
+		uint8x16_t v = _Base_NEON<sizeof(T)>::set(value);
+		sl_size i = 0;
+		for (; i + N <= count; i += N) {
+			vst1q_u8((sl_uint8*)(dst + i), v);
+		}
+		for (; i < count; i++) {
+			dst[i] = value;
+		}
+	}
+#endif
+
+	static sl_size _Base_findMismatch(const sl_uint8* m1, const sl_uint8* m2, sl_size count)
+	{
+#if defined(SLIB_CPU_USE_X86_EXTENSIONS)
+		if (_g_base_flagAVX2 && count >= 64) {
+			return _Base_findMismatch_AVX2(m1, m2, count);
+		}
+#endif
+#if defined(SLIB_CPU_USE_SSE2)
+		return _Base_findMismatch_SSE2(m1, m2, count);
+#elif defined(BASE_USE_NEON)
+		return _Base_findMismatch_NEON(m1, m2, count);
+#else
+		for (sl_size i = 0; i < count; i++) {
+			if (m1[i] != m2[i]) {
+				return i;
+			}
+		}
+		return count;
+#endif
+	}
+
+	static sl_size _Base_findNonZero(const sl_uint8* m, sl_size count)
+	{
+#if defined(SLIB_CPU_USE_X86_EXTENSIONS)
+		if (_g_base_flagAVX2 && count >= 64) {
+			return _Base_findNonZero_AVX2(m, count);
+		}
+#endif
+#if defined(SLIB_CPU_USE_SSE2)
+		return _Base_findNonZero_SSE2(m, count);
+#elif defined(BASE_USE_NEON)
+		return _Base_findNonZero_NEON(m, count);
+#else
+		for (sl_size i = 0; i < count; i++) {
+			if (m[i]) {
+				return i;
+			}
+		}
+		return count;
+#endif
+	}
+
+	template <class T>
+	static const T* _Base_find(const T* m, T pattern, sl_size count)
+	{
+#if defined(SLIB_CPU_USE_X86_EXTENSIONS)
+		if (_g_base_flagAVX2 && count >= 64 / sizeof(T)) {
+			return _Base_find_AVX2(m, pattern, count);
+		}
+#endif
+#if defined(SLIB_CPU_USE_SSE2)
+		return _Base_find_SSE2(m, pattern, count);
+#elif defined(BASE_USE_NEON)
+		return _Base_find_NEON(m, pattern, count);
+#else
+		for (sl_size i = 0; i < count; i++) {
+			if (m[i] == pattern) {
+				return m + i;
+			}
+		}
+		return sl_null;
+#endif
+	}
+
+	template <class T>
+	static const T* _Base_findReverse(const T* m, T pattern, sl_size count)
+	{
+#if defined(SLIB_CPU_USE_X86_EXTENSIONS)
+		if (_g_base_flagAVX2 && count >= 64 / sizeof(T)) {
+			return _Base_findReverse_AVX2(m, pattern, count);
+		}
+#endif
+#if defined(SLIB_CPU_USE_SSE2)
+		return _Base_findReverse_SSE2(m, pattern, count);
+#elif defined(BASE_USE_NEON)
+		return _Base_findReverse_NEON(m, pattern, count);
+#else
+		for (sl_reg i = count - 1; i >= 0; i--) {
+			if (m[i] == pattern) {
+				return m + i;
+			}
+		}
+		return sl_null;
+#endif
+	}
+
+	template <class T>
+	static void _Base_fill(T* dst, T value, sl_size count)
+	{
+#if defined(SLIB_CPU_USE_X86_EXTENSIONS)
+		if (_g_base_flagAVX2 && count >= 64 / sizeof(T)) {
+			_Base_fill_AVX2(dst, value, count);
+			return;
+		}
+#endif
+#if defined(SLIB_CPU_USE_SSE2)
+		_Base_fill_SSE2(dst, value, count);
+#elif defined(BASE_USE_NEON)
+		_Base_fill_NEON(dst, value, count);
+#else
+		for (sl_size i = 0; i < count; i++) {
+			dst[i] = value;
+		}
+#endif
+	}
+
+	template <class T>
+	SLIB_INLINE static sl_int32 _Base_compare(const T* m1, const T* m2, sl_size count)
+	{
+		sl_size size = count * sizeof(T);
+		sl_size n = _Base_findMismatch((const sl_uint8*)m1, (const sl_uint8*)m2, size);
+		if (n >= size) {
+			return 0;
+		}
+		n /= sizeof(T);
+		return m1[n] < m2[n] ? -1 : 1;
+	}
+
+	template <class T>
+	SLIB_INLINE static sl_int32 _Base_compareZero(const T* m, sl_size count)
+	{
+		sl_size size = count * sizeof(T);
+		sl_size n = _Base_findNonZero((const sl_uint8*)m, size);
+		if (n >= size) {
+			return 0;
+		}
+		return m[n / sizeof(T)] > 0 ? 1 : -1;
+	}
+
 	void* Base::createMemory(sl_size size)
 	{
 #ifndef FORCE_MEM_ALIGNED
@@ -102,553 +744,267 @@ namespace slib
 
 	void Base::zeroMemory(void* dst, sl_size size)
 	{
-		sl_uint8* d = (sl_uint8*)dst;
-		for (sl_size i = 0; i < size; i++) {
-			d[i] = 0;
-		}
+		_Base_fill((sl_uint8*)dst, (sl_uint8)0, size);
 	}
 
 	void Base::resetMemory(void* dst, sl_uint8 value, sl_size count)
 	{
-		sl_uint8* d = (sl_uint8*)dst;
-		for (sl_size i = 0; i < count; i++) {
-			d[i] = value;
-		}
+		_Base_fill((sl_uint8*)dst, value, count);
 	}
 
 	void Base::resetMemory2(sl_uint16* dst, sl_uint16 value, sl_size count)
 	{
-		for (sl_size i = 0; i < count; i++) {
-			dst[i] = value;
-		}
+		_Base_fill(dst, value, count);
 	}
 
 	void Base::resetMemory2(sl_int16* dst, sl_int16 value, sl_size count)
 	{
-		for (sl_size i = 0; i < count; i++) {
-			dst[i] = value;
-		}
+		_Base_fill((sl_uint16*)dst, (sl_uint16)value, count);
 	}
 
 	void Base::resetMemory4(sl_uint32* dst, sl_uint32 value, sl_size count)
 	{
-		for (sl_size i = 0; i < count; i++) {
-			dst[i] = value;
-		}
+		_Base_fill(dst, value, count);
 	}
 
 	void Base::resetMemory4(sl_int32* dst, sl_int32 value, sl_size count)
 	{
-		for (sl_size i = 0; i < count; i++) {
-			dst[i] = value;
-		}
+		_Base_fill((sl_uint32*)dst, (sl_uint32)value, count);
 	}
 
 	void Base::resetMemory8(sl_uint64* dst, sl_uint64 value, sl_size count)
 	{
-		for (sl_size i = 0; i < count; i++) {
-			dst[i] = value;
-		}
+		_Base_fill(dst, value, count);
 	}
 
 	void Base::resetMemory8(sl_int64* dst, sl_int64 value, sl_size count)
 	{
-		for (sl_size i = 0; i < count; i++) {
-			dst[i] = value;
-		}
+		_Base_fill((sl_uint64*)dst, (sl_uint64)value, count);
 	}
 
-	sl_bool Base::equalsMemory(const void* _m1, const void* _m2, sl_size count)
+	sl_bool Base::equalsMemory(const void* m1, const void* m2, sl_size count)
 	{
-		sl_uint8* m1 = (sl_uint8*)_m1;
-		sl_uint8* m2 = (sl_uint8*)_m2;
-		for (sl_size i = 0; i < count; i++) {
-			if (m1[i] != m2[i]) {
-				return sl_false;
-			}
-		}
-		return sl_true;
+		return _Base_findMismatch((const sl_uint8*)m1, (const sl_uint8*)m2, count) == count;
 	}
 
 	sl_bool Base::equalsMemory2(const sl_uint16* m1, const sl_uint16* m2, sl_size count)
 	{
-		for (sl_size i = 0; i < count; i++) {
-			if (m1[i] != m2[i]) {
-				return sl_false;
-			}
-		}
-		return sl_true;
+		return equalsMemory(m1, m2, count << 1);
 	}
 
 	sl_bool Base::equalsMemory2(const sl_int16* m1, const sl_int16* m2, sl_size count)
 	{
-		for (sl_size i = 0; i < count; i++) {
-			if (m1[i] != m2[i]) {
-				return sl_false;
-			}
-		}
-		return sl_true;
+		return equalsMemory(m1, m2, count << 1);
 	}
 
 	sl_bool Base::equalsMemory4(const sl_uint32* m1, const sl_uint32* m2, sl_size count)
 	{
-		for (sl_size i = 0; i < count; i++) {
-			if (m1[i] != m2[i]) {
-				return sl_false;
-			}
-		}
-		return sl_true;
+		return equalsMemory(m1, m2, count << 2);
 	}
 
 	sl_bool Base::equalsMemory4(const sl_int32* m1, const sl_int32* m2, sl_size count)
 	{
-		for (sl_size i = 0; i < count; i++) {
-			if (m1[i] != m2[i]) {
-				return sl_false;
-			}
-		}
-		return sl_true;
+		return equalsMemory(m1, m2, count << 2);
 	}
 
 	sl_bool Base::equalsMemory8(const sl_uint64* m1, const sl_uint64* m2, sl_size count)
 	{
-		for (sl_size i = 0; i < count; i++) {
-			if (m1[i] != m2[i]) {
-				return sl_false;
-			}
-		}
-		return sl_true;
+		return equalsMemory(m1, m2, count << 3);
 	}
 
 	sl_bool Base::equalsMemory8(const sl_int64* m1, const sl_int64* m2, sl_size count)
 	{
-		for (sl_size i = 0; i < count; i++) {
-			if (m1[i] != m2[i]) {
-				return sl_false;
-			}
-		}
-		return sl_true;
+		return equalsMemory(m1, m2, count << 3);
 	}
 
 	sl_int32 Base::compareMemory(const sl_uint8* m1, const sl_uint8* m2, sl_size count)
 	{
-		for (sl_size i = 0; i < count; i++) {
-			if (m1[i] < m2[i]) {
-				return -1;
-			} else if (m1[i] > m2[i]) {
-				return 1;
-			}
-		}
-		return 0;
+		return _Base_compare(m1, m2, count);
 	}
 
 	sl_int32 Base::compareMemory(const sl_int8* m1, const sl_int8* m2, sl_size count)
 	{
-		for (sl_size i = 0; i < count; i++) {
-			if (m1[i] < m2[i]) {
-				return -1;
-			} else if (m1[i] > m2[i]) {
-				return 1;
-			}
-		}
-		return 0;
+		return _Base_compare(m1, m2, count);
 	}
 
 	sl_int32 Base::compareMemory2(const sl_uint16* m1, const sl_uint16* m2, sl_size count)
 	{
-		for (sl_size i = 0; i < count; i++) {
-			if (m1[i] < m2[i]) {
-				return -1;
-			} else if (m1[i] > m2[i]) {
-				return 1;
-			}
-		}
-		return 0;
+		return _Base_compare(m1, m2, count);
 	}
 
 	sl_int32 Base::compareMemory2(const sl_int16* m1, const sl_int16* m2, sl_size count)
 	{
-		for (sl_size i = 0; i < count; i++) {
-			if (m1[i] < m2[i]) {
-				return -1;
-			} else if (m1[i] > m2[i]) {
-				return 1;
-			}
-		}
-		return 0;
+		return _Base_compare(m1, m2, count);
 	}
 
 	sl_int32 Base::compareMemory4(const sl_uint32* m1, const sl_uint32* m2, sl_size count)
 	{
-		for (sl_size i = 0; i < count; i++) {
-			if (m1[i] < m2[i]) {
-				return -1;
-			} else if (m1[i] > m2[i]) {
-				return 1;
-			}
-		}
-		return 0;
+		return _Base_compare(m1, m2, count);
 	}
 
 	sl_int32 Base::compareMemory4(const sl_int32* m1, const sl_int32* m2, sl_size count)
 	{
-		for (sl_size i = 0; i < count; i++) {
-			if (m1[i] < m2[i]) {
-				return -1;
-			} else if (m1[i] > m2[i]) {
-				return 1;
-			}
-		}
-		return 0;
+		return _Base_compare(m1, m2, count);
 	}
 
 	sl_int32 Base::compareMemory8(const sl_uint64* m1, const sl_uint64* m2, sl_size count)
 	{
-		for (sl_size i = 0; i < count; i++) {
-			if (m1[i] < m2[i]) {
-				return -1;
-			} else if (m1[i] > m2[i]) {
-				return 1;
-			}
-		}
-		return 0;
+		return _Base_compare(m1, m2, count);
 	}
 
 	sl_int32 Base::compareMemory8(const sl_int64* m1, const sl_int64* m2, sl_size count)
 	{
-		for (sl_size i = 0; i < count; i++) {
-			if (m1[i] < m2[i]) {
-				return -1;
-			} else if (m1[i] > m2[i]) {
-				return 1;
-			}
-		}
-		return 0;
+		return _Base_compare(m1, m2, count);
 	}
 
-	sl_bool Base::equalsMemoryZero(const void* _m, sl_size count)
+	sl_bool Base::equalsMemoryZero(const void* m, sl_size count)
 	{
-		sl_uint8* m = (sl_uint8*)_m;
-		for (sl_size i = 0; i < count; i++) {
-			if (m[i]) {
-				return sl_false;
-			}
-		}
-		return sl_true;
+		return _Base_findNonZero((const sl_uint8*)m, count) == count;
 	}
 
 	sl_bool Base::equalsMemoryZero2(const sl_uint16* m, sl_size count)
 	{
-		for (sl_size i = 0; i < count; i++) {
-			if (m[i]) {
-				return sl_false;
-			}
-		}
-		return sl_true;
+		return equalsMemoryZero(m, count << 1);
 	}
 
 	sl_bool Base::equalsMemoryZero2(const sl_int16* m, sl_size count)
 	{
-		for (sl_size i = 0; i < count; i++) {
-			if (m[i]) {
-				return sl_false;
-			}
-		}
-		return sl_true;
+		return equalsMemoryZero(m, count << 1);
 	}
 
 	sl_bool Base::equalsMemoryZero4(const sl_uint32* m, sl_size count)
 	{
-		for (sl_size i = 0; i < count; i++) {
-			if (m[i]) {
-				return sl_false;
-			}
-		}
-		return sl_true;
+		return equalsMemoryZero(m, count << 2);
 	}
 
 	sl_bool Base::equalsMemoryZero4(const sl_int32* m, sl_size count)
 	{
-		for (sl_size i = 0; i < count; i++) {
-			if (m[i]) {
-				return sl_false;
-			}
-		}
-		return sl_true;
+		return equalsMemoryZero(m, count << 2);
 	}
 
 	sl_bool Base::equalsMemoryZero8(const sl_uint64* m, sl_size count)
 	{
-		for (sl_size i = 0; i < count; i++) {
-			if (m[i]) {
-				return sl_false;
-			}
-		}
-		return sl_true;
+		return equalsMemoryZero(m, count << 3);
 	}
 
 	sl_bool Base::equalsMemoryZero8(const sl_int64* m, sl_size count)
 	{
-		for (sl_size i = 0; i < count; i++) {
-			if (m[i]) {
-				return sl_false;
-			}
-		}
-		return sl_true;
+		return equalsMemoryZero(m, count << 3);
 	}
 
 	sl_int32 Base::compareMemoryZero(const sl_uint8* m, sl_size count)
 	{
-		for (sl_size i = 0; i < count; i++) {
-			if (m[i]) {
-				return 1;
-			}
-		}
-		return 0;
+		return _Base_compareZero(m, count);
 	}
 
 	sl_int32 Base::compareMemoryZero(const sl_int8* m, sl_size count)
 	{
-		for (sl_size i = 0; i < count; i++) {
-			sl_int8 v = m[i];
-			if (v) {
-				if (v < 0) {
-					return -1;
-				} else {
-					return 1;
-				}
-			}
-		}
-		return 0;
+		return _Base_compareZero(m, count);
 	}
 
 	sl_int32 Base::compareMemoryZero2(const sl_uint16* m, sl_size count)
 	{
-		for (sl_size i = 0; i < count; i++) {
-			if (m[i]) {
-				return 1;
-			}
-		}
-		return 0;
+		return _Base_compareZero(m, count);
 	}
 
 	sl_int32 Base::compareMemoryZero2(const sl_int16* m, sl_size count)
 	{
-		for (sl_size i = 0; i < count; i++) {
-			sl_int16 v = m[i];
-			if (v) {
-				if (v < 0) {
-					return -1;
-				} else {
-					return 1;
-				}
-			}
-		}
-		return 0;
+		return _Base_compareZero(m, count);
 	}
 
 	sl_int32 Base::compareMemoryZero4(const sl_uint32* m, sl_size count)
 	{
-		for (sl_size i = 0; i < count; i++) {
-			if (m[i]) {
-				return 1;
-			}
-		}
-		return 0;
+		return _Base_compareZero(m, count);
 	}
 
 	sl_int32 Base::compareMemoryZero4(const sl_int32* m, sl_size count)
 	{
-		for (sl_size i = 0; i < count; i++) {
-			sl_int32 v = m[i];
-			if (v) {
-				if (v < 0) {
-					return -1;
-				} else {
-					return 1;
-				}
-			}
-		}
-		return 0;
+		return _Base_compareZero(m, count);
 	}
 
 	sl_int32 Base::compareMemoryZero8(const sl_uint64* m, sl_size count)
 	{
-		for (sl_size i = 0; i < count; i++) {
-			if (m[i]) {
-				return 1;
-			}
-		}
-		return 0;
+		return _Base_compareZero(m, count);
 	}
 
 	sl_int32 Base::compareMemoryZero8(const sl_int64* m, sl_size count)
 	{
-		for (sl_size i = 0; i < count; i++) {
-			sl_int64 v = m[i];
-			if (v) {
-				if (v < 0) {
-					return -1;
-				} else {
-					return 1;
-				}
-			}
-		}
-		return 0;
+		return _Base_compareZero(m, count);
 	}
 
 	const sl_uint8* Base::findMemory(const void* mem, sl_uint8 pattern, sl_size count)
 	{
-		sl_uint8* m = (sl_uint8*)mem;
-		for (sl_size i = 0; i < count; i++) {
-			if (m[i] == pattern) {
-				return m + i;
-			}
-		}
-		return sl_null;
+		return _Base_find((const sl_uint8*)mem, pattern, count);
 	}
 
 	const sl_int8* Base::findMemory(const sl_int8* m, sl_int8 pattern, sl_size count)
 	{
-		for (sl_size i = 0; i < count; i++) {
-			if (m[i] == pattern) {
-				return m + i;
-			}
-		}
-		return sl_null;
+		return (const sl_int8*)(_Base_find((const sl_uint8*)m, (sl_uint8)pattern, count));
 	}
 
 	const sl_uint16* Base::findMemory2(const sl_uint16* m, sl_uint16 pattern, sl_size count)
 	{
-		for (sl_size i = 0; i < count; i++) {
-			if (m[i] == pattern) {
-				return m + i;
-			}
-		}
-		return sl_null;
+		return _Base_find(m, pattern, count);
 	}
 
 	const sl_int16* Base::findMemory2(const sl_int16* m, sl_int16 pattern, sl_size count)
 	{
-		for (sl_size i = 0; i < count; i++) {
-			if (m[i] == pattern) {
-				return m + i;
-			}
-		}
-		return sl_null;
+		return (const sl_int16*)(_Base_find((const sl_uint16*)m, (sl_uint16)pattern, count));
 	}
 
 	const sl_uint32* Base::findMemory4(const sl_uint32* m, sl_uint32 pattern, sl_size count)
 	{
-		for (sl_size i = 0; i < count; i++) {
-			if (m[i] == pattern) {
-				return m + i;
-			}
-		}
-		return sl_null;
+		return _Base_find(m, pattern, count);
 	}
 
 	const sl_int32* Base::findMemory4(const sl_int32* m, sl_int32 pattern, sl_size count)
 	{
-		for (sl_size i = 0; i < count; i++) {
-			if (m[i] == pattern) {
-				return m + i;
-			}
-		}
-		return sl_null;
+		return (const sl_int32*)(_Base_find((const sl_uint32*)m, (sl_uint32)pattern, count));
 	}
 
 	const sl_uint64* Base::findMemory8(const sl_uint64* m, sl_uint64 pattern, sl_size count)
 	{
-		for (sl_size i = 0; i < count; i++) {
-			if (m[i] == pattern) {
-				return m + i;
-			}
-		}
-		return sl_null;
+		return _Base_find(m, pattern, count);
 	}
 
 	const sl_int64* Base::findMemory8(const sl_int64* m, sl_int64 pattern, sl_size count)
 	{
-		for (sl_size i = 0; i < count; i++) {
-			if (m[i] == pattern) {
-				return m + i;
-			}
-		}
-		return sl_null;
+		return (const sl_int64*)(_Base_find((const sl_uint64*)m, (sl_uint64)pattern, count));
 	}
 
 	const sl_uint8* Base::findMemoryReverse(const void* mem, sl_uint8 pattern, sl_size count)
 	{
-		sl_uint8* m = (sl_uint8*)mem;
-		for (sl_reg i = count - 1; i >= 0; i--) {
-			if (m[i] == pattern) {
-				return m + i;
-			}
-		}
-		return sl_null;
+		return _Base_findReverse((const sl_uint8*)mem, pattern, count);
 	}
 
 	const sl_uint16* Base::findMemoryReverse2(const sl_uint16* m, sl_uint16 pattern, sl_size count)
 	{
-		for (sl_reg i = count - 1; i >= 0; i--) {
-			if (m[i] == pattern) {
-				return m + i;
-			}
-		}
-		return sl_null;
+		return _Base_findReverse(m, pattern, count);
 	}
 
 	const sl_int16* Base::findMemoryReverse2(const sl_int16* m, sl_int16 pattern, sl_size count)
 	{
-		for (sl_reg i = count - 1; i >= 0; i--) {
-			if (m[i] == pattern) {
-				return m + i;
-			}
-		}
-		return sl_null;
+		return (const sl_int16*)(_Base_findReverse((const sl_uint16*)m, (sl_uint16)pattern, count));
 	}
 
 	const sl_uint32* Base::findMemoryReverse4(const sl_uint32* m, sl_uint32 pattern, sl_size count)
 	{
-		for (sl_reg i = count - 1; i >= 0; i--) {
-			if (m[i] == pattern) {
-				return m + i;
-			}
-		}
-		return sl_null;
+		return _Base_findReverse(m, pattern, count);
 	}
 
 	const sl_int32* Base::findMemoryReverse4(const sl_int32* m, sl_int32 pattern, sl_size count)
 	{
-		for (sl_reg i = count - 1; i >= 0; i--) {
-			if (m[i] == pattern) {
-				return m + i;
-			}
-		}
-		return sl_null;
+		return (const sl_int32*)(_Base_findReverse((const sl_uint32*)m, (sl_uint32)pattern, count));
 	}
 
-	const sl_uint64* Base::findMemoryReverse8(const sl_uint64* mem, sl_uint64 pattern, sl_size count)
+	const sl_uint64* Base::findMemoryReverse8(const sl_uint64* m, sl_uint64 pattern, sl_size count)
 	{
-		sl_uint64* m = (sl_uint64*)mem;
-		for (sl_reg i = count - 1; i >= 0; i--) {
-			if (m[i] == pattern) {
-				return m + i;
-			}
-		}
-		return sl_null;
+		return _Base_findReverse(m, pattern, count);
 	}
 
-	const sl_int64* Base::findMemoryReverse8(const sl_int64* mem, sl_int64 pattern, sl_size count)
+	const sl_int64* Base::findMemoryReverse8(const sl_int64* m, sl_int64 pattern, sl_size count)
 	{
-		sl_int64* m = (sl_int64*)mem;
-		for (sl_reg i = count - 1; i >= 0; i--) {
-			if (m[i] == pattern) {
-				return m + i;
-			}
-		}
-		return sl_null;
+		return (const sl_int64*)(_Base_findReverse((const sl_uint64*)m, (sl_uint64)pattern, count));
 	}
 
 	const sl_uint8* Base::findMemoryUntilZero(const void* mem, sl_uint8 pattern, sl_size count)
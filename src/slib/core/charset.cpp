@@ -10,9 +10,222 @@
 
 #include "../../../inc/slib/core/charset.h"
 #include "../../../inc/slib/core/base.h"
+#include "../../../inc/slib/core/cpu.h"
+
+#if defined(SLIB_CPU_USE_SSE2)
+#	include <emmintrin.h>
+#endif
+#if defined(SLIB_CPU_USE_NEON) && defined(SLIB_ARCH_IS_ARM64)
+#	include <arm_neon.h>
+#	define CHARSETS_USE_NEON
+#endif
 
 namespace slib
 {
+
+	/*
+		ASCII runs are converted 16 characters at a time; other characters go through the scalar decoders.
+	*/
+
+	// converts the leading run of ASCII characters, and returns its length
+	static sl_size _Charsets_copyAscii8To16(const sl_char8* src, sl_char16* dst, sl_size count)
+	{
+		sl_size i = 0;
+#if defined(SLIB_CPU_USE_SSE2)
+		__m128i zero = _mm_setzero_si128();
+		for (; i + 16 <= count; i += 16) {
+			__m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+			if (_mm_movemask_epi8(v)) {
+				break;
+			}
+			if (dst) {
+				_mm_storeu_si128((__m128i*)(dst + i), _mm_unpacklo_epi8(v, zero));
+				_mm_storeu_si128((__m128i*)(dst + i + 8), _mm_unpackhi_epi8(v, zero));
+			}
+		}
+#elif defined(CHARSETS_USE_NEON)
+		for (; i + 16 <= count; i += 16) {
+			uint8x16_t v = vld1q_u8((const sl_uint8*)(src + i));
+			if (vmaxvq_u8(v) >= 0x80) {
+				break;
+			}
+			if (dst) {
+				vst1q_u16((sl_uint16*)(dst + i), vmovl_u8(vget_low_u8(v)));
+				vst1q_u16((sl_uint16*)(dst + i + 8), vmovl_high_u8(v));
+			}
+		}
+#endif
+		for (; i < count; i++) {
+			sl_uint8 ch = (sl_uint8)(src[i]);
+			if (ch >= 0x80) {
+				break;
+			}
+			if (dst) {
+				dst[i] = (sl_char16)ch;
+			}
+		}
+		return i;
+	}
+
+	static sl_size _Charsets_copyAscii16To8(const sl_char16* src, sl_char8* dst, sl_size count)
+	{
+		sl_size i = 0;
+#if defined(SLIB_CPU_USE_SSE2)
+		__m128i zero = _mm_setzero_si128();
+		__m128i maskNonAscii = _mm_set1_epi16((short)0xFF80);
+		for (; i + 16 <= count; i += 16) {
+			__m128i a = _mm_loadu_si128((const __m128i*)(src + i));
+			__m128i b = _mm_loadu_si128((const __m128i*)(src + i + 8));
+			if (_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(_mm_or_si128(a, b), maskNonAscii), zero)) != 0xFFFF) {
+				break;
+			}
+			if (dst) {
+				_mm_storeu_si128((__m128i*)(dst + i), _mm_packus_epi16(a, b));
+			}
+		}
+#elif defined(CHARSETS_USE_NEON)
+		for (; i + 16 <= count; i += 16) {
+			uint16x8_t a = vld1q_u16((const sl_uint16*)(src + i));
+			uint16x8_t b = vld1q_u16((const sl_uint16*)(src + i + 8));
+			if (vmaxvq_u16(vorrq_u16(a, b)) >= 0x80) {
+				break;
+			}
+			if (dst) {
+				vst1q_u8((sl_uint8*)(dst + i), vcombine_u8(vmovn_u16(a), vmovn_u16(b)));
+			}
+		}
+#endif
+		for (; i < count; i++) {
+			sl_uint16 ch = (sl_uint16)(src[i]);
+			if (ch >= 0x80) {
+				break;
+			}
+			if (dst) {
+				dst[i] = (sl_char8)ch;
+			}
+		}
+		return i;
+	}
+
+	SLIB_INLINE static sl_uint32 _Charsets_getBitsCount(sl_uint32 n)
+	{
+		n = n - ((n >> 1) & 0x55555555);
+		n = (n & 0x33333333) + ((n >> 2) & 0x33333333);
+		return (((n + (n >> 4)) & 0x0F0F0F0F) * 0x01010101) >> 24;
+	}
+
+	// exact length of `utf16ToUtf8` output without a buffer limit; blocks of 8 BMP characters are counted at once
+	static sl_size _Charsets_getUtf8Length(const sl_char16* utf16, sl_size len)
+	{
+		sl_size n = 0;
+		sl_size i = 0;
+#if defined(SLIB_CPU_USE_SSE2)
+		__m128i zero = _mm_setzero_si128();
+		__m128i mask80 = _mm_set1_epi16((short)0xFF80);
+		__m128i mask800 = _mm_set1_epi16((short)0xF800);
+		__m128i surrogate = _mm_set1_epi16((short)0xD800);
+#elif defined(CHARSETS_USE_NEON)
+		uint16x8_t mask800 = vdupq_n_u16(0xF800);
+		uint16x8_t surrogate = vdupq_n_u16(0xD800);
+		uint16x8_t ch80 = vdupq_n_u16(0x80);
+		uint16x8_t ch800 = vdupq_n_u16(0x800);
+#endif
+		while (i < len) {
+#if defined(SLIB_CPU_USE_SSE2)
+			if (i + 8 <= len) {
+				__m128i v = _mm_loadu_si128((const __m128i*)(utf16 + i));
+				__m128i v800 = _mm_and_si128(v, mask800);
+				if (!(_mm_movemask_epi8(_mm_cmpeq_epi16(v800, surrogate)))) {
+					sl_uint32 nAscii = (sl_uint32)(_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(v, mask80), zero)));
+					sl_uint32 nBelow800 = (sl_uint32)(_mm_movemask_epi8(_mm_cmpeq_epi16(v800, zero)));
+					n += 24 - ((_Charsets_getBitsCount(nAscii) + _Charsets_getBitsCount(nBelow800)) >> 1);
+					i += 8;
+					continue;
+				}
+			}
+#elif defined(CHARSETS_USE_NEON)
+			if (i + 8 <= len) {
+				uint16x8_t v = vld1q_u16((const sl_uint16*)(utf16 + i));
+				if (!(vmaxvq_u16(vceqq_u16(vandq_u16(v, mask800), surrogate)))) {
+					uint16x8_t c = vaddq_u16(vshrq_n_u16(vcgeq_u16(v, ch80), 15), vshrq_n_u16(vcgeq_u16(v, ch800), 15));
+					n += 8 + vaddvq_u16(c);
+					i += 8;
+					continue;
+				}
+			}
+#endif
+			sl_uint32 ch = (sl_uint32)(utf16[i]);
+			if (ch < 0x80) {
+				n++;
+			} else if (ch < 0x800) {
+				n += 2;
+			} else if (ch >= 0xD800 && ch < 0xDC00 && i + 1 < len && (sl_uint32)(utf16[i + 1]) >= 0xDC00 && (sl_uint32)(utf16[i + 1]) < 0xE000) {
+				n += 4;
+				i++;
+			} else {
+				n += 3;
+			}
+			i++;
+		}
+		return n;
+	}
+
+	sl_bool Charsets::checkUtf8(const sl_char8* utf8, sl_size len)
+	{
+		const sl_uint8* s = (const sl_uint8*)utf8;
+		sl_size i = 0;
+		while (i < len) {
+			sl_uint32 ch = s[i];
+			if (ch < 0x80) {
+				i += _Charsets_copyAscii8To16(utf8 + i, sl_null, len - i);
+			} else if (ch < 0xC2) {
+				// continuation byte or overlong 2-byte form
+				return sl_false;
+			} else if (ch < 0xE0) {
+				if (i + 1 >= len || (s[i + 1] & 0xC0) != 0x80) {
+					return sl_false;
+				}
+				i += 2;
+			} else if (ch < 0xF0) {
+				if (i + 2 >= len) {
+					return sl_false;
+				}
+				sl_uint32 ch1 = s[i + 1];
+				if ((ch1 & 0xC0) != 0x80 || (s[i + 2] & 0xC0) != 0x80) {
+					return sl_false;
+				}
+				if (ch == 0xE0 && ch1 < 0xA0) {
+					// overlong
+					return sl_false;
+				}
+				if (ch == 0xED && ch1 >= 0xA0) {
+					// surrogates
+					return sl_false;
+				}
+				i += 3;
+			} else if (ch < 0xF5) {
+				if (i + 3 >= len) {
+					return sl_false;
+				}
+				sl_uint32 ch1 = s[i + 1];
+				if ((ch1 & 0xC0) != 0x80 || (s[i + 2] & 0xC0) != 0x80 || (s[i + 3] & 0xC0) != 0x80) {
+					return sl_false;
+				}
+				if (ch == 0xF0 && ch1 < 0x90) {
+					// overlong
+					return sl_false;
+				}
+				if (ch == 0xF4 && ch1 >= 0x90) {
+					// above U+10FFFF
+					return sl_false;
+				}
+				i += 4;
+			} else {
+				return sl_false;
+			}
+		}
+		return sl_true;
+	}
 	
 	sl_size Charsets::utf8ToUtf16(const sl_char8* utf8, sl_reg lenUtf8, sl_char16* utf16, sl_reg lenUtf16Buffer)
 	{
@@ -20,14 +233,18 @@ namespace slib
 			lenUtf8 = Base::getStringLength(utf8, -1) + 1;
 		}
 		sl_reg n = 0;
-		for (sl_reg i = 0; i < lenUtf8 && (lenUtf16Buffer < 0 || n < lenUtf16Buffer); i++) {
+		sl_reg i = 0;
+		while (i < lenUtf8 && (lenUtf16Buffer < 0 || n < lenUtf16Buffer)) {
 			sl_uint32 ch = (sl_uint32)((sl_uint8)utf8[i]);
 			if (ch < 0x80) {
-				if (utf16) {
-					utf16[n++] = (sl_char16)ch;
-				} else {
-					n++;
+				sl_reg m = lenUtf8 - i;
+				if (lenUtf16Buffer >= 0 && lenUtf16Buffer - n < m) {
+					m = lenUtf16Buffer - n;
 				}
+				sl_size k = _Charsets_copyAscii8To16(utf8 + i, utf16 ? utf16 + n : sl_null, m);
+				i += k;
+				n += k;
+				continue;
 			} else if (ch < 0xC0) {
 				// Corrupted data element
 			} else if (ch < 0xE0) {
@@ -53,7 +270,29 @@ namespace slib
 						}
 					}
 				}
+			} else if (ch < 0xF8) {
+				if (i + 3 < lenUtf8) {
+					sl_uint32 ch1 = (sl_uint32)((sl_uint8)utf8[++i]);
+					sl_uint32 ch2 = (sl_uint32)((sl_uint8)utf8[++i]);
+					sl_uint32 ch3 = (sl_uint32)((sl_uint8)utf8[++i]);
+					if (((ch1 & 0xC0) == 0x80) && ((ch2 & 0xC0) == 0x80) && ((ch3 & 0xC0) == 0x80)) {
+						sl_uint32 code = ((ch & 0x07) << 18) | ((ch1 & 0x3F) << 12) | ((ch2 & 0x3F) << 6) | (ch3 & 0x3F);
+						if (code >= 0x10000 && code < 0x110000) {
+							// surrogate pair
+							if (lenUtf16Buffer < 0 || n + 1 < lenUtf16Buffer) {
+								if (utf16) {
+									code -= 0x10000;
+									utf16[n++] = (sl_char16)(0xD800 + (code >> 10));
+									utf16[n++] = (sl_char16)(0xDC00 + (code & 0x3FF));
+								} else {
+									n += 2;
+								}
+							}
+						}
+					}
+				}
 			}
+			i++;
 		}
 		return n;
 	}
@@ -149,15 +388,22 @@ namespace slib
 		if (lenUtf16 < 0) {
 			lenUtf16 = Base::getStringLength2(utf16, -1) + 1;
 		}
+		if (!utf8 && lenUtf8Buffer < 0) {
+			return _Charsets_getUtf8Length(utf16, lenUtf16);
+		}
 		sl_reg n = 0;
-		for (sl_reg i = 0; i < lenUtf16 && (lenUtf8Buffer < 0 || n < lenUtf8Buffer); i++) {
+		sl_reg i = 0;
+		while (i < lenUtf16 && (lenUtf8Buffer < 0 || n < lenUtf8Buffer)) {
 			sl_uint32 ch = (sl_uint32)(utf16[i]);
 			if (ch < 0x80) {
-				if (utf8) {
-					utf8[n++] = (sl_char8)(ch);
-				} else {
-					n++;
+				sl_reg m = lenUtf16 - i;
+				if (lenUtf8Buffer >= 0 && lenUtf8Buffer - n < m) {
+					m = lenUtf8Buffer - n;
 				}
+				sl_size k = _Charsets_copyAscii16To8(utf16 + i, utf8 ? utf8 + n : sl_null, m);
+				i += k;
+				n += k;
+				continue;
 			} else if (ch < 0x800) {
 				if (lenUtf8Buffer < 0 || n + 1 < lenUtf8Buffer) {
 					if (utf8) {
@@ -167,6 +413,20 @@ namespace slib
 						n += 2;
 					}
 				}
+			} else if (ch >= 0xD800 && ch < 0xDC00 && i + 1 < lenUtf16 && (sl_uint32)(utf16[i + 1]) >= 0xDC00 && (sl_uint32)(utf16[i + 1]) < 0xE000) {
+				// surrogate pair
+				if (lenUtf8Buffer < 0 || n + 3 < lenUtf8Buffer) {
+					if (utf8) {
+						ch = (((ch - 0xD800) << 10) | ((sl_uint32)(utf16[i + 1]) - 0xDC00)) + 0x10000;
+						utf8[n++] = (sl_char8)((ch >> 18) | 0xF0);
+						utf8[n++] = (sl_char8)(((ch >> 12) & 0x3F) | 0x80);
+						utf8[n++] = (sl_char8)(((ch >> 6) & 0x3F) | 0x80);
+						utf8[n++] = (sl_char8)((ch & 0x3F) | 0x80);
+					} else {
+						n += 4;
+					}
+				}
+				i++;
 			} else {
 				if (lenUtf8Buffer < 0 || n + 2 < lenUtf8Buffer) {
 					if (utf8) {
@@ -178,6 +438,7 @@ namespace slib
 					}
 				}
 			}
+			i++;
 		}
 		return n;
 	}
@@ -0,0 +1,261 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "../../../inc/slib/core/cpu.h"
+
+#if defined(SLIB_ARCH_IS_X64) || defined(SLIB_ARCH_IS_X86)
+#	if defined(SLIB_COMPILER_IS_VC)
+#		include <intrin.h>
+#	else
+#		include <cpuid.h>
+#	endif
+#endif
+
+#if defined(SLIB_ARCH_IS_ARM) && (SLIB_PLATFORM == SLIB_PLATFORM_LINUX || SLIB_PLATFORM == SLIB_PLATFORM_ANDROID)
+#	include <sys/auxv.h>
+#	define ARM_USE_HWCAP
+#endif
+
+#if defined(SLIB_PLATFORM_IS_WIN32)
+#	include <windows.h>
+#else
+#	include <unistd.h>
+#endif
+
+namespace slib
+{
+
+	struct _Cpu_Features
+	{
+		sl_bool flagSSE2;
+		sl_bool flagSSSE3;
+		sl_bool flagSSE41;
+		sl_bool flagSSE42;
+		sl_bool flagAVX2;
+		sl_bool flagAESNI;
+		sl_bool flagPCLMULQDQ;
+		sl_bool flagSHANI;
+
+		sl_bool flagNEON;
+		sl_bool flagARMv8AES;
+		sl_bool flagARMv8PMULL;
+		sl_bool flagARMv8SHA1;
+		sl_bool flagARMv8SHA2;
+		sl_bool flagARMv8CRC32;
+
+		_Cpu_Features()
+		{
+			flagSSE2 = sl_false;
+			flagSSSE3 = sl_false;
+			flagSSE41 = sl_false;
+			flagSSE42 = sl_false;
+			flagAVX2 = sl_false;
+			flagAESNI = sl_false;
+			flagPCLMULQDQ = sl_false;
+			flagSHANI = sl_false;
+			flagNEON = sl_false;
+			flagARMv8AES = sl_false;
+			flagARMv8PMULL = sl_false;
+			flagARMv8SHA1 = sl_false;
+			flagARMv8SHA2 = sl_false;
+			flagARMv8CRC32 = sl_false;
+#if defined(SLIB_ARCH_IS_X64) || defined(SLIB_ARCH_IS_X86)
+			detectX86();
+#elif defined(SLIB_ARCH_IS_ARM)
+			detectARM();
+#endif
+		}
+
+#if defined(SLIB_ARCH_IS_X64) || defined(SLIB_ARCH_IS_X86)
+		static void cpuid(sl_uint32 leaf, sl_uint32 subleaf, sl_uint32 regs[4])
+		{
+#	if defined(SLIB_COMPILER_IS_VC)
+			int r[4];
+			__cpuidex(r, (int)leaf, (int)subleaf);
+			regs[0] = (sl_uint32)(r[0]);
+			regs[1] = (sl_uint32)(r[1]);
+			regs[2] = (sl_uint32)(r[2]);
+			regs[3] = (sl_uint32)(r[3]);
+#	else
+			__cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#	endif
+		}
+
+		static sl_uint64 xgetbv()
+		{
+#	if defined(SLIB_COMPILER_IS_VC)
+			return (sl_uint64)(_xgetbv(0));
+#	else
+			sl_uint32 eax, edx;
+			__asm__ __volatile__ ("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+			return ((sl_uint64)edx << 32) | eax;
+#	endif
+		}
+
+		void detectX86()
+		{
+			sl_uint32 regs[4];
+			cpuid(0, 0, regs);
+			sl_uint32 nMaxLeaf = regs[0];
+			if (nMaxLeaf < 1) {
+				return;
+			}
+			cpuid(1, 0, regs);
+			sl_uint32 ecx = regs[2];
+			sl_uint32 edx = regs[3];
+			flagSSE2 = (edx & (1 << 26)) != 0;
+			flagSSSE3 = (ecx & (1 << 9)) != 0;
+			flagSSE41 = (ecx & (1 << 19)) != 0;
+			flagSSE42 = (ecx & (1 << 20)) != 0;
+			flagAESNI = (ecx & (1 << 25)) != 0;
+			flagPCLMULQDQ = (ecx & (1 << 1)) != 0;
+			// AVX state must be enabled by the OS (OSXSAVE and XCR0 bits 1, 2)
+			sl_bool flagAVX = sl_false;
+			if ((ecx & (1 << 27)) && (ecx & (1 << 28))) {
+				flagAVX = (xgetbv() & 6) == 6;
+			}
+			if (nMaxLeaf >= 7) {
+				cpuid(7, 0, regs);
+				flagAVX2 = flagAVX && (regs[1] & (1 << 5)) != 0;
+				flagSHANI = (regs[1] & (1 << 29)) != 0;
+			}
+		}
+#endif
+
+#if defined(SLIB_ARCH_IS_ARM)
+		void detectARM()
+		{
+#	if defined(SLIB_ARCH_IS_ARM64)
+			flagNEON = sl_true;
+#		if defined(ARM_USE_HWCAP)
+			unsigned long hwcap = getauxval(AT_HWCAP);
+			flagARMv8AES = (hwcap & (1 << 3)) != 0;
+			flagARMv8PMULL = (hwcap & (1 << 4)) != 0;
+			flagARMv8SHA1 = (hwcap & (1 << 5)) != 0;
+			flagARMv8SHA2 = (hwcap & (1 << 6)) != 0;
+			flagARMv8CRC32 = (hwcap & (1 << 7)) != 0;
+#		elif defined(SLIB_PLATFORM_IS_APPLE)
+			flagARMv8AES = sl_true;
+			flagARMv8PMULL = sl_true;
+			flagARMv8SHA1 = sl_true;
+			flagARMv8SHA2 = sl_true;
+			flagARMv8CRC32 = sl_true;
+#		endif
+#	else
+#		if defined(ARM_USE_HWCAP)
+			unsigned long hwcap = getauxval(AT_HWCAP);
+			flagNEON = (hwcap & (1 << 12)) != 0;
+			unsigned long hwcap2 = getauxval(AT_HWCAP2);
+			flagARMv8AES = (hwcap2 & (1 << 0)) != 0;
+			flagARMv8PMULL = (hwcap2 & (1 << 1)) != 0;
+			flagARMv8SHA1 = (hwcap2 & (1 << 2)) != 0;
+			flagARMv8SHA2 = (hwcap2 & (1 << 3)) != 0;
+			flagARMv8CRC32 = (hwcap2 & (1 << 4)) != 0;
+#		elif defined(SLIB_CPU_USE_NEON)
+			flagNEON = sl_true;
+#		endif
+#	endif
+		}
+#endif
+
+	};
+
+	static const _Cpu_Features& _Cpu_getFeatures()
+	{
+		static _Cpu_Features features;
+		return features;
+	}
+
+	sl_bool Cpu::isSSE2Supported()
+	{
+		return _Cpu_getFeatures().flagSSE2;
+	}
+
+	sl_bool Cpu::isSSSE3Supported()
+	{
+		return _Cpu_getFeatures().flagSSSE3;
+	}
+
+	sl_bool Cpu::isSSE41Supported()
+	{
+		return _Cpu_getFeatures().flagSSE41;
+	}
+
+	sl_bool Cpu::isSSE42Supported()
+	{
+		return _Cpu_getFeatures().flagSSE42;
+	}
+
+	sl_bool Cpu::isAVX2Supported()
+	{
+		return _Cpu_getFeatures().flagAVX2;
+	}
+
+	sl_bool Cpu::isAESNISupported()
+	{
+		return _Cpu_getFeatures().flagAESNI;
+	}
+
+	sl_bool Cpu::isPCLMULQDQSupported()
+	{
+		return _Cpu_getFeatures().flagPCLMULQDQ;
+	}
+
+	sl_bool Cpu::isSHANISupported()
+	{
+		return _Cpu_getFeatures().flagSHANI;
+	}
+
+	sl_bool Cpu::isNEONSupported()
+	{
+		return _Cpu_getFeatures().flagNEON;
+	}
+
+	sl_bool Cpu::isARMv8AESSupported()
+	{
+		return _Cpu_getFeatures().flagARMv8AES;
+	}
+
+	sl_bool Cpu::isARMv8PMULLSupported()
+	{
+		return _Cpu_getFeatures().flagARMv8PMULL;
+	}
+
+	sl_bool Cpu::isARMv8SHA1Supported()
+	{
+		return _Cpu_getFeatures().flagARMv8SHA1;
+	}
+
+	sl_bool Cpu::isARMv8SHA2Supported()
+	{
+		return _Cpu_getFeatures().flagARMv8SHA2;
+	}
+
+	sl_bool Cpu::isARMv8CRC32Supported()
+	{
+		return _Cpu_getFeatures().flagARMv8CRC32;
+	}
+
+	sl_uint32 Cpu::getCoresCount()
+	{
+#if defined(SLIB_PLATFORM_IS_WIN32)
+		SYSTEM_INFO si;
+		GetSystemInfo(&si);
+		return (sl_uint32)(si.dwNumberOfProcessors);
+#else
+		long n = sysconf(_SC_NPROCESSORS_ONLN);
+		if (n > 0) {
+			return (sl_uint32)n;
+		}
+		return 1;
+#endif
+	}
+
+}
@@ -13,6 +13,11 @@
 #include "../../../inc/slib/core/file.h"
 #include "../../../inc/slib/core/variant.h"
 #include "../../../inc/slib/core/safe_static.h"
+#include "../../../inc/slib/core/thread.h"
+#include "../../../inc/slib/core/mutex.h"
+#include "../../../inc/slib/core/hashtable.h"
+
+#include <atomic>
 
 #if defined(SLIB_PLATFORM_IS_ANDROID)
 #include <android/log.h>
@@ -85,6 +90,504 @@ namespace slib
 		}
 	}
 	
+	AsyncFileLoggerParam::AsyncFileLoggerParam()
+	{
+		flushInterval = 1000;
+		flushSize = 32768;
+		bufferSize = 131072;
+		overflowPolicy = LoggerOverflowPolicy::Drop;
+		maxFileSize = 0;
+		rotationInterval = 0;
+		maxBackupFiles = 5;
+	}
+
+	AsyncFileLoggerParam::~AsyncFileLoggerParam()
+	{
+	}
+
+	SLIB_DEFINE_OBJECT(AsyncFileLogger, Logger)
+
+	AsyncFileLogger::AsyncFileLogger()
+	{
+	}
+
+	AsyncFileLogger::~AsyncFileLogger()
+	{
+	}
+
+	struct _AsyncFileLogger_Record
+	{
+		sl_uint32 size; // including this header
+		sl_uint32 lenTag;
+		sl_int64 time;
+	};
+
+	// shared by the buffers of a thread, cleared when the thread exits
+	class _AsyncFileLogger_ThreadState : public Referable
+	{
+	public:
+		std::atomic<sl_bool> flagAlive;
+
+	public:
+		_AsyncFileLogger_ThreadState() : flagAlive(sl_true)
+		{
+		}
+
+	};
+
+	// single-producer (logging thread), single-consumer (writer) ring buffer
+	class _AsyncFileLogger_Buffer : public Referable
+	{
+	public:
+		Ref<_AsyncFileLogger_ThreadState> thread;
+		sl_uint8* data;
+		sl_size capacity; // power of 2
+		std::atomic<sl_size> head; // advanced by the logging thread
+		std::atomic<sl_size> tail; // advanced by the writer
+
+	public:
+		_AsyncFileLogger_Buffer() : data(sl_null), capacity(0), head(0), tail(0)
+		{
+		}
+
+		~_AsyncFileLogger_Buffer()
+		{
+			if (data) {
+				Base::freeMemory(data);
+			}
+		}
+
+	public:
+		void write(sl_size pos, const void* src, sl_size size)
+		{
+			sl_size offset = pos & (capacity - 1);
+			sl_size n = capacity - offset;
+			if (n >= size) {
+				Base::copyMemory(data + offset, src, size);
+			} else {
+				Base::copyMemory(data + offset, src, n);
+				Base::copyMemory(data, (const sl_uint8*)src + n, size - n);
+			}
+		}
+
+		void read(sl_size pos, void* dst, sl_size size)
+		{
+			sl_size offset = pos & (capacity - 1);
+			sl_size n = capacity - offset;
+			if (n >= size) {
+				Base::copyMemory(dst, data + offset, size);
+			} else {
+				Base::copyMemory(dst, data + offset, n);
+				Base::copyMemory((sl_uint8*)dst + n, data, size - n);
+			}
+		}
+
+	};
+
+	// the buffer of the current thread for the last used logger
+	SLIB_THREAD sl_uint64 _gt_asyncFileLogger_idLogger = 0;
+	SLIB_THREAD _AsyncFileLogger_Buffer* _gt_asyncFileLogger_buffer = sl_null;
+	// set when the thread-local objects of the current thread are destroyed
+	SLIB_THREAD sl_bool _gt_asyncFileLogger_flagThreadExited = sl_false;
+
+	class _AsyncFileLogger_ThreadExit
+	{
+	public:
+		Ref<_AsyncFileLogger_ThreadState> state;
+
+	public:
+		~_AsyncFileLogger_ThreadExit()
+		{
+			// the writers release the buffers of the thread after draining them
+			if (state.isNotNull()) {
+				state->flagAlive.store(sl_false, std::memory_order_release);
+			}
+			_gt_asyncFileLogger_flagThreadExited = sl_true;
+			_gt_asyncFileLogger_idLogger = 0;
+			_gt_asyncFileLogger_buffer = sl_null;
+		}
+
+	};
+
+	SLIB_THREAD _AsyncFileLogger_ThreadExit _gt_asyncFileLogger_threadExit;
+
+	class _AsyncFileLogger : public AsyncFileLogger
+	{
+	public:
+		sl_uint64 m_id;
+		String m_fileName;
+		sl_uint32 m_flushInterval;
+		sl_size m_flushSize;
+		sl_size m_bufferSize;
+		LoggerOverflowPolicy m_overflowPolicy;
+		sl_uint64 m_maxFileSize;
+		sl_uint32 m_rotationInterval;
+		sl_uint32 m_maxBackupFiles;
+
+		sl_bool m_flagRunning;
+		Ref<Thread> m_thread;
+		std::atomic<sl_uint64> m_nDroppedLines;
+
+		Mutex m_lockBuffers;
+		HashTable< sl_uint64, Ref<_AsyncFileLogger_Buffer> > m_buffers;
+
+		// used by the writer only
+		Mutex m_lockWriter;
+		Ref<File> m_file;
+		sl_uint64 m_sizeFile;
+		sl_int64 m_periodFile;
+		sl_uint8* m_batch;
+		sl_size m_sizeBatch;
+		sl_size m_capacityBatch;
+		sl_int64 m_secondsTimeString;
+		String m_timeString;
+
+	public:
+		_AsyncFileLogger() : m_nDroppedLines(0)
+		{
+			static sl_int64 idLast = 0;
+			m_id = Base::interlockedIncrement64(&idLast);
+			m_flagRunning = sl_false;
+			m_sizeFile = 0;
+			m_periodFile = -1;
+			m_batch = sl_null;
+			m_sizeBatch = 0;
+			m_capacityBatch = 0;
+			m_secondsTimeString = -1;
+		}
+
+		~_AsyncFileLogger()
+		{
+			close();
+			if (m_thread.isNotNull()) {
+				m_thread->finishAndWait();
+			}
+			if (m_batch) {
+				Base::freeMemory(m_batch);
+			}
+		}
+
+	public:
+		static Ref<_AsyncFileLogger> create(const AsyncFileLoggerParam& param)
+		{
+			if (param.fileName.isEmpty()) {
+				return sl_null;
+			}
+			Ref<_AsyncFileLogger> ret = new _AsyncFileLogger;
+			if (ret.isNotNull()) {
+				ret->m_fileName = param.fileName;
+				ret->m_flushInterval = param.flushInterval;
+				if (ret->m_flushInterval < 1) {
+					ret->m_flushInterval = 1;
+				}
+				sl_size bufferSize = 4096;
+				while (bufferSize < param.bufferSize && bufferSize < 0x40000000) {
+					bufferSize <<= 1;
+				}
+				ret->m_bufferSize = bufferSize;
+				ret->m_flushSize = param.flushSize;
+				if (ret->m_flushSize < 1 || ret->m_flushSize > bufferSize) {
+					ret->m_flushSize = bufferSize / 2;
+				}
+				ret->m_overflowPolicy = param.overflowPolicy;
+				ret->m_maxFileSize = param.maxFileSize;
+				ret->m_rotationInterval = param.rotationInterval;
+				ret->m_maxBackupFiles = param.maxBackupFiles;
+				ret->m_thread = Thread::create(SLIB_FUNCTION_CLASS(_AsyncFileLogger, _run, ret.get()));
+				if (ret->m_thread.isNotNull()) {
+					ret->m_flagRunning = sl_true;
+					if (ret->m_thread->start()) {
+						return ret;
+					}
+					ret->m_flagRunning = sl_false;
+				}
+			}
+			return sl_null;
+		}
+
+	public:
+		// override
+		void log(const String& tag, const String& content)
+		{
+			if (!m_flagRunning) {
+				return;
+			}
+			_AsyncFileLogger_Buffer* buffer = _getThreadBuffer();
+			if (!buffer) {
+				return;
+			}
+			sl_size capacity = buffer->capacity;
+			sl_size lenTag = tag.getLength();
+			sl_size lenContent = content.getLength();
+			if (sizeof(_AsyncFileLogger_Record) + lenTag + lenContent > capacity) {
+				// too long lines are truncated to fit in the buffer
+				if (lenTag > capacity / 4) {
+					lenTag = capacity / 4;
+				}
+				lenContent = capacity - sizeof(_AsyncFileLogger_Record) - lenTag;
+			}
+			_AsyncFileLogger_Record record;
+			record.size = (sl_uint32)(sizeof(_AsyncFileLogger_Record) + lenTag + lenContent);
+			record.lenTag = (sl_uint32)lenTag;
+			record.time = Time::now().toInt();
+			
+			sl_size head = buffer->head.load(std::memory_order_relaxed);
+			sl_size sizeUsed;
+			for (;;) {
+				sizeUsed = head - buffer->tail.load(std::memory_order_acquire);
+				if (sizeUsed + record.size <= capacity) {
+					break;
+				}
+				if (m_overflowPolicy == LoggerOverflowPolicy::Drop || !m_flagRunning || m_thread->isCurrentThread()) {
+					m_nDroppedLines++;
+					return;
+				}
+				m_thread->wake();
+				Thread::sleep(1);
+			}
+			buffer->write(head, &record, sizeof(record));
+			buffer->write(head + sizeof(record), tag.getData(), lenTag);
+			buffer->write(head + sizeof(record) + lenTag, content.getData(), lenContent);
+			buffer->head.store(head + record.size, std::memory_order_release);
+			
+			if (sizeUsed < m_flushSize && sizeUsed + record.size >= m_flushSize) {
+				m_thread->wake();
+			}
+		}
+
+		// override
+		void flush()
+		{
+			MutexLocker lock(&m_lockWriter);
+			{
+				MutexLocker lockBuffers(&m_lockBuffers);
+				List<sl_uint64> listExited;
+				HashEntry< sl_uint64, Ref<_AsyncFileLogger_Buffer> >* entry = m_buffers.getFirstEntry();
+				while (entry) {
+					_AsyncFileLogger_Buffer* buffer = entry->value.get();
+					// checked before draining, so that the last lines of the exited thread are written
+					sl_bool flagAlive = buffer->thread->flagAlive.load(std::memory_order_acquire);
+					_drainBuffer(buffer);
+					if (!flagAlive) {
+						listExited.add_NoLock(entry->key);
+					}
+					entry = entry->next;
+				}
+				ListElements<sl_uint64> ids(listExited);
+				for (sl_size i = 0; i < ids.count; i++) {
+					m_buffers.remove(ids[i]);
+				}
+			}
+			_writeBatch();
+		}
+
+		// override
+		void close()
+		{
+			{
+				ObjectLocker lock(this);
+				if (!m_flagRunning) {
+					return;
+				}
+				m_flagRunning = sl_false;
+			}
+			m_thread->finishAndWait();
+			flush();
+			MutexLocker lock(&m_lockWriter);
+			m_file.setNull();
+		}
+
+		// override
+		sl_uint64 getDroppedLinesCount()
+		{
+			return m_nDroppedLines;
+		}
+
+	public:
+		void _run()
+		{
+			Ref<Thread> thread = m_thread;
+			while (thread->isNotStopping()) {
+				flush();
+				thread->wait(m_flushInterval);
+			}
+		}
+
+		_AsyncFileLogger_Buffer* _getThreadBuffer()
+		{
+			if (_gt_asyncFileLogger_idLogger == m_id) {
+				return _gt_asyncFileLogger_buffer;
+			}
+			if (_gt_asyncFileLogger_flagThreadExited) {
+				return sl_null;
+			}
+			// buffers are kept until the thread exits, because the threads can log again after switching loggers
+			Ref<_AsyncFileLogger_ThreadState>& state = _gt_asyncFileLogger_threadExit.state;
+			if (state.isNull()) {
+				state = new _AsyncFileLogger_ThreadState;
+				if (state.isNull()) {
+					return sl_null;
+				}
+			}
+			sl_uint64 idThread = Thread::getCurrentThreadUniqueId();
+			MutexLocker lock(&m_lockBuffers);
+			Ref<_AsyncFileLogger_Buffer> buffer;
+			if (!(m_buffers.get(idThread, &buffer))) {
+				buffer = new _AsyncFileLogger_Buffer;
+				if (buffer.isNull()) {
+					return sl_null;
+				}
+				buffer->data = (sl_uint8*)(Base::createMemory(m_bufferSize));
+				if (!(buffer->data)) {
+					return sl_null;
+				}
+				buffer->capacity = m_bufferSize;
+				buffer->thread = state;
+				if (!(m_buffers.put(idThread, buffer))) {
+					return sl_null;
+				}
+			}
+			_gt_asyncFileLogger_idLogger = m_id;
+			_gt_asyncFileLogger_buffer = buffer.get();
+			return buffer.get();
+		}
+
+		sl_bool _reserveBatch(sl_size size)
+		{
+			sl_size sizeRequired = m_sizeBatch + size;
+			if (sizeRequired <= m_capacityBatch) {
+				return sl_true;
+			}
+			sl_size capacity = m_capacityBatch ? m_capacityBatch : 65536;
+			while (capacity < sizeRequired) {
+				capacity <<= 1;
+			}
+			sl_uint8* batch = (sl_uint8*)(Base::reallocMemory(m_batch, capacity));
+			if (!batch) {
+				return sl_false;
+			}
+			m_batch = batch;
+			m_capacityBatch = capacity;
+			return sl_true;
+		}
+
+		void _appendBatch(const void* data, sl_size size)
+		{
+			Base::copyMemory(m_batch + m_sizeBatch, data, size);
+			m_sizeBatch += size;
+		}
+
+		void _drainBuffer(_AsyncFileLogger_Buffer* buffer)
+		{
+			sl_size tail = buffer->tail.load(std::memory_order_relaxed);
+			sl_size head = buffer->head.load(std::memory_order_acquire);
+			if (tail == head) {
+				return;
+			}
+			while (tail != head) {
+				_AsyncFileLogger_Record record;
+				buffer->read(tail, &record, sizeof(record));
+				sl_size lenContent = record.size - sizeof(record) - record.lenTag;
+				// same as the line of FileLogger: "time [tag] content\r\n"
+				Time time(record.time);
+				sl_int64 seconds = time.getSecondsCount();
+				if (seconds != m_secondsTimeString) {
+					m_timeString = time.toString();
+					m_secondsTimeString = seconds;
+				}
+				if (_reserveBatch(m_timeString.getLength() + record.lenTag + lenContent + 6)) {
+					_appendBatch(m_timeString.getData(), m_timeString.getLength());
+					_appendBatch(" [", 2);
+					buffer->read(tail + sizeof(record), m_batch + m_sizeBatch, record.lenTag);
+					m_sizeBatch += record.lenTag;
+					_appendBatch("] ", 2);
+					buffer->read(tail + sizeof(record) + record.lenTag, m_batch + m_sizeBatch, lenContent);
+					m_sizeBatch += lenContent;
+					_appendBatch("\r\n", 2);
+				} else {
+					m_nDroppedLines++;
+				}
+				tail += record.size;
+			}
+			buffer->tail.store(tail, std::memory_order_release);
+		}
+
+		void _writeBatch()
+		{
+			if (!m_sizeBatch) {
+				return;
+			}
+			sl_int64 period = -1;
+			if (m_rotationInterval) {
+				period = Time::now().getSecondsCount() / m_rotationInterval;
+			}
+			if (m_file.isNull()) {
+				_openFile();
+			}
+			if (m_file.isNotNull()) {
+				if (m_sizeFile > 0) {
+					if ((m_maxFileSize && m_sizeFile + m_sizeBatch > m_maxFileSize) || period != m_periodFile) {
+						_rotate();
+					}
+				}
+				if (m_file.isNotNull()) {
+					if (m_sizeFile == 0) {
+						m_periodFile = period;
+					}
+					sl_reg n = m_file->writeFully(m_batch, m_sizeBatch);
+					if (n > 0) {
+						m_sizeFile += n;
+					}
+				}
+			}
+			m_sizeBatch = 0;
+		}
+
+		void _openFile()
+		{
+			m_file = File::openForAppend(m_fileName);
+			if (m_file.isNotNull()) {
+				m_sizeFile = m_file->getSize();
+				if (m_rotationInterval && m_sizeFile > 0) {
+					m_periodFile = File::getModifiedTime(m_fileName).getSecondsCount() / m_rotationInterval;
+				} else {
+					m_periodFile = -1;
+				}
+			}
+		}
+
+		void _rotate()
+		{
+			m_file.setNull();
+			if (m_maxBackupFiles > 0) {
+				File::deleteFile(m_fileName + "." + String::fromUint32(m_maxBackupFiles));
+				for (sl_uint32 i = m_maxBackupFiles - 1; i >= 1; i--) {
+					String path = m_fileName + "." + String::fromUint32(i);
+					if (File::exists(path)) {
+						File::rename(path, m_fileName + "." + String::fromUint32(i + 1));
+					}
+				}
+				File::rename(m_fileName, m_fileName + ".1");
+			} else {
+				File::deleteFile(m_fileName);
+			}
+			_openFile();
+		}
+
+	};
+
+	Ref<AsyncFileLogger> AsyncFileLogger::create(const AsyncFileLoggerParam& param)
+	{
+		return _AsyncFileLogger::create(param);
+	}
+
+	Ref<AsyncFileLogger> AsyncFileLogger::create(const String& fileName)
+	{
+		AsyncFileLoggerParam param;
+		param.fileName = fileName;
+		return create(param);
+	}
+	
 	class ConsoleLogger : public Logger
 	{
 	public:
@@ -208,6 +711,11 @@ namespace slib
 		return new FileLogger(fileName);
 	}
 
+	Ref<Logger> Logger::createAsyncFileLogger(const String& fileName)
+	{
+		return AsyncFileLogger::create(fileName);
+	}
+
 	void Logger::logGlobal(const String& tag, const String& content)
 	{
 		Ref<LoggerSet> log = global();
@@ -10,6 +10,8 @@
 
 #include "../../../inc/slib/core/string.h"
 #include "../../../inc/slib/core/string_buffer.h"
+#include "../../../inc/slib/core/string_search.h"
+#include "../../../inc/slib/core/string_format.h"
 
 #include "../../../inc/slib/core/base.h"
 #include "../../../inc/slib/core/mio.h"
@@ -42,6 +44,16 @@ namespace slib
 		{
 			return Base::resetMemory(dst, value, count);
 		}
+		
+		SLIB_INLINE static sl_reg search(const sl_char8* text, sl_size count, const sl_char8* pattern, sl_size countPattern)
+		{
+			return StringSearcher::search(text, count, pattern, countPattern);
+		}
+		
+		SLIB_INLINE static sl_reg searchReverse(const sl_char8* text, sl_size count, const sl_char8* pattern, sl_size countPattern)
+		{
+			return StringSearcher::searchReverse(text, count, pattern, countPattern);
+		}
 	};
 
 	class _TemplateFunc16
@@ -66,6 +78,16 @@ namespace slib
 		{
 			return Base::resetMemory2((sl_uint16*)dst, value, count);
 		}
+		
+		SLIB_INLINE static sl_reg search(const sl_char16* text, sl_size count, const sl_char16* pattern, sl_size countPattern)
+		{
+			return StringSearcher16::search(text, count, pattern, countPattern);
+		}
+		
+		SLIB_INLINE static sl_reg searchReverse(const sl_char16* text, sl_size count, const sl_char16* pattern, sl_size countPattern)
+		{
+			return StringSearcher16::searchReverse(text, count, pattern, countPattern);
+		}
 	};
 
 
@@ -4508,18 +4530,11 @@ namespace slib
 				return -1;
 			}
 		}
-		while (start <= count - countPat) {
-			const CT* pt = (const CT*)(TT::findMemory(buf + start, bufPat[0], count - start - countPat + 1));
-			if (pt == sl_null) {
-				return -1;
-			}
-			if (TT::compareMemory(pt + 1, bufPat + 1, countPat - 1) == 0) {
-				return (sl_reg)(pt - buf);
-			} else {
-				start = (sl_size)(pt - buf + 1);
-			}
+		sl_reg index = TT::search(buf + start, count - start, bufPat, countPat);
+		if (index < 0) {
+			return -1;
 		}
-		return -1;
+		return (sl_reg)start + index;
 	}
 
 	sl_reg String::indexOf(const String& pattern, sl_reg start) const
@@ -4650,18 +4665,11 @@ namespace slib
 				s = n;
 			}
 		}
-		while (s > 0) {
-			const CT* pt = (const CT*)(TT::findMemoryReverse(buf, bufPat[0], s));
-			if (pt == sl_null) {
-				return -1;
-			}
-			if (TT::compareMemory(pt + 1, bufPat + 1, countPat - 1) == 0) {
-				return (sl_reg)(pt - buf);
-			} else {
-				s = (sl_size)(pt - buf);
-			}
+		if (s == 0) {
+			return -1;
 		}
-		return -1;
+		// the match must start before `s`
+		return TT::searchReverse(buf, s + countPat - 1, bufPat, countPat);
 	}
 
 	sl_reg String::lastIndexOf(const String& pattern, sl_reg start) const
@@ -6528,36 +6536,44 @@ namespace slib
 
 
 
-	template <class IT, class UT, class ST, class CT>
-	SLIB_INLINE ST _String_fromInt(IT _value, sl_uint32 radix, sl_uint32 minWidth, sl_bool flagUpperCase, CT chGroup = sl_false, sl_bool flagSignPositive = sl_false, sl_bool flagLeadingSpacePositive = sl_false, sl_bool flagEncloseNagtive = sl_false)
+	const char _string_conv_decimal_pairs[201] =
+		"00010203040506070809"
+		"10111213141516171819"
+		"20212223242526272829"
+		"30313233343536373839"
+		"40414243444546474849"
+		"50515253545556575859"
+		"60616263646566676869"
+		"70717273747576777879"
+		"80818283848586878889"
+		"90919293949596979899";
+
+	// writes the digits backward from `pos`, and returns the position of the first digit
+	template <class UT, class CT>
+	SLIB_INLINE sl_uint32 _String_writeDigits(CT* buf, sl_uint32 pos, UT value, sl_uint32 radix, sl_uint32 minWidth, sl_bool flagUpperCase, CT chGroup)
 	{
-		if (radix < 2 || radix > 64) {
-			return sl_null;
-		}
-		
-		const char* pattern = flagUpperCase && radix <= 36 ? _string_conv_radix_pattern_upper : _string_conv_radix_pattern_lower;
-		
-		CT buf[MAX_NUMBER_STR_LEN];
-		
-		sl_uint32 pos = MAX_NUMBER_STR_LEN;
-		
 		if (minWidth < 1) {
 			minWidth = 1;
 		}
 		
-		sl_bool flagMinus = sl_false;
-		UT value;
-		if (_value < 0) {
-			value = -_value;
-			flagMinus = sl_true;
-			if (flagEncloseNagtive) {
-				pos--;
-				buf[pos] = ')';
+		if (radix == 10 && !chGroup) {
+			// two digits per division
+			while (value >= 100 && pos >= 2) {
+				sl_uint32 r = (sl_uint32)(value % 100) << 1;
+				value /= 100;
+				pos -= 2;
+				buf[pos] = _string_conv_decimal_pairs[r];
+				buf[pos + 1] = _string_conv_decimal_pairs[r + 1];
+				if (minWidth > 2) {
+					minWidth -= 2;
+				} else {
+					minWidth = 0;
+				}
 			}
-		} else {
-			value = _value;
 		}
 		
+		const char* pattern = flagUpperCase && radix <= 36 ? _string_conv_radix_pattern_upper : _string_conv_radix_pattern_lower;
+		
 		sl_uint32 nDigits = 0;
 		while (value || minWidth > 0) {
 			if (chGroup) {
@@ -6584,6 +6600,29 @@ namespace slib
 				break;
 			}
 		}
+		return pos;
+	}
+
+	// writes at the end of `buf` (MAX_NUMBER_STR_LEN), and returns the start position
+	template <class IT, class UT, class CT>
+	SLIB_INLINE sl_uint32 _String_writeInt(CT* buf, IT _value, sl_uint32 radix, sl_uint32 minWidth, sl_bool flagUpperCase, CT chGroup, sl_bool flagSignPositive, sl_bool flagLeadingSpacePositive, sl_bool flagEncloseNagtive)
+	{
+		sl_uint32 pos = MAX_NUMBER_STR_LEN;
+		
+		sl_bool flagMinus = sl_false;
+		UT value;
+		if (_value < 0) {
+			value = -_value;
+			flagMinus = sl_true;
+			if (flagEncloseNagtive) {
+				pos--;
+				buf[pos] = ')';
+			}
+		} else {
+			value = _value;
+		}
+		
+		pos = _String_writeDigits<UT, CT>(buf, pos, value, radix, minWidth, flagUpperCase, chGroup);
 		
 		if (flagMinus) {
 			if (pos > 0) {
@@ -6610,52 +6649,14 @@ namespace slib
 				}
 			}
 		}
-		return ST(buf + pos, MAX_NUMBER_STR_LEN - pos);
+		return pos;
 	}
 
-	template <class IT, class ST, class CT>
-	SLIB_INLINE ST _String_fromUint(IT value, sl_uint32 radix, sl_uint32 minWidth, sl_bool flagUpperCase, CT chGroup = 0, sl_bool flagSignPositive = sl_false, sl_bool flagLeadingSpacePositive = sl_false)
+	// writes at the end of `buf` (MAX_NUMBER_STR_LEN), and returns the start position
+	template <class IT, class CT>
+	SLIB_INLINE sl_uint32 _String_writeUint(CT* buf, IT value, sl_uint32 radix, sl_uint32 minWidth, sl_bool flagUpperCase, CT chGroup, sl_bool flagSignPositive, sl_bool flagLeadingSpacePositive)
 	{
-		if (radix < 2 || radix > 64) {
-			return sl_null;
-		}
-		
-		const char* pattern = flagUpperCase && radix <= 36 ? _string_conv_radix_pattern_upper : _string_conv_radix_pattern_lower;
-		
-		CT buf[MAX_NUMBER_STR_LEN];
-		
-		sl_uint32 pos = MAX_NUMBER_STR_LEN;
-		
-		if (minWidth < 1) {
-			minWidth = 1;
-		}
-		
-		sl_uint32 nDigits = 0;
-		while (value || minWidth > 0) {
-			if (chGroup) {
-				if (nDigits > 0) {
-					if (pos > 0) {
-						if (nDigits % 3 == 0) {
-							pos--;
-							buf[pos] = chGroup;
-						}
-					} else {
-						break;
-					}
-				}
-			}
-			if (pos > 0) {
-				pos--;
-				buf[pos] = pattern[value % radix];
-				value = value / radix;
-				if (minWidth > 0) {
-					minWidth--;
-				}
-				nDigits++;
-			} else {
-				break;
-			}
-		}
+		sl_uint32 pos = _String_writeDigits<IT, CT>(buf, MAX_NUMBER_STR_LEN, value, radix, minWidth, flagUpperCase, chGroup);
 		
 		if (flagSignPositive) {
 			if (pos > 0) {
@@ -6669,7 +6670,28 @@ namespace slib
 				buf[pos] = ' ';
 			}
 		}
-		
+		return pos;
+	}
+
+	template <class IT, class UT, class ST, class CT>
+	SLIB_INLINE ST _String_fromInt(IT value, sl_uint32 radix, sl_uint32 minWidth, sl_bool flagUpperCase, CT chGroup = sl_false, sl_bool flagSignPositive = sl_false, sl_bool flagLeadingSpacePositive = sl_false, sl_bool flagEncloseNagtive = sl_false)
+	{
+		if (radix < 2 || radix > 64) {
+			return sl_null;
+		}
+		CT buf[MAX_NUMBER_STR_LEN];
+		sl_uint32 pos = _String_writeInt<IT, UT, CT>(buf, value, radix, minWidth, flagUpperCase, chGroup, flagSignPositive, flagLeadingSpacePositive, flagEncloseNagtive);
+		return ST(buf + pos, MAX_NUMBER_STR_LEN - pos);
+	}
+
+	template <class IT, class ST, class CT>
+	SLIB_INLINE ST _String_fromUint(IT value, sl_uint32 radix, sl_uint32 minWidth, sl_bool flagUpperCase, CT chGroup = 0, sl_bool flagSignPositive = sl_false, sl_bool flagLeadingSpacePositive = sl_false)
+	{
+		if (radix < 2 || radix > 64) {
+			return sl_null;
+		}
+		CT buf[MAX_NUMBER_STR_LEN];
+		sl_uint32 pos = _String_writeUint<IT, CT>(buf, value, radix, minWidth, flagUpperCase, chGroup, flagSignPositive, flagLeadingSpacePositive);
 		return ST(buf + pos, MAX_NUMBER_STR_LEN - pos);
 	}
 
@@ -6749,17 +6771,22 @@ namespace slib
 #endif
 	}
 
-	template <class FT, class ST, class CT>
-	SLIB_INLINE ST _String_fromFloat(FT value, sl_int32 precision, sl_bool flagZeroPadding, sl_int32 minWidthIntegral, CT chConv = 'g', CT chGroup = 0, sl_bool flagSignPositive = sl_false, sl_bool flagLeadingSpacePositive = sl_false, sl_bool flagEncloseNagtive = sl_false)
+	// writes into `buf` (MAX_NUMBER_STR_LEN), and returns the length
+	template <class FT, class CT>
+	SLIB_INLINE sl_uint32 _String_writeFloat(CT* buf, FT value, sl_int32 precision, sl_bool flagZeroPadding, sl_int32 minWidthIntegral, CT chConv, CT chGroup, sl_bool flagSignPositive, sl_bool flagLeadingSpacePositive, sl_bool flagEncloseNagtive)
 	{
-		
-		CT buf[MAX_NUMBER_STR_LEN];
-		
 		if (Math::isNaN(value)) {
-			return "NaN";
+			buf[0] = 'N';
+			buf[1] = 'a';
+			buf[2] = 'N';
+			return 3;
 		}
 		if (Math::isInfinite(value)) {
-			return "Infinity";
+			static const char szInfinity[] = "Infinity";
+			for (sl_uint32 i = 0; i < 8; i++) {
+				buf[i] = szInfinity[i];
+			}
+			return 8;
 		}
 
 		if (minWidthIntegral > MAX_PRECISION) {
@@ -6800,7 +6827,7 @@ namespace slib
 					buf[pos++] = '0';
 				}
 			}
-			return ST(buf, pos);
+			return pos;
 		}
 		
 		CT* str = buf;
@@ -6941,7 +6968,15 @@ namespace slib
 			}
 		}
 		
-		return ST(buf, str - buf);
+		return (sl_uint32)(str - buf);
+	}
+
+	template <class FT, class ST, class CT>
+	SLIB_INLINE ST _String_fromFloat(FT value, sl_int32 precision, sl_bool flagZeroPadding, sl_int32 minWidthIntegral, CT chConv = 'g', CT chGroup = 0, sl_bool flagSignPositive = sl_false, sl_bool flagLeadingSpacePositive = sl_false, sl_bool flagEncloseNagtive = sl_false)
+	{
+		CT buf[MAX_NUMBER_STR_LEN];
+		sl_uint32 len = _String_writeFloat<FT, CT>(buf, value, precision, flagZeroPadding, minWidthIntegral, chConv, chGroup, flagSignPositive, flagLeadingSpacePositive, flagEncloseNagtive);
+		return ST(buf, len);
 	}
 
 	String String::fromDouble(double value, sl_int32 precision, sl_bool flagZeroPadding, sl_uint32 minWidthIntegral) {
@@ -7580,6 +7615,413 @@ https://docs.oracle.com/javase/7/docs/api/java/util/Formatter.html
 	}
 
 
+	StringFormat::StringFormat(const sl_char8* format) : m_format(format)
+	{
+		_parse();
+	}
+
+	StringFormat::StringFormat(const String& format) : m_format(format)
+	{
+		_parse();
+	}
+
+	StringFormat::~StringFormat()
+	{
+	}
+
+	const String& StringFormat::getFormat() const
+	{
+		return m_format;
+	}
+
+	sl_uint32 StringFormat::getArgumentsCount() const
+	{
+		return m_nArgs;
+	}
+
+	// follows the parsing of _String_format()
+	void StringFormat::_parse()
+	{
+		m_nArgs = 0;
+		const sl_char8* format = m_format.getData();
+		sl_size len = m_format.getLength();
+		if (len == 0) {
+			return;
+		}
+		sl_size nPercents = 0;
+		sl_size pos;
+		for (pos = 0; pos < len; pos++) {
+			if (format[pos] == '%') {
+				nPercents++;
+			}
+		}
+		// '%n' adds an extra item for the line break
+		Array<_StringFormatItem> items = Array<_StringFormatItem>::create(nPercents * 2 + 1);
+		if (items.isNull()) {
+			return;
+		}
+		_StringFormatItem* pItems = items.getData();
+		sl_size nItems = 0;
+		sl_uint32 nArgs = 0;
+		pos = 0;
+		sl_size posText = 0;
+		sl_uint32 indexArgLast = 0;
+		sl_uint32 indexArgAuto = 0;
+		while (pos <= len) {
+			sl_char8 ch;
+			if (pos < len) {
+				ch = format[pos];
+			} else {
+				ch = 0;
+			}
+			if (ch == '%' || ch == 0) {
+				_StringFormatItem& item = pItems[nItems];
+				nItems++;
+				item.text = format + posText;
+				item.lenText = pos - posText;
+				item.indexArg = (sl_uint32)-1;
+				posText = pos;
+				pos++;
+				if (pos >= len) {
+					break;
+				}
+				do {
+					ch = format[pos];
+					if (ch == '%') {
+						// the next text starts with this '%'
+						posText = pos;
+						pos++;
+						break;
+					} else if (ch == 'n') {
+						_StringFormatItem& itemLineBreak = pItems[nItems];
+						nItems++;
+						itemLineBreak.text = "\r\n";
+						itemLineBreak.lenText = 2;
+						itemLineBreak.indexArg = (sl_uint32)-1;
+						pos++;
+						posText = pos;
+						break;
+					}
+					// Argument Index
+					sl_uint32 indexArg;
+					if (ch == '<') {
+						indexArg = indexArgLast;
+						pos++;
+					} else {
+						sl_uint32 iv;
+						sl_reg iRet = String::parseUint32(10, &iv, format, pos, len);
+						if (iRet == SLIB_PARSE_ERROR) {
+							indexArg = indexArgAuto;
+							indexArgAuto++;
+						} else {
+							if ((sl_uint32)iRet >= len) {
+								break;
+							}
+							if (format[iRet] == '$') {
+								if (iv > 0) {
+									iv--;
+								}
+								indexArg = iv;
+								pos = iRet + 1;
+							} else {
+								indexArg = indexArgAuto;
+								indexArgAuto++;
+							}
+						}
+					}
+					indexArgLast = indexArg;
+					if (pos >= len) {
+						break;
+					}
+					
+					// Flags
+					item.flagAlignLeft = sl_false;
+					item.flagSignPositive = sl_false;
+					item.flagLeadingSpacePositive = sl_false;
+					item.flagZeroPadded = sl_false;
+					item.flagGroupingDigits = sl_false;
+					item.flagEncloseNegative = sl_false;
+					do {
+						ch = format[pos];
+						if (ch == '-') {
+							item.flagAlignLeft = sl_true;
+						} else if (ch == '+') {
+							item.flagSignPositive = sl_true;
+						} else if (ch == ' ') {
+							item.flagLeadingSpacePositive = sl_true;
+						} else if (ch == '0') {
+							item.flagZeroPadded = sl_true;
+						} else if (ch == ',') {
+							item.flagGroupingDigits = sl_true;
+						} else if (ch == '(') {
+							item.flagEncloseNegative = sl_true;
+						} else {
+							break;
+						}
+						pos++;
+					} while (pos < len);
+					if (pos >= len) {
+						break;
+					}
+					
+					// Min-Width
+					item.minWidth = 0;
+					sl_reg iRet = String::parseUint32(10, &(item.minWidth), format, pos, len);
+					if (iRet != SLIB_PARSE_ERROR) {
+						pos = iRet;
+						if (pos >= len) {
+							break;
+						}
+					}
+					
+					// Precision
+					item.precision = 0;
+					item.flagUsePrecision = sl_false;
+					if (format[pos] == '.') {
+						pos++;
+						if (pos >= len) {
+							break;
+						}
+						item.flagUsePrecision = sl_true;
+						iRet = String::parseUint32(10, &(item.precision), format, pos, len);
+						if (iRet != SLIB_PARSE_ERROR) {
+							pos = iRet;
+							if (pos >= len) {
+								break;
+							}
+						}
+					}
+					
+					// Conversion
+					item.conversion = format[pos];
+					pos++;
+					
+					item.indexArg = indexArg;
+					item.spec = format + posText;
+					item.lenSpec = pos - posText;
+					if (indexArg >= nArgs) {
+						nArgs = indexArg + 1;
+					}
+					posText = pos;
+				} while (0);
+			} else {
+				pos++;
+			}
+		}
+		m_items = items.sub(0, nItems);
+		m_nArgs = nArgs;
+	}
+
+
+	_StringFormatOutput::_StringFormatOutput(sl_char8* buf, sl_size size)
+	{
+		m_buf = buf;
+		m_size = size;
+		m_pos = 0;
+		m_length = 0;
+		m_flagFixed = sl_true;
+		m_sb = sl_null;
+		m_flagOwnStringBuffer = sl_false;
+	}
+
+	_StringFormatOutput::_StringFormatOutput(StringBuffer* sb)
+	{
+		m_buf = m_chunk;
+		m_size = sizeof(m_chunk);
+		m_pos = 0;
+		m_length = 0;
+		m_flagFixed = sl_false;
+		m_sb = sb;
+		m_flagOwnStringBuffer = sl_false;
+	}
+
+	_StringFormatOutput::~_StringFormatOutput()
+	{
+		if (m_flagOwnStringBuffer) {
+			delete m_sb;
+		}
+	}
+
+	void _StringFormatOutput::write(const sl_char8* data, sl_size len)
+	{
+		if (len == 0) {
+			return;
+		}
+		m_length += len;
+		if (m_flagFixed) {
+			if (m_pos + 1 < m_size) {
+				sl_size n = m_size - 1 - m_pos;
+				if (n > len) {
+					n = len;
+				}
+				Base::copyMemory(m_buf + m_pos, data, n);
+				m_pos += n;
+			}
+			return;
+		}
+		if (m_pos + len > m_size) {
+			_flush();
+			if (len >= m_size) {
+				if (!m_sb) {
+					m_sb = new StringBuffer;
+					m_flagOwnStringBuffer = sl_true;
+				}
+				m_sb->add(String(data, len));
+				return;
+			}
+		}
+		Base::copyMemory(m_buf + m_pos, data, len);
+		m_pos += len;
+	}
+
+	void _StringFormatOutput::_writeSpaces(sl_size n)
+	{
+		static const sl_char8 spaces[] = "                                ";
+		while (n > 0) {
+			sl_size m = n;
+			if (m > sizeof(spaces) - 1) {
+				m = sizeof(spaces) - 1;
+			}
+			write(spaces, m);
+			n -= m;
+		}
+	}
+
+	void _StringFormatOutput::_writePadded(const _StringFormatItem& item, const sl_char8* content, sl_size len)
+	{
+		if (len < item.minWidth) {
+			if (item.flagAlignLeft) {
+				write(content, len);
+				_writeSpaces(item.minWidth - len);
+			} else {
+				_writeSpaces(item.minWidth - len);
+				write(content, len);
+			}
+		} else {
+			write(content, len);
+		}
+	}
+
+	void _StringFormatOutput::writeArgument(const _StringFormatItem& item, sl_int64 value)
+	{
+		sl_char8 ch = item.conversion;
+		sl_uint32 radix;
+		if (ch == 'd') {
+			radix = 10;
+		} else if (ch == 'x' || ch == 'X') {
+			radix = 16;
+		} else if (ch == 'o') {
+			radix = 8;
+		} else {
+			writeArgument(item, Variant(value));
+			return;
+		}
+		sl_char8 buf[MAX_NUMBER_STR_LEN];
+		sl_uint32 pos = _String_writeInt<sl_int64, sl_uint64, sl_char8>(buf, value, radix, item.flagZeroPadded ? item.minWidth : 0, ch == 'X', item.flagGroupingDigits ? ',' : 0, item.flagSignPositive, item.flagLeadingSpacePositive, item.flagEncloseNegative);
+		_writePadded(item, buf + pos, MAX_NUMBER_STR_LEN - pos);
+	}
+
+	void _StringFormatOutput::writeArgument(const _StringFormatItem& item, sl_uint64 value)
+	{
+		sl_char8 ch = item.conversion;
+		sl_uint32 radix;
+		if (ch == 'd') {
+			radix = 10;
+		} else if (ch == 'x' || ch == 'X') {
+			radix = 16;
+		} else if (ch == 'o') {
+			radix = 8;
+		} else {
+			writeArgument(item, Variant(value));
+			return;
+		}
+		sl_char8 buf[MAX_NUMBER_STR_LEN];
+		sl_uint32 pos = _String_writeUint<sl_uint64, sl_char8>(buf, value, radix, item.flagZeroPadded ? item.minWidth : 0, ch == 'X', item.flagGroupingDigits ? ',' : 0, item.flagSignPositive, item.flagLeadingSpacePositive);
+		_writePadded(item, buf + pos, MAX_NUMBER_STR_LEN - pos);
+	}
+
+	void _StringFormatOutput::writeArgument(const _StringFormatItem& item, float value)
+	{
+		sl_char8 ch = item.conversion;
+		if (ch == 'f' || ch == 'e' || ch == 'E' || ch == 'g' || ch == 'G') {
+			sl_char8 buf[MAX_NUMBER_STR_LEN];
+			sl_uint32 len = _String_writeFloat<float, sl_char8>(buf, value, item.flagUsePrecision ? (sl_int32)(item.precision) : -1, item.flagZeroPadded, 1, ch, item.flagGroupingDigits ? ',' : 0, item.flagSignPositive, item.flagLeadingSpacePositive, item.flagEncloseNegative);
+			_writePadded(item, buf, len);
+		} else {
+			writeArgument(item, Variant(value));
+		}
+	}
+
+	void _StringFormatOutput::writeArgument(const _StringFormatItem& item, double value)
+	{
+		sl_char8 ch = item.conversion;
+		if (ch == 'f' || ch == 'e' || ch == 'E' || ch == 'g' || ch == 'G') {
+			sl_char8 buf[MAX_NUMBER_STR_LEN];
+			sl_uint32 len = _String_writeFloat<double, sl_char8>(buf, value, item.flagUsePrecision ? (sl_int32)(item.precision) : -1, item.flagZeroPadded, 1, ch, item.flagGroupingDigits ? ',' : 0, item.flagSignPositive, item.flagLeadingSpacePositive, item.flagEncloseNegative);
+			_writePadded(item, buf, len);
+		} else {
+			writeArgument(item, Variant(value));
+		}
+	}
+
+	void _StringFormatOutput::writeArgument(const _StringFormatItem& item, const sl_char8* sz)
+	{
+		if (item.conversion == 's' && sz) {
+			_writePadded(item, sz, Base::getStringLength(sz));
+		} else {
+			writeArgument(item, Variant(sz));
+		}
+	}
+
+	void _StringFormatOutput::writeArgument(const _StringFormatItem& item, const String& str)
+	{
+		if (item.conversion == 's' && str.isNotEmpty()) {
+			_writePadded(item, str.getData(), str.getLength());
+		} else {
+			writeArgument(item, Variant(str));
+		}
+	}
+
+	void _StringFormatOutput::writeArgument(const _StringFormatItem& item, const Variant& var)
+	{
+		String content = _String_format<String, sl_char8, StringBuffer>(item.spec, item.lenSpec, &var, 1);
+		write(content.getData(), content.getLength());
+	}
+
+	void _StringFormatOutput::_flush()
+	{
+		if (m_pos) {
+			if (!m_sb) {
+				m_sb = new StringBuffer;
+				m_flagOwnStringBuffer = sl_true;
+			}
+			m_sb->add(String(m_buf, m_pos));
+			m_pos = 0;
+		}
+	}
+
+	sl_size _StringFormatOutput::finish()
+	{
+		if (m_flagFixed) {
+			if (m_size) {
+				m_buf[m_pos] = 0;
+			}
+		} else {
+			_flush();
+		}
+		return m_length;
+	}
+
+	String _StringFormatOutput::finishString()
+	{
+		if (m_sb) {
+			_flush();
+			return m_sb->merge();
+		}
+		return String(m_buf, m_pos);
+	}
+
+
 	int Compare<String>::operator()(const String& a, const String& b) const
 	{
 		return a.compare(b);
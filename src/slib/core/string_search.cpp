@@ -0,0 +1,582 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "../../../inc/slib/core/string_search.h"
+
+#include "../../../inc/slib/core/base.h"
+#include "../../../inc/slib/core/cpu.h"
+
+#if defined(SLIB_CPU_USE_SSE2)
+#	include <emmintrin.h>
+#endif
+#if defined(SLIB_CPU_USE_X86_EXTENSIONS)
+#	include <immintrin.h>
+#endif
+#if defined(SLIB_COMPILER_IS_VC)
+#	include <intrin.h>
+#endif
+
+// patterns up to this length are searched by first/last character filtering
+#define SHORT_PATTERN_LENGTH_MAX 32
+
+namespace slib
+{
+
+#if defined(SLIB_CPU_USE_X86_EXTENSIONS)
+	static sl_bool _g_string_search_flagAVX2 = Cpu::isAVX2Supported();
+#endif
+
+	SLIB_INLINE static sl_uint32 _StringSearch_scanBit(sl_uint32 mask)
+	{
+#if defined(SLIB_COMPILER_IS_VC)
+		unsigned long index;
+		_BitScanForward(&index, mask);
+		return (sl_uint32)index;
+#else
+		return (sl_uint32)(__builtin_ctz(mask));
+#endif
+	}
+
+	template <class CT>
+	class _StringSearch_Reverse
+	{
+	public:
+		const CT* end;
+
+	public:
+		SLIB_INLINE _StringSearch_Reverse(const CT* _end): end(_end) {}
+
+		SLIB_INLINE CT operator[](sl_size index) const
+		{
+			return *(end - 1 - index);
+		}
+	};
+
+	template <class CT>
+	class _StringSearch
+	{
+	public:
+		SLIB_INLINE static sl_bool equals(const CT* m1, const CT* m2, sl_size count)
+		{
+			return Base::equalsMemory(m1, m2, count * sizeof(CT));
+		}
+
+		SLIB_INLINE static const CT* findChar(const CT* m, CT c, sl_size count);
+
+		SLIB_INLINE static const CT* findCharReverse(const CT* m, CT c, sl_size count);
+
+		SLIB_INLINE static sl_uint8 getTableIndex(CT c)
+		{
+			return (sl_uint8)c;
+		}
+
+		// finds the first position where both the first and the last characters match, then verifies the middle
+		static sl_reg searchShort(const CT* text, sl_size n, const CT* pat, sl_size m)
+		{
+			sl_size i = 0;
+#if defined(SLIB_CPU_USE_X86_EXTENSIONS)
+			if (_g_string_search_flagAVX2) {
+				if (searchShort_AVX2(text, n, pat, m, i)) {
+					return (sl_reg)i;
+				}
+			} else {
+				if (searchShort_SSE2(text, n, pat, m, i)) {
+					return (sl_reg)i;
+				}
+			}
+#elif defined(SLIB_CPU_USE_SSE2)
+			if (searchShort_SSE2(text, n, pat, m, i)) {
+				return (sl_reg)i;
+			}
+#endif
+			CT first = pat[0];
+			CT last = pat[m - 1];
+			while (i <= n - m) {
+				const CT* pt = findChar(text + i, first, n - m - i + 1);
+				if (!pt) {
+					return -1;
+				}
+				i = (sl_size)(pt - text);
+				if (text[i + m - 1] == last && equals(pt + 1, pat + 1, m - 2)) {
+					return (sl_reg)i;
+				}
+				i++;
+			}
+			return -1;
+		}
+
+		static sl_reg searchShortReverse(const CT* text, sl_size n, const CT* pat, sl_size m)
+		{
+			sl_size s = n - m + 1;
+			CT last = pat[m - 1];
+			while (s > 0) {
+				const CT* pt = findCharReverse(text, pat[0], s);
+				if (!pt) {
+					return -1;
+				}
+				s = (sl_size)(pt - text);
+				if (pt[m - 1] == last && equals(pt + 1, pat + 1, m - 2)) {
+					return (sl_reg)s;
+				}
+			}
+			return -1;
+		}
+
+#if defined(SLIB_CPU_USE_SSE2)
+		SLIB_INLINE static __m128i set_SSE2(CT c);
+
+		SLIB_INLINE static __m128i equals_SSE2(__m128i a, __m128i b);
+
+		// returns sl_true with the matched index in `pos`, or sl_false with the first position left for the scalar loop
+		static sl_bool searchShort_SSE2(const CT* text, sl_size n, const CT* pat, sl_size m, sl_size& pos)
+		{
+			const sl_size N = 16 / sizeof(CT);
+			__m128i first = set_SSE2(pat[0]);
+			__m128i last = set_SSE2(pat[m - 1]);
+			sl_size i = 0;
+			for (; i + N + m - 1 <= n; i += N) {
+				__m128i a = _mm_loadu_si128((const __m128i*)(text + i));
+				__m128i b = _mm_loadu_si128((const __m128i*)(text + i + m - 1));
+				sl_uint32 mask = (sl_uint32)(_mm_movemask_epi8(_mm_and_si128(equals_SSE2(a, first), equals_SSE2(b, last))));
+				while (mask) {
+					sl_uint32 bit = _StringSearch_scanBit(mask);
+					sl_size k = i + bit / sizeof(CT);
+					if (equals(text + k + 1, pat + 1, m - 2)) {
+						pos = k;
+						return sl_true;
+					}
+					mask &= ~((sl_uint32)((1 << sizeof(CT)) - 1) << bit);
+				}
+			}
+			pos = i;
+			return sl_false;
+		}
+#endif
+
+#if defined(SLIB_CPU_USE_X86_EXTENSIONS)
+		SLIB_CPU_TARGET("avx2") SLIB_INLINE static __m256i set_AVX2(CT c);
+
+		SLIB_CPU_TARGET("avx2") SLIB_INLINE static __m256i equals_AVX2(__m256i a, __m256i b);
+
+		SLIB_CPU_TARGET("avx2") static sl_bool searchShort_AVX2(const CT* text, sl_size n, const CT* pat, sl_size m, sl_size& pos)
+		{
+			const sl_size N = 32 / sizeof(CT);
+			__m256i first = set_AVX2(pat[0]);
+			__m256i last = set_AVX2(pat[m - 1]);
+			sl_size i = 0;
+			for (; i + N + m - 1 <= n; i += N) {
+				__m256i a = _mm256_loadu_si256((const __m256i*)(text + i));
+				__m256i b = _mm256_loadu_si256((const __m256i*)(text + i + m - 1));
+				sl_uint32 mask = (sl_uint32)(_mm256_movemask_epi8(_mm256_and_si256(equals_AVX2(a, first), equals_AVX2(b, last))));
+				while (mask) {
+					sl_uint32 bit = _StringSearch_scanBit(mask);
+					sl_size k = i + bit / sizeof(CT);
+					if (equals(text + k + 1, pat + 1, m - 2)) {
+						pos = k;
+						return sl_true;
+					}
+					mask &= ~((sl_uint32)((1 << sizeof(CT)) - 1) << bit);
+				}
+			}
+			sl_bool flagFound = searchShort_SSE2(text + i, n - i, pat, m, pos);
+			pos += i;
+			return flagFound;
+		}
+#endif
+
+		/*
+			Two-Way string matching (Crochemore & Perrin)
+
+			`P` and `T` are pointers or reversed views, so that the same code serves `lastIndexOf`.
+		*/
+		template <class P>
+		static void prepareTwoWay(const P& pat, sl_size l, _StringSearchTable& table)
+		{
+			sl_size i, ip, jp, k, p, ms, p0;
+
+			Base::zeroMemory(table.charset, sizeof(table.charset));
+			for (i = 0; i < l; i++) {
+				sl_uint8 c = getTableIndex(pat[i]);
+				table.charset[c >> 3] |= (sl_uint8)(1 << (c & 7));
+				table.shift[c] = i + 1;
+			}
+
+			// maximal suffix for the natural order
+			ip = (sl_size)-1; jp = 0; k = p = 1;
+			while (jp + k < l) {
+				if (pat[ip + k] == pat[jp + k]) {
+					if (k == p) {
+						jp += p;
+						k = 1;
+					} else {
+						k++;
+					}
+				} else if (pat[ip + k] > pat[jp + k]) {
+					jp += k;
+					k = 1;
+					p = jp - ip;
+				} else {
+					ip = jp++;
+					k = p = 1;
+				}
+			}
+			ms = ip;
+			p0 = p;
+
+			// maximal suffix for the reversed order
+			ip = (sl_size)-1; jp = 0; k = p = 1;
+			while (jp + k < l) {
+				if (pat[ip + k] == pat[jp + k]) {
+					if (k == p) {
+						jp += p;
+						k = 1;
+					} else {
+						k++;
+					}
+				} else if (pat[ip + k] < pat[jp + k]) {
+					jp += k;
+					k = 1;
+					p = jp - ip;
+				} else {
+					ip = jp++;
+					k = p = 1;
+				}
+			}
+			if (ip + 1 > ms + 1) {
+				ms = ip;
+			} else {
+				p = p0;
+			}
+
+			// periodic pattern?
+			sl_bool flagPeriodic = sl_true;
+			for (i = 0; i < ms + 1; i++) {
+				if (pat[i] != pat[i + p]) {
+					flagPeriodic = sl_false;
+					break;
+				}
+			}
+			if (flagPeriodic) {
+				table.memoryPeriodic = l - p;
+			} else {
+				table.memoryPeriodic = 0;
+				sl_size a = ms;
+				sl_size b = l - ms - 1;
+				p = (a > b ? a : b) + 1;
+			}
+			table.criticalPosition = ms;
+			table.period = p;
+		}
+
+		template <class T, class P>
+		static sl_reg searchTwoWay(const T& text, sl_size n, const P& pat, sl_size l, const _StringSearchTable& table)
+		{
+			sl_size ms = table.criticalPosition;
+			sl_size p = table.period;
+			sl_size mem0 = table.memoryPeriodic;
+			sl_size mem = 0;
+			sl_size h = 0;
+			sl_size k;
+			for (;;) {
+				if (n - h < l) {
+					return -1;
+				}
+				// check the last character first, and advance by the shift table on mismatch
+				sl_uint8 c = getTableIndex(text[h + l - 1]);
+				if (table.charset[c >> 3] & (1 << (c & 7))) {
+					k = l - table.shift[c];
+					if (k) {
+						if (k < mem) {
+							k = mem;
+						}
+						h += k;
+						mem = 0;
+						continue;
+					}
+				} else {
+					h += l;
+					mem = 0;
+					continue;
+				}
+				// right half
+				k = ms + 1;
+				if (k < mem) {
+					k = mem;
+				}
+				for (; k < l && pat[k] == text[h + k]; k++);
+				if (k < l) {
+					h += k - ms;
+					mem = 0;
+					continue;
+				}
+				// left half
+				for (k = ms + 1; k > mem && pat[k - 1] == text[h + k - 1]; k--);
+				if (k <= mem) {
+					return (sl_reg)h;
+				}
+				h += p;
+				mem = mem0;
+			}
+		}
+
+		static sl_reg search(const CT* text, sl_size n, const CT* pat, sl_size m)
+		{
+			if (m == 0) {
+				return 0;
+			}
+			if (n < m) {
+				return -1;
+			}
+			if (m == 1) {
+				const CT* pt = findChar(text, pat[0], n);
+				return pt ? (sl_reg)(pt - text) : -1;
+			}
+			if (m <= SHORT_PATTERN_LENGTH_MAX) {
+				return searchShort(text, n, pat, m);
+			}
+			_StringSearchTable table;
+			prepareTwoWay(pat, m, table);
+			return searchTwoWay(text, n, pat, m, table);
+		}
+
+		static sl_reg searchReverse(const CT* text, sl_size n, const CT* pat, sl_size m)
+		{
+			if (m == 0) {
+				return n;
+			}
+			if (n < m) {
+				return -1;
+			}
+			if (m == 1) {
+				const CT* pt = findCharReverse(text, pat[0], n);
+				return pt ? (sl_reg)(pt - text) : -1;
+			}
+			if (m <= SHORT_PATTERN_LENGTH_MAX) {
+				return searchShortReverse(text, n, pat, m);
+			}
+			_StringSearch_Reverse<CT> textReverse(text + n);
+			_StringSearch_Reverse<CT> patReverse(pat + m);
+			_StringSearchTable table;
+			prepareTwoWay(patReverse, m, table);
+			sl_reg index = searchTwoWay(textReverse, n, patReverse, m, table);
+			if (index < 0) {
+				return -1;
+			}
+			return (sl_reg)(n - m) - index;
+		}
+
+		static sl_reg searchPrepared(const CT* text, sl_size n, const CT* pat, sl_size m, const _StringSearchTable& table)
+		{
+			if (m <= SHORT_PATTERN_LENGTH_MAX) {
+				return search(text, n, pat, m);
+			}
+			if (n < m) {
+				return -1;
+			}
+			return searchTwoWay(text, n, pat, m, table);
+		}
+
+		static sl_reg indexOf(const CT* text, sl_size n, sl_reg _start, const CT* pat, sl_size m, const _StringSearchTable& table)
+		{
+			sl_size start = _start < 0 ? 0 : (sl_size)_start;
+			if (start > n) {
+				return -1;
+			}
+			sl_reg index = searchPrepared(text + start, n - start, pat, m, table);
+			if (index < 0) {
+				return -1;
+			}
+			return index + (sl_reg)start;
+		}
+
+	};
+
+	template <>
+	SLIB_INLINE const sl_char8* _StringSearch<sl_char8>::findChar(const sl_char8* m, sl_char8 c, sl_size count)
+	{
+		return (const sl_char8*)(Base::findMemory(m, (sl_uint8)c, count));
+	}
+
+	template <>
+	SLIB_INLINE const sl_char8* _StringSearch<sl_char8>::findCharReverse(const sl_char8* m, sl_char8 c, sl_size count)
+	{
+		return (const sl_char8*)(Base::findMemoryReverse(m, (sl_uint8)c, count));
+	}
+
+	template <>
+	SLIB_INLINE const sl_char16* _StringSearch<sl_char16>::findChar(const sl_char16* m, sl_char16 c, sl_size count)
+	{
+		return (const sl_char16*)(Base::findMemory2((const sl_uint16*)m, (sl_uint16)c, count));
+	}
+
+	template <>
+	SLIB_INLINE const sl_char16* _StringSearch<sl_char16>::findCharReverse(const sl_char16* m, sl_char16 c, sl_size count)
+	{
+		return (const sl_char16*)(Base::findMemoryReverse2((const sl_uint16*)m, (sl_uint16)c, count));
+	}
+
+#if defined(SLIB_CPU_USE_SSE2)
+	template <>
+	SLIB_INLINE __m128i _StringSearch<sl_char8>::set_SSE2(sl_char8 c)
+	{
+		return _mm_set1_epi8(c);
+	}
+
+	template <>
+	SLIB_INLINE __m128i _StringSearch<sl_char8>::equals_SSE2(__m128i a, __m128i b)
+	{
+		return _mm_cmpeq_epi8(a, b);
+	}
+
+	template <>
+	SLIB_INLINE __m128i _StringSearch<sl_char16>::set_SSE2(sl_char16 c)
+	{
+		return _mm_set1_epi16((short)c);
+	}
+
+	template <>
+	SLIB_INLINE __m128i _StringSearch<sl_char16>::equals_SSE2(__m128i a, __m128i b)
+	{
+		return _mm_cmpeq_epi16(a, b);
+	}
+#endif
+
+#if defined(SLIB_CPU_USE_X86_EXTENSIONS)
+	template <>
+	SLIB_CPU_TARGET("avx2") SLIB_INLINE __m256i _StringSearch<sl_char8>::set_AVX2(sl_char8 c)
+	{
+		return _mm256_set1_epi8(c);
+	}
+
+	template <>
+	SLIB_CPU_TARGET("avx2") SLIB_INLINE __m256i _StringSearch<sl_char8>::equals_AVX2(__m256i a, __m256i b)
+	{
+		return _mm256_cmpeq_epi8(a, b);
+	}
+
+	template <>
+	SLIB_CPU_TARGET("avx2") SLIB_INLINE __m256i _StringSearch<sl_char16>::set_AVX2(sl_char16 c)
+	{
+		return _mm256_set1_epi16((short)c);
+	}
+
+	template <>
+	SLIB_CPU_TARGET("avx2") SLIB_INLINE __m256i _StringSearch<sl_char16>::equals_AVX2(__m256i a, __m256i b)
+	{
+		return _mm256_cmpeq_epi16(a, b);
+	}
+#endif
+
+
+	StringSearcher::StringSearcher()
+	{
+	}
+
+	StringSearcher::StringSearcher(const String& pattern)
+	{
+		setPattern(pattern);
+	}
+
+	StringSearcher::~StringSearcher()
+	{
+	}
+
+	const String& StringSearcher::getPattern() const
+	{
+		return m_pattern;
+	}
+
+	void StringSearcher::setPattern(const String& pattern)
+	{
+		m_pattern = pattern;
+		sl_size len = pattern.getLength();
+		if (len > SHORT_PATTERN_LENGTH_MAX) {
+			_StringSearch<sl_char8>::prepareTwoWay(pattern.getData(), len, m_table);
+		}
+	}
+
+	sl_reg StringSearcher::indexOf(const sl_char8* text, sl_size len, sl_reg start) const
+	{
+		return _StringSearch<sl_char8>::indexOf(text, len, start, m_pattern.getData(), m_pattern.getLength(), m_table);
+	}
+
+	sl_reg StringSearcher::indexOf(const String& text, sl_reg start) const
+	{
+		return _StringSearch<sl_char8>::indexOf(text.getData(), text.getLength(), start, m_pattern.getData(), m_pattern.getLength(), m_table);
+	}
+
+	const void* StringSearcher::findMemory(const void* mem, sl_size size) const
+	{
+		sl_reg index = _StringSearch<sl_char8>::searchPrepared((const sl_char8*)mem, size, m_pattern.getData(), m_pattern.getLength(), m_table);
+		if (index < 0) {
+			return sl_null;
+		}
+		return (const sl_uint8*)mem + index;
+	}
+
+	sl_reg StringSearcher::search(const sl_char8* text, sl_size len, const sl_char8* pattern, sl_size lenPattern)
+	{
+		return _StringSearch<sl_char8>::search(text, len, pattern, lenPattern);
+	}
+
+	sl_reg StringSearcher::searchReverse(const sl_char8* text, sl_size len, const sl_char8* pattern, sl_size lenPattern)
+	{
+		return _StringSearch<sl_char8>::searchReverse(text, len, pattern, lenPattern);
+	}
+
+
+	StringSearcher16::StringSearcher16()
+	{
+	}
+
+	StringSearcher16::StringSearcher16(const String16& pattern)
+	{
+		setPattern(pattern);
+	}
+
+	StringSearcher16::~StringSearcher16()
+	{
+	}
+
+	const String16& StringSearcher16::getPattern() const
+	{
+		return m_pattern;
+	}
+
+	void StringSearcher16::setPattern(const String16& pattern)
+	{
+		m_pattern = pattern;
+		sl_size len = pattern.getLength();
+		if (len > SHORT_PATTERN_LENGTH_MAX) {
+			_StringSearch<sl_char16>::prepareTwoWay(pattern.getData(), len, m_table);
+		}
+	}
+
+	sl_reg StringSearcher16::indexOf(const sl_char16* text, sl_size len, sl_reg start) const
+	{
+		return _StringSearch<sl_char16>::indexOf(text, len, start, m_pattern.getData(), m_pattern.getLength(), m_table);
+	}
+
+	sl_reg StringSearcher16::indexOf(const String16& text, sl_reg start) const
+	{
+		return _StringSearch<sl_char16>::indexOf(text.getData(), text.getLength(), start, m_pattern.getData(), m_pattern.getLength(), m_table);
+	}
+
+	sl_reg StringSearcher16::search(const sl_char16* text, sl_size len, const sl_char16* pattern, sl_size lenPattern)
+	{
+		return _StringSearch<sl_char16>::search(text, len, pattern, lenPattern);
+	}
+
+	sl_reg StringSearcher16::searchReverse(const sl_char16* text, sl_size len, const sl_char16* pattern, sl_size lenPattern)
+	{
+		return _StringSearch<sl_char16>::searchReverse(text, len, pattern, lenPattern);
+	}
+
+}
@@ -10,6 +10,10 @@
 
 #include "../../../inc/slib/core/thread_pool.h"
 
+#include "../../../inc/slib/core/cpu.h"
+#include "../../../inc/slib/core/event.h"
+#include "../../../inc/slib/core/safe_static.h"
+
 namespace slib
 {
 
@@ -36,6 +40,87 @@ namespace slib
 		return ret;
 	}
 
+	SLIB_SAFE_STATIC_GETTER(Ref<ThreadPool>, _ThreadPool_getComputePool, ThreadPool::create(0, Cpu::getCoresCount()))
+
+	Ref<ThreadPool> ThreadPool::getComputePool()
+	{
+		Ref<ThreadPool>* pPool = _ThreadPool_getComputePool();
+		if (pPool) {
+			return *pPool;
+		}
+		return sl_null;
+	}
+
+	class _ThreadPool_ParallelJob : public Referable
+	{
+	public:
+		Function<void(sl_size)> task;
+		sl_size count;
+		sl_reg indexNext;
+		sl_reg nRemaining;
+		Ref<Event> eventDone;
+
+	public:
+		void run()
+		{
+			for (;;) {
+				sl_reg index = Base::interlockedIncrement(&indexNext) - 1;
+				if (index >= (sl_reg)count) {
+					return;
+				}
+				task(index);
+				if (Base::interlockedDecrement(&nRemaining) == 0) {
+					eventDone->set();
+				}
+			}
+		}
+
+	};
+
+	void ThreadPool::parallelFor(sl_size count, const Function<void(sl_size)>& task, sl_uint32 maxThreads)
+	{
+		if (!count || task.isNull()) {
+			return;
+		}
+		sl_uint32 nThreads = Cpu::getCoresCount();
+		if (maxThreads && maxThreads < nThreads) {
+			nThreads = maxThreads;
+		}
+		Ref<ThreadPool> pool;
+		if (nThreads > 1 && count > 1) {
+			pool = getComputePool();
+		}
+		Ref<_ThreadPool_ParallelJob> job;
+		Ref<Event> eventDone;
+		if (pool.isNotNull()) {
+			job = new _ThreadPool_ParallelJob;
+			eventDone = Event::create(sl_false);
+		}
+		if (job.isNull() || eventDone.isNull()) {
+			for (sl_size i = 0; i < count; i++) {
+				task(i);
+			}
+			return;
+		}
+		job->task = task;
+		job->count = count;
+		job->indexNext = 0;
+		job->nRemaining = (sl_reg)count;
+		job->eventDone = eventDone;
+		sl_size nWorkers = nThreads - 1;
+		if (nWorkers > count - 1) {
+			nWorkers = count - 1;
+		}
+		for (sl_size i = 0; i < nWorkers; i++) {
+			// the job is kept alive by the task until the worker picks it up, even after this call returns
+			pool->addTask([job]() {
+				job->run();
+			});
+		}
+		job->run();
+		eventDone->wait();
+	}
+
 	void ThreadPool::release()
 	{
 		ObjectLocker lock(this);
@@ -115,6 +200,10 @@ namespace slib
 				task();
 			} else {
 				ObjectLocker lock(this);
+				// a task may have been added after the failed pop, without starting a new worker
+				if (m_tasks.isNotEmpty()) {
+					continue;
+				}
 				sl_size nThreads = m_threadWorkers.getCount();
 				if (nThreads > getMinimumThreadsCount()) {
 					m_threadWorkers.removeValue_NoLock(Thread::getCurrent());
@@ -12,6 +12,17 @@
 
 #include "../../../inc/slib/crypto/sha2.h"
 #include "../../../inc/slib/core/mio.h"
+#include "../../../inc/slib/core/cpu.h"
+
+#if defined(SLIB_CPU_USE_X86_EXTENSIONS)
+#	include <wmmintrin.h>
+#	define AES_SUPPORT_HW
+#	define AES_SUPPORT_AESNI
+#elif defined(SLIB_CPU_USE_ARMV8_CRYPTO)
+#	include <arm_neon.h>
+#	define AES_SUPPORT_HW
+#	define AES_SUPPORT_ARMV8
+#endif
 
 /*
 	AES - Advanced Encryption Standard
@@ -22,6 +33,12 @@
 namespace slib
 {
 
+#if defined(AES_SUPPORT_AESNI)
+	static sl_bool _g_aes_flagHW = Cpu::isAESNISupported();
+#elif defined(AES_SUPPORT_ARMV8)
+	static sl_bool _g_aes_flagHW = Cpu::isARMv8AESSupported();
+#endif
+
 	AES::AES()
 	{
 	}
@@ -353,9 +370,185 @@ static const sl_uint32 _AES_RT3[256] = { RT };
 			W += 4;
 		}
 		Base::copyMemory(W, WE, 32);
+
+		sl_uint32 nWords = (nRounds + 1) << 2;
+		for (i = 0; i < nWords; i++) {
+			MIO::writeUint32BE(m_roundKeyEncHW + (i << 2), m_roundKeyEnc[i]);
+			MIO::writeUint32BE(m_roundKeyDecHW + (i << 2), m_roundKeyDec[i]);
+		}
 		return sl_true;
 	}
 
+/*
+	Hardware Implementations
+
+	The byte-order round keys are used as they are by AES-NI and ARMv8 instructions.
+	The decryption keys of the equivalent inverse cipher (InvMixColumns applied to the middle round keys) match
+	the ones expected by AESDEC (x86) and AESD + AESIMC (ARMv8).
+	Independent blocks are interleaved to hide the latency of the round instructions.
+*/
+
+#if defined(AES_SUPPORT_AESNI)
+
+#define _AESNI_LOAD(K, I) K[I] = _mm_loadu_si128((__m128i const*)(keys + ((I) << 4)))
+
+#define _AESNI_X8(OP, K) \
+	b0 = OP(b0, K); b1 = OP(b1, K); b2 = OP(b2, K); b3 = OP(b3, K); \
+	b4 = OP(b4, K); b5 = OP(b5, K); b6 = OP(b6, K); b7 = OP(b7, K);
+
+#define _AESNI_PROCESS_BLOCKS(OP, OP_LAST) \
+	__m128i K[15]; \
+	for (sl_uint32 i = 0; i <= nRounds; i++) { \
+		_AESNI_LOAD(K, i); \
+	} \
+	const __m128i* s = (const __m128i*)src; \
+	__m128i* d = (__m128i*)dst; \
+	while (nBlocks >= 8) { \
+		__m128i b0 = _mm_loadu_si128(s); \
+		__m128i b1 = _mm_loadu_si128(s + 1); \
+		__m128i b2 = _mm_loadu_si128(s + 2); \
+		__m128i b3 = _mm_loadu_si128(s + 3); \
+		__m128i b4 = _mm_loadu_si128(s + 4); \
+		__m128i b5 = _mm_loadu_si128(s + 5); \
+		__m128i b6 = _mm_loadu_si128(s + 6); \
+		__m128i b7 = _mm_loadu_si128(s + 7); \
+		_AESNI_X8(_mm_xor_si128, K[0]) \
+		for (sl_uint32 r = 1; r < nRounds; r++) { \
+			__m128i k = K[r]; \
+			_AESNI_X8(OP, k) \
+		} \
+		_AESNI_X8(OP_LAST, K[nRounds]) \
+		_mm_storeu_si128(d, b0); \
+		_mm_storeu_si128(d + 1, b1); \
+		_mm_storeu_si128(d + 2, b2); \
+		_mm_storeu_si128(d + 3, b3); \
+		_mm_storeu_si128(d + 4, b4); \
+		_mm_storeu_si128(d + 5, b5); \
+		_mm_storeu_si128(d + 6, b6); \
+		_mm_storeu_si128(d + 7, b7); \
+		s += 8; \
+		d += 8; \
+		nBlocks -= 8; \
+	} \
+	while (nBlocks) { \
+		__m128i b = _mm_xor_si128(_mm_loadu_si128(s), K[0]); \
+		for (sl_uint32 r = 1; r < nRounds; r++) { \
+			b = OP(b, K[r]); \
+		} \
+		_mm_storeu_si128(d, OP_LAST(b, K[nRounds])); \
+		s++; \
+		d++; \
+		nBlocks--; \
+	}
+
+	SLIB_CPU_TARGET("aes,sse2") static void _AES_encryptBlocks_HW(const sl_uint8* keys, sl_uint32 nRounds, const sl_uint8* src, sl_uint8* dst, sl_size nBlocks)
+	{
+		_AESNI_PROCESS_BLOCKS(_mm_aesenc_si128, _mm_aesenclast_si128)
+	}
+
+	SLIB_CPU_TARGET("aes,sse2") static void _AES_decryptBlocks_HW(const sl_uint8* keys, sl_uint32 nRounds, const sl_uint8* src, sl_uint8* dst, sl_size nBlocks)
+	{
+		_AESNI_PROCESS_BLOCKS(_mm_aesdec_si128, _mm_aesdeclast_si128)
+	}
+
+	SLIB_CPU_TARGET("aes,sse2") static void _AES_encryptBlock_HW(const sl_uint8* keys, sl_uint32 nRounds, const void* src, void* dst)
+	{
+		const __m128i* K = (const __m128i*)keys;
+		__m128i b = _mm_xor_si128(_mm_loadu_si128((__m128i const*)src), _mm_loadu_si128(K));
+		for (sl_uint32 r = 1; r < nRounds; r++) {
+			b = _mm_aesenc_si128(b, _mm_loadu_si128(K + r));
+		}
+		_mm_storeu_si128((__m128i*)dst, _mm_aesenclast_si128(b, _mm_loadu_si128(K + nRounds)));
+	}
+
+	SLIB_CPU_TARGET("aes,sse2") static void _AES_decryptBlock_HW(const sl_uint8* keys, sl_uint32 nRounds, const void* src, void* dst)
+	{
+		const __m128i* K = (const __m128i*)keys;
+		__m128i b = _mm_xor_si128(_mm_loadu_si128((__m128i const*)src), _mm_loadu_si128(K));
+		for (sl_uint32 r = 1; r < nRounds; r++) {
+			b = _mm_aesdec_si128(b, _mm_loadu_si128(K + r));
+		}
+		_mm_storeu_si128((__m128i*)dst, _mm_aesdeclast_si128(b, _mm_loadu_si128(K + nRounds)));
+	}
+
+#elif defined(AES_SUPPORT_ARMV8)
+
+	// AESE/AESD add the round key before the substitution, so the last round key is added separately
+#define _ARMV8_ENC_ROUND(b, k) vaesmcq_u8(vaeseq_u8(b, k))
+#define _ARMV8_ENC_LAST(b, k) vaeseq_u8(b, k)
+#define _ARMV8_DEC_ROUND(b, k) vaesimcq_u8(vaesdq_u8(b, k))
+#define _ARMV8_DEC_LAST(b, k) vaesdq_u8(b, k)
+
+#define _ARMV8_PROCESS_BLOCKS(OP, OP_LAST) \
+	uint8x16_t K[15]; \
+	for (sl_uint32 i = 0; i <= nRounds; i++) { \
+		K[i] = vld1q_u8(keys + (i << 4)); \
+	} \
+	while (nBlocks >= 4) { \
+		uint8x16_t b0 = vld1q_u8(src); \
+		uint8x16_t b1 = vld1q_u8(src + 16); \
+		uint8x16_t b2 = vld1q_u8(src + 32); \
+		uint8x16_t b3 = vld1q_u8(src + 48); \
+		for (sl_uint32 r = 0; r < nRounds - 1; r++) { \
+			uint8x16_t k = K[r]; \
+			b0 = OP(b0, k); \
+			b1 = OP(b1, k); \
+			b2 = OP(b2, k); \
+			b3 = OP(b3, k); \
+		} \
+		uint8x16_t k1 = K[nRounds - 1]; \
+		uint8x16_t k2 = K[nRounds]; \
+		vst1q_u8(dst, veorq_u8(OP_LAST(b0, k1), k2)); \
+		vst1q_u8(dst + 16, veorq_u8(OP_LAST(b1, k1), k2)); \
+		vst1q_u8(dst + 32, veorq_u8(OP_LAST(b2, k1), k2)); \
+		vst1q_u8(dst + 48, veorq_u8(OP_LAST(b3, k1), k2)); \
+		src += 64; \
+		dst += 64; \
+		nBlocks -= 4; \
+	} \
+	while (nBlocks) { \
+		uint8x16_t b = vld1q_u8(src); \
+		for (sl_uint32 r = 0; r < nRounds - 1; r++) { \
+			b = OP(b, K[r]); \
+		} \
+		vst1q_u8(dst, veorq_u8(OP_LAST(b, K[nRounds - 1]), K[nRounds])); \
+		src += 16; \
+		dst += 16; \
+		nBlocks--; \
+	}
+
+	static void _AES_encryptBlocks_HW(const sl_uint8* keys, sl_uint32 nRounds, const sl_uint8* src, sl_uint8* dst, sl_size nBlocks)
+	{
+		_ARMV8_PROCESS_BLOCKS(_ARMV8_ENC_ROUND, _ARMV8_ENC_LAST)
+	}
+
+	static void _AES_decryptBlocks_HW(const sl_uint8* keys, sl_uint32 nRounds, const sl_uint8* src, sl_uint8* dst, sl_size nBlocks)
+	{
+		_ARMV8_PROCESS_BLOCKS(_ARMV8_DEC_ROUND, _ARMV8_DEC_LAST)
+	}
+
+	static void _AES_encryptBlock_HW(const sl_uint8* keys, sl_uint32 nRounds, const void* src, void* dst)
+	{
+		uint8x16_t b = vld1q_u8((const sl_uint8*)src);
+		for (sl_uint32 r = 0; r < nRounds - 1; r++) {
+			b = _ARMV8_ENC_ROUND(b, vld1q_u8(keys + (r << 4)));
+		}
+		b = _ARMV8_ENC_LAST(b, vld1q_u8(keys + ((nRounds - 1) << 4)));
+		vst1q_u8((sl_uint8*)dst, veorq_u8(b, vld1q_u8(keys + (nRounds << 4))));
+	}
+
+	static void _AES_decryptBlock_HW(const sl_uint8* keys, sl_uint32 nRounds, const void* src, void* dst)
+	{
+		uint8x16_t b = vld1q_u8((const sl_uint8*)src);
+		for (sl_uint32 r = 0; r < nRounds - 1; r++) {
+			b = _ARMV8_DEC_ROUND(b, vld1q_u8(keys + (r << 4)));
+		}
+		b = _ARMV8_DEC_LAST(b, vld1q_u8(keys + ((nRounds - 1) << 4)));
+		vst1q_u8((sl_uint8*)dst, veorq_u8(b, vld1q_u8(keys + (nRounds << 4))));
+	}
+
+#endif
+
 /*
 	Encryption Rounds
 
@@ -434,6 +627,12 @@ Roundn (Last):
 	
 	void AES::encryptBlock(const void* _src, void *_dst) const
 	{
+#if defined(AES_SUPPORT_HW)
+		if (_g_aes_flagHW) {
+			_AES_encryptBlock_HW(m_roundKeyEncHW, m_nCountRounds, _src, _dst);
+			return;
+		}
+#endif
 		const sl_uint8* IN = (const sl_uint8*)_src;
 		sl_uint8* OUT = (sl_uint8*)_dst;
 
@@ -530,6 +729,12 @@ Roundn (Last):
 	
 	void AES::decryptBlock(const void* _src, void *_dst) const
 	{
+#if defined(AES_SUPPORT_HW)
+		if (_g_aes_flagHW) {
+			_AES_decryptBlock_HW(m_roundKeyDecHW, m_nCountRounds, _src, _dst);
+			return;
+		}
+#endif
 		const sl_uint8* IN = (const sl_uint8*)_src;
 		sl_uint8* OUT = (sl_uint8*)_dst;
 		
@@ -546,6 +751,50 @@ Roundn (Last):
 		MIO::writeUint32BE(OUT + 12, d3);
 	}
 
+	sl_size AES::encryptBlocks(const void* _src, void* _dst, sl_size size) const
+	{
+		if (size & 15) {
+			return 0;
+		}
+		const sl_uint8* src = (const sl_uint8*)_src;
+		sl_uint8* dst = (sl_uint8*)_dst;
+		sl_size n = size >> 4;
+#if defined(AES_SUPPORT_HW)
+		if (_g_aes_flagHW) {
+			_AES_encryptBlocks_HW(m_roundKeyEncHW, m_nCountRounds, src, dst, n);
+			return size;
+		}
+#endif
+		for (sl_size i = 0; i < n; i++) {
+			encryptBlock(src, dst);
+			src += 16;
+			dst += 16;
+		}
+		return size;
+	}
+
+	sl_size AES::decryptBlocks(const void* _src, void* _dst, sl_size size) const
+	{
+		if (size & 15) {
+			return 0;
+		}
+		const sl_uint8* src = (const sl_uint8*)_src;
+		sl_uint8* dst = (sl_uint8*)_dst;
+		sl_size n = size >> 4;
+#if defined(AES_SUPPORT_HW)
+		if (_g_aes_flagHW) {
+			_AES_decryptBlocks_HW(m_roundKeyDecHW, m_nCountRounds, src, dst, n);
+			return size;
+		}
+#endif
+		for (sl_size i = 0; i < n; i++) {
+			decryptBlock(src, dst);
+			src += 16;
+			dst += 16;
+		}
+		return size;
+	}
+
 	void AES::setKey_SHA256(const String& key)
 	{
 		char sig[32];
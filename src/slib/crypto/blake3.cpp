@@ -0,0 +1,760 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "../../../inc/slib/crypto/blake3.h"
+#include "../../../inc/slib/core/mio.h"
+#include "../../../inc/slib/core/math.h"
+#include "../../../inc/slib/core/base.h"
+#include "../../../inc/slib/core/cpu.h"
+#include "../../../inc/slib/core/file.h"
+#include "../../../inc/slib/core/thread_pool.h"
+
+#if defined(SLIB_CPU_USE_X86_EXTENSIONS)
+#	include <immintrin.h>
+#	define BLAKE3_SUPPORT_AVX2
+#endif
+
+#define BLAKE3_BLOCK_LEN 64
+#define BLAKE3_CHUNK_LEN 1024
+#define BLAKE3_OUT_LEN 32
+#define BLAKE3_MAX_SIMD_DEGREE 8
+
+#define BLAKE3_CHUNK_START 1
+#define BLAKE3_CHUNK_END 2
+#define BLAKE3_PARENT 4
+#define BLAKE3_ROOT 8
+#define BLAKE3_KEYED_HASH 16
+
+// subtrees of the parallel updates are at least 256KB
+#define BLAKE3_PARALLEL_PIECE_MIN 0x40000
+#define BLAKE3_PARALLEL_PIECES_MAX 64
+
+#define BLAKE3_FILE_BUFFER_SIZE 0x1000000
+
+namespace slib
+{
+
+	static const sl_uint32 _BLAKE3_IV[8] = {
+		0x6A09E667ul, 0xBB67AE85ul, 0x3C6EF372ul, 0xA54FF53Aul,
+		0x510E527Ful, 0x9B05688Cul, 0x1F83D9ABul, 0x5BE0CD19ul
+	};
+
+	static const sl_uint8 _BLAKE3_MSG_SCHEDULE[7][16] = {
+		{0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15},
+		{2, 6, 3, 10, 7, 0, 4, 13, 1, 11, 12, 5, 9, 14, 15, 8},
+		{3, 4, 10, 12, 13, 2, 7, 14, 6, 5, 9, 0, 11, 15, 8, 1},
+		{10, 7, 12, 9, 14, 3, 13, 15, 4, 0, 11, 2, 5, 8, 1, 6},
+		{12, 13, 9, 11, 15, 10, 14, 8, 7, 2, 5, 3, 0, 1, 6, 4},
+		{9, 14, 11, 5, 8, 12, 15, 1, 13, 3, 0, 10, 2, 6, 4, 7},
+		{11, 15, 5, 0, 1, 9, 8, 6, 14, 10, 2, 12, 3, 4, 7, 13},
+	};
+
+#if defined(BLAKE3_SUPPORT_AVX2)
+	static sl_bool _g_blake3_flagAVX2 = Cpu::isAVX2Supported();
+#endif
+
+	SLIB_INLINE static sl_uint32 _BLAKE3_getSimdDegree()
+	{
+#if defined(BLAKE3_SUPPORT_AVX2)
+		if (_g_blake3_flagAVX2) {
+			return 8;
+		}
+#endif
+		return 1;
+	}
+
+	SLIB_INLINE static sl_uint64 _BLAKE3_roundDownToPowerOf2(sl_uint64 x)
+	{
+		sl_uint64 r = 1;
+		while (r <= (x >> 1)) {
+			r <<= 1;
+		}
+		return r;
+	}
+
+	SLIB_INLINE static sl_uint32 _BLAKE3_popcount(sl_uint64 x)
+	{
+		sl_uint32 n = 0;
+		while (x) {
+			n++;
+			x &= x - 1;
+		}
+		return n;
+	}
+
+	static void _BLAKE3_loadKey(sl_uint32* key, const sl_uint8* cv)
+	{
+		for (sl_uint32 i = 0; i < 8; i++) {
+			key[i] = MIO::readUint32LE(cv + (i << 2));
+		}
+	}
+
+	static void _BLAKE3_storeCV(sl_uint8* cv, const sl_uint32* h)
+	{
+		for (sl_uint32 i = 0; i < 8; i++) {
+			MIO::writeUint32LE(cv + (i << 2), h[i]);
+		}
+	}
+
+#define BLAKE3_G(a, b, c, d, x, y) \
+	a = a + b + x; \
+	d = Math::rotateRight32(d ^ a, 16); \
+	c = c + d; \
+	b = Math::rotateRight32(b ^ c, 12); \
+	a = a + b + y; \
+	d = Math::rotateRight32(d ^ a, 8); \
+	c = c + d; \
+	b = Math::rotateRight32(b ^ c, 7);
+
+	static void _BLAKE3_compress(sl_uint32 state[16], const sl_uint32 cv[8], const sl_uint8* block, sl_uint32 blockLen, sl_uint64 counter, sl_uint32 flags)
+	{
+		sl_uint32 m[16];
+		sl_uint32 i;
+		for (i = 0; i < 16; i++) {
+			m[i] = MIO::readUint32LE(block + (i << 2));
+		}
+		sl_uint32* v = state;
+		for (i = 0; i < 8; i++) {
+			v[i] = cv[i];
+		}
+		v[8] = _BLAKE3_IV[0];
+		v[9] = _BLAKE3_IV[1];
+		v[10] = _BLAKE3_IV[2];
+		v[11] = _BLAKE3_IV[3];
+		v[12] = (sl_uint32)counter;
+		v[13] = (sl_uint32)(counter >> 32);
+		v[14] = blockLen;
+		v[15] = flags;
+		for (i = 0; i < 7; i++) {
+			const sl_uint8* s = _BLAKE3_MSG_SCHEDULE[i];
+			BLAKE3_G(v[0], v[4], v[8], v[12], m[s[0]], m[s[1]])
+			BLAKE3_G(v[1], v[5], v[9], v[13], m[s[2]], m[s[3]])
+			BLAKE3_G(v[2], v[6], v[10], v[14], m[s[4]], m[s[5]])
+			BLAKE3_G(v[3], v[7], v[11], v[15], m[s[6]], m[s[7]])
+			BLAKE3_G(v[0], v[5], v[10], v[15], m[s[8]], m[s[9]])
+			BLAKE3_G(v[1], v[6], v[11], v[12], m[s[10]], m[s[11]])
+			BLAKE3_G(v[2], v[7], v[8], v[13], m[s[12]], m[s[13]])
+			BLAKE3_G(v[3], v[4], v[9], v[14], m[s[14]], m[s[15]])
+		}
+	}
+
+	static void _BLAKE3_compressInPlace(sl_uint32 cv[8], const sl_uint8* block, sl_uint32 blockLen, sl_uint64 counter, sl_uint32 flags)
+	{
+		sl_uint32 v[16];
+		_BLAKE3_compress(v, cv, block, blockLen, counter, flags);
+		for (sl_uint32 i = 0; i < 8; i++) {
+			cv[i] = v[i] ^ v[i + 8];
+		}
+	}
+
+	static void _BLAKE3_compressXof(const sl_uint32 cv[8], const sl_uint8* block, sl_uint32 blockLen, sl_uint64 counter, sl_uint32 flags, sl_uint8 out[64])
+	{
+		sl_uint32 v[16];
+		_BLAKE3_compress(v, cv, block, blockLen, counter, flags);
+		for (sl_uint32 i = 0; i < 8; i++) {
+			MIO::writeUint32LE(out + (i << 2), v[i] ^ v[i + 8]);
+			MIO::writeUint32LE(out + 32 + (i << 2), v[i + 8] ^ cv[i]);
+		}
+	}
+
+	static void _BLAKE3_hashMany_Generic(const sl_uint8* const* inputs, sl_size nInputs, sl_size nBlocks, const sl_uint32 key[8], sl_uint64 counter, sl_bool flagIncrementCounter, sl_uint32 flags, sl_uint32 flagsStart, sl_uint32 flagsEnd, sl_uint8* out)
+	{
+		for (sl_size i = 0; i < nInputs; i++) {
+			sl_uint32 cv[8];
+			sl_uint32 k;
+			for (k = 0; k < 8; k++) {
+				cv[k] = key[k];
+			}
+			const sl_uint8* input = inputs[i];
+			sl_uint32 blockFlags = flags | flagsStart;
+			for (sl_size b = 0; b < nBlocks; b++) {
+				if (b + 1 == nBlocks) {
+					blockFlags |= flagsEnd;
+				}
+				_BLAKE3_compressInPlace(cv, input, BLAKE3_BLOCK_LEN, counter, blockFlags);
+				input += BLAKE3_BLOCK_LEN;
+				blockFlags = flags;
+			}
+			_BLAKE3_storeCV(out, cv);
+			out += BLAKE3_OUT_LEN;
+			if (flagIncrementCounter) {
+				counter++;
+			}
+		}
+	}
+
+#if defined(BLAKE3_SUPPORT_AVX2)
+
+#define BLAKE3_AVX2_ROT16(x) _mm256_shuffle_epi8(x, _mm256_set_epi8(13, 12, 15, 14, 9, 8, 11, 10, 5, 4, 7, 6, 1, 0, 3, 2, 13, 12, 15, 14, 9, 8, 11, 10, 5, 4, 7, 6, 1, 0, 3, 2))
+#define BLAKE3_AVX2_ROT8(x) _mm256_shuffle_epi8(x, _mm256_set_epi8(12, 15, 14, 13, 8, 11, 10, 9, 4, 7, 6, 5, 0, 3, 2, 1, 12, 15, 14, 13, 8, 11, 10, 9, 4, 7, 6, 5, 0, 3, 2, 1))
+#define BLAKE3_AVX2_ROT12(x) _mm256_or_si256(_mm256_srli_epi32(x, 12), _mm256_slli_epi32(x, 20))
+#define BLAKE3_AVX2_ROT7(x) _mm256_or_si256(_mm256_srli_epi32(x, 7), _mm256_slli_epi32(x, 25))
+
+#define BLAKE3_AVX2_G(a, b, c, d, x, y) \
+	a = _mm256_add_epi32(_mm256_add_epi32(a, b), x); \
+	d = BLAKE3_AVX2_ROT16(_mm256_xor_si256(d, a)); \
+	c = _mm256_add_epi32(c, d); \
+	b = BLAKE3_AVX2_ROT12(_mm256_xor_si256(b, c)); \
+	a = _mm256_add_epi32(_mm256_add_epi32(a, b), y); \
+	d = BLAKE3_AVX2_ROT8(_mm256_xor_si256(d, a)); \
+	c = _mm256_add_epi32(c, d); \
+	b = BLAKE3_AVX2_ROT7(_mm256_xor_si256(b, c));
+
+	// transposes 8x8 words: vecs[i] (the words of lane `i`) <-> vecs[j] (the word `j` of all lanes)
+	SLIB_CPU_TARGET("avx2")
+	static void _BLAKE3_transpose_AVX2(__m256i vecs[8])
+	{
+		__m256i ab_0145 = _mm256_unpacklo_epi32(vecs[0], vecs[1]);
+		__m256i ab_2367 = _mm256_unpackhi_epi32(vecs[0], vecs[1]);
+		__m256i cd_0145 = _mm256_unpacklo_epi32(vecs[2], vecs[3]);
+		__m256i cd_2367 = _mm256_unpackhi_epi32(vecs[2], vecs[3]);
+		__m256i ef_0145 = _mm256_unpacklo_epi32(vecs[4], vecs[5]);
+		__m256i ef_2367 = _mm256_unpackhi_epi32(vecs[4], vecs[5]);
+		__m256i gh_0145 = _mm256_unpacklo_epi32(vecs[6], vecs[7]);
+		__m256i gh_2367 = _mm256_unpackhi_epi32(vecs[6], vecs[7]);
+		__m256i abcd_04 = _mm256_unpacklo_epi64(ab_0145, cd_0145);
+		__m256i abcd_15 = _mm256_unpackhi_epi64(ab_0145, cd_0145);
+		__m256i abcd_26 = _mm256_unpacklo_epi64(ab_2367, cd_2367);
+		__m256i abcd_37 = _mm256_unpackhi_epi64(ab_2367, cd_2367);
+		__m256i efgh_04 = _mm256_unpacklo_epi64(ef_0145, gh_0145);
+		__m256i efgh_15 = _mm256_unpackhi_epi64(ef_0145, gh_0145);
+		__m256i efgh_26 = _mm256_unpacklo_epi64(ef_2367, gh_2367);
+		__m256i efgh_37 = _mm256_unpackhi_epi64(ef_2367, gh_2367);
+		vecs[0] = _mm256_permute2x128_si256(abcd_04, efgh_04, 0x20);
+		vecs[1] = _mm256_permute2x128_si256(abcd_15, efgh_15, 0x20);
+		vecs[2] = _mm256_permute2x128_si256(abcd_26, efgh_26, 0x20);
+		vecs[3] = _mm256_permute2x128_si256(abcd_37, efgh_37, 0x20);
+		vecs[4] = _mm256_permute2x128_si256(abcd_04, efgh_04, 0x31);
+		vecs[5] = _mm256_permute2x128_si256(abcd_15, efgh_15, 0x31);
+		vecs[6] = _mm256_permute2x128_si256(abcd_26, efgh_26, 0x31);
+		vecs[7] = _mm256_permute2x128_si256(abcd_37, efgh_37, 0x31);
+	}
+
+	// hashes 8 inputs of `nBlocks` blocks, one input per lane
+	SLIB_CPU_TARGET("avx2")
+	static void _BLAKE3_hash8_AVX2(const sl_uint8* const* inputs, sl_size nBlocks, const sl_uint32 key[8], sl_uint64 counter, sl_bool flagIncrementCounter, sl_uint32 flags, sl_uint32 flagsStart, sl_uint32 flagsEnd, sl_uint8* out)
+	{
+		__m256i h[8];
+		sl_uint32 i;
+		for (i = 0; i < 8; i++) {
+			h[i] = _mm256_set1_epi32((int)(key[i]));
+		}
+		SLIB_ALIGN(32) sl_uint32 counterLow[8];
+		SLIB_ALIGN(32) sl_uint32 counterHigh[8];
+		for (i = 0; i < 8; i++) {
+			sl_uint64 c = counter + (flagIncrementCounter ? i : 0);
+			counterLow[i] = (sl_uint32)c;
+			counterHigh[i] = (sl_uint32)(c >> 32);
+		}
+		__m256i vCounterLow = _mm256_load_si256((const __m256i*)counterLow);
+		__m256i vCounterHigh = _mm256_load_si256((const __m256i*)counterHigh);
+		__m256i vBlockLen = _mm256_set1_epi32(BLAKE3_BLOCK_LEN);
+		sl_uint32 blockFlags = flags | flagsStart;
+		for (sl_size b = 0; b < nBlocks; b++) {
+			if (b + 1 == nBlocks) {
+				blockFlags |= flagsEnd;
+			}
+			sl_size offset = b * BLAKE3_BLOCK_LEN;
+			__m256i m[16];
+			for (i = 0; i < 8; i++) {
+				m[i] = _mm256_loadu_si256((const __m256i*)(inputs[i] + offset));
+				m[i + 8] = _mm256_loadu_si256((const __m256i*)(inputs[i] + offset + 32));
+			}
+			_BLAKE3_transpose_AVX2(m);
+			_BLAKE3_transpose_AVX2(m + 8);
+			__m256i v[16];
+			for (i = 0; i < 8; i++) {
+				v[i] = h[i];
+			}
+			v[8] = _mm256_set1_epi32((int)(_BLAKE3_IV[0]));
+			v[9] = _mm256_set1_epi32((int)(_BLAKE3_IV[1]));
+			v[10] = _mm256_set1_epi32((int)(_BLAKE3_IV[2]));
+			v[11] = _mm256_set1_epi32((int)(_BLAKE3_IV[3]));
+			v[12] = vCounterLow;
+			v[13] = vCounterHigh;
+			v[14] = vBlockLen;
+			v[15] = _mm256_set1_epi32((int)blockFlags);
+			for (i = 0; i < 7; i++) {
+				const sl_uint8* s = _BLAKE3_MSG_SCHEDULE[i];
+				BLAKE3_AVX2_G(v[0], v[4], v[8], v[12], m[s[0]], m[s[1]])
+				BLAKE3_AVX2_G(v[1], v[5], v[9], v[13], m[s[2]], m[s[3]])
+				BLAKE3_AVX2_G(v[2], v[6], v[10], v[14], m[s[4]], m[s[5]])
+				BLAKE3_AVX2_G(v[3], v[7], v[11], v[15], m[s[6]], m[s[7]])
+				BLAKE3_AVX2_G(v[0], v[5], v[10], v[15], m[s[8]], m[s[9]])
+				BLAKE3_AVX2_G(v[1], v[6], v[11], v[12], m[s[10]], m[s[11]])
+				BLAKE3_AVX2_G(v[2], v[7], v[8], v[13], m[s[12]], m[s[13]])
+				BLAKE3_AVX2_G(v[3], v[4], v[9], v[14], m[s[14]], m[s[15]])
+			}
+			for (i = 0; i < 8; i++) {
+				h[i] = _mm256_xor_si256(v[i], v[i + 8]);
+			}
+			blockFlags = flags;
+		}
+		_BLAKE3_transpose_AVX2(h);
+		for (i = 0; i < 8; i++) {
+			_mm256_storeu_si256((__m256i*)(out + i * BLAKE3_OUT_LEN), h[i]);
+		}
+	}
+
+#endif
+
+	static void _BLAKE3_hashMany(const sl_uint8* const* inputs, sl_size nInputs, sl_size nBlocks, const sl_uint32 key[8], sl_uint64 counter, sl_bool flagIncrementCounter, sl_uint32 flags, sl_uint32 flagsStart, sl_uint32 flagsEnd, sl_uint8* out)
+	{
+#if defined(BLAKE3_SUPPORT_AVX2)
+		if (_g_blake3_flagAVX2) {
+			while (nInputs >= 8) {
+				_BLAKE3_hash8_AVX2(inputs, nBlocks, key, counter, flagIncrementCounter, flags, flagsStart, flagsEnd, out);
+				if (flagIncrementCounter) {
+					counter += 8;
+				}
+				inputs += 8;
+				nInputs -= 8;
+				out += 8 * BLAKE3_OUT_LEN;
+			}
+		}
+#endif
+		_BLAKE3_hashMany_Generic(inputs, nInputs, nBlocks, key, counter, flagIncrementCounter, flags, flagsStart, flagsEnd, out);
+	}
+
+
+	struct _BLAKE3_ChunkState
+	{
+		sl_uint32 cv[8];
+		sl_uint64 chunkCounter;
+		sl_uint8 buf[BLAKE3_BLOCK_LEN];
+		sl_uint32 bufLen;
+		sl_uint32 blocksCompressed;
+		sl_uint32 flags;
+
+		void init(const sl_uint32 key[8], sl_uint64 counter, sl_uint32 _flags)
+		{
+			Base::copyMemory(cv, key, 32);
+			chunkCounter = counter;
+			bufLen = 0;
+			blocksCompressed = 0;
+			flags = _flags;
+		}
+
+		sl_uint32 getStartFlag()
+		{
+			return blocksCompressed ? 0 : BLAKE3_CHUNK_START;
+		}
+
+		void update(const sl_uint8* input, sl_size len)
+		{
+			if (bufLen) {
+				sl_size n = BLAKE3_BLOCK_LEN - bufLen;
+				if (n > len) {
+					n = len;
+				}
+				Base::copyMemory(buf + bufLen, input, n);
+				bufLen += (sl_uint32)n;
+				input += n;
+				len -= n;
+				if (len) {
+					_BLAKE3_compressInPlace(cv, buf, BLAKE3_BLOCK_LEN, chunkCounter, flags | getStartFlag());
+					blocksCompressed++;
+					bufLen = 0;
+				}
+			}
+			while (len > BLAKE3_BLOCK_LEN) {
+				_BLAKE3_compressInPlace(cv, input, BLAKE3_BLOCK_LEN, chunkCounter, flags | getStartFlag());
+				blocksCompressed++;
+				input += BLAKE3_BLOCK_LEN;
+				len -= BLAKE3_BLOCK_LEN;
+			}
+			if (len) {
+				Base::copyMemory(buf + bufLen, input, len);
+				bufLen += (sl_uint32)len;
+			}
+		}
+
+	};
+
+	// input of the final compression, which can produce either a chaining value or root output bytes
+	struct _BLAKE3_Output
+	{
+		sl_uint32 cv[8];
+		sl_uint8 block[BLAKE3_BLOCK_LEN];
+		sl_uint32 blockLen;
+		sl_uint64 counter;
+		sl_uint32 flags;
+
+		void setChunk(const sl_uint32 _cv[8], const sl_uint8* _block, sl_uint32 _blockLen, sl_uint64 _counter, sl_uint32 _flags)
+		{
+			Base::copyMemory(cv, _cv, 32);
+			Base::zeroMemory(block, BLAKE3_BLOCK_LEN);
+			Base::copyMemory(block, _block, _blockLen);
+			blockLen = _blockLen;
+			counter = _counter;
+			flags = _flags;
+		}
+
+		void setChunk(const _BLAKE3_ChunkState& state)
+		{
+			setChunk(state.cv, state.buf, state.bufLen, state.chunkCounter, state.flags | (state.blocksCompressed ? 0 : BLAKE3_CHUNK_START) | BLAKE3_CHUNK_END);
+		}
+
+		void setParent(const sl_uint8 block[64], const sl_uint32 key[8], sl_uint32 flags)
+		{
+			setChunk(key, block, BLAKE3_BLOCK_LEN, 0, flags | BLAKE3_PARENT);
+		}
+
+		void getChainingValue(sl_uint8 out[32])
+		{
+			sl_uint32 h[8];
+			Base::copyMemory(h, cv, 32);
+			_BLAKE3_compressInPlace(h, block, blockLen, counter, flags);
+			_BLAKE3_storeCV(out, h);
+		}
+
+		void getRootBytes(sl_uint8* out, sl_size len)
+		{
+			sl_uint64 outputCounter = 0;
+			sl_uint8 buf[64];
+			while (len) {
+				_BLAKE3_compressXof(cv, block, blockLen, outputCounter, flags | BLAKE3_ROOT, buf);
+				sl_size n = len < 64 ? len : 64;
+				Base::copyMemory(out, buf, n);
+				out += n;
+				len -= n;
+				outputCounter++;
+			}
+		}
+
+	};
+
+	// length of the left subtree: the largest power of 2 number of full chunks, leaving at least 1 byte for the right subtree
+	SLIB_INLINE static sl_size _BLAKE3_getLeftLength(sl_size len)
+	{
+		sl_size nFullChunks = (len - 1) / BLAKE3_CHUNK_LEN;
+		return (sl_size)(_BLAKE3_roundDownToPowerOf2(nFullChunks)) * BLAKE3_CHUNK_LEN;
+	}
+
+	static sl_size _BLAKE3_compressChunks(const sl_uint8* input, sl_size len, const sl_uint32 key[8], sl_uint64 chunkCounter, sl_uint32 flags, sl_uint8* out)
+	{
+		const sl_uint8* chunks[BLAKE3_MAX_SIMD_DEGREE];
+		sl_size nChunks = 0;
+		sl_size pos = 0;
+		while (len - pos >= BLAKE3_CHUNK_LEN) {
+			chunks[nChunks++] = input + pos;
+			pos += BLAKE3_CHUNK_LEN;
+		}
+		_BLAKE3_hashMany(chunks, nChunks, BLAKE3_CHUNK_LEN / BLAKE3_BLOCK_LEN, key, chunkCounter, sl_true, flags, BLAKE3_CHUNK_START, BLAKE3_CHUNK_END, out);
+		if (len > pos) {
+			_BLAKE3_ChunkState state;
+			state.init(key, chunkCounter + nChunks, flags);
+			state.update(input + pos, len - pos);
+			_BLAKE3_Output output;
+			output.setChunk(state);
+			output.getChainingValue(out + nChunks * BLAKE3_OUT_LEN);
+			return nChunks + 1;
+		}
+		return nChunks;
+	}
+
+	// `nCVs`: up to 2 * simd degree (wide subtree), or the parallel pieces (reduction)
+	static sl_size _BLAKE3_compressParents(const sl_uint8* cvs, sl_size nCVs, const sl_uint32 key[8], sl_uint32 flags, sl_uint8* out)
+	{
+		const sl_uint8* parents[BLAKE3_PARALLEL_PIECES_MAX / 2];
+		sl_size nParents = 0;
+		while (nCVs - 2 * nParents >= 2) {
+			parents[nParents] = cvs + 2 * nParents * BLAKE3_OUT_LEN;
+			nParents++;
+		}
+		_BLAKE3_hashMany(parents, nParents, 1, key, 0, sl_false, flags | BLAKE3_PARENT, 0, 0, out);
+		if (nCVs > 2 * nParents) {
+			Base::copyMemory(out + nParents * BLAKE3_OUT_LEN, cvs + 2 * nParents * BLAKE3_OUT_LEN, BLAKE3_OUT_LEN);
+			return nParents + 1;
+		}
+		return nParents;
+	}
+
+	// compresses the subtree into at most `simd degree` chaining values (at least 2 when the subtree has more than 1 chunk)
+	static sl_size _BLAKE3_compressSubtreeWide(const sl_uint8* input, sl_size len, const sl_uint32 key[8], sl_uint64 chunkCounter, sl_uint32 flags, sl_uint8* out)
+	{
+		sl_uint32 degree = _BLAKE3_getSimdDegree();
+		if (len <= degree * BLAKE3_CHUNK_LEN) {
+			return _BLAKE3_compressChunks(input, len, key, chunkCounter, flags, out);
+		}
+		sl_size lenLeft = _BLAKE3_getLeftLength(len);
+		if (lenLeft > BLAKE3_CHUNK_LEN && degree == 1) {
+			degree = 2;
+		}
+		sl_uint8 cvs[2 * BLAKE3_MAX_SIMD_DEGREE * BLAKE3_OUT_LEN];
+		sl_uint8* cvsRight = cvs + degree * BLAKE3_OUT_LEN;
+		sl_size nLeft = _BLAKE3_compressSubtreeWide(input, lenLeft, key, chunkCounter, flags, cvs);
+		sl_size nRight = _BLAKE3_compressSubtreeWide(input + lenLeft, len - lenLeft, key, chunkCounter + lenLeft / BLAKE3_CHUNK_LEN, flags, cvsRight);
+		if (nLeft == 1) {
+			Base::copyMemory(out, cvs, 2 * BLAKE3_OUT_LEN);
+			return 2;
+		}
+		return _BLAKE3_compressParents(cvs, nLeft + nRight, key, flags, out);
+	}
+
+	static void _BLAKE3_reduceToParentNode(sl_uint8* cvs, sl_size nCVs, const sl_uint32 key[8], sl_uint32 flags, sl_uint8 out[64])
+	{
+		sl_uint8 parents[BLAKE3_PARALLEL_PIECES_MAX * BLAKE3_OUT_LEN / 2];
+		while (nCVs > 2) {
+			nCVs = _BLAKE3_compressParents(cvs, nCVs, key, flags, parents);
+			Base::copyMemory(cvs, parents, nCVs * BLAKE3_OUT_LEN);
+		}
+		Base::copyMemory(out, cvs, 2 * BLAKE3_OUT_LEN);
+	}
+
+	// hashes the subtree of 2 or more chunks into the children of its root node
+	static void _BLAKE3_compressSubtreeToParentNode_Serial(const sl_uint8* input, sl_size len, const sl_uint32 key[8], sl_uint64 chunkCounter, sl_uint32 flags, sl_uint8 out[64])
+	{
+		sl_uint8 cvs[BLAKE3_PARALLEL_PIECES_MAX * BLAKE3_OUT_LEN];
+		sl_size nCVs = _BLAKE3_compressSubtreeWide(input, len, key, chunkCounter, flags, cvs);
+		_BLAKE3_reduceToParentNode(cvs, nCVs, key, flags, out);
+	}
+
+
+	/*
+		A power of 2 subtree is split into equal power of 2 pieces.
+		Every piece is a complete subtree whose chaining value is independent of the others,
+		and the pieces are the leaves of a perfect binary tree under the root of the subtree.
+	*/
+	static void _BLAKE3_compressSubtreeToParentNode(const sl_uint8* input, sl_size len, const sl_uint32 key[8], sl_uint64 chunkCounter, sl_uint32 flags, sl_uint8 out[64])
+	{
+		if (len < 2 * BLAKE3_PARALLEL_PIECE_MIN || Cpu::getCoresCount() < 2) {
+			_BLAKE3_compressSubtreeToParentNode_Serial(input, len, key, chunkCounter, flags, out);
+			return;
+		}
+		sl_size nPieces = len / BLAKE3_PARALLEL_PIECE_MIN;
+		if (nPieces > BLAKE3_PARALLEL_PIECES_MAX) {
+			nPieces = BLAKE3_PARALLEL_PIECES_MAX;
+		}
+		nPieces = (sl_size)(_BLAKE3_roundDownToPowerOf2(nPieces));
+		sl_size lenPiece = len / nPieces;
+		sl_uint8 cvs[BLAKE3_PARALLEL_PIECES_MAX * BLAKE3_OUT_LEN];
+		ThreadPool::parallelFor(nPieces, [input, lenPiece, key, chunkCounter, flags, &cvs](sl_size index) {
+			sl_uint8 pair[64];
+			_BLAKE3_compressSubtreeToParentNode_Serial(input + index * lenPiece, lenPiece, key, chunkCounter + index * (lenPiece / BLAKE3_CHUNK_LEN), flags, pair);
+			_BLAKE3_Output output;
+			output.setParent(pair, key, flags);
+			output.getChainingValue(cvs + index * BLAKE3_OUT_LEN);
+		});
+		_BLAKE3_reduceToParentNode(cvs, nPieces, key, flags, out);
+	}
+
+
+	BLAKE3::BLAKE3()
+	{
+	}
+
+	BLAKE3::~BLAKE3()
+	{
+	}
+
+	void BLAKE3::start()
+	{
+		Base::copyMemory(m_key, _BLAKE3_IV, 32);
+		m_flags = 0;
+		Base::copyMemory(m_chunkCV, m_key, 32);
+		m_chunkCounter = 0;
+		m_blockLen = 0;
+		m_blocksCompressed = 0;
+		m_stackLen = 0;
+	}
+
+	void BLAKE3::start(const void* key)
+	{
+		start();
+		_BLAKE3_loadKey(m_key, (const sl_uint8*)key);
+		m_flags = BLAKE3_KEYED_HASH;
+		Base::copyMemory(m_chunkCV, m_key, 32);
+	}
+
+#define BLAKE3_LOAD_CHUNK_STATE(STATE) \
+	Base::copyMemory(STATE.cv, m_chunkCV, 32); \
+	STATE.chunkCounter = m_chunkCounter; \
+	Base::copyMemory(STATE.buf, m_block, m_blockLen); \
+	STATE.bufLen = m_blockLen; \
+	STATE.blocksCompressed = m_blocksCompressed; \
+	STATE.flags = m_flags;
+
+#define BLAKE3_SAVE_CHUNK_STATE(STATE) \
+	Base::copyMemory(m_chunkCV, STATE.cv, 32); \
+	m_chunkCounter = STATE.chunkCounter; \
+	Base::copyMemory(m_block, STATE.buf, STATE.bufLen); \
+	m_blockLen = STATE.bufLen; \
+	m_blocksCompressed = STATE.blocksCompressed;
+
+	void BLAKE3::update(const void* _input, sl_size len)
+	{
+		if (!len) {
+			return;
+		}
+		const sl_uint8* input = (const sl_uint8*)_input;
+		_BLAKE3_ChunkState chunk;
+		BLAKE3_LOAD_CHUNK_STATE(chunk)
+		// fill the current chunk first, which is pushed only when more input follows (the last chunk may be the root)
+		if (m_blocksCompressed || m_blockLen) {
+			sl_size lenChunk = m_blocksCompressed * BLAKE3_BLOCK_LEN + m_blockLen;
+			sl_size n = BLAKE3_CHUNK_LEN - lenChunk;
+			if (n > len) {
+				n = len;
+			}
+			chunk.update(input, n);
+			input += n;
+			len -= n;
+			if (!len) {
+				BLAKE3_SAVE_CHUNK_STATE(chunk)
+				return;
+			}
+			_BLAKE3_Output output;
+			output.setChunk(chunk);
+			sl_uint8 cv[32];
+			output.getChainingValue(cv);
+			_pushCV(cv, chunk.chunkCounter);
+			chunk.init(m_key, chunk.chunkCounter + 1, m_flags);
+		}
+		// hash the largest subtrees aligned to the chunk counter
+		while (len > BLAKE3_CHUNK_LEN) {
+			sl_uint64 lenSubtree = _BLAKE3_roundDownToPowerOf2(len);
+			sl_uint64 lenBefore = chunk.chunkCounter * BLAKE3_CHUNK_LEN;
+			while (((lenSubtree - 1) & lenBefore) != 0) {
+				lenSubtree >>= 1;
+			}
+			sl_uint64 nSubtreeChunks = lenSubtree / BLAKE3_CHUNK_LEN;
+			if (lenSubtree <= BLAKE3_CHUNK_LEN) {
+				_BLAKE3_ChunkState state;
+				state.init(m_key, chunk.chunkCounter, m_flags);
+				state.update(input, (sl_size)lenSubtree);
+				_BLAKE3_Output output;
+				output.setChunk(state);
+				sl_uint8 cv[32];
+				output.getChainingValue(cv);
+				_pushCV(cv, state.chunkCounter);
+			} else {
+				sl_uint8 pair[64];
+				_BLAKE3_compressSubtreeToParentNode(input, (sl_size)lenSubtree, m_key, chunk.chunkCounter, m_flags, pair);
+				_pushCV(pair, chunk.chunkCounter);
+				_pushCV(pair + 32, chunk.chunkCounter + nSubtreeChunks / 2);
+			}
+			chunk.chunkCounter += nSubtreeChunks;
+			input += lenSubtree;
+			len -= (sl_size)lenSubtree;
+		}
+		if (len) {
+			chunk.update(input, len);
+			_mergeCVs(chunk.chunkCounter);
+		}
+		BLAKE3_SAVE_CHUNK_STATE(chunk)
+	}
+
+	void BLAKE3::finish(void* output)
+	{
+		finish(output, 32);
+	}
+
+	void BLAKE3::finish(void* _output, sl_size size)
+	{
+		sl_uint8* out = (sl_uint8*)_output;
+		_BLAKE3_ChunkState chunk;
+		BLAKE3_LOAD_CHUNK_STATE(chunk)
+		_BLAKE3_Output output;
+		if (!m_stackLen) {
+			output.setChunk(chunk);
+			output.getRootBytes(out, size);
+			return;
+		}
+		sl_uint32 nRemaining;
+		if (m_blocksCompressed || m_blockLen) {
+			nRemaining = m_stackLen;
+			output.setChunk(chunk);
+		} else {
+			nRemaining = m_stackLen - 2;
+			output.setParent(m_stackCV + nRemaining * BLAKE3_OUT_LEN, m_key, m_flags);
+		}
+		while (nRemaining) {
+			nRemaining--;
+			sl_uint8 block[64];
+			Base::copyMemory(block, m_stackCV + nRemaining * BLAKE3_OUT_LEN, 32);
+			output.getChainingValue(block + 32);
+			output.setParent(block, m_key, m_flags);
+		}
+		output.getRootBytes(out, size);
+	}
+
+	void BLAKE3::_pushCV(const sl_uint8* cv, sl_uint64 chunkCounter)
+	{
+		_mergeCVs(chunkCounter);
+		Base::copyMemory(m_stackCV + m_stackLen * BLAKE3_OUT_LEN, cv, BLAKE3_OUT_LEN);
+		m_stackLen++;
+	}
+
+	// the stack holds one entry per 1-bit of the number of completed chunks; the merges are deferred, because the last entry may belong to the root
+	void BLAKE3::_mergeCVs(sl_uint64 totalChunks)
+	{
+		sl_uint32 n = _BLAKE3_popcount(totalChunks);
+		while (m_stackLen > n) {
+			sl_uint8* node = m_stackCV + (m_stackLen - 2) * BLAKE3_OUT_LEN;
+			_BLAKE3_Output output;
+			output.setParent(node, m_key, m_flags);
+			output.getChainingValue(node);
+			m_stackLen--;
+		}
+	}
+
+	sl_bool BLAKE3::hashFile(const String& path, void* output)
+	{
+		Ref<File> file = File::openForRead(path);
+		if (file.isNull()) {
+			return sl_false;
+		}
+		sl_uint64 size = file->getSize();
+		sl_size sizeBuf = BLAKE3_FILE_BUFFER_SIZE;
+		if (size < sizeBuf) {
+			sizeBuf = (sl_size)size;
+			if (!sizeBuf) {
+				sizeBuf = 1;
+			}
+		}
+		Memory mem = Memory::create(sizeBuf);
+		if (mem.isNull()) {
+			return sl_false;
+		}
+		sl_uint8* buf = (sl_uint8*)(mem.getData());
+		BLAKE3 hash;
+		hash.start();
+		while (size) {
+			// fill the whole buffer, so that every update is a power of 2 subtree eligible for the parallel hashing
+			sl_size n = sizeBuf;
+			if (n > size) {
+				n = (sl_size)size;
+			}
+			sl_size pos = 0;
+			while (pos < n) {
+				sl_reg m = file->read(buf + pos, n - pos);
+				if (m <= 0) {
+					return sl_false;
+				}
+				pos += m;
+			}
+			hash.update(buf, n);
+			size -= n;
+		}
+		hash.finish(output);
+		return sl_true;
+	}
+
+	Memory BLAKE3::hashFile(const String& path)
+	{
+		sl_uint8 h[32];
+		if (hashFile(path, h)) {
+			return Memory::create(h, 32);
+		}
+		return sl_null;
+	}
+
+}
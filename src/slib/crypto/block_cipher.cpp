@@ -17,9 +17,40 @@
 #include "../../../inc/slib/crypto/aes.h"
 #include "../../../inc/slib/crypto/blowfish.h"
 
+#include "../../../inc/slib/core/cpu.h"
+
+#if defined(SLIB_CPU_USE_SSE2)
+#	include <emmintrin.h>
+#endif
+#if defined(SLIB_CPU_USE_NEON)
+#	include <arm_neon.h>
+#endif
+
+// count of blocks passed to `encryptBlocks()` at once, so that the ciphers having parallel implementations (AES-NI, ARMv8 AES) can pipeline them
+#define BATCH_BLOCKS 8
+
 namespace slib
 {
 
+	static void _BlockCipher_xor(sl_uint8* output, const sl_uint8* input, const sl_uint8* mask, sl_size size)
+	{
+		sl_size i = 0;
+#if defined(SLIB_CPU_USE_SSE2)
+		for (; i + 16 <= size; i += 16) {
+			__m128i a = _mm_loadu_si128((__m128i const*)(input + i));
+			__m128i b = _mm_loadu_si128((__m128i const*)(mask + i));
+			_mm_storeu_si128((__m128i*)(output + i), _mm_xor_si128(a, b));
+		}
+#elif defined(SLIB_CPU_USE_NEON)
+		for (; i + 16 <= size; i += 16) {
+			vst1q_u8(output + i, veorq_u8(vld1q_u8(input + i), vld1q_u8(mask + i)));
+		}
+#endif
+		for (; i < size; i++) {
+			output[i] = input[i] ^ mask[i];
+		}
+	}
+
 /*
 				BlockCipherPadding_PKCS7
  
@@ -121,13 +152,13 @@ namespace slib
 			return 0;
 		}
 		sl_size n = size / block;
-		for (sl_size i = 0; i < n; i++) {
-			crypto->encryptBlock(src, dst);
-			src += block;
-			dst += block;
+		sl_size p = n * block;
+		if (n) {
+			crypto->encryptBlocks(src, dst, p);
+			src += p;
+			dst += p;
 		}
 		char last[256];
-		sl_size p = n * block;
 		sl_uint32 m = (sl_uint32)(size - p);
 		Base::copyMemory(last, src, m);
 		Padding::addPadding(last + m, block - m);
@@ -148,12 +179,11 @@ namespace slib
 		if (size % block != 0) {
 			return 0;
 		}
-		sl_size n = size / block;
-		for (sl_size i = 0; i < n; i++) {
-			crypto->decryptBlock(src, dst);
-			src += block;
-			dst += block;
+		if (!size) {
+			return 0;
 		}
+		crypto->decryptBlocks(src, dst, size);
+		dst += size;
 		sl_uint32 padding = Padding::removePadding(dst - block, block);
 		if (padding > 0) {
 			return size - padding;
@@ -242,19 +272,28 @@ namespace slib
 		if (size % block != 0) {
 			return 0;
 		}
-		sl_size n = size / block;
-		for (sl_size i = 0; i < n; i++) {
-			crypto->decryptBlock(src, dst);
-			for (sl_uint32 k = 0; k < block; k++) {
-				dst[k] ^= iv[k];
-			}
-			iv = src;
-			src += block;
-			dst += block;
+		if (!size) {
+			return 0;
+		}
+		sl_size total = size;
+		// the blocks can be deciphered in parallel, chaining only the XOR. The ciphertext is copied before deciphering so that `dst` may overlap `src`.
+		char chunk[BATCH_BLOCKS * 256];
+		char last[256];
+		Base::copyMemory(last, iv, block);
+		while (size) {
+			sl_size m = SLIB_MIN(size, (sl_size)(BATCH_BLOCKS * block));
+			Base::copyMemory(chunk, src, m);
+			crypto->decryptBlocks(chunk, dst, m);
+			_BlockCipher_xor((sl_uint8*)dst, (sl_uint8*)dst, (sl_uint8*)last, block);
+			_BlockCipher_xor((sl_uint8*)dst + block, (sl_uint8*)dst + block, (sl_uint8*)chunk, m - block);
+			Base::copyMemory(last, chunk + m - block, block);
+			src += m;
+			dst += m;
+			size -= m;
 		}
 		sl_uint32 padding = Padding::removePadding(dst - block, block);
 		if (padding > 0) {
-			return size - padding;
+			return total - padding;
 		} else {
 			return 0;
 		}
@@ -314,9 +353,7 @@ namespace slib
 			crypto->encryptBlock(counter, mask);
 			n = sizeBlock - offset;
 			if (size > n) {
-				for (i = 0; i < n; i++) {
-					output[i] = input[i] ^ mask[i + offset];
-				}
+				_BlockCipher_xor(output, input, mask + offset, n);
 				size -= n;
 				input += n;
 				output += n;
@@ -328,16 +365,27 @@ namespace slib
 				return size;
 			}
 		}
-		while (size > 0) {
-			crypto->encryptBlock(counter, mask);
-			n = SLIB_MIN(sizeBlock, size);
-			for (i = 0; i < n; i++) {
-				output[i] = input[i] ^ mask[i];
-			}
-			size -= n;
-			input += n;
-			output += n;
-			MIO::increaseBE(counter, sizeBlock);
+		if (size > 0) {
+			sl_uint8 counters[BATCH_BLOCKS * SLIB_CRYPTO_BLOCK_CIPHER_BLOCK_MAX_LEN];
+			sl_uint8 masks[BATCH_BLOCKS * SLIB_CRYPTO_BLOCK_CIPHER_BLOCK_MAX_LEN];
+			do {
+				sl_size nBlocks = (size + sizeBlock - 1) / sizeBlock;
+				if (nBlocks > BATCH_BLOCKS) {
+					nBlocks = BATCH_BLOCKS;
+				}
+				sl_uint8* c = counters;
+				for (i = 0; i < nBlocks; i++) {
+					Base::copyMemory(c, counter, sizeBlock);
+					MIO::increaseBE(counter, sizeBlock);
+					c += sizeBlock;
+				}
+				crypto->encryptBlocks(counters, masks, nBlocks * sizeBlock);
+				n = SLIB_MIN(nBlocks * sizeBlock, size);
+				_BlockCipher_xor(output, input, masks, n);
+				size -= n;
+				input += n;
+				output += n;
+			} while (size > 0);
 		}
 		return _size;
 	}
@@ -369,11 +417,13 @@ namespace slib
 	}
 
 
-#define DEFINE_BLOCKCIPHER(CLASS) \
+#define DEFINE_BLOCKCIPHER_BLOCKS(CLASS) \
 	sl_size CLASS::encryptBlocks(const void* src, void* dst, sl_size size) const \
 	{ return BlockCipher_Blocks<CLASS>::encryptBlocks(this, src, dst, size); } \
 	sl_size CLASS::decryptBlocks(const void* src, void* dst, sl_size size) const \
-	{ return BlockCipher_Blocks<CLASS>::decryptBlocks(this, src, dst, size); } \
+	{ return BlockCipher_Blocks<CLASS>::decryptBlocks(this, src, dst, size); }
+
+#define DEFINE_BLOCKCIPHER_MODES(CLASS) \
 	sl_size CLASS::encrypt_ECB_PKCS7Padding(const void* src, sl_size size, void* dst) const \
 	{ return BlockCipher_ECB<CLASS, BlockCipherPadding_PKCS7>::encrypt(this, src, size, dst); } \
 	sl_size CLASS::decrypt_ECB_PKCS7Padding(const void* src, sl_size size, void* dst) const \
@@ -401,7 +451,10 @@ namespace slib
 	sl_size CLASS::encrypt_CTR(const void* iv, sl_uint64 pos, const void* input, sl_size size, void* output) const \
 	{ return BlockCipher_CTR<CLASS>::encrypt(this, iv, pos, input, size, output); }
 
-	DEFINE_BLOCKCIPHER(AES);
-	DEFINE_BLOCKCIPHER(Blowfish);
+	// AES defines its own `encryptBlocks()` and `decryptBlocks()`, running the hardware instructions on multiple blocks
+	DEFINE_BLOCKCIPHER_MODES(AES);
+
+	DEFINE_BLOCKCIPHER_BLOCKS(Blowfish);
+	DEFINE_BLOCKCIPHER_MODES(Blowfish);
 
 }
@@ -0,0 +1,854 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "../../../inc/slib/crypto/chacha.h"
+
+#include "../../../inc/slib/crypto/sha2.h"
+#include "../../../inc/slib/core/mio.h"
+#include "../../../inc/slib/core/math.h"
+#include "../../../inc/slib/core/base.h"
+#include "../../../inc/slib/core/cpu.h"
+
+#if defined(SLIB_CPU_USE_X86_EXTENSIONS)
+#	include <immintrin.h>
+#	define CHACHA_SUPPORT_AVX2
+#endif
+
+#if defined(SLIB_CPU_USE_SSE2)
+#	include <emmintrin.h>
+#elif defined(SLIB_CPU_USE_NEON)
+#	include <arm_neon.h>
+#endif
+
+// the ciphertext is authenticated while it is still in the L1 cache
+#define CHACHA20_POLY1305_SEGMENT 4096
+
+// Poly1305 uses the vectorized blocks for 8 blocks or more
+#define POLY1305_VECTOR_MIN_BLOCKS 8
+
+namespace slib
+{
+
+#if defined(CHACHA_SUPPORT_AVX2)
+	static sl_bool _g_chacha_flagAVX2 = Cpu::isAVX2Supported();
+#endif
+
+/*
+	ChaCha20
+*/
+
+#define CHACHA_QUARTER_ROUND(a, b, c, d) \
+	a += b; d = Math::rotateLeft32(d ^ a, 16); \
+	c += d; b = Math::rotateLeft32(b ^ c, 12); \
+	a += b; d = Math::rotateLeft32(d ^ a, 8); \
+	c += d; b = Math::rotateLeft32(b ^ c, 7);
+
+	// the vector version works on the same word of all the blocks in the lanes
+#define CHACHA_VECTOR_QUARTER_ROUND(a, b, c, d, ADD, XOR, ROT16, ROT12, ROT8, ROT7) \
+	a = ADD(a, b); d = ROT16(XOR(d, a)); \
+	c = ADD(c, d); b = ROT12(XOR(b, c)); \
+	a = ADD(a, b); d = ROT8(XOR(d, a)); \
+	c = ADD(c, d); b = ROT7(XOR(b, c));
+
+#define CHACHA_VECTOR_DOUBLE_ROUND(x, ADD, XOR, ROT16, ROT12, ROT8, ROT7) \
+	CHACHA_VECTOR_QUARTER_ROUND(x[0], x[4], x[8], x[12], ADD, XOR, ROT16, ROT12, ROT8, ROT7) \
+	CHACHA_VECTOR_QUARTER_ROUND(x[1], x[5], x[9], x[13], ADD, XOR, ROT16, ROT12, ROT8, ROT7) \
+	CHACHA_VECTOR_QUARTER_ROUND(x[2], x[6], x[10], x[14], ADD, XOR, ROT16, ROT12, ROT8, ROT7) \
+	CHACHA_VECTOR_QUARTER_ROUND(x[3], x[7], x[11], x[15], ADD, XOR, ROT16, ROT12, ROT8, ROT7) \
+	CHACHA_VECTOR_QUARTER_ROUND(x[0], x[5], x[10], x[15], ADD, XOR, ROT16, ROT12, ROT8, ROT7) \
+	CHACHA_VECTOR_QUARTER_ROUND(x[1], x[6], x[11], x[12], ADD, XOR, ROT16, ROT12, ROT8, ROT7) \
+	CHACHA_VECTOR_QUARTER_ROUND(x[2], x[7], x[8], x[13], ADD, XOR, ROT16, ROT12, ROT8, ROT7) \
+	CHACHA_VECTOR_QUARTER_ROUND(x[3], x[4], x[9], x[14], ADD, XOR, ROT16, ROT12, ROT8, ROT7)
+
+	static void _ChaCha20_block(const sl_uint32 state[16], sl_uint8 out[64])
+	{
+		sl_uint32 x[16];
+		sl_uint32 i;
+		for (i = 0; i < 16; i++) {
+			x[i] = state[i];
+		}
+		for (i = 0; i < 10; i++) {
+			CHACHA_QUARTER_ROUND(x[0], x[4], x[8], x[12])
+			CHACHA_QUARTER_ROUND(x[1], x[5], x[9], x[13])
+			CHACHA_QUARTER_ROUND(x[2], x[6], x[10], x[14])
+			CHACHA_QUARTER_ROUND(x[3], x[7], x[11], x[15])
+			CHACHA_QUARTER_ROUND(x[0], x[5], x[10], x[15])
+			CHACHA_QUARTER_ROUND(x[1], x[6], x[11], x[12])
+			CHACHA_QUARTER_ROUND(x[2], x[7], x[8], x[13])
+			CHACHA_QUARTER_ROUND(x[3], x[4], x[9], x[14])
+		}
+		for (i = 0; i < 16; i++) {
+			MIO::writeUint32LE(out + (i << 2), x[i] + state[i]);
+		}
+	}
+
+	static void _ChaCha20_xor(sl_uint8* output, const sl_uint8* input, const sl_uint8* mask, sl_size size)
+	{
+		sl_size i = 0;
+#if defined(SLIB_CPU_USE_SSE2)
+		for (; i + 16 <= size; i += 16) {
+			__m128i a = _mm_loadu_si128((__m128i const*)(input + i));
+			__m128i b = _mm_loadu_si128((__m128i const*)(mask + i));
+			_mm_storeu_si128((__m128i*)(output + i), _mm_xor_si128(a, b));
+		}
+#elif defined(SLIB_CPU_USE_NEON)
+		for (; i + 16 <= size; i += 16) {
+			vst1q_u8(output + i, veorq_u8(vld1q_u8(input + i), vld1q_u8(mask + i)));
+		}
+#endif
+		for (; i < size; i++) {
+			output[i] = input[i] ^ mask[i];
+		}
+	}
+
+#if defined(CHACHA_SUPPORT_AVX2)
+
+#define CHACHA_AVX2_ADD(a, b) _mm256_add_epi32(a, b)
+#define CHACHA_AVX2_XOR(a, b) _mm256_xor_si256(a, b)
+#define CHACHA_AVX2_ROT16(x) _mm256_shuffle_epi8(x, _mm256_set_epi8(13, 12, 15, 14, 9, 8, 11, 10, 5, 4, 7, 6, 1, 0, 3, 2, 13, 12, 15, 14, 9, 8, 11, 10, 5, 4, 7, 6, 1, 0, 3, 2))
+#define CHACHA_AVX2_ROT8(x) _mm256_shuffle_epi8(x, _mm256_set_epi8(14, 13, 12, 15, 10, 9, 8, 11, 6, 5, 4, 7, 2, 1, 0, 3, 14, 13, 12, 15, 10, 9, 8, 11, 6, 5, 4, 7, 2, 1, 0, 3))
+#define CHACHA_AVX2_ROT12(x) _mm256_or_si256(_mm256_slli_epi32(x, 12), _mm256_srli_epi32(x, 20))
+#define CHACHA_AVX2_ROT7(x) _mm256_or_si256(_mm256_slli_epi32(x, 7), _mm256_srli_epi32(x, 25))
+
+	// 8 blocks, counter: state[12] ~ state[12] + 7
+	SLIB_CPU_TARGET("avx2") static void _ChaCha20_xor8_AVX2(const sl_uint32 state[16], const sl_uint8* src, sl_uint8* dst)
+	{
+		__m256i s[16];
+		__m256i x[16];
+		sl_uint32 i;
+		for (i = 0; i < 16; i++) {
+			s[i] = _mm256_set1_epi32((int)(state[i]));
+		}
+		s[12] = _mm256_add_epi32(s[12], _mm256_set_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+		for (i = 0; i < 16; i++) {
+			x[i] = s[i];
+		}
+		for (i = 0; i < 10; i++) {
+			CHACHA_VECTOR_DOUBLE_ROUND(x, CHACHA_AVX2_ADD, CHACHA_AVX2_XOR, CHACHA_AVX2_ROT16, CHACHA_AVX2_ROT12, CHACHA_AVX2_ROT8, CHACHA_AVX2_ROT7)
+		}
+		for (i = 0; i < 16; i++) {
+			x[i] = _mm256_add_epi32(x[i], s[i]);
+		}
+		// 4x4 transposes in the 128-bit lanes: y[g][k] has the words 4g~4g+3 of the block k (low lane) and k+4 (high lane)
+		__m256i y[4][4];
+		for (i = 0; i < 4; i++) {
+			__m256i t0 = _mm256_unpacklo_epi32(x[4 * i], x[4 * i + 1]);
+			__m256i t1 = _mm256_unpackhi_epi32(x[4 * i], x[4 * i + 1]);
+			__m256i t2 = _mm256_unpacklo_epi32(x[4 * i + 2], x[4 * i + 3]);
+			__m256i t3 = _mm256_unpackhi_epi32(x[4 * i + 2], x[4 * i + 3]);
+			y[i][0] = _mm256_unpacklo_epi64(t0, t2);
+			y[i][1] = _mm256_unpackhi_epi64(t0, t2);
+			y[i][2] = _mm256_unpacklo_epi64(t1, t3);
+			y[i][3] = _mm256_unpackhi_epi64(t1, t3);
+		}
+		for (i = 0; i < 4; i++) {
+			const sl_uint8* p = src + (i << 6);
+			sl_uint8* q = dst + (i << 6);
+			_mm256_storeu_si256((__m256i*)q, _mm256_xor_si256(_mm256_loadu_si256((__m256i const*)p), _mm256_permute2x128_si256(y[0][i], y[1][i], 0x20)));
+			_mm256_storeu_si256((__m256i*)(q + 32), _mm256_xor_si256(_mm256_loadu_si256((__m256i const*)(p + 32)), _mm256_permute2x128_si256(y[2][i], y[3][i], 0x20)));
+			p += 256;
+			q += 256;
+			_mm256_storeu_si256((__m256i*)q, _mm256_xor_si256(_mm256_loadu_si256((__m256i const*)p), _mm256_permute2x128_si256(y[0][i], y[1][i], 0x31)));
+			_mm256_storeu_si256((__m256i*)(q + 32), _mm256_xor_si256(_mm256_loadu_si256((__m256i const*)(p + 32)), _mm256_permute2x128_si256(y[2][i], y[3][i], 0x31)));
+		}
+	}
+
+#endif
+
+#if defined(SLIB_CPU_USE_SSE2)
+
+#define CHACHA_SSE2_ADD(a, b) _mm_add_epi32(a, b)
+#define CHACHA_SSE2_XOR(a, b) _mm_xor_si128(a, b)
+#define CHACHA_SSE2_ROT(x, n) _mm_or_si128(_mm_slli_epi32(x, n), _mm_srli_epi32(x, 32 - (n)))
+#define CHACHA_SSE2_ROT16(x) _mm_shufflehi_epi16(_mm_shufflelo_epi16(x, 0xB1), 0xB1)
+#define CHACHA_SSE2_ROT12(x) CHACHA_SSE2_ROT(x, 12)
+#define CHACHA_SSE2_ROT8(x) CHACHA_SSE2_ROT(x, 8)
+#define CHACHA_SSE2_ROT7(x) CHACHA_SSE2_ROT(x, 7)
+
+	// 4 blocks, counter: state[12] ~ state[12] + 3
+	static void _ChaCha20_xor4_SIMD(const sl_uint32 state[16], const sl_uint8* src, sl_uint8* dst)
+	{
+		__m128i s[16];
+		__m128i x[16];
+		sl_uint32 i;
+		for (i = 0; i < 16; i++) {
+			s[i] = _mm_set1_epi32((int)(state[i]));
+		}
+		s[12] = _mm_add_epi32(s[12], _mm_set_epi32(3, 2, 1, 0));
+		for (i = 0; i < 16; i++) {
+			x[i] = s[i];
+		}
+		for (i = 0; i < 10; i++) {
+			CHACHA_VECTOR_DOUBLE_ROUND(x, CHACHA_SSE2_ADD, CHACHA_SSE2_XOR, CHACHA_SSE2_ROT16, CHACHA_SSE2_ROT12, CHACHA_SSE2_ROT8, CHACHA_SSE2_ROT7)
+		}
+		for (i = 0; i < 4; i++) {
+			__m128i a0 = _mm_add_epi32(x[4 * i], s[4 * i]);
+			__m128i a1 = _mm_add_epi32(x[4 * i + 1], s[4 * i + 1]);
+			__m128i a2 = _mm_add_epi32(x[4 * i + 2], s[4 * i + 2]);
+			__m128i a3 = _mm_add_epi32(x[4 * i + 3], s[4 * i + 3]);
+			__m128i t0 = _mm_unpacklo_epi32(a0, a1);
+			__m128i t1 = _mm_unpackhi_epi32(a0, a1);
+			__m128i t2 = _mm_unpacklo_epi32(a2, a3);
+			__m128i t3 = _mm_unpackhi_epi32(a2, a3);
+			__m128i b[4];
+			b[0] = _mm_unpacklo_epi64(t0, t2);
+			b[1] = _mm_unpackhi_epi64(t0, t2);
+			b[2] = _mm_unpacklo_epi64(t1, t3);
+			b[3] = _mm_unpackhi_epi64(t1, t3);
+			for (sl_uint32 k = 0; k < 4; k++) {
+				sl_size offset = (k << 6) + (i << 4);
+				_mm_storeu_si128((__m128i*)(dst + offset), _mm_xor_si128(_mm_loadu_si128((__m128i const*)(src + offset)), b[k]));
+			}
+		}
+	}
+
+#	define CHACHA_SUPPORT_SIMD4
+
+#elif defined(SLIB_CPU_USE_NEON)
+
+#define CHACHA_NEON_ADD(a, b) vaddq_u32(a, b)
+#define CHACHA_NEON_XOR(a, b) veorq_u32(a, b)
+#define CHACHA_NEON_ROT(x, n) vsriq_n_u32(vshlq_n_u32(x, n), x, 32 - (n))
+#define CHACHA_NEON_ROT16(x) vreinterpretq_u32_u16(vrev32q_u16(vreinterpretq_u16_u32(x)))
+#define CHACHA_NEON_ROT12(x) CHACHA_NEON_ROT(x, 12)
+#define CHACHA_NEON_ROT8(x) CHACHA_NEON_ROT(x, 8)
+#define CHACHA_NEON_ROT7(x) CHACHA_NEON_ROT(x, 7)
+
+	// 4 blocks, counter: state[12] ~ state[12] + 3
+	static void _ChaCha20_xor4_SIMD(const sl_uint32 state[16], const sl_uint8* src, sl_uint8* dst)
+	{
+		static const sl_uint32 increments[4] = { 0, 1, 2, 3 };
+		uint32x4_t s[16];
+		uint32x4_t x[16];
+		sl_uint32 i;
+		for (i = 0; i < 16; i++) {
+			s[i] = vdupq_n_u32(state[i]);
+		}
+		s[12] = vaddq_u32(s[12], vld1q_u32(increments));
+		for (i = 0; i < 16; i++) {
+			x[i] = s[i];
+		}
+		for (i = 0; i < 10; i++) {
+			CHACHA_VECTOR_DOUBLE_ROUND(x, CHACHA_NEON_ADD, CHACHA_NEON_XOR, CHACHA_NEON_ROT16, CHACHA_NEON_ROT12, CHACHA_NEON_ROT8, CHACHA_NEON_ROT7)
+		}
+		for (i = 0; i < 4; i++) {
+			uint32x4x2_t t01 = vtrnq_u32(vaddq_u32(x[4 * i], s[4 * i]), vaddq_u32(x[4 * i + 1], s[4 * i + 1]));
+			uint32x4x2_t t23 = vtrnq_u32(vaddq_u32(x[4 * i + 2], s[4 * i + 2]), vaddq_u32(x[4 * i + 3], s[4 * i + 3]));
+			uint32x4_t b[4];
+			b[0] = vcombine_u32(vget_low_u32(t01.val[0]), vget_low_u32(t23.val[0]));
+			b[1] = vcombine_u32(vget_low_u32(t01.val[1]), vget_low_u32(t23.val[1]));
+			b[2] = vcombine_u32(vget_high_u32(t01.val[0]), vget_high_u32(t23.val[0]));
+			b[3] = vcombine_u32(vget_high_u32(t01.val[1]), vget_high_u32(t23.val[1]));
+			for (sl_uint32 k = 0; k < 4; k++) {
+				sl_size offset = (k << 6) + (i << 4);
+				vst1q_u8(dst + offset, veorq_u8(vld1q_u8(src + offset), vreinterpretq_u8_u32(b[k])));
+			}
+		}
+	}
+
+#	define CHACHA_SUPPORT_SIMD4
+
+#endif
+
+	static const sl_uint8 _ChaCha20_zeros[256] = { 0 };
+
+	// XORs the key stream of `nBlocks` blocks, increasing the counter
+	static void _ChaCha20_xorBlocks(sl_uint32 state[16], const sl_uint8* src, sl_uint8* dst, sl_size nBlocks)
+	{
+#if defined(CHACHA_SUPPORT_AVX2)
+		if (_g_chacha_flagAVX2) {
+			while (nBlocks >= 8) {
+				_ChaCha20_xor8_AVX2(state, src, dst);
+				state[12] += 8;
+				src += 512;
+				dst += 512;
+				nBlocks -= 8;
+			}
+		}
+#endif
+#if defined(CHACHA_SUPPORT_SIMD4)
+		while (nBlocks >= 4) {
+			_ChaCha20_xor4_SIMD(state, src, dst);
+			state[12] += 4;
+			src += 256;
+			dst += 256;
+			nBlocks -= 4;
+		}
+#endif
+		sl_uint8 block[64];
+		while (nBlocks) {
+			_ChaCha20_block(state, block);
+			_ChaCha20_xor(dst, src, block, 64);
+			state[12]++;
+			src += 64;
+			dst += 64;
+			nBlocks--;
+		}
+	}
+
+	// generates the key stream of the next blocks (4 blocks by SIMD, costing about the same as 1 or 2 blocks of the scalar version), returns the size
+	static sl_uint32 _ChaCha20_generateKeyStream(sl_uint32 state[16], sl_uint8 out[256])
+	{
+#if defined(CHACHA_SUPPORT_SIMD4)
+		_ChaCha20_xor4_SIMD(state, _ChaCha20_zeros, out);
+		state[12] += 4;
+		return 256;
+#else
+		_ChaCha20_block(state, out);
+		state[12]++;
+		return 64;
+#endif
+	}
+
+	ChaCha20::ChaCha20()
+	{
+		Base::zeroMemory(m_state, sizeof(m_state));
+		m_posKeyStream = 0;
+		m_sizeKeyStream = 0;
+	}
+
+	ChaCha20::~ChaCha20()
+	{
+	}
+
+	void ChaCha20::setKey(const void* _key)
+	{
+		const sl_uint8* key = (const sl_uint8*)_key;
+		// "expand 32-byte k"
+		m_state[0] = 0x61707865;
+		m_state[1] = 0x3320646e;
+		m_state[2] = 0x79622d32;
+		m_state[3] = 0x6b206574;
+		for (sl_uint32 i = 0; i < 8; i++) {
+			m_state[4 + i] = MIO::readUint32LE(key + (i << 2));
+		}
+		m_posKeyStream = 0;
+		m_sizeKeyStream = 0;
+	}
+
+	void ChaCha20::start(const void* _nonce, sl_uint32 counter)
+	{
+		const sl_uint8* nonce = (const sl_uint8*)_nonce;
+		m_state[12] = counter;
+		m_state[13] = MIO::readUint32LE(nonce);
+		m_state[14] = MIO::readUint32LE(nonce + 4);
+		m_state[15] = MIO::readUint32LE(nonce + 8);
+		m_posKeyStream = 0;
+		m_sizeKeyStream = 0;
+	}
+
+	void ChaCha20::encrypt(const void* _src, void* _dst, sl_size len)
+	{
+		const sl_uint8* src = (const sl_uint8*)_src;
+		sl_uint8* dst = (sl_uint8*)_dst;
+		for (;;) {
+			if (m_posKeyStream < m_sizeKeyStream) {
+				sl_size n = m_sizeKeyStream - m_posKeyStream;
+				if (n > len) {
+					n = len;
+				}
+				_ChaCha20_xor(dst, src, m_keyStream + m_posKeyStream, n);
+				m_posKeyStream += (sl_uint32)n;
+				src += n;
+				dst += n;
+				len -= n;
+			}
+			if (!len) {
+				return;
+			}
+			// the remaining blocks less than the count of the SIMD blocks are taken from the generated key stream
+			sl_size nBlocks = len >> 6;
+#if defined(CHACHA_SUPPORT_SIMD4)
+			nBlocks &= ~((sl_size)3);
+#endif
+			if (nBlocks) {
+				_ChaCha20_xorBlocks(m_state, src, dst, nBlocks);
+				src += nBlocks << 6;
+				dst += nBlocks << 6;
+				len -= nBlocks << 6;
+				if (!len) {
+					return;
+				}
+			}
+			m_sizeKeyStream = _ChaCha20_generateKeyStream(m_state, m_keyStream);
+			m_posKeyStream = 0;
+		}
+	}
+
+	void ChaCha20::decrypt(const void* src, void* dst, sl_size len)
+	{
+		encrypt(src, dst, len);
+	}
+
+/*
+	Poly1305
+
+	The accumulator and the key are kept in 5 limbs of 26 bits, so that the products fit in 64 bits
+	(poly1305-donna, https://github.com/floodyberry/poly1305-donna).
+	The vectorized version evaluates 4 interleaved polynomials of r^4, one in each lane:
+		h = (h + M0) * r^4 + M1 * r^3 + M2 * r^2 + M3 * r for every 4 blocks,
+	multiplying the lanes by (r^4, r^3, r^2, r) for the last 4 blocks instead of r^4.
+*/
+
+#define POLY1305_MASK26 0x3ffffff
+
+	// h = h * r mod (2^130 - 5), partially reduced
+	static void _Poly1305_multiply(sl_uint32 h[5], const sl_uint32 r[5])
+	{
+		sl_uint32 r0 = r[0], r1 = r[1], r2 = r[2], r3 = r[3], r4 = r[4];
+		sl_uint32 s1 = r1 * 5, s2 = r2 * 5, s3 = r3 * 5, s4 = r4 * 5;
+		sl_uint32 h0 = h[0], h1 = h[1], h2 = h[2], h3 = h[3], h4 = h[4];
+		sl_uint64 d0 = (sl_uint64)h0 * r0 + (sl_uint64)h1 * s4 + (sl_uint64)h2 * s3 + (sl_uint64)h3 * s2 + (sl_uint64)h4 * s1;
+		sl_uint64 d1 = (sl_uint64)h0 * r1 + (sl_uint64)h1 * r0 + (sl_uint64)h2 * s4 + (sl_uint64)h3 * s3 + (sl_uint64)h4 * s2;
+		sl_uint64 d2 = (sl_uint64)h0 * r2 + (sl_uint64)h1 * r1 + (sl_uint64)h2 * r0 + (sl_uint64)h3 * s4 + (sl_uint64)h4 * s3;
+		sl_uint64 d3 = (sl_uint64)h0 * r3 + (sl_uint64)h1 * r2 + (sl_uint64)h2 * r1 + (sl_uint64)h3 * r0 + (sl_uint64)h4 * s4;
+		sl_uint64 d4 = (sl_uint64)h0 * r4 + (sl_uint64)h1 * r3 + (sl_uint64)h2 * r2 + (sl_uint64)h3 * r1 + (sl_uint64)h4 * r0;
+		sl_uint32 c;
+		c = (sl_uint32)(d0 >> 26); h0 = (sl_uint32)d0 & POLY1305_MASK26;
+		d1 += c; c = (sl_uint32)(d1 >> 26); h1 = (sl_uint32)d1 & POLY1305_MASK26;
+		d2 += c; c = (sl_uint32)(d2 >> 26); h2 = (sl_uint32)d2 & POLY1305_MASK26;
+		d3 += c; c = (sl_uint32)(d3 >> 26); h3 = (sl_uint32)d3 & POLY1305_MASK26;
+		d4 += c; c = (sl_uint32)(d4 >> 26); h4 = (sl_uint32)d4 & POLY1305_MASK26;
+		h0 += c * 5; c = h0 >> 26; h0 &= POLY1305_MASK26;
+		h1 += c;
+		h[0] = h0;
+		h[1] = h1;
+		h[2] = h2;
+		h[3] = h3;
+		h[4] = h4;
+	}
+
+	// `hibit` is 2^128 in the limb 4, and is zero for the padded last block
+	static void _Poly1305_blocks(sl_uint32 h[5], const sl_uint32 r[5], const sl_uint8* m, sl_size nBlocks, sl_uint32 hibit)
+	{
+		while (nBlocks) {
+			h[0] += MIO::readUint32LE(m) & POLY1305_MASK26;
+			h[1] += (MIO::readUint32LE(m + 3) >> 2) & POLY1305_MASK26;
+			h[2] += (MIO::readUint32LE(m + 6) >> 4) & POLY1305_MASK26;
+			h[3] += (MIO::readUint32LE(m + 9) >> 6) & POLY1305_MASK26;
+			h[4] += (MIO::readUint32LE(m + 12) >> 8) | hibit;
+			_Poly1305_multiply(h, r);
+			m += 16;
+			nBlocks--;
+		}
+	}
+
+#if defined(CHACHA_SUPPORT_AVX2)
+
+#define POLY1305_AVX2_MUL(a, b) _mm256_mul_epu32(a, b)
+
+	// processes nChunks * 4 full blocks
+	SLIB_CPU_TARGET("avx2") static void _Poly1305_blocks4_AVX2(sl_uint32 h[5], const sl_uint32 r[5], const sl_uint32 rPowers[3][5], const sl_uint8* m, sl_size nChunks)
+	{
+		const __m256i mask = _mm256_set1_epi64x(POLY1305_MASK26);
+		const __m256i hibit = _mm256_set1_epi64x(1 << 24);
+		const sl_uint32* r4 = rPowers[2];
+		__m256i R[5], S[5], RL[5], SL[5];
+		sl_uint32 i;
+		for (i = 0; i < 5; i++) {
+			R[i] = _mm256_set1_epi64x(r4[i]);
+			S[i] = _mm256_set1_epi64x(r4[i] * 5);
+			RL[i] = _mm256_set_epi64x(r[i], rPowers[0][i], rPowers[1][i], r4[i]);
+			SL[i] = _mm256_set_epi64x(r[i] * 5, rPowers[0][i] * 5, rPowers[1][i] * 5, r4[i] * 5);
+		}
+		__m256i H[5];
+		for (i = 0; i < 5; i++) {
+			H[i] = _mm256_set_epi64x(0, 0, 0, h[i]);
+		}
+		while (nChunks) {
+			__m256i v0 = _mm256_loadu_si256((__m256i const*)m);
+			__m256i v1 = _mm256_loadu_si256((__m256i const*)(m + 32));
+			// low and high 64 bits of the blocks 0~3
+			__m256i lo = _mm256_permute4x64_epi64(_mm256_unpacklo_epi64(v0, v1), 0xD8);
+			__m256i hi = _mm256_permute4x64_epi64(_mm256_unpackhi_epi64(v0, v1), 0xD8);
+			H[0] = _mm256_add_epi64(H[0], _mm256_and_si256(lo, mask));
+			H[1] = _mm256_add_epi64(H[1], _mm256_and_si256(_mm256_srli_epi64(lo, 26), mask));
+			H[2] = _mm256_add_epi64(H[2], _mm256_and_si256(_mm256_or_si256(_mm256_srli_epi64(lo, 52), _mm256_slli_epi64(hi, 12)), mask));
+			H[3] = _mm256_add_epi64(H[3], _mm256_and_si256(_mm256_srli_epi64(hi, 14), mask));
+			H[4] = _mm256_add_epi64(H[4], _mm256_or_si256(_mm256_srli_epi64(hi, 40), hibit));
+			// (r^4, r^3, r^2, r) for the last 4 blocks
+			const __m256i* pr = nChunks == 1 ? RL : R;
+			const __m256i* ps = nChunks == 1 ? SL : S;
+			__m256i d0 = POLY1305_AVX2_MUL(H[0], pr[0]);
+			d0 = _mm256_add_epi64(d0, POLY1305_AVX2_MUL(H[1], ps[4]));
+			d0 = _mm256_add_epi64(d0, POLY1305_AVX2_MUL(H[2], ps[3]));
+			d0 = _mm256_add_epi64(d0, POLY1305_AVX2_MUL(H[3], ps[2]));
+			d0 = _mm256_add_epi64(d0, POLY1305_AVX2_MUL(H[4], ps[1]));
+			__m256i d1 = POLY1305_AVX2_MUL(H[0], pr[1]);
+			d1 = _mm256_add_epi64(d1, POLY1305_AVX2_MUL(H[1], pr[0]));
+			d1 = _mm256_add_epi64(d1, POLY1305_AVX2_MUL(H[2], ps[4]));
+			d1 = _mm256_add_epi64(d1, POLY1305_AVX2_MUL(H[3], ps[3]));
+			d1 = _mm256_add_epi64(d1, POLY1305_AVX2_MUL(H[4], ps[2]));
+			__m256i d2 = POLY1305_AVX2_MUL(H[0], pr[2]);
+			d2 = _mm256_add_epi64(d2, POLY1305_AVX2_MUL(H[1], pr[1]));
+			d2 = _mm256_add_epi64(d2, POLY1305_AVX2_MUL(H[2], pr[0]));
+			d2 = _mm256_add_epi64(d2, POLY1305_AVX2_MUL(H[3], ps[4]));
+			d2 = _mm256_add_epi64(d2, POLY1305_AVX2_MUL(H[4], ps[3]));
+			__m256i d3 = POLY1305_AVX2_MUL(H[0], pr[3]);
+			d3 = _mm256_add_epi64(d3, POLY1305_AVX2_MUL(H[1], pr[2]));
+			d3 = _mm256_add_epi64(d3, POLY1305_AVX2_MUL(H[2], pr[1]));
+			d3 = _mm256_add_epi64(d3, POLY1305_AVX2_MUL(H[3], pr[0]));
+			d3 = _mm256_add_epi64(d3, POLY1305_AVX2_MUL(H[4], ps[4]));
+			__m256i d4 = POLY1305_AVX2_MUL(H[0], pr[4]);
+			d4 = _mm256_add_epi64(d4, POLY1305_AVX2_MUL(H[1], pr[3]));
+			d4 = _mm256_add_epi64(d4, POLY1305_AVX2_MUL(H[2], pr[2]));
+			d4 = _mm256_add_epi64(d4, POLY1305_AVX2_MUL(H[3], pr[1]));
+			d4 = _mm256_add_epi64(d4, POLY1305_AVX2_MUL(H[4], pr[0]));
+			__m256i c;
+			c = _mm256_srli_epi64(d0, 26); H[0] = _mm256_and_si256(d0, mask);
+			d1 = _mm256_add_epi64(d1, c); c = _mm256_srli_epi64(d1, 26); H[1] = _mm256_and_si256(d1, mask);
+			d2 = _mm256_add_epi64(d2, c); c = _mm256_srli_epi64(d2, 26); H[2] = _mm256_and_si256(d2, mask);
+			d3 = _mm256_add_epi64(d3, c); c = _mm256_srli_epi64(d3, 26); H[3] = _mm256_and_si256(d3, mask);
+			d4 = _mm256_add_epi64(d4, c); c = _mm256_srli_epi64(d4, 26); H[4] = _mm256_and_si256(d4, mask);
+			H[0] = _mm256_add_epi64(H[0], _mm256_add_epi64(c, _mm256_slli_epi64(c, 2)));
+			c = _mm256_srli_epi64(H[0], 26); H[0] = _mm256_and_si256(H[0], mask);
+			H[1] = _mm256_add_epi64(H[1], c);
+			m += 64;
+			nChunks--;
+		}
+		// sums the lanes
+		sl_uint64 d[5];
+		for (i = 0; i < 5; i++) {
+			SLIB_ALIGN(32) sl_uint64 lanes[4];
+			_mm256_store_si256((__m256i*)lanes, H[i]);
+			d[i] = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+		}
+		sl_uint64 c;
+		c = d[0] >> 26; h[0] = (sl_uint32)d[0] & POLY1305_MASK26;
+		d[1] += c; c = d[1] >> 26; h[1] = (sl_uint32)d[1] & POLY1305_MASK26;
+		d[2] += c; c = d[2] >> 26; h[2] = (sl_uint32)d[2] & POLY1305_MASK26;
+		d[3] += c; c = d[3] >> 26; h[3] = (sl_uint32)d[3] & POLY1305_MASK26;
+		d[4] += c; c = d[4] >> 26; h[4] = (sl_uint32)d[4] & POLY1305_MASK26;
+		h[0] += (sl_uint32)c * 5; c = h[0] >> 26; h[0] &= POLY1305_MASK26;
+		h[1] += (sl_uint32)c;
+	}
+
+#endif
+
+	Poly1305::Poly1305()
+	{
+	}
+
+	Poly1305::~Poly1305()
+	{
+	}
+
+	void Poly1305::start(const void* _key)
+	{
+		const sl_uint8* key = (const sl_uint8*)_key;
+		// r &= 0xffffffc0ffffffc0ffffffc0fffffff
+		m_r[0] = MIO::readUint32LE(key) & 0x3ffffff;
+		m_r[1] = (MIO::readUint32LE(key + 3) >> 2) & 0x3ffff03;
+		m_r[2] = (MIO::readUint32LE(key + 6) >> 4) & 0x3ffc0ff;
+		m_r[3] = (MIO::readUint32LE(key + 9) >> 6) & 0x3f03fff;
+		m_r[4] = (MIO::readUint32LE(key + 12) >> 8) & 0x00fffff;
+		sl_uint32 i;
+		for (i = 0; i < 5; i++) {
+			m_h[i] = 0;
+		}
+		for (i = 0; i < 4; i++) {
+			m_pad[i] = MIO::readUint32LE(key + 16 + (i << 2));
+		}
+		m_flagPowers = sl_false;
+		m_lenBuffer = 0;
+	}
+
+	void Poly1305::_processBlocks(const sl_uint8* data, sl_size nBlocks, sl_uint32 hibit)
+	{
+#if defined(CHACHA_SUPPORT_AVX2)
+		if (_g_chacha_flagAVX2 && hibit && nBlocks >= POLY1305_VECTOR_MIN_BLOCKS) {
+			if (!m_flagPowers) {
+				Base::copyMemory(m_rPowers[0], m_r, sizeof(m_r));
+				_Poly1305_multiply(m_rPowers[0], m_r);
+				Base::copyMemory(m_rPowers[1], m_rPowers[0], sizeof(m_r));
+				_Poly1305_multiply(m_rPowers[1], m_r);
+				Base::copyMemory(m_rPowers[2], m_rPowers[1], sizeof(m_r));
+				_Poly1305_multiply(m_rPowers[2], m_r);
+				m_flagPowers = sl_true;
+			}
+			sl_size nChunks = nBlocks >> 2;
+			_Poly1305_blocks4_AVX2(m_h, m_r, m_rPowers, data, nChunks);
+			data += nChunks << 6;
+			nBlocks &= 3;
+		}
+#endif
+		_Poly1305_blocks(m_h, m_r, data, nBlocks, hibit);
+	}
+
+	void Poly1305::update(const void* _input, sl_size n)
+	{
+		const sl_uint8* input = (const sl_uint8*)_input;
+		if (m_lenBuffer) {
+			sl_size k = 16 - m_lenBuffer;
+			if (k > n) {
+				k = n;
+			}
+			Base::copyMemory(m_buffer + m_lenBuffer, input, k);
+			m_lenBuffer += (sl_uint32)k;
+			input += k;
+			n -= k;
+			if (m_lenBuffer < 16) {
+				return;
+			}
+			_processBlocks(m_buffer, 1, 1 << 24);
+			m_lenBuffer = 0;
+		}
+		sl_size nBlocks = n >> 4;
+		if (nBlocks) {
+			_processBlocks(input, nBlocks, 1 << 24);
+			input += nBlocks << 4;
+			n &= 15;
+		}
+		if (n) {
+			Base::copyMemory(m_buffer, input, n);
+			m_lenBuffer = (sl_uint32)n;
+		}
+	}
+
+	void Poly1305::finish(void* _output)
+	{
+		sl_uint8* output = (sl_uint8*)_output;
+		if (m_lenBuffer) {
+			m_buffer[m_lenBuffer] = 1;
+			Base::zeroMemory(m_buffer + m_lenBuffer + 1, 15 - m_lenBuffer);
+			_processBlocks(m_buffer, 1, 0);
+			m_lenBuffer = 0;
+		}
+		sl_uint32 h0 = m_h[0], h1 = m_h[1], h2 = m_h[2], h3 = m_h[3], h4 = m_h[4];
+		sl_uint32 c;
+		// fully carry h
+		c = h1 >> 26; h1 &= POLY1305_MASK26;
+		h2 += c; c = h2 >> 26; h2 &= POLY1305_MASK26;
+		h3 += c; c = h3 >> 26; h3 &= POLY1305_MASK26;
+		h4 += c; c = h4 >> 26; h4 &= POLY1305_MASK26;
+		h0 += c * 5; c = h0 >> 26; h0 &= POLY1305_MASK26;
+		h1 += c;
+		// g = h + -p
+		sl_uint32 g0 = h0 + 5; c = g0 >> 26; g0 &= POLY1305_MASK26;
+		sl_uint32 g1 = h1 + c; c = g1 >> 26; g1 &= POLY1305_MASK26;
+		sl_uint32 g2 = h2 + c; c = g2 >> 26; g2 &= POLY1305_MASK26;
+		sl_uint32 g3 = h3 + c; c = g3 >> 26; g3 &= POLY1305_MASK26;
+		sl_uint32 g4 = h4 + c - (1 << 26);
+		// selects h if h < p, or g if h >= p
+		sl_uint32 mask = (g4 >> 31) - 1;
+		g0 &= mask; g1 &= mask; g2 &= mask; g3 &= mask; g4 &= mask;
+		mask = ~mask;
+		h0 = (h0 & mask) | g0;
+		h1 = (h1 & mask) | g1;
+		h2 = (h2 & mask) | g2;
+		h3 = (h3 & mask) | g3;
+		h4 = (h4 & mask) | g4;
+		// h = h % 2^128
+		h0 = (h0 | (h1 << 26));
+		h1 = ((h1 >> 6) | (h2 << 20));
+		h2 = ((h2 >> 12) | (h3 << 14));
+		h3 = ((h3 >> 18) | (h4 << 8));
+		// tag = (h + pad) % 2^128
+		sl_uint64 f;
+		f = (sl_uint64)h0 + m_pad[0]; h0 = (sl_uint32)f;
+		f = (sl_uint64)h1 + m_pad[1] + (f >> 32); h1 = (sl_uint32)f;
+		f = (sl_uint64)h2 + m_pad[2] + (f >> 32); h2 = (sl_uint32)f;
+		f = (sl_uint64)h3 + m_pad[3] + (f >> 32); h3 = (sl_uint32)f;
+		MIO::writeUint32LE(output, h0);
+		MIO::writeUint32LE(output + 4, h1);
+		MIO::writeUint32LE(output + 8, h2);
+		MIO::writeUint32LE(output + 12, h3);
+	}
+
+	void Poly1305::execute(const void* key, const void* input, sl_size n, void* output)
+	{
+		Poly1305 poly;
+		poly.start(key);
+		poly.update(input, n);
+		poly.finish(output);
+	}
+
+/*
+	ChaCha20-Poly1305 (RFC 8439, Section 2.8)
+*/
+
+	ChaCha20_Poly1305::ChaCha20_Poly1305()
+	{
+		m_lenA = 0;
+		m_lenC = 0;
+		m_flagPaddedA = sl_false;
+	}
+
+	ChaCha20_Poly1305::~ChaCha20_Poly1305()
+	{
+	}
+
+	void ChaCha20_Poly1305::setKey(const void* key)
+	{
+		m_cipher.setKey(key);
+	}
+
+	void ChaCha20_Poly1305::setKey_SHA256(const String& key)
+	{
+		char sig[32];
+		SHA256::hash(key, sig);
+		setKey(sig);
+	}
+
+	sl_bool ChaCha20_Poly1305::start(const void* IV, sl_size lenIV)
+	{
+		if (lenIV != 12) {
+			return sl_false;
+		}
+		// one-time Poly1305 key from the block 0, and the data from the block 1
+		m_cipher.start(IV, 0);
+		sl_uint8 block[64];
+		m_cipher.encrypt(_ChaCha20_zeros, block, 64);
+		m_auth.start(block);
+		Base::zeroMemory(block, 64);
+		m_lenA = 0;
+		m_lenC = 0;
+		m_flagPaddedA = sl_false;
+		return sl_true;
+	}
+
+	void ChaCha20_Poly1305::put(const void* A, sl_size lenA)
+	{
+		m_auth.update(A, lenA);
+		m_lenA += lenA;
+	}
+
+	void ChaCha20_Poly1305::_padAuthData()
+	{
+		if (!m_flagPaddedA) {
+			m_auth.update(_ChaCha20_zeros, (16 - (sl_uint32)(m_lenA & 15)) & 15);
+			m_flagPaddedA = sl_true;
+		}
+	}
+
+	void ChaCha20_Poly1305::encrypt(const void* src, void* dst, sl_size len)
+	{
+		_padAuthData();
+		const sl_uint8* P = (const sl_uint8*)src;
+		sl_uint8* C = (sl_uint8*)dst;
+		m_lenC += len;
+		while (len) {
+			sl_size n = len;
+			if (n > CHACHA20_POLY1305_SEGMENT) {
+				n = CHACHA20_POLY1305_SEGMENT;
+			}
+			m_cipher.encrypt(P, C, n);
+			m_auth.update(C, n);
+			P += n;
+			C += n;
+			len -= n;
+		}
+	}
+
+	void ChaCha20_Poly1305::decrypt(const void* src, void* dst, sl_size len)
+	{
+		_padAuthData();
+		const sl_uint8* C = (const sl_uint8*)src;
+		sl_uint8* P = (sl_uint8*)dst;
+		m_lenC += len;
+		while (len) {
+			sl_size n = len;
+			if (n > CHACHA20_POLY1305_SEGMENT) {
+				n = CHACHA20_POLY1305_SEGMENT;
+			}
+			// authenticates the ciphertext before writing the plaintext, so that `dst` may be equal to `src`
+			m_auth.update(C, n);
+			m_cipher.decrypt(C, P, n);
+			C += n;
+			P += n;
+			len -= n;
+		}
+	}
+
+	void ChaCha20_Poly1305::_finishAuth(sl_uint8* tag)
+	{
+		_padAuthData();
+		m_auth.update(_ChaCha20_zeros, (16 - (sl_uint32)(m_lenC & 15)) & 15);
+		sl_uint8 lengths[16];
+		MIO::writeUint64LE(lengths, m_lenA);
+		MIO::writeUint64LE(lengths + 8, m_lenC);
+		m_auth.update(lengths, 16);
+		m_auth.finish(tag);
+	}
+
+	sl_bool ChaCha20_Poly1305::finish(void* tag, sl_size lenTag)
+	{
+		if (lenTag < 4 || lenTag > 16) {
+			return sl_false;
+		}
+		sl_uint8 T[16];
+		_finishAuth(T);
+		Base::copyMemory(tag, T, lenTag);
+		return sl_true;
+	}
+
+	sl_bool ChaCha20_Poly1305::finishAndCheckTag(const void* _tag, sl_size lenTag)
+	{
+		if (lenTag < 4 || lenTag > 16) {
+			return sl_false;
+		}
+		const sl_uint8* tag = (const sl_uint8*)_tag;
+		sl_uint8 T[16];
+		_finishAuth(T);
+		sl_uint8 diff = 0;
+		for (sl_size i = 0; i < lenTag; i++) {
+			diff |= tag[i] ^ T[i];
+		}
+		return diff == 0;
+	}
+
+	sl_bool ChaCha20_Poly1305::encrypt(
+					const void* IV, sl_size lenIV
+					, const void* A, sl_size lenA
+					, const void* input, void* output, sl_size len
+					, void* tag, sl_size lenTag
+	)
+	{
+		if (!start(IV, lenIV)) {
+			return sl_false;
+		}
+		put(A, lenA);
+		encrypt(input, output, len);
+		return finish(tag, lenTag);
+	}
+
+	sl_bool ChaCha20_Poly1305::decrypt(
+					const void* IV, sl_size lenIV
+					, const void* A, sl_size lenA
+					, const void* input, void* output, sl_size len
+					, const void* tag, sl_size lenTag
+	)
+	{
+		if (!start(IV, lenIV)) {
+			return sl_false;
+		}
+		put(A, lenA);
+		decrypt(input, output, len);
+		return finishAndCheckTag(tag, lenTag);
+	}
+
+	sl_bool ChaCha20_Poly1305::check(
+				const void* IV, sl_size lenIV
+				, const void* A, sl_size lenA
+				, const void* C, sl_size lenC
+				, const void* tag, sl_size lenTag
+	)
+	{
+		if (!start(IV, lenIV)) {
+			return sl_false;
+		}
+		put(A, lenA);
+		_padAuthData();
+		m_auth.update(C, lenC);
+		m_lenC = lenC;
+		return finishAndCheckTag(tag, lenTag);
+	}
+
+}
@@ -0,0 +1,513 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "../../../inc/slib/crypto/zlib.h"
+
+#include "../../../inc/slib/core/mio.h"
+#include "../../../inc/slib/core/cpu.h"
+
+#include "../../../inc/thirdparty/zlib/zlib.h"
+
+#if defined(SLIB_CPU_USE_X86_EXTENSIONS)
+#	include <wmmintrin.h>
+#	include <smmintrin.h>
+#	include <nmmintrin.h>
+#	include <immintrin.h>
+#	define CRC32_SUPPORT_CLMUL
+#	define CRC32_CLMUL_TARGET SLIB_CPU_TARGET("pclmul,sse4.1")
+#	define CRC32C_SUPPORT_HW
+#	define CRC32C_TARGET SLIB_CPU_TARGET("sse4.2")
+#	define ADLER32_SUPPORT_AVX2
+#	define ADLER32_TARGET SLIB_CPU_TARGET("avx2")
+#elif defined(SLIB_CPU_USE_ARMV8_CRC32)
+#	include <arm_acle.h>
+#	define CRC32_SUPPORT_ARMV8
+#	define CRC32C_SUPPORT_HW
+#	define CRC32C_TARGET
+#endif
+
+#define CRC32_POLY 0xedb88320
+#define CRC32C_POLY 0x82f63b78
+
+// largest n such that 255n(n+1)/2 + (n+1)(BASE-1) <= 2^32-1
+#define ADLER32_BASE 65521
+#define ADLER32_NMAX 5552
+
+namespace slib
+{
+
+/*
+	CRC combination
+
+	crc(A|B) = crc(A) * x^(8|B|) + crc(B) mod P(x), where the shift by x^(8|B|) is computed
+	by multiplying the powers x^(2^k) for the bits of |B| (bit-reflected, x^0 is the top bit)
+*/
+
+	static sl_uint32 _Crc32_multiplyModP(sl_uint32 a, sl_uint32 b, sl_uint32 poly)
+	{
+		sl_uint32 m = (sl_uint32)1 << 31;
+		sl_uint32 p = 0;
+		for (;;) {
+			if (a & m) {
+				p ^= b;
+				if (!(a & (m - 1))) {
+					break;
+				}
+			}
+			m >>= 1;
+			b = (b & 1) ? ((b >> 1) ^ poly) : (b >> 1);
+		}
+		return p;
+	}
+
+	// x^(8n) mod P(x)
+	static sl_uint32 _Crc32_shiftBytesModP(sl_uint64 n, sl_uint32 poly)
+	{
+		// x^0
+		sl_uint32 p = (sl_uint32)1 << 31;
+		// x^8
+		sl_uint32 q = (sl_uint32)1 << 23;
+		while (n) {
+			if (n & 1) {
+				p = _Crc32_multiplyModP(q, p, poly);
+			}
+			n >>= 1;
+			if (n) {
+				q = _Crc32_multiplyModP(q, q, poly);
+			}
+		}
+		return p;
+	}
+
+	static sl_uint32 _Crc32_combine(sl_uint32 crc1, sl_uint32 crc2, sl_uint64 len2, sl_uint32 poly)
+	{
+		if (!len2) {
+			return crc1;
+		}
+		return _Crc32_multiplyModP(_Crc32_shiftBytesModP(len2, poly), crc1, poly) ^ crc2;
+	}
+
+/*
+	CRC32 by folding with carry-less multiplication
+
+	Intel, "Fast CRC Computation for Generic Polynomials Using PCLMULQDQ Instruction".
+	Four 128-bit lanes are folded over 64 bytes in parallel, then folded into one lane,
+	reduced to 64 bits and finally Barrett-reduced to the 32-bit remainder.
+	The constants are x^(n) mod P(x) for the bit-reflected polynomial of CRC32.
+*/
+
+#if defined(CRC32_SUPPORT_CLMUL)
+
+	static sl_bool _g_crc32_flagCLMUL = Cpu::isPCLMULQDQSupported() && Cpu::isSSE41Supported();
+
+	SLIB_ALIGN(16) static const sl_uint64 _g_crc32_k1k2[2] = { 0x0154442bd4, 0x01c6e41596 };
+	SLIB_ALIGN(16) static const sl_uint64 _g_crc32_k3k4[2] = { 0x01751997d0, 0x00ccaa009e };
+	SLIB_ALIGN(16) static const sl_uint64 _g_crc32_k5k0[2] = { 0x0163cd6124, 0x0000000000 };
+	SLIB_ALIGN(16) static const sl_uint64 _g_crc32_poly[2] = { 0x01db710641, 0x01f7011641 };
+
+	// `size` should be a multiple of 16 and at least 64, `crc` is the inverted register value
+	CRC32_CLMUL_TARGET static sl_uint32 _Crc32_fold_CLMUL(sl_uint32 crc, const sl_uint8* data, sl_size size)
+	{
+		__m128i x0, x1, x2, x3, x4, x5, x6, x7, x8, y5, y6, y7, y8;
+
+		x1 = _mm_loadu_si128((__m128i const*)(data));
+		x2 = _mm_loadu_si128((__m128i const*)(data + 16));
+		x3 = _mm_loadu_si128((__m128i const*)(data + 32));
+		x4 = _mm_loadu_si128((__m128i const*)(data + 48));
+		x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128((int)crc));
+		x0 = _mm_load_si128((__m128i const*)_g_crc32_k1k2);
+		data += 64;
+		size -= 64;
+
+		// parallel folding of 64 bytes
+		while (size >= 64) {
+			x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+			x6 = _mm_clmulepi64_si128(x2, x0, 0x00);
+			x7 = _mm_clmulepi64_si128(x3, x0, 0x00);
+			x8 = _mm_clmulepi64_si128(x4, x0, 0x00);
+			x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+			x2 = _mm_clmulepi64_si128(x2, x0, 0x11);
+			x3 = _mm_clmulepi64_si128(x3, x0, 0x11);
+			x4 = _mm_clmulepi64_si128(x4, x0, 0x11);
+			y5 = _mm_loadu_si128((__m128i const*)(data));
+			y6 = _mm_loadu_si128((__m128i const*)(data + 16));
+			y7 = _mm_loadu_si128((__m128i const*)(data + 32));
+			y8 = _mm_loadu_si128((__m128i const*)(data + 48));
+			x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), y5);
+			x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), y6);
+			x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), y7);
+			x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), y8);
+			data += 64;
+			size -= 64;
+		}
+
+		// fold 4 lanes into 1
+		x0 = _mm_load_si128((__m128i const*)_g_crc32_k3k4);
+		x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+		x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+		x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+		x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+		x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+		x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+		x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+		x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+		x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+
+		// single folding of 16 bytes
+		while (size >= 16) {
+			x2 = _mm_loadu_si128((__m128i const*)data);
+			x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+			x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+			x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+			data += 16;
+			size -= 16;
+		}
+
+		// 128 bits to 64 bits
+		x2 = _mm_clmulepi64_si128(x1, x0, 0x10);
+		x3 = _mm_setr_epi32(~0, 0, ~0, 0);
+		x1 = _mm_srli_si128(x1, 8);
+		x1 = _mm_xor_si128(x1, x2);
+		x0 = _mm_loadl_epi64((__m128i const*)_g_crc32_k5k0);
+		x2 = _mm_srli_si128(x1, 4);
+		x1 = _mm_and_si128(x1, x3);
+		x1 = _mm_clmulepi64_si128(x1, x0, 0x00);
+		x1 = _mm_xor_si128(x1, x2);
+
+		// Barrett reduction to 32 bits
+		x0 = _mm_load_si128((__m128i const*)_g_crc32_poly);
+		x2 = _mm_and_si128(x1, x3);
+		x2 = _mm_clmulepi64_si128(x2, x0, 0x10);
+		x2 = _mm_and_si128(x2, x3);
+		x2 = _mm_clmulepi64_si128(x2, x0, 0x00);
+		x1 = _mm_xor_si128(x1, x2);
+		return (sl_uint32)(_mm_extract_epi32(x1, 1));
+	}
+
+#endif
+
+#if defined(CRC32_SUPPORT_ARMV8) || defined(CRC32C_SUPPORT_HW)
+
+#	if defined(SLIB_CPU_USE_X86_EXTENSIONS)
+
+	static sl_bool _g_crc32c_flagHW = Cpu::isSSE42Supported();
+
+#		if defined(SLIB_ARCH_IS_64BIT)
+	/*
+		The instruction has the latency of 3 cycles and the throughput of 1 cycle,
+		so that 3 independent streams are interleaved and then combined:
+		crc(A|B|C) = crc(A) * x^(16 * STREAM) + crc(B) * x^(8 * STREAM) + crc(C)
+	*/
+#			define CRC32C_STREAM_SIZE 4096
+	static sl_uint32 _g_crc32c_shift1 = _Crc32_shiftBytesModP(CRC32C_STREAM_SIZE, CRC32C_POLY);
+	static sl_uint32 _g_crc32c_shift2 = _Crc32_shiftBytesModP(CRC32C_STREAM_SIZE * 2, CRC32C_POLY);
+#		endif
+
+	// `crc` is the inverted register value
+	CRC32C_TARGET static sl_uint32 _Crc32C_HW(sl_uint32 crc, const sl_uint8* data, sl_size size)
+	{
+#		if defined(SLIB_ARCH_IS_64BIT)
+		sl_uint64 crc64 = crc;
+		while (size >= CRC32C_STREAM_SIZE * 3) {
+			sl_uint64 crcB = 0;
+			sl_uint64 crcC = 0;
+			const sl_uint8* end = data + CRC32C_STREAM_SIZE;
+			while (data < end) {
+				crc64 = _mm_crc32_u64(crc64, MIO::readUint64LE(data));
+				crcB = _mm_crc32_u64(crcB, MIO::readUint64LE(data + CRC32C_STREAM_SIZE));
+				crcC = _mm_crc32_u64(crcC, MIO::readUint64LE(data + CRC32C_STREAM_SIZE * 2));
+				data += 8;
+			}
+			crc64 = _Crc32_multiplyModP(_g_crc32c_shift2, (sl_uint32)crc64, CRC32C_POLY) ^ _Crc32_multiplyModP(_g_crc32c_shift1, (sl_uint32)crcB, CRC32C_POLY) ^ (sl_uint32)crcC;
+			data += CRC32C_STREAM_SIZE * 2;
+			size -= CRC32C_STREAM_SIZE * 3;
+		}
+		while (size >= 32) {
+			crc64 = _mm_crc32_u64(crc64, MIO::readUint64LE(data));
+			crc64 = _mm_crc32_u64(crc64, MIO::readUint64LE(data + 8));
+			crc64 = _mm_crc32_u64(crc64, MIO::readUint64LE(data + 16));
+			crc64 = _mm_crc32_u64(crc64, MIO::readUint64LE(data + 24));
+			data += 32;
+			size -= 32;
+		}
+		while (size >= 8) {
+			crc64 = _mm_crc32_u64(crc64, MIO::readUint64LE(data));
+			data += 8;
+			size -= 8;
+		}
+		crc = (sl_uint32)crc64;
+#		else
+		while (size >= 4) {
+			crc = _mm_crc32_u32(crc, MIO::readUint32LE(data));
+			data += 4;
+			size -= 4;
+		}
+#		endif
+		while (size) {
+			crc = _mm_crc32_u8(crc, *data);
+			data++;
+			size--;
+		}
+		return crc;
+	}
+
+#	else
+
+	static sl_bool _g_crc32_flagARMv8 = Cpu::isARMv8CRC32Supported();
+	static sl_bool _g_crc32c_flagHW = Cpu::isARMv8CRC32Supported();
+
+#		define DEFINE_CRC32_ARMV8(NAME, OP_D, OP_B) \
+		static sl_uint32 NAME(sl_uint32 crc, const sl_uint8* data, sl_size size) \
+		{ \
+			while (size >= 32) { \
+				crc = OP_D(crc, MIO::readUint64LE(data)); \
+				crc = OP_D(crc, MIO::readUint64LE(data + 8)); \
+				crc = OP_D(crc, MIO::readUint64LE(data + 16)); \
+				crc = OP_D(crc, MIO::readUint64LE(data + 24)); \
+				data += 32; \
+				size -= 32; \
+			} \
+			while (size >= 8) { \
+				crc = OP_D(crc, MIO::readUint64LE(data)); \
+				data += 8; \
+				size -= 8; \
+			} \
+			while (size) { \
+				crc = OP_B(crc, *data); \
+				data++; \
+				size--; \
+			} \
+			return crc; \
+		}
+
+	// `crc` is the inverted register value
+	DEFINE_CRC32_ARMV8(_Crc32_ARMv8, __crc32d, __crc32b)
+
+	DEFINE_CRC32_ARMV8(_Crc32C_HW, __crc32cd, __crc32cb)
+
+#	endif
+
+#endif
+
+	// slicing-by-8 tables of CRC32C for the CPUs without the CRC32C instruction
+	class _Crc32C_Table
+	{
+	public:
+		sl_uint32 t[8][256];
+
+	public:
+		_Crc32C_Table()
+		{
+			sl_uint32 i, k;
+			for (i = 0; i < 256; i++) {
+				sl_uint32 c = i;
+				for (k = 0; k < 8; k++) {
+					c = (c & 1) ? ((c >> 1) ^ CRC32C_POLY) : (c >> 1);
+				}
+				t[0][i] = c;
+			}
+			for (i = 0; i < 256; i++) {
+				for (k = 1; k < 8; k++) {
+					t[k][i] = (t[k - 1][i] >> 8) ^ t[0][t[k - 1][i] & 0xff];
+				}
+			}
+		}
+
+	};
+
+	static sl_uint32 _Crc32C_table(sl_uint32 crc, const sl_uint8* data, sl_size size)
+	{
+		static const _Crc32C_Table table;
+		const sl_uint32 (*t)[256] = table.t;
+		while (size >= 8) {
+			sl_uint32 a = crc ^ MIO::readUint32LE(data);
+			sl_uint32 b = MIO::readUint32LE(data + 4);
+			crc = t[7][a & 0xff] ^ t[6][(a >> 8) & 0xff] ^ t[5][(a >> 16) & 0xff] ^ t[4][a >> 24] ^
+				t[3][b & 0xff] ^ t[2][(b >> 8) & 0xff] ^ t[1][(b >> 16) & 0xff] ^ t[0][b >> 24];
+			data += 8;
+			size -= 8;
+		}
+		while (size) {
+			crc = (crc >> 8) ^ t[0][(crc ^ *data) & 0xff];
+			data++;
+			size--;
+		}
+		return crc;
+	}
+
+/*
+	Adler32 by AVX2
+
+	For every 32 bytes: s2 += 32 * s1 + (32 * d[0] + 31 * d[1] + ... + 1 * d[31]), s1 += d[0] + ... + d[31]
+	The sums are accumulated in the 32-bit lanes, and reduced modulo BASE for every NMAX bytes.
+*/
+
+#if defined(ADLER32_SUPPORT_AVX2)
+
+	static sl_bool _g_adler32_flagAVX2 = Cpu::isAVX2Supported();
+
+	// processes the multiple of 32 bytes
+	ADLER32_TARGET static sl_uint32 _Adler32_AVX2(sl_uint32 adler, const sl_uint8* data, sl_size size)
+	{
+		sl_uint32 s1 = adler & 0xffff;
+		sl_uint32 s2 = adler >> 16;
+		const __m256i weights = _mm256_setr_epi8(32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17, 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1);
+		const __m256i ones = _mm256_set1_epi16(1);
+		const __m256i zero = _mm256_setzero_si256();
+		while (size) {
+			sl_size n = size;
+			if (n > (ADLER32_NMAX & ~31)) {
+				n = ADLER32_NMAX & ~31;
+			}
+			size -= n;
+			__m256i vs1 = _mm256_setr_epi32((int)s1, 0, 0, 0, 0, 0, 0, 0);
+			__m256i vs2 = _mm256_setr_epi32((int)s2, 0, 0, 0, 0, 0, 0, 0);
+			// sum of s1 before every 32 bytes
+			__m256i vs1Prev = zero;
+			while (n) {
+				__m256i d = _mm256_loadu_si256((__m256i const*)data);
+				vs1Prev = _mm256_add_epi32(vs1Prev, vs1);
+				vs1 = _mm256_add_epi32(vs1, _mm256_sad_epu8(d, zero));
+				vs2 = _mm256_add_epi32(vs2, _mm256_madd_epi16(_mm256_maddubs_epi16(d, weights), ones));
+				data += 32;
+				n -= 32;
+			}
+			vs2 = _mm256_add_epi32(vs2, _mm256_slli_epi32(vs1Prev, 5));
+			SLIB_ALIGN(32) sl_uint32 t1[8];
+			SLIB_ALIGN(32) sl_uint32 t2[8];
+			_mm256_store_si256((__m256i*)t1, vs1);
+			_mm256_store_si256((__m256i*)t2, vs2);
+			s1 = t1[0] + t1[1] + t1[2] + t1[3] + t1[4] + t1[5] + t1[6] + t1[7];
+			s2 = t2[0] + t2[1] + t2[2] + t2[3] + t2[4] + t2[5] + t2[6] + t2[7];
+			s1 %= ADLER32_BASE;
+			s2 %= ADLER32_BASE;
+		}
+		return s1 | (s2 << 16);
+	}
+
+#endif
+
+	sl_uint32 Zlib::adler32(sl_uint32 adler, const void* _data, sl_size size)
+	{
+		const sl_uint8* data = (const sl_uint8*)_data;
+#if defined(ADLER32_SUPPORT_AVX2)
+		if (_g_adler32_flagAVX2 && size >= 64) {
+			sl_size n = size & ~((sl_size)31);
+			adler = _Adler32_AVX2(adler, data, n);
+			data += n;
+			size -= n;
+		}
+#endif
+		while (size > 0) {
+			sl_uint32 n = 0x10000000;
+			if (size < n) {
+				n = (sl_uint32)size;
+			}
+			adler = (sl_uint32)(::adler32(adler, (Bytef*)data, n));
+			size -= n;
+			data += n;
+		}
+		return adler;
+	}
+
+	sl_uint32 Zlib::adler32(const void* data, sl_size size)
+	{
+		return adler32(1, data, size);
+	}
+
+	sl_uint32 Zlib::adler32(sl_uint32 adler, const Memory& mem)
+	{
+		return adler32(adler, mem.getData(), mem.getSize());
+	}
+
+	sl_uint32 Zlib::adler32(const Memory& mem)
+	{
+		return adler32(1, mem.getData(), mem.getSize());
+	}
+
+	sl_uint32 Zlib::crc32(sl_uint32 crc, const void* _data, sl_size size)
+	{
+		const sl_uint8* data = (const sl_uint8*)_data;
+#if defined(CRC32_SUPPORT_CLMUL)
+		if (_g_crc32_flagCLMUL && size >= 64) {
+			sl_size n = size & ~((sl_size)15);
+			crc = ~(_Crc32_fold_CLMUL(~crc, data, n));
+			data += n;
+			size -= n;
+		}
+#elif defined(CRC32_SUPPORT_ARMV8)
+		if (_g_crc32_flagARMv8) {
+			return ~(_Crc32_ARMv8(~crc, data, size));
+		}
+#endif
+		while (size > 0) {
+			sl_uint32 n = 0x10000000;
+			if (size < n) {
+				n = (sl_uint32)size;
+			}
+			crc = (sl_uint32)(::crc32(crc, (Bytef*)data, n));
+			size -= n;
+			data += n;
+		}
+		return crc;
+	}
+
+	sl_uint32 Zlib::crc32(const void* data, sl_size size)
+	{
+		return crc32(0, data, size);
+	}
+
+	sl_uint32 Zlib::crc32(sl_uint32 crc, const Memory& mem)
+	{
+		return crc32(crc, mem.getData(), mem.getSize());
+	}
+
+	sl_uint32 Zlib::crc32(const Memory& mem)
+	{
+		return crc32(0, mem.getData(), mem.getSize());
+	}
+
+	sl_uint32 Zlib::crc32Combine(sl_uint32 crc1, sl_uint32 crc2, sl_uint64 size2)
+	{
+		return _Crc32_combine(crc1, crc2, size2, CRC32_POLY);
+	}
+
+	sl_uint32 Zlib::crc32c(sl_uint32 crc, const void* _data, sl_size size)
+	{
+		const sl_uint8* data = (const sl_uint8*)_data;
+#if defined(CRC32C_SUPPORT_HW)
+		if (_g_crc32c_flagHW) {
+			return ~(_Crc32C_HW(~crc, data, size));
+		}
+#endif
+		return ~(_Crc32C_table(~crc, data, size));
+	}
+
+	sl_uint32 Zlib::crc32c(const void* data, sl_size size)
+	{
+		return crc32c(0, data, size);
+	}
+
+	sl_uint32 Zlib::crc32c(sl_uint32 crc, const Memory& mem)
+	{
+		return crc32c(crc, mem.getData(), mem.getSize());
+	}
+
+	sl_uint32 Zlib::crc32c(const Memory& mem)
+	{
+		return crc32c(0, mem.getData(), mem.getSize());
+	}
+
+	sl_uint32 Zlib::crc32cCombine(sl_uint32 crc1, sl_uint32 crc2, sl_uint64 size2)
+	{
+		return _Crc32_combine(crc1, crc2, size2, CRC32C_POLY);
+	}
+
+}
@@ -0,0 +1,390 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "../../../inc/slib/crypto/compress.h"
+
+#define COMPRESS_CHUNK_SIZE_SMALL 4096
+#define COMPRESS_CHUNK_SIZE_LARGE 262144
+#define COMPRESS_STREAM_BUFFER_SIZE 65536
+
+namespace slib
+{
+
+	SLIB_DEFINE_OBJECT(Compressor, Object)
+
+	Compressor::Compressor()
+	{
+	}
+
+	Compressor::~Compressor()
+	{
+	}
+
+	Memory Compressor::compress(const void* _data, sl_size size, sl_bool flagFinish)
+	{
+		Memory ret;
+		sl_uint8* data = (sl_uint8*)_data;
+		sl_uint32 sizeChunk;
+		if (size > 16384) {
+			sizeChunk = COMPRESS_CHUNK_SIZE_LARGE;
+		} else {
+			sizeChunk = COMPRESS_CHUNK_SIZE_SMALL;
+		}
+		Memory memChunk = Memory::create(sizeChunk);
+		if (memChunk.isEmpty()) {
+			return ret;
+		}
+		sl_uint8* chunk = (sl_uint8*)(memChunk.getData());
+
+		MemoryBuffer buffer;
+		while (1) {
+			sl_uint32 sizeInput = (sl_uint32)(SLIB_MIN(size, sizeChunk));
+			sl_uint32 sizeInputPassed = 0, sizeOutputUsed = 0;
+			sl_int32 iRet = compress(data, sizeInput, sizeInputPassed, chunk, sizeChunk, sizeOutputUsed, flagFinish && sizeInput < sizeChunk);
+			if (iRet < 0) {
+				return ret;
+			}
+			if (sizeOutputUsed > 0) {
+				buffer.add(Memory::create(chunk, sizeOutputUsed));
+			}
+			data += sizeInputPassed;
+			size -= sizeInputPassed;
+			if (iRet == 0) {
+				break;
+			}
+			if (size == 0 && sizeOutputUsed == 0) {
+				break;
+			}
+		}
+		ret = buffer.merge();
+		return ret;
+	}
+
+	Memory Compressor::flush()
+	{
+		sl_uint8 chunk[COMPRESS_CHUNK_SIZE_SMALL];
+		MemoryBuffer buffer;
+		while (1) {
+			sl_uint32 sizeOutputUsed = 0;
+			sl_int32 iRet = flush(chunk, sizeof(chunk), sizeOutputUsed);
+			if (iRet < 0) {
+				return sl_null;
+			}
+			if (sizeOutputUsed > 0) {
+				buffer.add(Memory::create(chunk, sizeOutputUsed));
+			}
+			if (iRet == 0) {
+				break;
+			}
+		}
+		return buffer.merge();
+	}
+
+
+	SLIB_DEFINE_OBJECT(Decompressor, Object)
+
+	Decompressor::Decompressor()
+	{
+	}
+
+	Decompressor::~Decompressor()
+	{
+	}
+
+	Memory Decompressor::decompress(const void* data, sl_size size)
+	{
+		MemoryBuffer buffer;
+		decompress(data, size, buffer);
+		return buffer.merge();
+	}
+
+	sl_bool Decompressor::decompress(const void* _data, sl_size size, MemoryBuffer& output, sl_bool* flagFinished)
+	{
+		if (flagFinished) {
+			*flagFinished = sl_false;
+		}
+		sl_uint8* data = (sl_uint8*)_data;
+		sl_uint32 sizeChunk;
+		if (size > 16384) {
+			sizeChunk = COMPRESS_CHUNK_SIZE_LARGE;
+		} else {
+			sizeChunk = COMPRESS_CHUNK_SIZE_SMALL;
+		}
+		Memory memChunk = Memory::create(sizeChunk);
+		if (memChunk.isEmpty()) {
+			return sl_false;
+		}
+		sl_uint8* chunk = (sl_uint8*)(memChunk.getData());
+
+		while (1) {
+			sl_uint32 sizeInput = (sl_uint32)(SLIB_MIN(size, sizeChunk));
+			sl_uint32 sizeInputPassed = 0, sizeOutputUsed = 0;
+			sl_int32 iRet = decompress(data, sizeInput, sizeInputPassed, chunk, sizeChunk, sizeOutputUsed);
+			if (iRet < 0) {
+				return sl_false;
+			}
+			if (sizeOutputUsed > 0) {
+				output.add(Memory::create(chunk, sizeOutputUsed));
+			}
+			data += sizeInputPassed;
+			size -= sizeInputPassed;
+			if (iRet == 0) {
+				if (flagFinished) {
+					*flagFinished = sl_true;
+				}
+				break;
+			}
+			if (size == 0 && sizeOutputUsed == 0) {
+				break;
+			}
+		}
+		return sl_true;
+	}
+
+
+	CompressionWriter::CompressionWriter()
+	{
+	}
+
+	CompressionWriter::~CompressionWriter()
+	{
+	}
+
+	Ref<CompressionWriter> CompressionWriter::create(const Ref<Compressor>& compressor, const Ptr<IWriter>& output)
+	{
+		if (compressor.isNotNull() && output.isNotNull()) {
+			Memory buf = Memory::create(COMPRESS_STREAM_BUFFER_SIZE);
+			if (buf.isNotNull()) {
+				Ref<CompressionWriter> ret = new CompressionWriter;
+				if (ret.isNotNull()) {
+					ret->m_compressor = compressor;
+					ret->m_output = output;
+					ret->m_bufOutput = buf;
+					return ret;
+				}
+			}
+		}
+		return sl_null;
+	}
+
+	sl_reg CompressionWriter::write(const void* data, sl_size size)
+	{
+		MutexLocker lock(&m_lock);
+		if (_write(data, size, sl_false)) {
+			return size;
+		}
+		return -1;
+	}
+
+	sl_bool CompressionWriter::flush()
+	{
+		MutexLocker lock(&m_lock);
+		Ptr<IWriter> output = m_output.lock();
+		if (output.isNull()) {
+			return sl_false;
+		}
+		sl_uint8* buf = (sl_uint8*)(m_bufOutput.getData());
+		sl_uint32 sizeBuf = (sl_uint32)(m_bufOutput.getSize());
+		while (1) {
+			sl_uint32 sizeOutputUsed = 0;
+			sl_int32 iRet = m_compressor->flush(buf, sizeBuf, sizeOutputUsed);
+			if (iRet < 0) {
+				return sl_false;
+			}
+			if (sizeOutputUsed > 0) {
+				if (output->writeFully(buf, sizeOutputUsed) != (sl_reg)sizeOutputUsed) {
+					return sl_false;
+				}
+			}
+			if (iRet == 0) {
+				return sl_true;
+			}
+		}
+	}
+
+	sl_bool CompressionWriter::finish()
+	{
+		MutexLocker lock(&m_lock);
+		return _write(sl_null, 0, sl_true);
+	}
+
+	sl_bool CompressionWriter::_write(const void* _data, sl_size size, sl_bool flagFinish)
+	{
+		Ptr<IWriter> output = m_output.lock();
+		if (output.isNull()) {
+			return sl_false;
+		}
+		const sl_uint8* data = (const sl_uint8*)_data;
+		sl_uint8* buf = (sl_uint8*)(m_bufOutput.getData());
+		sl_uint32 sizeBuf = (sl_uint32)(m_bufOutput.getSize());
+		while (1) {
+			sl_uint32 sizeInput = (sl_uint32)(SLIB_MIN(size, 0x40000000));
+			sl_uint32 sizeInputPassed = 0, sizeOutputUsed = 0;
+			sl_int32 iRet = m_compressor->compress(data, sizeInput, sizeInputPassed, buf, sizeBuf, sizeOutputUsed, flagFinish && sizeInput == size);
+			if (iRet < 0) {
+				return sl_false;
+			}
+			if (sizeOutputUsed > 0) {
+				if (output->writeFully(buf, sizeOutputUsed) != (sl_reg)sizeOutputUsed) {
+					return sl_false;
+				}
+			}
+			data += sizeInputPassed;
+			size -= sizeInputPassed;
+			if (iRet == 0) {
+				return sl_true;
+			}
+			if (size == 0 && sizeOutputUsed < sizeBuf) {
+				if (!flagFinish) {
+					return sl_true;
+				}
+			}
+		}
+	}
+
+
+	DecompressionReader::DecompressionReader()
+	{
+		m_posInput = 0;
+		m_sizeInput = 0;
+		m_flagEnded = sl_false;
+		m_flagError = sl_false;
+	}
+
+	DecompressionReader::~DecompressionReader()
+	{
+	}
+
+	Ref<DecompressionReader> DecompressionReader::create(const Ref<Decompressor>& decompressor, const Ptr<IReader>& input)
+	{
+		if (decompressor.isNotNull() && input.isNotNull()) {
+			Memory buf = Memory::create(COMPRESS_STREAM_BUFFER_SIZE);
+			if (buf.isNotNull()) {
+				Ref<DecompressionReader> ret = new DecompressionReader;
+				if (ret.isNotNull()) {
+					ret->m_decompressor = decompressor;
+					ret->m_input = input;
+					ret->m_bufInput = buf;
+					return ret;
+				}
+			}
+		}
+		return sl_null;
+	}
+
+	sl_reg DecompressionReader::read(void* _data, sl_size size)
+	{
+		MutexLocker lock(&m_lock);
+		if (m_flagError) {
+			return -1;
+		}
+		if (m_flagEnded || !size) {
+			return 0;
+		}
+		sl_uint8* data = (sl_uint8*)_data;
+		sl_uint32 sizeOutput = (sl_uint32)(SLIB_MIN(size, 0x40000000));
+		sl_uint8* buf = (sl_uint8*)(m_bufInput.getData());
+		while (1) {
+			if (m_posInput >= m_sizeInput) {
+				Ptr<IReader> input = m_input.lock();
+				if (input.isNull()) {
+					m_flagError = sl_true;
+					return -1;
+				}
+				sl_reg n = input->read(buf, m_bufInput.getSize());
+				if (n <= 0) {
+					// the source ended before the end of the compressed stream
+					m_flagError = sl_true;
+					return -1;
+				}
+				m_posInput = 0;
+				m_sizeInput = (sl_uint32)n;
+			}
+			sl_uint32 sizeInputPassed = 0, sizeOutputUsed = 0;
+			sl_int32 iRet = m_decompressor->decompress(buf + m_posInput, m_sizeInput - m_posInput, sizeInputPassed, data, sizeOutput, sizeOutputUsed);
+			if (iRet < 0) {
+				m_flagError = sl_true;
+				return -1;
+			}
+			m_posInput += sizeInputPassed;
+			if (iRet == 0) {
+				m_flagEnded = sl_true;
+				return sizeOutputUsed;
+			}
+			if (sizeOutputUsed > 0) {
+				return sizeOutputUsed;
+			}
+		}
+	}
+
+
+	SLIB_DEFINE_OBJECT(AsyncCompressionFilter, AsyncStreamFilter)
+
+	AsyncCompressionFilter::AsyncCompressionFilter()
+	{
+	}
+
+	AsyncCompressionFilter::~AsyncCompressionFilter()
+	{
+	}
+
+	Ref<AsyncCompressionFilter> AsyncCompressionFilter::create(const Ref<AsyncStream>& stream, const Ref<Compressor>& compressor, const Ref<Decompressor>& decompressor)
+	{
+		if (stream.isNull()) {
+			return sl_null;
+		}
+		Ref<AsyncCompressionFilter> ret = new AsyncCompressionFilter;
+		if (ret.isNotNull()) {
+			ret->m_compressor = compressor;
+			ret->m_decompressor = decompressor;
+			ret->setSourceStream(stream);
+		}
+		return ret;
+	}
+
+	Memory AsyncCompressionFilter::filterRead(void* data, sl_uint32 size, Referable* userObject)
+	{
+		if (m_decompressor.isNull()) {
+			return Memory::createStatic(data, size, userObject);
+		}
+		MemoryBuffer output;
+		sl_bool flagFinished = sl_false;
+		if (!(m_decompressor->decompress(data, size, output, &flagFinished))) {
+			setReadingError();
+			return sl_null;
+		}
+		if (flagFinished) {
+			setReadingEnded();
+		}
+		return output.merge();
+	}
+
+	Memory AsyncCompressionFilter::filterWrite(void* data, sl_uint32 size, Referable* userObject)
+	{
+		if (m_compressor.isNull()) {
+			return Memory::createStatic(data, size, userObject);
+		}
+		MemoryBuffer output;
+		Memory mem = m_compressor->compress(data, size, sl_false);
+		if (mem.isNotEmpty()) {
+			output.add(mem);
+		}
+		mem = m_compressor->flush();
+		if (mem.isNotEmpty()) {
+			output.add(mem);
+		}
+		Memory ret = output.merge();
+		if (ret.isEmpty()) {
+			setWritingError();
+		}
+		return ret;
+	}
+
+}
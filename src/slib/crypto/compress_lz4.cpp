@@ -0,0 +1,1012 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "../../../inc/slib/crypto/lz4.h"
+
+#include "../../../inc/slib/core/mio.h"
+
+#define LZ4_MIN_MATCH 4
+#define LZ4_LAST_LITERALS 5
+#define LZ4_MF_LIMIT 12
+#define LZ4_MIN_INPUT_SIZE 13
+#define LZ4_MAX_INPUT_SIZE 0x7E000000
+#define LZ4_MAX_OFFSET 65535
+#define LZ4_HASH_LOG 12
+#define LZ4_HASH_SIZE (1 << LZ4_HASH_LOG)
+#define LZ4_SKIP_TRIGGER 6
+
+#define LZ4_FRAME_MAGIC 0x184D2204
+#define LZ4_FRAME_HEADER_SIZE_MIN 7
+#define LZ4_FRAME_HEADER_SIZE_MAX 19
+#define LZ4_HISTORY_SIZE 65536
+#define LZ4_BLOCK_UNCOMPRESSED 0x80000000
+
+#define XXH32_PRIME1 2654435761U
+#define XXH32_PRIME2 2246822519U
+#define XXH32_PRIME3 3266489917U
+#define XXH32_PRIME4 668265263U
+#define XXH32_PRIME5 374761393U
+
+namespace slib
+{
+
+/*
+	XXH32, used for the checksums of the LZ4 frame
+*/
+
+	class _Lz4_XXH32
+	{
+	public:
+		sl_uint32 v1, v2, v3, v4;
+		sl_uint32 sizeTotal;
+		sl_bool flagLarge;
+		sl_uint8 buf[16];
+		sl_uint32 sizeBuf;
+
+	public:
+		SLIB_INLINE static sl_uint32 rotl(sl_uint32 x, sl_uint32 r)
+		{
+			return (x << r) | (x >> (32 - r));
+		}
+
+		SLIB_INLINE static sl_uint32 round(sl_uint32 acc, sl_uint32 input)
+		{
+			acc += input * XXH32_PRIME2;
+			acc = rotl(acc, 13);
+			return acc * XXH32_PRIME1;
+		}
+
+		void start(sl_uint32 seed)
+		{
+			v1 = seed + XXH32_PRIME1 + XXH32_PRIME2;
+			v2 = seed + XXH32_PRIME2;
+			v3 = seed;
+			v4 = seed - XXH32_PRIME1;
+			sizeTotal = 0;
+			flagLarge = sl_false;
+			sizeBuf = 0;
+		}
+
+		const sl_uint8* processStripes(const sl_uint8* p, const sl_uint8* end)
+		{
+			sl_uint32 a1 = v1, a2 = v2, a3 = v3, a4 = v4;
+			while (p + 16 <= end) {
+				a1 = round(a1, MIO::readUint32LE(p));
+				a2 = round(a2, MIO::readUint32LE(p + 4));
+				a3 = round(a3, MIO::readUint32LE(p + 8));
+				a4 = round(a4, MIO::readUint32LE(p + 12));
+				p += 16;
+			}
+			v1 = a1; v2 = a2; v3 = a3; v4 = a4;
+			return p;
+		}
+
+		void update(const void* data, sl_size size)
+		{
+			const sl_uint8* p = (const sl_uint8*)data;
+			const sl_uint8* end = p + size;
+			sizeTotal += (sl_uint32)size;
+			if (size >= 16 || sizeTotal >= 16) {
+				flagLarge = sl_true;
+			}
+			if (sizeBuf + size < 16) {
+				Base::copyMemory(buf + sizeBuf, p, size);
+				sizeBuf += (sl_uint32)size;
+				return;
+			}
+			if (sizeBuf) {
+				sl_uint32 n = 16 - sizeBuf;
+				Base::copyMemory(buf + sizeBuf, p, n);
+				processStripes(buf, buf + 16);
+				p += n;
+				sizeBuf = 0;
+			}
+			p = processStripes(p, end);
+			if (p < end) {
+				sizeBuf = (sl_uint32)(end - p);
+				Base::copyMemory(buf, p, sizeBuf);
+			}
+		}
+
+		sl_uint32 finish()
+		{
+			sl_uint32 h;
+			if (flagLarge) {
+				h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+			} else {
+				h = v3 + XXH32_PRIME5;
+			}
+			h += sizeTotal;
+			const sl_uint8* p = buf;
+			const sl_uint8* end = buf + sizeBuf;
+			while (p + 4 <= end) {
+				h += MIO::readUint32LE(p) * XXH32_PRIME3;
+				h = rotl(h, 17) * XXH32_PRIME4;
+				p += 4;
+			}
+			while (p < end) {
+				h += (*p) * XXH32_PRIME5;
+				h = rotl(h, 11) * XXH32_PRIME1;
+				p++;
+			}
+			h ^= h >> 15;
+			h *= XXH32_PRIME2;
+			h ^= h >> 13;
+			h *= XXH32_PRIME3;
+			h ^= h >> 16;
+			return h;
+		}
+
+		static sl_uint32 execute(const void* data, sl_size size, sl_uint32 seed = 0)
+		{
+			_Lz4_XXH32 state;
+			state.start(seed);
+			state.update(data, size);
+			return state.finish();
+		}
+
+	};
+
+#define XXH32_STATE(s) ((_Lz4_XXH32*)((void*)(s)))
+
+/*
+	Block Format
+*/
+
+	SLIB_INLINE static sl_uint32 _Lz4_hash(sl_uint32 seq)
+	{
+		return (seq * 2654435761U) >> (32 - LZ4_HASH_LOG);
+	}
+
+	SLIB_INLINE static sl_uint32 _Lz4_getTrailingZeroBytes(sl_uint64 v)
+	{
+#if defined(SLIB_COMPILER_IS_GCC)
+		return (sl_uint32)(__builtin_ctzll(v) >> 3);
+#else
+		sl_uint32 n = 0;
+		while (!(v & 0xFF)) {
+			v >>= 8;
+			n++;
+		}
+		return n;
+#endif
+	}
+
+	SLIB_INLINE static void _Lz4_copy8(sl_uint8* dst, const sl_uint8* src)
+	{
+		MIO::writeUint64LE(dst, MIO::readUint64LE(src));
+	}
+
+	// copies in 8 bytes units, may write up to 7 bytes after `dst + size`
+	SLIB_INLINE static void _Lz4_wildCopy(sl_uint8* dst, const sl_uint8* src, sl_size size)
+	{
+		sl_uint8* end = dst + size;
+		do {
+			_Lz4_copy8(dst, src);
+			dst += 8;
+			src += 8;
+		} while (dst < end);
+	}
+
+	// returns the length of the common prefix, `p` does not exceed `limit`
+	SLIB_INLINE static sl_size _Lz4_countMatch(const sl_uint8* p, const sl_uint8* match, const sl_uint8* limit)
+	{
+		const sl_uint8* start = p;
+		while (p + 8 <= limit) {
+			sl_uint64 diff = MIO::readUint64LE(p) ^ MIO::readUint64LE(match);
+			if (diff) {
+				return (sl_size)(p - start) + _Lz4_getTrailingZeroBytes(diff);
+			}
+			p += 8;
+			match += 8;
+		}
+		while (p < limit && *p == *match) {
+			p++;
+			match++;
+		}
+		return (sl_size)(p - start);
+	}
+
+	SLIB_INLINE static sl_uint8* _Lz4_writeLength(sl_uint8* op, sl_size len)
+	{
+		while (len >= 255) {
+			*(op++) = 255;
+			len -= 255;
+		}
+		*(op++) = (sl_uint8)len;
+		return op;
+	}
+
+	/*
+		Greedy parsing with a single probe of the hash table.
+		The search step grows while no match is found, so that the incompressible data is skipped quickly.
+		`table` is LZ4_HASH_SIZE entries of the positions relative to `src`.
+	*/
+	static sl_size _Lz4_compressBlock(const sl_uint8* src, sl_size size, sl_uint8* dst, sl_uint32* table)
+	{
+		const sl_uint8* ip = src;
+		const sl_uint8* anchor = src;
+		const sl_uint8* iend = src + size;
+		sl_uint8* op = dst;
+
+		if (size >= LZ4_MIN_INPUT_SIZE) {
+			const sl_uint8* mflimit = iend - LZ4_MF_LIMIT;
+			const sl_uint8* matchlimit = iend - LZ4_LAST_LITERALS;
+			Base::zeroMemory(table, sizeof(sl_uint32) * LZ4_HASH_SIZE);
+			ip++;
+			for (;;) {
+				// find a match
+				const sl_uint8* match = sl_null;
+				sl_uint32 nSearch = 1 << LZ4_SKIP_TRIGGER;
+				for (;;) {
+					sl_uint32 seq = MIO::readUint32LE(ip);
+					sl_uint32 h = _Lz4_hash(seq);
+					const sl_uint8* ref = src + table[h];
+					table[h] = (sl_uint32)(ip - src);
+					if (ip - ref <= LZ4_MAX_OFFSET && MIO::readUint32LE(ref) == seq) {
+						match = ref;
+						break;
+					}
+					ip += nSearch >> LZ4_SKIP_TRIGGER;
+					nSearch++;
+					if (ip > mflimit) {
+						break;
+					}
+				}
+				if (!match) {
+					break;
+				}
+				// extend backwards
+				while (ip > anchor && match > src && ip[-1] == match[-1]) {
+					ip--;
+					match--;
+				}
+				// literals
+				sl_size nLiterals = (sl_size)(ip - anchor);
+				sl_uint8* token = op++;
+				if (nLiterals >= 15) {
+					*token = 15 << 4;
+					op = _Lz4_writeLength(op, nLiterals - 15);
+				} else {
+					*token = (sl_uint8)(nLiterals << 4);
+				}
+				if (nLiterals) {
+					// the sequence is followed by at least 8 bytes (offset, last token and last literals), so the overrun is safe
+					_Lz4_wildCopy(op, anchor, nLiterals);
+					op += nLiterals;
+				}
+				// offset
+				MIO::writeUint16LE(op, (sl_uint16)(ip - match));
+				op += 2;
+				// match length
+				sl_size nMatch = _Lz4_countMatch(ip + LZ4_MIN_MATCH, match + LZ4_MIN_MATCH, matchlimit);
+				ip += nMatch + LZ4_MIN_MATCH;
+				if (nMatch >= 15) {
+					*token += 15;
+					op = _Lz4_writeLength(op, nMatch - 15);
+				} else {
+					*token += (sl_uint8)nMatch;
+				}
+				anchor = ip;
+				if (ip > mflimit) {
+					break;
+				}
+				table[_Lz4_hash(MIO::readUint32LE(ip - 2))] = (sl_uint32)(ip - 2 - src);
+			}
+		}
+
+		// last literals
+		sl_size nLiterals = (sl_size)(iend - anchor);
+		if (nLiterals >= 15) {
+			*(op++) = 15 << 4;
+			op = _Lz4_writeLength(op, nLiterals - 15);
+		} else {
+			*(op++) = (sl_uint8)(nLiterals << 4);
+		}
+		Base::copyMemory(op, anchor, nLiterals);
+		op += nLiterals;
+		return (sl_size)(op - dst);
+	}
+
+	/*
+		`sizePrefix` bytes before `dst` are the previously decoded data, which can be referenced by the matches (linked blocks)
+		returns -1 on the corrupted input or the insufficient output
+	*/
+	static sl_reg _Lz4_decompressBlock(const sl_uint8* src, sl_size size, sl_uint8* dst, sl_size sizeDst, sl_size sizePrefix)
+	{
+		const sl_uint8* ip = src;
+		const sl_uint8* iend = src + size;
+		sl_uint8* op = dst;
+		sl_uint8* oend = dst + sizeDst;
+		const sl_uint8* lowest = dst - sizePrefix;
+
+		for (;;) {
+			if (ip >= iend) {
+				return -1;
+			}
+			sl_uint32 token = *(ip++);
+
+			// literals
+			sl_size nLiterals = token >> 4;
+			if (nLiterals < 15 && (sl_size)(iend - ip) >= 16 && (sl_size)(oend - op) >= 16) {
+				_Lz4_copy8(op, ip);
+				_Lz4_copy8(op + 8, ip + 8);
+				op += nLiterals;
+				ip += nLiterals;
+			} else {
+				if (nLiterals == 15) {
+					sl_uint32 s;
+					do {
+						if (ip >= iend) {
+							return -1;
+						}
+						s = *(ip++);
+						nLiterals += s;
+					} while (s == 255);
+				}
+				if ((sl_size)(iend - ip) < nLiterals || (sl_size)(oend - op) < nLiterals) {
+					return -1;
+				}
+				Base::copyMemory(op, ip, nLiterals);
+				op += nLiterals;
+				ip += nLiterals;
+				if (ip == iend) {
+					// last sequence
+					break;
+				}
+			}
+
+			// offset
+			if (iend - ip < 2) {
+				return -1;
+			}
+			sl_size offset = MIO::readUint16LE(ip);
+			ip += 2;
+			if (!offset || offset > (sl_size)(op - lowest)) {
+				return -1;
+			}
+			const sl_uint8* match = op - offset;
+
+			// match length
+			sl_size nMatch = token & 15;
+			if (nMatch == 15) {
+				sl_uint32 s;
+				do {
+					if (ip >= iend) {
+						return -1;
+					}
+					s = *(ip++);
+					nMatch += s;
+				} while (s == 255);
+			}
+			nMatch += LZ4_MIN_MATCH;
+			if ((sl_size)(oend - op) < nMatch) {
+				return -1;
+			}
+			sl_uint8* cpy = op + nMatch;
+			if ((sl_size)(oend - cpy) >= 16 && offset >= 8) {
+				// most matches are short: copies 16 bytes without the loop
+				_Lz4_copy8(op, match);
+				_Lz4_copy8(op + 8, match + 8);
+				if (nMatch > 16) {
+					_Lz4_wildCopy(op + 16, match + 16, nMatch - 16);
+				}
+			} else if ((sl_size)(oend - cpy) >= 8) {
+				if (offset < 8) {
+					// repeating pattern: expands the first 8 bytes, then copies from the distance of the multiple of the period (8~14)
+					for (sl_uint32 i = 0; i < 8; i++) {
+						op[i] = match[i];
+					}
+					op += 8;
+					match = op - ((8 + offset - 1) / offset) * offset;
+					if (op < cpy) {
+						_Lz4_wildCopy(op, match, cpy - op);
+					}
+				} else {
+					_Lz4_wildCopy(op, match, nMatch);
+				}
+			} else {
+				while (op < cpy) {
+					*(op++) = *(match++);
+				}
+			}
+			op = cpy;
+		}
+		return (sl_reg)(op - dst);
+	}
+
+	sl_size Lz4::getCompressBound(sl_size size)
+	{
+		return size + size / 255 + 16;
+	}
+
+	sl_size Lz4::compressBlock(const void* input, sl_size size, void* output)
+	{
+		if (size > LZ4_MAX_INPUT_SIZE) {
+			return 0;
+		}
+		sl_uint32 table[LZ4_HASH_SIZE];
+		return _Lz4_compressBlock((const sl_uint8*)input, size, (sl_uint8*)output, table);
+	}
+
+	sl_reg Lz4::decompressBlock(const void* input, sl_size size, void* output, sl_size sizeOutput)
+	{
+		return _Lz4_decompressBlock((const sl_uint8*)input, size, (sl_uint8*)output, sizeOutput, 0);
+	}
+
+	Memory Lz4::compress(const void* data, sl_size size)
+	{
+		Lz4Compress lz4;
+		if (lz4.start()) {
+			return lz4.compress(data, size, sl_true);
+		}
+		return sl_null;
+	}
+
+	Memory Lz4::decompress(const void* data, sl_size size)
+	{
+		Lz4Decompress lz4;
+		if (lz4.start()) {
+			return lz4.decompress(data, size);
+		}
+		return sl_null;
+	}
+
+/*
+	Frame Format
+*/
+
+	SLIB_INLINE static sl_uint32 _Lz4_getBlockSizeId(sl_uint32 sizeBlock)
+	{
+		if (sizeBlock <= 65536) {
+			return 4;
+		} else if (sizeBlock <= 262144) {
+			return 5;
+		} else if (sizeBlock <= 1048576) {
+			return 6;
+		} else {
+			return 7;
+		}
+	}
+
+	SLIB_INLINE static sl_uint32 _Lz4_getBlockSize(sl_uint32 id)
+	{
+		return 1 << (8 + 2 * id);
+	}
+
+	SLIB_INLINE static sl_uint8 _Lz4_getHeaderChecksum(const sl_uint8* descriptor, sl_uint32 size)
+	{
+		return (sl_uint8)(_Lz4_XXH32::execute(descriptor, size) >> 8);
+	}
+
+	Lz4Compress::Lz4Compress()
+	{
+		m_flagStarted = sl_false;
+	}
+
+	Lz4Compress::~Lz4Compress()
+	{
+		abort();
+	}
+
+	sl_bool Lz4Compress::isStarted()
+	{
+		return m_flagStarted;
+	}
+
+	sl_bool Lz4Compress::start(sl_uint32 sizeBlock, sl_bool flagContentChecksum)
+	{
+		if (m_flagStarted) {
+			abort();
+		}
+		sizeBlock = _Lz4_getBlockSize(_Lz4_getBlockSizeId(sizeBlock));
+		if (m_memInput.getSize() != sizeBlock) {
+			m_memInput = Memory::create(sizeBlock);
+			if (m_memInput.isNull()) {
+				return sl_false;
+			}
+			// frame header, block size, block and endmark
+			m_memOutput = Memory::create(LZ4_FRAME_HEADER_SIZE_MAX + 4 + Lz4::getCompressBound(sizeBlock) + 8);
+			if (m_memOutput.isNull()) {
+				m_memInput.setNull();
+				return sl_false;
+			}
+		}
+		if (m_memTable.isNull()) {
+			m_memTable = Memory::create(sizeof(sl_uint32) * LZ4_HASH_SIZE);
+			if (m_memTable.isNull()) {
+				return sl_false;
+			}
+		}
+		m_sizeBlock = sizeBlock;
+		m_flagContentChecksum = flagContentChecksum;
+		if (flagContentChecksum) {
+			XXH32_STATE(m_checksum)->start(0);
+		}
+		m_flagHeaderWritten = sl_false;
+		m_flagFinished = sl_false;
+		m_sizeInput = 0;
+		m_sizeOutput = 0;
+		m_posOutput = 0;
+		m_flagStarted = sl_true;
+		return sl_true;
+	}
+
+	sl_int32 Lz4Compress::compress(
+		const void* _input, sl_uint32 sizeInputAvailable, sl_uint32& sizeInputPassed
+		, void* _output, sl_uint32 sizeOutputAvailable, sl_uint32& sizeOutputUsed
+		, sl_bool flagFinish)
+	{
+		sizeInputPassed = 0;
+		sizeOutputUsed = 0;
+		if (!m_flagStarted) {
+			return -1;
+		}
+		const sl_uint8* input = (const sl_uint8*)_input;
+		sl_uint8* output = (sl_uint8*)_output;
+		for (;;) {
+			if (m_posOutput < m_sizeOutput) {
+				sizeOutputUsed += _writePending(output + sizeOutputUsed, sizeOutputAvailable - sizeOutputUsed);
+				if (m_posOutput < m_sizeOutput) {
+					return 1;
+				}
+			}
+			m_posOutput = 0;
+			m_sizeOutput = 0;
+			if (m_flagFinished) {
+				abort();
+				return 0;
+			}
+			if (!m_flagHeaderWritten) {
+				_writeHeader();
+				continue;
+			}
+			sl_uint32 sizeRemain = sizeInputAvailable - sizeInputPassed;
+			if (sizeRemain) {
+				if (!m_sizeInput && sizeRemain >= m_sizeBlock) {
+					// compresses directly from the input
+					_compressBlock(input + sizeInputPassed, m_sizeBlock);
+					sizeInputPassed += m_sizeBlock;
+				} else {
+					sl_uint32 n = m_sizeBlock - m_sizeInput;
+					if (n > sizeRemain) {
+						n = sizeRemain;
+					}
+					Base::copyMemory((sl_uint8*)(m_memInput.getData()) + m_sizeInput, input + sizeInputPassed, n);
+					sizeInputPassed += n;
+					m_sizeInput += n;
+					if (m_sizeInput == m_sizeBlock) {
+						_compressBlock((sl_uint8*)(m_memInput.getData()), m_sizeBlock);
+						m_sizeInput = 0;
+					}
+				}
+				continue;
+			}
+			if (flagFinish) {
+				if (m_sizeInput) {
+					_compressBlock((sl_uint8*)(m_memInput.getData()), m_sizeInput);
+					m_sizeInput = 0;
+					continue;
+				}
+				// endmark
+				sl_uint8* pending = (sl_uint8*)(m_memOutput.getData());
+				MIO::writeUint32LE(pending, 0);
+				m_sizeOutput = 4;
+				if (m_flagContentChecksum) {
+					MIO::writeUint32LE(pending + 4, XXH32_STATE(m_checksum)->finish());
+					m_sizeOutput = 8;
+				}
+				m_flagFinished = sl_true;
+				continue;
+			}
+			return 1;
+		}
+	}
+
+	Memory Lz4Compress::compress(const void* data, sl_size size, sl_bool flagFinish)
+	{
+		return Compressor::compress(data, size, flagFinish);
+	}
+
+	sl_int32 Lz4Compress::flush(void* _output, sl_uint32 sizeOutputAvailable, sl_uint32& sizeOutputUsed)
+	{
+		sizeOutputUsed = 0;
+		if (!m_flagStarted) {
+			return -1;
+		}
+		sl_uint8* output = (sl_uint8*)_output;
+		for (;;) {
+			if (m_posOutput < m_sizeOutput) {
+				sizeOutputUsed += _writePending(output + sizeOutputUsed, sizeOutputAvailable - sizeOutputUsed);
+				if (m_posOutput < m_sizeOutput) {
+					return 1;
+				}
+			}
+			m_posOutput = 0;
+			m_sizeOutput = 0;
+			if (m_flagFinished) {
+				return 0;
+			}
+			if (!m_flagHeaderWritten) {
+				_writeHeader();
+				continue;
+			}
+			if (m_sizeInput) {
+				_compressBlock((sl_uint8*)(m_memInput.getData()), m_sizeInput);
+				m_sizeInput = 0;
+				continue;
+			}
+			return 0;
+		}
+	}
+
+	Memory Lz4Compress::flush()
+	{
+		return Compressor::flush();
+	}
+
+	void Lz4Compress::abort()
+	{
+		m_flagStarted = sl_false;
+	}
+
+	void Lz4Compress::_writeHeader()
+	{
+		sl_uint8* pending = (sl_uint8*)(m_memOutput.getData()) + m_sizeOutput;
+		MIO::writeUint32LE(pending, LZ4_FRAME_MAGIC);
+		// version 01, independent blocks
+		pending[4] = (sl_uint8)(0x60 | (m_flagContentChecksum ? 0x04 : 0));
+		pending[5] = (sl_uint8)(_Lz4_getBlockSizeId(m_sizeBlock) << 4);
+		pending[6] = _Lz4_getHeaderChecksum(pending + 4, 2);
+		m_sizeOutput += LZ4_FRAME_HEADER_SIZE_MIN;
+		m_flagHeaderWritten = sl_true;
+	}
+
+	void Lz4Compress::_compressBlock(const sl_uint8* data, sl_uint32 size)
+	{
+		if (m_flagContentChecksum) {
+			XXH32_STATE(m_checksum)->update(data, size);
+		}
+		sl_uint8* pending = (sl_uint8*)(m_memOutput.getData()) + m_sizeOutput;
+		sl_size sizeCompressed = _Lz4_compressBlock(data, size, pending + 4, (sl_uint32*)(m_memTable.getData()));
+		if (sizeCompressed < size) {
+			MIO::writeUint32LE(pending, (sl_uint32)sizeCompressed);
+			m_sizeOutput += 4 + (sl_uint32)sizeCompressed;
+		} else {
+			MIO::writeUint32LE(pending, size | LZ4_BLOCK_UNCOMPRESSED);
+			Base::copyMemory(pending + 4, data, size);
+			m_sizeOutput += 4 + size;
+		}
+	}
+
+	sl_uint32 Lz4Compress::_writePending(sl_uint8* output, sl_uint32 sizeOutput)
+	{
+		sl_uint32 n = m_sizeOutput - m_posOutput;
+		if (n > sizeOutput) {
+			n = sizeOutput;
+		}
+		Base::copyMemory(output, (sl_uint8*)(m_memOutput.getData()) + m_posOutput, n);
+		m_posOutput += n;
+		return n;
+	}
+
+
+	enum _Lz4_DecompressState
+	{
+		_Lz4_DecompressState_Header = 0,
+		_Lz4_DecompressState_BlockSize = 1,
+		_Lz4_DecompressState_BlockData = 2,
+		_Lz4_DecompressState_BlockChecksum = 3,
+		_Lz4_DecompressState_ContentChecksum = 4,
+		_Lz4_DecompressState_Finished = 5
+	};
+
+	Lz4Decompress::Lz4Decompress()
+	{
+		m_flagStarted = sl_false;
+	}
+
+	Lz4Decompress::~Lz4Decompress()
+	{
+		abort();
+	}
+
+	sl_bool Lz4Decompress::isStarted()
+	{
+		return m_flagStarted;
+	}
+
+	sl_bool Lz4Decompress::start()
+	{
+		if (m_flagStarted) {
+			abort();
+		}
+		m_state = _Lz4_DecompressState_Header;
+		m_sizeHeader = 0;
+		// magic number, FLG and BD
+		m_sizeHeaderNeeded = 6;
+		m_sizeBlockMax = 0;
+		m_sizeInput = 0;
+		m_posOutput = 0;
+		m_endOutput = 0;
+		m_flagStarted = sl_true;
+		return sl_true;
+	}
+
+	sl_int32 Lz4Decompress::decompress(
+		const void* _input, sl_uint32 sizeInputAvailable, sl_uint32& sizeInputPassed
+		, void* _output, sl_uint32 sizeOutputAvailable, sl_uint32& sizeOutputUsed)
+	{
+		sizeInputPassed = 0;
+		sizeOutputUsed = 0;
+		if (!m_flagStarted) {
+			return -1;
+		}
+		const sl_uint8* input = (const sl_uint8*)_input;
+		sl_uint8* output = (sl_uint8*)_output;
+		for (;;) {
+			if (m_posOutput < m_endOutput) {
+				sl_uint32 n = m_endOutput - m_posOutput;
+				if (n > sizeOutputAvailable - sizeOutputUsed) {
+					n = sizeOutputAvailable - sizeOutputUsed;
+				}
+				Base::copyMemory(output + sizeOutputUsed, (sl_uint8*)(m_memOutput.getData()) + m_posOutput, n);
+				sizeOutputUsed += n;
+				m_posOutput += n;
+				if (m_posOutput < m_endOutput) {
+					return 1;
+				}
+			}
+			if (m_state == _Lz4_DecompressState_Finished) {
+				abort();
+				return 0;
+			}
+			sl_uint32 sizeRemain = sizeInputAvailable - sizeInputPassed;
+			if (m_state == _Lz4_DecompressState_BlockData) {
+				if (!m_sizeInput && sizeRemain >= m_sizeBlock && !m_flagBlockChecksum) {
+					// decompresses directly from the input
+					sl_reg n = _decompressBlock(input + sizeInputPassed, m_sizeBlock, output + sizeOutputUsed, sizeOutputAvailable - sizeOutputUsed);
+					if (n < 0) {
+						abort();
+						return -1;
+					}
+					sizeInputPassed += m_sizeBlock;
+					sizeOutputUsed += (sl_uint32)n;
+				} else {
+					if (!sizeRemain) {
+						return 1;
+					}
+					sl_uint32 n = m_sizeBlock - m_sizeInput;
+					if (n > sizeRemain) {
+						n = sizeRemain;
+					}
+					Base::copyMemory((sl_uint8*)(m_memInput.getData()) + m_sizeInput, input + sizeInputPassed, n);
+					sizeInputPassed += n;
+					m_sizeInput += n;
+					if (m_sizeInput < m_sizeBlock) {
+						return 1;
+					}
+					if (m_flagBlockChecksum) {
+						m_state = _Lz4_DecompressState_BlockChecksum;
+						m_sizeHeader = 0;
+						m_sizeHeaderNeeded = 4;
+						continue;
+					}
+					sl_reg nDirect = _decompressBlock((sl_uint8*)(m_memInput.getData()), m_sizeBlock, output + sizeOutputUsed, sizeOutputAvailable - sizeOutputUsed);
+					if (nDirect < 0) {
+						abort();
+						return -1;
+					}
+					sizeOutputUsed += (sl_uint32)nDirect;
+				}
+				continue;
+			}
+			// small fields
+			if (m_sizeHeader < m_sizeHeaderNeeded) {
+				if (!sizeRemain) {
+					return 1;
+				}
+				sl_uint32 n = m_sizeHeaderNeeded - m_sizeHeader;
+				if (n > sizeRemain) {
+					n = sizeRemain;
+				}
+				Base::copyMemory(m_header + m_sizeHeader, input + sizeInputPassed, n);
+				sizeInputPassed += n;
+				m_sizeHeader += n;
+				if (m_sizeHeader < m_sizeHeaderNeeded) {
+					return 1;
+				}
+			}
+			switch (m_state) {
+				case _Lz4_DecompressState_Header:
+					if (!(_parseHeader())) {
+						abort();
+						return -1;
+					}
+					break;
+				case _Lz4_DecompressState_BlockSize:
+					{
+						sl_uint32 size = MIO::readUint32LE(m_header);
+						if (size) {
+							m_sizeBlock = size & (~LZ4_BLOCK_UNCOMPRESSED);
+							m_flagBlockCompressed = !(size & LZ4_BLOCK_UNCOMPRESSED);
+							if (!m_sizeBlock || m_sizeBlock > m_sizeBlockMax) {
+								abort();
+								return -1;
+							}
+							m_sizeInput = 0;
+							m_state = _Lz4_DecompressState_BlockData;
+						} else {
+							// endmark
+							if (m_flagContentChecksum) {
+								m_state = _Lz4_DecompressState_ContentChecksum;
+								m_sizeHeader = 0;
+								m_sizeHeaderNeeded = 4;
+							} else {
+								m_state = _Lz4_DecompressState_Finished;
+							}
+						}
+					}
+					break;
+				case _Lz4_DecompressState_BlockChecksum:
+					if (_Lz4_XXH32::execute(m_memInput.getData(), m_sizeBlock) != MIO::readUint32LE(m_header)) {
+						abort();
+						return -1;
+					}
+					{
+						sl_reg n = _decompressBlock((sl_uint8*)(m_memInput.getData()), m_sizeBlock, output + sizeOutputUsed, sizeOutputAvailable - sizeOutputUsed);
+						if (n < 0) {
+							abort();
+							return -1;
+						}
+						sizeOutputUsed += (sl_uint32)n;
+					}
+					break;
+				case _Lz4_DecompressState_ContentChecksum:
+					if (XXH32_STATE(m_checksum)->finish() != MIO::readUint32LE(m_header)) {
+						abort();
+						return -1;
+					}
+					m_state = _Lz4_DecompressState_Finished;
+					break;
+				default:
+					abort();
+					return -1;
+			}
+		}
+	}
+
+	Memory Lz4Decompress::decompress(const void* data, sl_size size)
+	{
+		return Decompressor::decompress(data, size);
+	}
+
+	void Lz4Decompress::abort()
+	{
+		m_flagStarted = sl_false;
+	}
+
+	sl_bool Lz4Decompress::_parseHeader()
+	{
+		sl_uint8* header = m_header;
+		if (m_sizeHeaderNeeded == 6) {
+			if (MIO::readUint32LE(header) != LZ4_FRAME_MAGIC) {
+				return sl_false;
+			}
+			sl_uint8 flg = header[4];
+			sl_uint8 bd = header[5];
+			// version 01, reserved bit
+			if ((flg & 0xC2) != 0x40) {
+				return sl_false;
+			}
+			// the frames depending on the external dictionary are not supported
+			if (flg & 0x01) {
+				return sl_false;
+			}
+			sl_uint32 idBlockSize = (bd >> 4) & 7;
+			if ((bd & 0x8F) || idBlockSize < 4) {
+				return sl_false;
+			}
+			// content size (8 bytes) and header checksum
+			m_sizeHeaderNeeded = 6 + ((flg & 0x08) ? 8 : 0) + 1;
+			return sl_true;
+		}
+		sl_uint32 sizeHeader = m_sizeHeaderNeeded;
+		if (_Lz4_getHeaderChecksum(header + 4, sizeHeader - 5) != header[sizeHeader - 1]) {
+			return sl_false;
+		}
+		sl_uint8 flg = header[4];
+		m_flagLinkedBlocks = !(flg & 0x20);
+		m_flagBlockChecksum = (flg & 0x10) != 0;
+		m_flagContentChecksum = (flg & 0x04) != 0;
+		sl_uint32 sizeBlockMax = _Lz4_getBlockSize((header[5] >> 4) & 7);
+		sl_uint32 sizeOutput = sizeBlockMax + (m_flagLinkedBlocks ? LZ4_HISTORY_SIZE : 0);
+		if (m_memInput.getSize() < sizeBlockMax) {
+			m_memInput = Memory::create(sizeBlockMax);
+			if (m_memInput.isNull()) {
+				return sl_false;
+			}
+		}
+		if (m_memOutput.getSize() < sizeOutput) {
+			m_memOutput = Memory::create(sizeOutput);
+			if (m_memOutput.isNull()) {
+				return sl_false;
+			}
+		}
+		m_sizeBlockMax = sizeBlockMax;
+		if (m_flagContentChecksum) {
+			XXH32_STATE(m_checksum)->start(0);
+		}
+		m_posOutput = 0;
+		m_endOutput = 0;
+		m_state = _Lz4_DecompressState_BlockSize;
+		m_sizeHeader = 0;
+		m_sizeHeaderNeeded = 4;
+		return sl_true;
+	}
+
+	/*
+		The block is decoded into the output directly when it fits and no history is kept,
+		otherwise into the internal buffer to be drained by the next calls.
+	*/
+	sl_reg Lz4Decompress::_decompressBlock(const sl_uint8* data, sl_uint32 size, sl_uint8* output, sl_uint32 sizeOutput)
+	{
+		sl_uint8* decoded;
+		sl_uint32 sizeDecoded;
+		sl_uint32 sizeDirect = 0;
+		if (!m_flagLinkedBlocks && sizeOutput >= m_sizeBlockMax) {
+			if (m_flagBlockCompressed) {
+				sl_reg n = _Lz4_decompressBlock(data, size, output, m_sizeBlockMax, 0);
+				if (n < 0) {
+					return -1;
+				}
+				sizeDecoded = (sl_uint32)n;
+			} else {
+				Base::copyMemory(output, data, size);
+				sizeDecoded = size;
+			}
+			decoded = output;
+			sizeDirect = sizeDecoded;
+		} else {
+			sl_uint8* buf = (sl_uint8*)(m_memOutput.getData());
+			sl_uint32 sizeHistory = 0;
+			if (m_flagLinkedBlocks) {
+				// keeps the last 64KB of the decoded data in front of the block
+				sizeHistory = m_endOutput;
+				if (sizeHistory > LZ4_HISTORY_SIZE) {
+					// forward copy to the lower address
+					Base::copyMemory(buf, buf + sizeHistory - LZ4_HISTORY_SIZE, LZ4_HISTORY_SIZE);
+					sizeHistory = LZ4_HISTORY_SIZE;
+				}
+			}
+			decoded = buf + sizeHistory;
+			if (m_flagBlockCompressed) {
+				sl_reg n = _Lz4_decompressBlock(data, size, decoded, m_sizeBlockMax, sizeHistory);
+				if (n < 0) {
+					return -1;
+				}
+				sizeDecoded = (sl_uint32)n;
+			} else {
+				Base::copyMemory(decoded, data, size);
+				sizeDecoded = size;
+			}
+			m_posOutput = sizeHistory;
+			m_endOutput = sizeHistory + sizeDecoded;
+		}
+		if (m_flagContentChecksum) {
+			XXH32_STATE(m_checksum)->update(decoded, sizeDecoded);
+		}
+		m_state = _Lz4_DecompressState_BlockSize;
+		m_sizeHeader = 0;
+		m_sizeHeaderNeeded = 4;
+		return sizeDirect;
+	}
+
+}
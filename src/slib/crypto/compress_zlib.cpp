@@ -10,6 +10,11 @@
 
 #include "../../../inc/slib/crypto/zlib.h"
 
+#include "../../../inc/slib/core/mio.h"
+#include "../../../inc/slib/core/cpu.h"
+#include "../../../inc/slib/core/event.h"
+#include "../../../inc/slib/core/thread_pool.h"
+
 #include "../../../inc/thirdparty/zlib/zlib.h"
 
 #define STREAM ((z_stream*)(this->m_stream))
@@ -134,54 +139,371 @@ namespace slib
 		return 1;
 	}
 
-	Memory ZlibCompress::compress(const void* _data, sl_size size, sl_bool flagFinish)
+	Memory ZlibCompress::compress(const void* data, sl_size size, sl_bool flagFinish)
 	{
-		Memory ret;
-		sl_uint8* data = (sl_uint8*)_data;
-		sl_uint32 sizeChunk;
-		if (size > 16384) {
-			sizeChunk = 262144;
-		} else {
-			sizeChunk = 4096;
+		return Compressor::compress(data, size, flagFinish);
+	}
+
+	sl_int32 ZlibCompress::flush(void* output, sl_uint32 sizeOutputAvailable, sl_uint32& sizeOutputUsed)
+	{
+		sizeOutputUsed = 0;
+		if (!m_flagStarted) {
+			return Z_STREAM_ERROR;
+		}
+		z_stream* stream = STREAM;
+		stream->next_in = sl_null;
+		stream->avail_in = 0;
+		stream->next_out = (Bytef*)output;
+		stream->avail_out = sizeOutputAvailable;
+		int iRet = deflate(stream, Z_SYNC_FLUSH);
+		// Z_BUF_ERROR: nothing to flush
+		if (iRet < 0 && iRet != Z_BUF_ERROR) {
+			abort();
+			return iRet;
+		}
+		sizeOutputUsed = sizeOutputAvailable - stream->avail_out;
+		if (stream->avail_out) {
+			return 0;
 		}
-		Memory memChunk = Memory::create(sizeChunk);
-		if (memChunk.isEmpty()) {
-			return ret;
+		return 1;
+	}
+
+	Memory ZlibCompress::flush()
+	{
+		return Compressor::flush();
+	}
+
+	void ZlibCompress::abort()
+	{
+		if (m_flagStarted) {
+			deflateEnd(STREAM);
+			m_flagStarted = sl_false;
 		}
-		sl_uint8* chunk = (sl_uint8*)(memChunk.getData());
+	}
+
 
-		MemoryBuffer buffer;
-		while (1) {
-			sl_uint32 sizeInput = (sl_uint32)(SLIB_MIN(size, sizeChunk));
-			sl_uint32 sizeInputPassed = 0, sizeOutputUsed = 0;
-			sl_int32 iRet = compress(data, sizeInput, sizeInputPassed, chunk, sizeChunk, sizeOutputUsed, flagFinish && sizeInput < sizeChunk);
-			if (iRet < 0) {
-				return ret;
+#define ZLIB_PARALLEL_BLOCK_SIZE_DEFAULT 131072
+#define ZLIB_PARALLEL_BLOCK_SIZE_MIN 65536
+#define ZLIB_PARALLEL_DICTIONARY_SIZE 32768
+
+	class _ZlibParallel_Block : public Referable
+	{
+	public:
+		Memory input;
+		sl_uint32 sizeInput;
+		// previous block, the last 32KB is used as the dictionary
+		Memory dictionary;
+		sl_int32 level;
+		sl_bool flagLast;
+
+		Memory output;
+		sl_uint32 sizeOutput;
+		sl_uint32 crc;
+		sl_bool flagSuccess;
+
+		Ref<Event> eventDone;
+
+	public:
+		void run()
+		{
+			crc = Zlib::crc32(0, input.getData(), sizeInput);
+			flagSuccess = sl_false;
+			z_stream stream;
+			Base::zeroMemory(&stream, sizeof(z_stream));
+			if (deflateInit2(&stream, level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) == Z_OK) {
+				flagSuccess = deflateBlock(&stream);
+				deflateEnd(&stream);
 			}
-			if (sizeOutputUsed > 0) {
-				buffer.add(Memory::create(chunk, sizeOutputUsed));
+			input.setNull();
+			dictionary.setNull();
+			if (eventDone.isNotNull()) {
+				eventDone->set();
 			}
-			data += sizeInputPassed;
-			size -= sizeInputPassed;
-			if (iRet == 0) {
-				break;
+		}
+
+		sl_bool deflateBlock(z_stream* stream)
+		{
+			sl_size sizeDictionary = dictionary.getSize();
+			if (sizeDictionary) {
+				sl_uint8* dict = (sl_uint8*)(dictionary.getData());
+				if (sizeDictionary > ZLIB_PARALLEL_DICTIONARY_SIZE) {
+					dict += sizeDictionary - ZLIB_PARALLEL_DICTIONARY_SIZE;
+					sizeDictionary = ZLIB_PARALLEL_DICTIONARY_SIZE;
+				}
+				if (deflateSetDictionary(stream, dict, (uInt)sizeDictionary) != Z_OK) {
+					return sl_false;
+				}
 			}
-			if (size == 0 && sizeOutputUsed == 0) {
-				break;
+			// the sync flush appends an empty stored block (5 bytes) over the bound for Z_FINISH
+			sl_uint32 sizeBound = (sl_uint32)(deflateBound(stream, sizeInput)) + 16;
+			output = Memory::create(sizeBound);
+			if (output.isNull()) {
+				return sl_false;
 			}
+			stream->next_in = (Bytef*)(input.getData());
+			stream->avail_in = sizeInput;
+			stream->next_out = (Bytef*)(output.getData());
+			stream->avail_out = sizeBound;
+			// the sync flush ends the block at a byte boundary without the final bit, so that the next block can be appended
+			int iRet = deflate(stream, flagLast ? Z_FINISH : Z_SYNC_FLUSH);
+			if (flagLast) {
+				if (iRet != Z_STREAM_END) {
+					return sl_false;
+				}
+			} else {
+				if (iRet != Z_OK || stream->avail_in || !(stream->avail_out)) {
+					return sl_false;
+				}
+			}
+			sizeOutput = sizeBound - stream->avail_out;
+			return sl_true;
 		}
-		ret = buffer.merge();
-		return ret;
+
+	};
+
+	ZlibParallelCompress::ZlibParallelCompress()
+	{
+		m_level = 6;
+		m_sizeBlock = ZLIB_PARALLEL_BLOCK_SIZE_DEFAULT;
+		m_nThreads = 1;
+		m_sizeFilled = 0;
+		m_crc = 0;
+		m_sizeTotal = 0;
+		m_flagStarted = sl_false;
 	}
 
-	void ZlibCompress::abort()
+	ZlibParallelCompress::~ZlibParallelCompress()
+	{
+		abort();
+	}
+
+	sl_bool ZlibParallelCompress::isStarted()
+	{
+		return m_flagStarted;
+	}
+
+	sl_bool ZlibParallelCompress::startGzip(const Ptr<IWriter>& _output, const GzipParam& param, sl_int32 level)
 	{
 		if (m_flagStarted) {
-			deflateEnd(STREAM);
-			m_flagStarted = sl_false;
+			abort();
+		}
+		Ptr<IWriter> output = _output.lock();
+		if (output.isNull()) {
+			return sl_false;
+		}
+		if (level < 0) {
+			level = 6;
+		} else if (level > 9) {
+			level = 9;
+		}
+		m_memBlock = Memory::create(m_sizeBlock);
+		if (m_memBlock.isNull()) {
+			return sl_false;
+		}
+
+		// gzip header, same as the one written by ZlibCompress::startGzip
+		sl_size lenName = param.fileName.getLength();
+		sl_size lenComment = param.comment.getLength();
+		sl_size sizeHeader = 10;
+		sl_uint8 flags = 0;
+		if (lenName) {
+			flags |= 0x08; // FNAME
+			sizeHeader += lenName + 1;
+		}
+		if (lenComment) {
+			flags |= 0x10; // FCOMMENT
+			sizeHeader += lenComment + 1;
+		}
+		Memory memHeader = Memory::create(sizeHeader);
+		if (memHeader.isNull()) {
+			return sl_false;
+		}
+		sl_uint8* header = (sl_uint8*)(memHeader.getData());
+		Base::zeroMemory(header, 10);
+		header[0] = 0x1f;
+		header[1] = 0x8b;
+		header[2] = Z_DEFLATED;
+		header[3] = flags;
+		header[8] = (sl_uint8)(level == 9 ? 2 : (level < 2 ? 4 : 0));
+		header[9] = 255; // OS: unknown
+		sl_uint8* p = header + 10;
+		if (lenName) {
+			Base::copyMemory(p, param.fileName.getData(), lenName + 1);
+			p += lenName + 1;
+		}
+		if (lenComment) {
+			Base::copyMemory(p, param.comment.getData(), lenComment + 1);
+		}
+		if (output->writeFully(header, sizeHeader) != (sl_reg)sizeHeader) {
+			m_memBlock.setNull();
+			return sl_false;
+		}
+
+		m_output = output;
+		m_level = level;
+		m_nThreads = Cpu::getCoresCount();
+		m_sizeFilled = 0;
+		m_memPrevBlock.setNull();
+		m_blocks.removeAll_NoLock();
+		m_crc = 0;
+		m_sizeTotal = 0;
+		m_flagStarted = sl_true;
+		return sl_true;
+	}
+
+	sl_bool ZlibParallelCompress::startGzip(const Ptr<IWriter>& output, sl_int32 level)
+	{
+		GzipParam param;
+		return startGzip(output, param, level);
+	}
+
+	void ZlibParallelCompress::setBlockSize(sl_uint32 size)
+	{
+		if (size < ZLIB_PARALLEL_BLOCK_SIZE_MIN) {
+			size = ZLIB_PARALLEL_BLOCK_SIZE_MIN;
+		}
+		m_sizeBlock = size;
+	}
+
+	sl_reg ZlibParallelCompress::write(const void* _data, sl_size size)
+	{
+		if (!m_flagStarted) {
+			return -1;
+		}
+		const sl_uint8* data = (const sl_uint8*)_data;
+		sl_size sizeRemain = size;
+		while (sizeRemain) {
+			sl_uint32 n = m_sizeBlock - m_sizeFilled;
+			if (n > sizeRemain) {
+				n = (sl_uint32)sizeRemain;
+			}
+			Base::copyMemory((sl_uint8*)(m_memBlock.getData()) + m_sizeFilled, data, n);
+			m_sizeFilled += n;
+			data += n;
+			sizeRemain -= n;
+			if (m_sizeFilled == m_sizeBlock) {
+				if (!(_dispatchBlock(sl_false))) {
+					abort();
+					return -1;
+				}
+			}
+		}
+		return size;
+	}
+
+	sl_bool ZlibParallelCompress::finish()
+	{
+		if (!m_flagStarted) {
+			return sl_false;
+		}
+		if (!(_dispatchBlock(sl_true))) {
+			abort();
+			return sl_false;
+		}
+		sl_uint8 trailer[8];
+		MIO::writeUint32LE(trailer, m_crc);
+		MIO::writeUint32LE(trailer + 4, (sl_uint32)m_sizeTotal);
+		sl_bool flagSuccess = sl_false;
+		Ptr<IWriter> output = m_output.lock();
+		if (output.isNotNull()) {
+			flagSuccess = output->writeFully(trailer, 8) == 8;
+		}
+		abort();
+		return flagSuccess;
+	}
+
+	void ZlibParallelCompress::abort()
+	{
+		// the blocks being compressed are kept alive by their tasks
+		m_blocks.removeAll_NoLock();
+		m_memBlock.setNull();
+		m_memPrevBlock.setNull();
+		m_output.setNull();
+		m_flagStarted = sl_false;
+	}
+
+	sl_bool ZlibParallelCompress::_dispatchBlock(sl_bool flagLast)
+	{
+		Ref<_ZlibParallel_Block> block = new _ZlibParallel_Block;
+		if (block.isNull()) {
+			return sl_false;
+		}
+		block->input = m_memBlock;
+		block->sizeInput = m_sizeFilled;
+		block->dictionary = m_memPrevBlock;
+		block->level = m_level;
+		block->flagLast = flagLast;
+		block->sizeOutput = 0;
+		block->crc = 0;
+		block->flagSuccess = sl_false;
+		m_sizeTotal += m_sizeFilled;
+
+		m_memPrevBlock = m_memBlock;
+		m_sizeFilled = 0;
+		if (flagLast) {
+			m_memBlock.setNull();
+		} else {
+			m_memBlock = Memory::create(m_sizeBlock);
+			if (m_memBlock.isNull()) {
+				return sl_false;
+			}
+		}
+
+		Ref<ThreadPool> pool;
+		if (m_nThreads > 1) {
+			pool = ThreadPool::getComputePool();
+		}
+		sl_bool flagQueued = sl_false;
+		if (pool.isNotNull()) {
+			block->eventDone = Event::create(sl_false);
+			if (block->eventDone.isNotNull()) {
+				flagQueued = pool->addTask([block]() {
+					block->run();
+				});
+			}
+		}
+		if (!flagQueued) {
+			block->eventDone.setNull();
+			block->run();
+		}
+		if (!(m_blocks.push_NoLock(block))) {
+			return sl_false;
+		}
+
+		// keeps enough blocks in flight to feed all the threads, while bounding the memory
+		sl_size nMaxBlocks = flagLast ? 0 : (sl_size)(m_nThreads) * 2;
+		while (m_blocks.getCount() > nMaxBlocks) {
+			Ref<_ZlibParallel_Block> front;
+			m_blocks.pop_NoLock(&front);
+			if (!(_writeBlock(front.get()))) {
+				return sl_false;
+			}
 		}
+		return sl_true;
 	}
 
+	sl_bool ZlibParallelCompress::_writeBlock(_ZlibParallel_Block* block)
+	{
+		if (block->eventDone.isNotNull()) {
+			block->eventDone->wait();
+		}
+		if (!(block->flagSuccess)) {
+			return sl_false;
+		}
+		m_crc = Zlib::crc32Combine(m_crc, block->crc, block->sizeInput);
+		Ptr<IWriter> output = m_output.lock();
+		if (output.isNull()) {
+			return sl_false;
+		}
+		sl_reg sizeOutput = (sl_reg)(block->sizeOutput);
+		if (output->writeFully(block->output.getData(), sizeOutput) != sizeOutput) {
+			return sl_false;
+		}
+		block->output.setNull();
+		return sl_true;
+	}
+
+
 	ZlibDecompress::ZlibDecompress()
 	{
 		m_flagStarted = sl_false;
@@ -256,44 +578,9 @@ namespace slib
 		return 1;
 	}
 
-	Memory ZlibDecompress::decompress(const void* _data, sl_size size)
+	Memory ZlibDecompress::decompress(const void* data, sl_size size)
 	{
-		Memory ret;
-		sl_uint8* data = (sl_uint8*)_data;
-		sl_uint32 sizeChunk;
-		if (size > 16384) {
-			sizeChunk = 262144;
-		} else {
-			sizeChunk = 4096;
-		}
-		Memory memChunk = Memory::create(sizeChunk);
-		if (memChunk.isEmpty()) {
-			return ret;
-		}
-		sl_uint8* chunk = (sl_uint8*)(memChunk.getData());
-
-		MemoryBuffer buffer;
-		while (1) {
-			sl_uint32 sizeInput = (sl_uint32)(SLIB_MIN(size, sizeChunk));
-			sl_uint32 sizeInputPassed = 0, sizeOutputUsed = 0;
-			sl_int32 iRet = decompress(data, sizeInput, sizeInputPassed, chunk, sizeChunk, sizeOutputUsed);
-			if (iRet < 0) {
-				return ret;
-			}
-			if (sizeOutputUsed > 0) {
-				buffer.add(Memory::create(chunk, sizeOutputUsed));
-			}
-			data += sizeInputPassed;
-			size -= sizeInputPassed;
-			if (iRet == 0) {
-				break;
-			}
-			if (size == 0 && sizeOutputUsed == 0) {
-				break;
-			}
-		}
-		ret = buffer.merge();
-		return ret;
+		return Decompressor::decompress(data, size);
 	}
 
 	void ZlibDecompress::abort()
@@ -304,67 +591,6 @@ namespace slib
 		}
 	}
 
-	sl_uint32 Zlib::adler32(sl_uint32 adler, const void* _data, sl_size size)
-	{
-		const char* data = (const char*)_data;
-		while (size > 0) {
-			sl_uint32 n = 0x10000000;
-			if (size < n) {
-				n = (sl_uint32)size;
-			}
-			adler = (sl_uint32)(::adler32(adler, (Bytef*)data, n));
-			size -= n;
-			data += n;
-		}
-		return adler;
-	}
-
-	sl_uint32 Zlib::adler32(const void* data, sl_size size)
-	{
-		return adler32(1, data, size);
-	}
-
-	sl_uint32 Zlib::adler32(sl_uint32 adler, const Memory& mem)
-	{
-		return adler32(adler, mem.getData(), mem.getSize());
-	}
-
-	sl_uint32 Zlib::adler32(const Memory& mem)
-	{
-		return adler32(1, mem.getData(), mem.getSize());
-	}
-
-	sl_uint32 Zlib::crc32(sl_uint32 crc, const void* _data, sl_size size)
-	{
-		const char* data = (const char*)_data;
-		while (size > 0) {
-			sl_uint32 n = 0x10000000;
-			if (size < n) {
-				n = (sl_uint32)size;
-			}
-			crc = (sl_uint32)(::crc32(crc, (Bytef*)data, n));
-			size -= n;
-			data += n;
-		}
-		return crc;
-	}
-
-	sl_uint32 Zlib::crc32(const void* data, sl_size size)
-	{
-		return crc32(0, data, size);
-	}
-
-	sl_uint32 Zlib::crc32(sl_uint32 crc, const Memory& mem)
-	{
-		return crc32(crc, mem.getData(), mem.getSize());
-	}
-
-	sl_uint32 Zlib::crc32(const Memory& mem)
-	{
-		return crc32(0, mem.getData(), mem.getSize());
-	}
-
-
 	Memory Zlib::compress(const void* data, sl_size size, sl_int32 level)
 	{
 		ZlibCompress zlib;
@@ -398,6 +624,32 @@ namespace slib
 		return compressGzip(param, data, size, level);
 	}
 
+	Memory Zlib::compressGzipParallel(const GzipParam& param, const void* data, sl_size size, sl_int32 level, sl_uint32 sizeBlock)
+	{
+		ZlibParallelCompress zlib;
+		if (sizeBlock) {
+			zlib.setBlockSize(sizeBlock);
+		}
+		Ref<MemoryWriter> writer = new MemoryWriter;
+		if (writer.isNull()) {
+			return sl_null;
+		}
+		if (zlib.startGzip(writer, param, level)) {
+			if (zlib.write(data, size) == (sl_reg)size) {
+				if (zlib.finish()) {
+					return writer->getData();
+				}
+			}
+		}
+		return sl_null;
+	}
+
+	Memory Zlib::compressGzipParallel(const void* data, sl_size size, sl_int32 level, sl_uint32 sizeBlock)
+	{
+		GzipParam param;
+		return compressGzipParallel(param, data, size, level, sizeBlock);
+	}
+
 	Memory Zlib::decompress(const void* data, sl_size size)
 	{
 		ZlibDecompress zlib;
@@ -13,6 +13,7 @@
 #include "../../../inc/slib/crypto/md5.h"
 #include "../../../inc/slib/crypto/sha1.h"
 #include "../../../inc/slib/crypto/sha2.h"
+#include "../../../inc/slib/crypto/blake3.h"
 
 #include "../../../inc/slib/core/scoped.h"
 #include "../../../inc/slib/core/mio.h"
@@ -43,6 +44,8 @@ namespace slib
 			return new SHA384();
 		case CryptoHashType::SHA512:
 			return new SHA512();
+		case CryptoHashType::BLAKE3:
+			return new BLAKE3();
 		}
 		return sl_null;
 	}
@@ -77,6 +80,11 @@ namespace slib
 		return new SHA512();
 	}
 
+	Ref<CryptoHash> CryptoHash::blake3()
+	{
+		return new BLAKE3();
+	}
+
 	void CryptoHash::execute(const void* input, sl_size n, void* output)
 	{
 		start();
@@ -172,5 +180,6 @@ namespace slib
 	DEFINE_CRYPTO_HASH(SHA256, 32)
 	DEFINE_CRYPTO_HASH(SHA384, 48)
 	DEFINE_CRYPTO_HASH(SHA512, 64)
+	DEFINE_CRYPTO_HASH(BLAKE3, 32)
 
 }
@@ -11,10 +11,226 @@
 #include "../../../inc/slib/crypto/gcm.h"
 
 #include "../../../inc/slib/crypto/aes.h"
+#include "../../../inc/slib/core/cpu.h"
+
+#if defined(SLIB_CPU_USE_X86_EXTENSIONS)
+#	include <wmmintrin.h>
+#	include <tmmintrin.h>
+#	define GHASH_SUPPORT_CLMUL
+#	define GHASH_TARGET SLIB_CPU_TARGET("pclmul,ssse3")
+#elif defined(SLIB_CPU_USE_ARMV8_CRYPTO)
+#	include <arm_neon.h>
+#	define GHASH_SUPPORT_CLMUL
+#	define GHASH_TARGET
+#endif
+
+#if defined(SLIB_CPU_USE_SSE2)
+#	include <emmintrin.h>
+#elif defined(SLIB_CPU_USE_NEON)
+#	include <arm_neon.h>
+#endif
+
+// count of counter blocks encrypted at once by bulk encryption/decryption
+#define BATCH_BLOCKS 8
 
 namespace slib
 {
 
+/*
+	Carry-less Multiplication
+
+	Elements of GF(2^128) are byte-reflected on loading, so that the bit order of GCM matches the
+	bit order of the polynomial multiplication except for one bit shift (Intel, "Intel Carry-Less
+	Multiplication Instruction and its Usage for Computing the GCM Mode", Algorithm 5).
+	Shifting and reducing are linear, so the 256-bit products of several blocks are summed and then
+	reduced once: X' = (X + D0) * H^n + D1 * H^(n-1) + ... + D(n-1) * H
+*/
+
+#if defined(GHASH_SUPPORT_CLMUL)
+
+#	if defined(SLIB_CPU_USE_X86_EXTENSIONS)
+
+	static sl_bool _g_gcm_flagCLMUL = Cpu::isPCLMULQDQSupported() && Cpu::isSSSE3Supported();
+
+	typedef __m128i _GCM_V;
+
+#		define V_ZERO _mm_setzero_si128()
+#		define V_XOR(a, b) _mm_xor_si128(a, b)
+#		define V_OR(a, b) _mm_or_si128(a, b)
+#		define V_SHL_BYTES(x, n) _mm_slli_si128(x, n)
+#		define V_SHR_BYTES(x, n) _mm_srli_si128(x, n)
+#		define V_SHL32(x, n) _mm_slli_epi32(x, n)
+#		define V_SHR32(x, n) _mm_srli_epi32(x, n)
+		// CLMUL_XY: X selects the half of `a`, Y selects the half of `b`
+#		define V_CLMUL_LL(a, b) _mm_clmulepi64_si128(a, b, 0x00)
+#		define V_CLMUL_HL(a, b) _mm_clmulepi64_si128(a, b, 0x01)
+#		define V_CLMUL_LH(a, b) _mm_clmulepi64_si128(a, b, 0x10)
+#		define V_CLMUL_HH(a, b) _mm_clmulepi64_si128(a, b, 0x11)
+
+	GHASH_TARGET SLIB_INLINE static _GCM_V _GCM_load(const void* p)
+	{
+		return _mm_shuffle_epi8(_mm_loadu_si128((__m128i const*)p), _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+	}
+
+	GHASH_TARGET SLIB_INLINE static void _GCM_store(void* p, _GCM_V v)
+	{
+		_mm_storeu_si128((__m128i*)p, _mm_shuffle_epi8(v, _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15)));
+	}
+
+#	else
+
+	static sl_bool _g_gcm_flagCLMUL = Cpu::isARMv8PMULLSupported();
+
+	typedef uint8x16_t _GCM_V;
+
+#		define V_ZERO vdupq_n_u8(0)
+#		define V_XOR(a, b) veorq_u8(a, b)
+#		define V_OR(a, b) vorrq_u8(a, b)
+#		define V_SHL_BYTES(x, n) vextq_u8(vdupq_n_u8(0), x, 16 - (n))
+#		define V_SHR_BYTES(x, n) vextq_u8(x, vdupq_n_u8(0), n)
+#		define V_SHL32(x, n) vreinterpretq_u8_u32(vshlq_n_u32(vreinterpretq_u32_u8(x), n))
+#		define V_SHR32(x, n) vreinterpretq_u8_u32(vshrq_n_u32(vreinterpretq_u32_u8(x), n))
+#		define V_LANE64(x, i) ((poly64_t)(vgetq_lane_u64(vreinterpretq_u64_u8(x), i)))
+#		define V_CLMUL_LL(a, b) vreinterpretq_u8_p128(vmull_p64(V_LANE64(a, 0), V_LANE64(b, 0)))
+#		define V_CLMUL_HL(a, b) vreinterpretq_u8_p128(vmull_p64(V_LANE64(a, 1), V_LANE64(b, 0)))
+#		define V_CLMUL_LH(a, b) vreinterpretq_u8_p128(vmull_p64(V_LANE64(a, 0), V_LANE64(b, 1)))
+#		define V_CLMUL_HH(a, b) vreinterpretq_u8_p128(vmull_p64(V_LANE64(a, 1), V_LANE64(b, 1)))
+
+	SLIB_INLINE static _GCM_V _GCM_load(const void* p)
+	{
+		uint8x16_t v = vrev64q_u8(vld1q_u8((const sl_uint8*)p));
+		return vextq_u8(v, v, 8);
+	}
+
+	SLIB_INLINE static void _GCM_store(void* p, _GCM_V v)
+	{
+		v = vrev64q_u8(v);
+		vst1q_u8((sl_uint8*)p, vextq_u8(v, v, 8));
+	}
+
+#	endif
+
+	// accumulates the 256-bit product of `a` and `b` into (lo, mid, hi)
+	GHASH_TARGET SLIB_INLINE static void _GCM_multiplyAccumulate(_GCM_V a, _GCM_V b, _GCM_V& lo, _GCM_V& mid, _GCM_V& hi)
+	{
+		lo = V_XOR(lo, V_CLMUL_LL(a, b));
+		hi = V_XOR(hi, V_CLMUL_HH(a, b));
+		mid = V_XOR(mid, V_XOR(V_CLMUL_HL(a, b), V_CLMUL_LH(a, b)));
+	}
+
+	GHASH_TARGET SLIB_INLINE static _GCM_V _GCM_reduce(_GCM_V lo, _GCM_V mid, _GCM_V hi)
+	{
+		lo = V_XOR(lo, V_SHL_BYTES(mid, 8));
+		hi = V_XOR(hi, V_SHR_BYTES(mid, 8));
+
+		// shift the product left by 1 bit
+		_GCM_V t1 = V_SHR32(lo, 31);
+		_GCM_V t2 = V_SHR32(hi, 31);
+		lo = V_SHL32(lo, 1);
+		hi = V_SHL32(hi, 1);
+		_GCM_V t3 = V_SHR_BYTES(t1, 12);
+		t2 = V_SHL_BYTES(t2, 4);
+		t1 = V_SHL_BYTES(t1, 4);
+		lo = V_OR(lo, t1);
+		hi = V_OR(hi, t2);
+		hi = V_OR(hi, t3);
+
+		// reduce by x^128 + x^7 + x^2 + x + 1
+		t1 = V_XOR(V_XOR(V_SHL32(lo, 31), V_SHL32(lo, 30)), V_SHL32(lo, 25));
+		t2 = V_SHR_BYTES(t1, 4);
+		t1 = V_SHL_BYTES(t1, 12);
+		lo = V_XOR(lo, t1);
+		t3 = V_XOR(V_XOR(V_SHR32(lo, 1), V_SHR32(lo, 2)), V_SHR32(lo, 7));
+		t3 = V_XOR(t3, t2);
+		lo = V_XOR(lo, t3);
+		return V_XOR(hi, lo);
+	}
+
+	GHASH_TARGET static _GCM_V _GCM_multiply(_GCM_V a, _GCM_V b)
+	{
+		_GCM_V lo = V_ZERO;
+		_GCM_V mid = V_ZERO;
+		_GCM_V hi = V_ZERO;
+		_GCM_multiplyAccumulate(a, b, lo, mid, hi);
+		return _GCM_reduce(lo, mid, hi);
+	}
+
+	GHASH_TARGET static void _GCM_generatePowers_CLMUL(const void* H, sl_uint8 HP[8][16])
+	{
+		_GCM_V h = _GCM_load(H);
+		_GCM_V p = h;
+		_GCM_store(HP[0], p);
+		for (sl_uint32 i = 1; i < 8; i++) {
+			p = _GCM_multiply(p, h);
+			_GCM_store(HP[i], p);
+		}
+	}
+
+	GHASH_TARGET static void _GCM_multiplyH_CLMUL(const sl_uint8 HP[8][16], const void* X, void* O)
+	{
+		_GCM_store(O, _GCM_multiply(_GCM_load(X), _GCM_load(HP[0])));
+	}
+
+	GHASH_TARGET static void _GCM_multiplyData_CLMUL(const sl_uint8 HP[8][16], void* _X, const sl_uint8* D, sl_size lenD)
+	{
+		_GCM_V X = _GCM_load(_X);
+		_GCM_V H = _GCM_load(HP[0]);
+		if (lenD >= 128) {
+			_GCM_V P[8];
+			for (sl_uint32 i = 0; i < 8; i++) {
+				P[i] = _GCM_load(HP[7 - i]);
+			}
+			do {
+				_GCM_V lo = V_ZERO;
+				_GCM_V mid = V_ZERO;
+				_GCM_V hi = V_ZERO;
+				_GCM_multiplyAccumulate(V_XOR(X, _GCM_load(D)), P[0], lo, mid, hi);
+				_GCM_multiplyAccumulate(_GCM_load(D + 16), P[1], lo, mid, hi);
+				_GCM_multiplyAccumulate(_GCM_load(D + 32), P[2], lo, mid, hi);
+				_GCM_multiplyAccumulate(_GCM_load(D + 48), P[3], lo, mid, hi);
+				_GCM_multiplyAccumulate(_GCM_load(D + 64), P[4], lo, mid, hi);
+				_GCM_multiplyAccumulate(_GCM_load(D + 80), P[5], lo, mid, hi);
+				_GCM_multiplyAccumulate(_GCM_load(D + 96), P[6], lo, mid, hi);
+				_GCM_multiplyAccumulate(_GCM_load(D + 112), P[7], lo, mid, hi);
+				X = _GCM_reduce(lo, mid, hi);
+				D += 128;
+				lenD -= 128;
+			} while (lenD >= 128);
+		}
+		while (lenD >= 16) {
+			X = _GCM_multiply(V_XOR(X, _GCM_load(D)), H);
+			D += 16;
+			lenD -= 16;
+		}
+		if (lenD) {
+			sl_uint8 last[16] = { 0 };
+			Base::copyMemory(last, D, lenD);
+			X = _GCM_multiply(V_XOR(X, _GCM_load(last)), H);
+		}
+		_GCM_store(_X, X);
+	}
+
+#endif
+
+	static void _GCM_xor(sl_uint8* output, const sl_uint8* input, const sl_uint8* mask, sl_size size)
+	{
+		sl_size i = 0;
+#if defined(SLIB_CPU_USE_SSE2)
+		for (; i + 16 <= size; i += 16) {
+			__m128i a = _mm_loadu_si128((__m128i const*)(input + i));
+			__m128i b = _mm_loadu_si128((__m128i const*)(mask + i));
+			_mm_storeu_si128((__m128i*)(output + i), _mm_xor_si128(a, b));
+		}
+#elif defined(SLIB_CPU_USE_NEON)
+		for (; i + 16 <= size; i += 16) {
+			vst1q_u8(output + i, veorq_u8(vld1q_u8(input + i), vld1q_u8(mask + i)));
+		}
+#endif
+		for (; i < size; i++) {
+			output[i] = input[i] ^ mask[i];
+		}
+	}
+
 	void GCM_Table::generateTable(const void* _H)
 	{
 		sl_uint32 i, j;
@@ -50,6 +266,12 @@ namespace slib
 			}
 			i <<= 1;
 		}
+
+#if defined(GHASH_SUPPORT_CLMUL)
+		if (_g_gcm_flagCLMUL) {
+			_GCM_generatePowers_CLMUL(_H, HP);
+		}
+#endif
 	}
 
 	static const sl_uint64 _GCM_R[16] =
@@ -74,6 +296,12 @@ namespace slib
 
 	void GCM_Table::multiplyH(const void* _X, void* _O) const
 	{
+#if defined(GHASH_SUPPORT_CLMUL)
+		if (_g_gcm_flagCLMUL) {
+			_GCM_multiplyH_CLMUL(HP, _X, _O);
+			return;
+		}
+#endif
 		const sl_uint8* X = (const sl_uint8*)_X;
 		sl_uint8* O = (sl_uint8*)_O;
 		Uint128 Z;
@@ -117,6 +345,12 @@ namespace slib
 	{
 		sl_uint8* X = (sl_uint8*)_X;
 		const sl_uint8* D = (const sl_uint8*)_D;
+#if defined(GHASH_SUPPORT_CLMUL)
+		if (_g_gcm_flagCLMUL) {
+			_GCM_multiplyData_CLMUL(HP, X, D, lenD);
+			return;
+		}
+#endif
 		sl_size i, k, n;
 
 		n = lenD >> 4;
@@ -312,25 +546,27 @@ namespace slib
 	template <class BlockCipher>
 	void GCM<BlockCipher>::encrypt(const void* src, void *dst, sl_size len)
 	{
-		sl_uint8 GCTR[16];
-		sl_size i, k, n;
+		sl_uint8 counters[BATCH_BLOCKS << 4];
+		sl_uint8 GCTR[BATCH_BLOCKS << 4];
 		const sl_uint8* P = (const sl_uint8*)src;
 		sl_uint8* C = (sl_uint8*)dst;
 		
-		for (i = 0; i < len; i += 16) {
-			increaseCIV();
-			m_cipher->encryptBlock(CIV, GCTR);
-			n = len - i;
-			if (n > 16) {
-				n = 16;
+		while (len) {
+			sl_size n = len;
+			if (n > (BATCH_BLOCKS << 4)) {
+				n = BATCH_BLOCKS << 4;
 			}
-			for (k = 0; k < n; k++) {
-				*C = *P ^ GCTR[k];
-				GHASH_X[k] ^= *C;
-				C++;
-				P++;
+			sl_size nBlocks = (n + 15) >> 4;
+			for (sl_size i = 0; i < nBlocks; i++) {
+				increaseCIV();
+				Base::copyMemory(counters + (i << 4), CIV, 16);
 			}
-			multiplyH(GHASH_X, GHASH_X);
+			m_cipher->encryptBlocks(counters, GCTR, nBlocks << 4);
+			_GCM_xor(C, P, GCTR, n);
+			multiplyData(GHASH_X, C, n);
+			P += n;
+			C += n;
+			len -= n;
 		}
 	}
 
@@ -355,25 +591,28 @@ namespace slib
 	template <class BlockCipher>
 	void GCM<BlockCipher>::decrypt(const void* src, void *dst, sl_size len)
 	{
-		sl_uint8 GCTR[16];
-		sl_size i, k, n;
+		sl_uint8 counters[BATCH_BLOCKS << 4];
+		sl_uint8 GCTR[BATCH_BLOCKS << 4];
 		const sl_uint8* C = (const sl_uint8*)src;
 		sl_uint8* P = (sl_uint8*)dst;
 		
-		for (i = 0; i < len; i += 16) {
-			increaseCIV();
-			m_cipher->encryptBlock(CIV, GCTR);
-			n = len - i;
-			if (n > 16) {
-				n = 16;
+		while (len) {
+			sl_size n = len;
+			if (n > (BATCH_BLOCKS << 4)) {
+				n = BATCH_BLOCKS << 4;
 			}
-			for (k = 0; k < n; k++) {
-				GHASH_X[k] ^= *C;
-				*P = *C ^ GCTR[k];
-				C++;
-				P++;
+			sl_size nBlocks = (n + 15) >> 4;
+			for (sl_size i = 0; i < nBlocks; i++) {
+				increaseCIV();
+				Base::copyMemory(counters + (i << 4), CIV, 16);
 			}
-			multiplyH(GHASH_X, GHASH_X);
+			m_cipher->encryptBlocks(counters, GCTR, nBlocks << 4);
+			// hashes the ciphertext before writing the plaintext, so that `dst` may be equal to `src`
+			multiplyData(GHASH_X, C, n);
+			_GCM_xor(P, C, GCTR, n);
+			C += n;
+			P += n;
+			len -= n;
 		}
 	}
 
@@ -14,6 +14,8 @@
 #include "../../../inc/slib/core/math.h"
 #include "../../../inc/slib/core/io.h"
 #include "../../../inc/slib/core/scoped.h"
+#include "../../../inc/slib/core/base.h"
+#include "../../../inc/slib/core/thread_pool.h"
 
 namespace slib
 {
@@ -46,37 +48,130 @@ namespace slib
 	}
 
 
-	sl_bool RSA::executePublic(const RSAPublicKey& key, const void* src, void* dst)
+	RSAPublicKeyContext::RSAPublicKeyContext()
 	{
-		sl_size n = key.N.getMostSignificantBytes();
-		BigInt T = BigInt::fromBytesBE(src, n);
-		if (T >= key.N) {
+		m_length = 0;
+	}
+
+	RSAPublicKeyContext::~RSAPublicKeyContext()
+	{
+	}
+
+	sl_bool RSAPublicKeyContext::setKey(const RSAPublicKey& key)
+	{
+		m_length = 0;
+		m_key = key;
+		sl_uint32 n = key.getLength();
+		if (!n) {
 			return sl_false;
 		}
-		T = T.pow_montgomery(key.E, key.N);
-		if (T.isNotNull()) {
-			if (T.getBytesBE(dst, n)) {
-				return sl_true;
-			}
+		m_bytesN = key.N.getBytesBE();
+		if (m_bytesN.getSize() != n) {
+			return sl_false;
 		}
-		return sl_false;
+		if (!(m_montN.setModulus(key.N))) {
+			return sl_false;
+		}
+		m_length = n;
+		return sl_true;
 	}
 
-	sl_bool RSA::executePrivate(const RSAPrivateKey& key, const void* src, void* dst)
+	const RSAPublicKey& RSAPublicKeyContext::getKey() const
 	{
-		sl_size n = key.N.getMostSignificantBytes();
-		BigInt T = BigInt::fromBytesBE(src, n);
-		if (T >= key.N) {
+		return m_key;
+	}
+
+	sl_uint32 RSAPublicKeyContext::getLength() const
+	{
+		return m_length;
+	}
+
+	sl_bool RSAPublicKeyContext::execute(const void* src, void* dst) const
+	{
+		sl_uint32 n = m_length;
+		if (!n) {
+			return sl_false;
+		}
+		if (Base::compareMemory((const sl_uint8*)src, (const sl_uint8*)(m_bytesN.getData()), n) >= 0) {
+			return sl_false;
+		}
+		return m_montN.powBytesBE(src, n, m_key.E, dst, n);
+	}
+
+
+	RSAPrivateKeyContext::RSAPrivateKeyContext()
+	{
+		m_length = 0;
+	}
+
+	RSAPrivateKeyContext::~RSAPrivateKeyContext()
+	{
+	}
+
+	sl_bool RSAPrivateKeyContext::setKey(const RSAPrivateKey& key)
+	{
+		m_length = 0;
+		m_key = key;
+		sl_uint32 n = key.getLength();
+		if (!n) {
+			return sl_false;
+		}
+		m_bytesN = key.N.getBytesBE();
+		if (m_bytesN.getSize() != n) {
 			return sl_false;
 		}
 		if (key.flagUseOnlyD) {
-			T = T.pow_montgomery(key.D, key.N);
+			if (!(m_montN.setModulus(key.N))) {
+				return sl_false;
+			}
 		} else {
-			BigInt TP = T.pow_montgomery(key.DP, key.P);
-			BigInt TQ = T.pow_montgomery(key.DQ, key.Q);
-			T = ((TP - TQ) * key.IQ) % key.P;
-			T = TQ + T * key.Q;
+			if (!(m_montP.setModulus(key.P))) {
+				return sl_false;
+			}
+			if (!(m_montQ.setModulus(key.Q))) {
+				return sl_false;
+			}
+		}
+		m_length = n;
+		return sl_true;
+	}
+
+	const RSAPrivateKey& RSAPrivateKeyContext::getKey() const
+	{
+		return m_key;
+	}
+
+	sl_uint32 RSAPrivateKeyContext::getLength() const
+	{
+		return m_length;
+	}
+
+	sl_bool RSAPrivateKeyContext::execute(const void* src, void* dst) const
+	{
+		sl_uint32 n = m_length;
+		if (!n) {
+			return sl_false;
 		}
+		if (Base::compareMemory((const sl_uint8*)src, (const sl_uint8*)(m_bytesN.getData()), n) >= 0) {
+			return sl_false;
+		}
+		if (m_key.flagUseOnlyD) {
+			return m_montN.powBytesBE(src, n, m_key.D, dst, n);
+		}
+		BigInt T = BigInt::fromBytesBE(src, n);
+		if (T.isNull()) {
+			// zero input: 0^D = 0
+			Base::zeroMemory(dst, n);
+			return sl_true;
+		}
+		// TP or TQ is null (zero) when T is a multiple of P or Q
+		BigInt TP = m_montP.pow(T, m_key.DP);
+		BigInt TQ = m_montQ.pow(T, m_key.DQ);
+		T = ((TP - TQ) * m_key.IQ) % m_key.P;
+		if (T.getSign() < 0) {
+			T += m_key.P;
+		}
+		T = TQ + T * m_key.Q;
 		if (T.isNotNull()) {
 			if (T.getBytesBE(dst, n)) {
 				return sl_true;
@@ -85,20 +180,49 @@ namespace slib
 		return sl_false;
 	}
 
-	static sl_bool _rsa_execute(const RSAPublicKey* keyPublic, const RSAPrivateKey* keyPrivate
+
+	sl_bool RSA::executePublic(const RSAPublicKey& key, const void* src, void* dst)
+	{
+		RSAPublicKeyContext context;
+		if (context.setKey(key)) {
+			return context.execute(src, dst);
+		}
+		return sl_false;
+	}
+
+	sl_bool RSA::executePrivate(const RSAPrivateKey& key, const void* src, void* dst)
+	{
+		RSAPrivateKeyContext context;
+		if (context.setKey(key)) {
+			return context.execute(src, dst);
+		}
+		return sl_false;
+	}
+
+	sl_bool RSA::executePublic(const RSAPublicKeyContext& context, const void* src, void* dst)
+	{
+		return context.execute(src, dst);
+	}
+
+	sl_bool RSA::executePrivate(const RSAPrivateKeyContext& context, const void* src, void* dst)
+	{
+		return context.execute(src, dst);
+	}
+
+	static sl_bool _rsa_execute(const RSAPublicKeyContext* keyPublic, const RSAPrivateKeyContext* keyPrivate
 		, const void* src, void* dst)
 	{
 		if (keyPublic) {
-			return RSA::executePublic(*keyPublic, src, dst);
+			return keyPublic->execute(src, dst);
 		} else {
-			return RSA::executePrivate(*keyPrivate, src, dst);
+			return keyPrivate->execute(src, dst);
 		}
 	}
 
 #define RSA_PKCS1_SIGN		1
 #define RSA_PKCS1_CRYPT		2
 
-	static sl_bool _rsa_encrypt_pkcs1_v15(const RSAPublicKey* keyPublic, const RSAPrivateKey* keyPrivate
+	static sl_bool _rsa_encrypt_pkcs1_v15(const RSAPublicKeyContext* keyPublic, const RSAPrivateKeyContext* keyPrivate
 		, const void* src, sl_uint32 n, void* dst)
 	{
 		sl_uint32 len;
@@ -141,7 +265,7 @@ namespace slib
 		return _rsa_execute(keyPublic, keyPrivate, dst, dst);
 	}
 
-	static sl_uint32 _rsa_decrypt_pkcs1_v15(const RSAPublicKey* keyPublic, const RSAPrivateKey* keyPrivate
+	static sl_uint32 _rsa_decrypt_pkcs1_v15(const RSAPublicKeyContext* keyPublic, const RSAPrivateKeyContext* keyPrivate
 		, const void* src, void* dst, sl_uint32 n, sl_bool* pFlagSign)
 	{
 		sl_uint32 len;
@@ -188,22 +312,58 @@ namespace slib
 
 	sl_bool RSA::encryptPublic_pkcs1_v15(const RSAPublicKey& key, const void* src, sl_uint32 n, void* dst)
 	{
-		return _rsa_encrypt_pkcs1_v15(&key, sl_null, src, n, dst);
+		RSAPublicKeyContext context;
+		if (!(context.setKey(key))) {
+			return sl_false;
+		}
+		return _rsa_encrypt_pkcs1_v15(&context, sl_null, src, n, dst);
 	}
 
 	sl_bool RSA::encryptPrivate_pkcs1_v15(const RSAPrivateKey& key, const void* src, sl_uint32 n, void* dst)
 	{
-		return _rsa_encrypt_pkcs1_v15(sl_null, &key, src, n, dst);
+		RSAPrivateKeyContext context;
+		if (!(context.setKey(key))) {
+			return sl_false;
+		}
+		return _rsa_encrypt_pkcs1_v15(sl_null, &context, src, n, dst);
 	}
 
 	sl_uint32 RSA::decryptPublic_pkcs1_v15(const RSAPublicKey& key, const void* src, void* dst, sl_uint32 n, sl_bool* pFlagSign)
 	{
-		return _rsa_decrypt_pkcs1_v15(&key, sl_null, src, dst, n, pFlagSign);
+		RSAPublicKeyContext context;
+		if (!(context.setKey(key))) {
+			return 0;
+		}
+		return _rsa_decrypt_pkcs1_v15(&context, sl_null, src, dst, n, pFlagSign);
 	}
 
 	sl_uint32 RSA::decryptPrivate_pkcs1_v15(const RSAPrivateKey& key, const void* src, void* dst, sl_uint32 n, sl_bool* pFlagSign)
 	{
-		return _rsa_decrypt_pkcs1_v15(sl_null, &key, src, dst, n, pFlagSign);
+		RSAPrivateKeyContext context;
+		if (!(context.setKey(key))) {
+			return 0;
+		}
+		return _rsa_decrypt_pkcs1_v15(sl_null, &context, src, dst, n, pFlagSign);
+	}
+
+	sl_bool RSA::encryptPublic_pkcs1_v15(const RSAPublicKeyContext& context, const void* src, sl_uint32 n, void* dst)
+	{
+		return _rsa_encrypt_pkcs1_v15(&context, sl_null, src, n, dst);
+	}
+
+	sl_bool RSA::encryptPrivate_pkcs1_v15(const RSAPrivateKeyContext& context, const void* src, sl_uint32 n, void* dst)
+	{
+		return _rsa_encrypt_pkcs1_v15(sl_null, &context, src, n, dst);
+	}
+
+	sl_uint32 RSA::decryptPublic_pkcs1_v15(const RSAPublicKeyContext& context, const void* src, void* dst, sl_uint32 n, sl_bool* pFlagSign)
+	{
+		return _rsa_decrypt_pkcs1_v15(&context, sl_null, src, dst, n, pFlagSign);
+	}
+
+	sl_uint32 RSA::decryptPrivate_pkcs1_v15(const RSAPrivateKeyContext& context, const void* src, void* dst, sl_uint32 n, sl_bool* pFlagSign)
+	{
+		return _rsa_decrypt_pkcs1_v15(sl_null, &context, src, dst, n, pFlagSign);
 	}
 
 /*
@@ -213,7 +373,7 @@ namespace slib
 
 	Section 7.1 RSAES-OAEP
 */
-	static sl_bool _rsa_encrypt_oaep_v21(const RSAPublicKey* keyPublic, const RSAPrivateKey* keyPrivate, const Ref<CryptoHash>& hash
+	static sl_bool _rsa_encrypt_oaep_v21(const RSAPublicKeyContext* keyPublic, const RSAPrivateKeyContext* keyPrivate, const Ref<CryptoHash>& hash
 		, const void* _input, sl_uint32 sizeInput, void* _output, const void* label, sl_uint32 sizeLabel)
 	{
 		if (hash.isNull()) {
@@ -254,7 +414,7 @@ namespace slib
 		return _rsa_execute(keyPublic, keyPrivate, output, output);
 	}
 
-	static sl_uint32 _rsa_decrypt_oaep_v21(const RSAPublicKey* keyPublic, const RSAPrivateKey* keyPrivate, const Ref<CryptoHash>& hash
+	static sl_uint32 _rsa_decrypt_oaep_v21(const RSAPublicKeyContext* keyPublic, const RSAPrivateKeyContext* keyPrivate, const Ref<CryptoHash>& hash
 		, const void* input, void* output, sl_uint32 sizeOutputBuffer, const void* label, sl_uint32 sizeLabel)
 	{
 		if (hash.isNull()) {
@@ -310,22 +470,106 @@ namespace slib
 
 	sl_bool RSA::encryptPublic_oaep_v21(const RSAPublicKey& key, const Ref<CryptoHash>& hash, const void* input, sl_uint32 sizeInput, void* output, const void* label, sl_uint32 sizeLabel)
 	{
-		return _rsa_encrypt_oaep_v21(&key, sl_null, hash, input, sizeInput, output, label, sizeLabel);
+		RSAPublicKeyContext context;
+		if (!(context.setKey(key))) {
+			return sl_false;
+		}
+		return _rsa_encrypt_oaep_v21(&context, sl_null, hash, input, sizeInput, output, label, sizeLabel);
 	}
 
 	sl_bool RSA::encryptPrivate_oaep_v21(const RSAPrivateKey& key, const Ref<CryptoHash>& hash, const void* input, sl_uint32 sizeInput, void* output, const void* label, sl_uint32 sizeLabel)
 	{
-		return _rsa_encrypt_oaep_v21(sl_null, &key, hash, input, sizeInput, output, label, sizeLabel);
+		RSAPrivateKeyContext context;
+		if (!(context.setKey(key))) {
+			return sl_false;
+		}
+		return _rsa_encrypt_oaep_v21(sl_null, &context, hash, input, sizeInput, output, label, sizeLabel);
 	}
 
 	sl_uint32 RSA::decryptPublic_oaep_v21(const RSAPublicKey& key, const Ref<CryptoHash>& hash, const void* input, void* output, sl_uint32 sizeOutputBuffer, const void* label, sl_uint32 sizeLabel)
 	{
-		return _rsa_decrypt_oaep_v21(&key, sl_null, hash, input, output, sizeOutputBuffer, label, sizeLabel);
+		RSAPublicKeyContext context;
+		if (!(context.setKey(key))) {
+			return 0;
+		}
+		return _rsa_decrypt_oaep_v21(&context, sl_null, hash, input, output, sizeOutputBuffer, label, sizeLabel);
 	}
 
 	sl_uint32 RSA::decryptPrivate_oaep_v21(const RSAPrivateKey& key, const Ref<CryptoHash>& hash, const void* input, void* output, sl_uint32 sizeOutputBuffer, const void* label, sl_uint32 sizeLabel)
 	{
-		return _rsa_decrypt_oaep_v21(sl_null, &key, hash, input, output, sizeOutputBuffer, label, sizeLabel);
+		RSAPrivateKeyContext context;
+		if (!(context.setKey(key))) {
+			return 0;
+		}
+		return _rsa_decrypt_oaep_v21(sl_null, &context, hash, input, output, sizeOutputBuffer, label, sizeLabel);
+	}
+
+	sl_bool RSA::encryptPublic_oaep_v21(const RSAPublicKeyContext& context, const Ref<CryptoHash>& hash, const void* input, sl_uint32 sizeInput, void* output, const void* label, sl_uint32 sizeLabel)
+	{
+		return _rsa_encrypt_oaep_v21(&context, sl_null, hash, input, sizeInput, output, label, sizeLabel);
+	}
+
+	sl_bool RSA::encryptPrivate_oaep_v21(const RSAPrivateKeyContext& context, const Ref<CryptoHash>& hash, const void* input, sl_uint32 sizeInput, void* output, const void* label, sl_uint32 sizeLabel)
+	{
+		return _rsa_encrypt_oaep_v21(sl_null, &context, hash, input, sizeInput, output, label, sizeLabel);
+	}
+
+	sl_uint32 RSA::decryptPublic_oaep_v21(const RSAPublicKeyContext& context, const Ref<CryptoHash>& hash, const void* input, void* output, sl_uint32 sizeOutputBuffer, const void* label, sl_uint32 sizeLabel)
+	{
+		return _rsa_decrypt_oaep_v21(&context, sl_null, hash, input, output, sizeOutputBuffer, label, sizeLabel);
+	}
+
+	sl_uint32 RSA::decryptPrivate_oaep_v21(const RSAPrivateKeyContext& context, const Ref<CryptoHash>& hash, const void* input, void* output, sl_uint32 sizeOutputBuffer, const void* label, sl_uint32 sizeLabel)
+	{
+		return _rsa_decrypt_oaep_v21(sl_null, &context, hash, input, output, sizeOutputBuffer, label, sizeLabel);
+	}
+
+	static sl_bool _rsa_verify_pkcs1_v15(const RSAPublicKeyContext* context, const void* signature, const void* message, sl_uint32 sizeMessage)
+	{
+		sl_uint32 len = context->getLength();
+		if (len < sizeMessage + 11) {
+			return sl_false;
+		}
+		SLIB_SCOPED_BUFFER(sl_uint8, 4096, buf, len);
+		if (!buf) {
+			return sl_false;
+		}
+		if (!(context->execute(signature, buf))) {
+			return sl_false;
+		}
+		if (buf[0] != 0 || buf[1] != RSA_PKCS1_SIGN) {
+			return sl_false;
+		}
+		sl_uint32 lenPadding = len - 3 - sizeMessage;
+		for (sl_uint32 i = 0; i < lenPadding; i++) {
+			if (buf[2 + i] != 0xFF) {
+				return sl_false;
+			}
+		}
+		if (buf[2 + lenPadding] != 0) {
+			return sl_false;
+		}
+		return Base::compareMemory(buf + (len - sizeMessage), (const sl_uint8*)message, sizeMessage) == 0;
+	}
+
+	void RSA::executePublicBatch(const RSAPublicKeyContext& context, const void* const* inputs, void* const* outputs, sl_bool* results, sl_size count)
+	{
+		ThreadPool::parallelFor(count, [&context, inputs, outputs, results](sl_size index) {
+			sl_bool flagResult = context.execute(inputs[index], outputs[index]);
+			if (results) {
+				results[index] = flagResult;
+			}
+		});
+	}
+
+	void RSA::verifyPublicBatch_pkcs1_v15(const RSAPublicKeyContext& context, const void* const* signatures, const void* const* messages, const sl_uint32* sizesMessage, sl_bool* results, sl_size count)
+	{
+		ThreadPool::parallelFor(count, [&context, signatures, messages, sizesMessage, results](sl_size index) {
+			sl_bool flagResult = _rsa_verify_pkcs1_v15(&context, signatures[index], messages[index], sizesMessage[index]);
+			if (results) {
+				results[index] = flagResult;
+			}
+		});
 	}
 
 }
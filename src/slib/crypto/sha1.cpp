@@ -12,10 +12,236 @@
 
 #include "../../../inc/slib/core/mio.h"
 #include "../../../inc/slib/core/math.h"
+#include "../../../inc/slib/core/cpu.h"
+
+#if defined(SLIB_CPU_USE_X86_EXTENSIONS)
+#	include <immintrin.h>
+#	define SHA1_SUPPORT_SHANI
+#elif defined(SLIB_CPU_USE_ARMV8_CRYPTO)
+#	include <arm_neon.h>
+#	define SHA1_SUPPORT_ARMV8
+#endif
 
 namespace slib
 {
 
+#if defined(SHA1_SUPPORT_SHANI)
+	static sl_bool _g_sha1_flagSHANI = Cpu::isSHANISupported() && Cpu::isSSE41Supported();
+#elif defined(SHA1_SUPPORT_ARMV8)
+	static sl_bool _g_sha1_flagARMv8 = Cpu::isARMv8SHA1Supported();
+#endif
+
+	static void _SHA1_process_Generic(sl_uint32* h, const sl_uint8* input, sl_size nBlocks)
+	{
+		static sl_uint32 K[4] = {
+			0x5A827999ul, 0x6ED9EBA1ul, 0x8F1BBCDCul, 0xCA62C1D6ul
+		};
+
+		sl_uint32 W[80];
+		sl_uint32 v[5];
+		sl_uint32 i;
+		for (; nBlocks; nBlocks--) {
+			for (i = 0; i < 16; i++) {
+				W[i] = MIO::readUint32BE(input + (i << 2));
+			}
+			for (i = 16; i < 80; i++) {
+				W[i] = Math::rotateLeft32(W[i - 3] ^ W[i - 8] ^ W[i - 14] ^ W[i - 16], 1);
+			}
+			for (i = 0; i < 5; i++) {
+				v[i] = h[i];
+			}
+			sl_uint32 f[4];
+			for (i = 0; i < 80; i++) {
+				sl_uint32 j = i / 20;
+				f[0] = v[3] ^ (v[1] & (v[2] ^ v[3]));
+				f[1] = v[1] ^ v[2] ^ v[3];
+				f[2] = (v[1] & v[2]) | (v[3] & (v[1] | v[2]));
+				f[3] = f[1];
+				sl_uint32 t = Math::rotateLeft32(v[0], 5) + f[j] + v[4] + K[j] + W[i];
+				v[4] = v[3];
+				v[3] = v[2];
+				v[2] = Math::rotateLeft32(v[1], 30);
+				v[1] = v[0];
+				v[0] = t;
+			}
+			for (i = 0; i < 5; i++) {
+				h[i] += v[i];
+			}
+			input += 64;
+		}
+	}
+
+#if defined(SHA1_SUPPORT_SHANI)
+
+	// 4 rounds on the message words `MSG_CUR` (W[4i] ~ W[4i+3]), computing E of the next rounds into `E_NEXT`
+#define _SHANI_ROUNDS(E_CUR, E_NEXT, MSG_CUR, FUNC) \
+	E_CUR = _mm_sha1nexte_epu32(E_CUR, MSG_CUR); \
+	E_NEXT = ABCD; \
+	ABCD = _mm_sha1rnds4_epu32(ABCD, E_CUR, FUNC);
+
+	// W[i] = (W[i-3] ^ W[i-8] ^ W[i-14] ^ W[i-16]) <<< 1, computed in 3 steps over the 4-word groups
+#define _SHANI_MSG1(MSG_PREV, MSG_CUR) MSG_PREV = _mm_sha1msg1_epu32(MSG_PREV, MSG_CUR);
+#define _SHANI_XOR(MSG_NEXT2, MSG_CUR) MSG_NEXT2 = _mm_xor_si128(MSG_NEXT2, MSG_CUR);
+#define _SHANI_MSG2(MSG_NEXT, MSG_CUR) MSG_NEXT = _mm_sha1msg2_epu32(MSG_NEXT, MSG_CUR);
+
+	SLIB_CPU_TARGET("sha,sse4.1") static void _SHA1_process_SHANI(sl_uint32* h, const sl_uint8* input, sl_size nBlocks)
+	{
+		const __m128i MASK = _mm_set_epi64x(SLIB_UINT64(0x0001020304050607), SLIB_UINT64(0x08090a0b0c0d0e0f));
+		__m128i ABCD = _mm_shuffle_epi32(_mm_loadu_si128((__m128i const*)h), 0x1B);
+		__m128i E0 = _mm_set_epi32((int)(h[4]), 0, 0, 0);
+		__m128i E1;
+		__m128i MSG0, MSG1, MSG2, MSG3;
+
+		for (; nBlocks; nBlocks--) {
+			__m128i ABCD_SAVE = ABCD;
+			__m128i E0_SAVE = E0;
+
+			MSG0 = _mm_shuffle_epi8(_mm_loadu_si128((__m128i const*)input), MASK);
+			MSG1 = _mm_shuffle_epi8(_mm_loadu_si128((__m128i const*)(input + 16)), MASK);
+			MSG2 = _mm_shuffle_epi8(_mm_loadu_si128((__m128i const*)(input + 32)), MASK);
+			MSG3 = _mm_shuffle_epi8(_mm_loadu_si128((__m128i const*)(input + 48)), MASK);
+
+			// Rounds 0 ~ 3
+			E0 = _mm_add_epi32(E0, MSG0);
+			E1 = ABCD;
+			ABCD = _mm_sha1rnds4_epu32(ABCD, E0, 0);
+
+			_SHANI_ROUNDS(E1, E0, MSG1, 0) // Rounds 4 ~ 7
+			_SHANI_MSG1(MSG0, MSG1)
+			_SHANI_ROUNDS(E0, E1, MSG2, 0) // Rounds 8 ~ 11
+			_SHANI_MSG1(MSG1, MSG2)
+			_SHANI_XOR(MSG0, MSG2)
+			_SHANI_ROUNDS(E1, E0, MSG3, 0) // Rounds 12 ~ 15
+			_SHANI_MSG2(MSG0, MSG3)
+			_SHANI_MSG1(MSG2, MSG3)
+			_SHANI_XOR(MSG1, MSG3)
+			_SHANI_ROUNDS(E0, E1, MSG0, 0) // Rounds 16 ~ 19
+			_SHANI_MSG2(MSG1, MSG0)
+			_SHANI_MSG1(MSG3, MSG0)
+			_SHANI_XOR(MSG2, MSG0)
+			_SHANI_ROUNDS(E1, E0, MSG1, 1) // Rounds 20 ~ 23
+			_SHANI_MSG2(MSG2, MSG1)
+			_SHANI_MSG1(MSG0, MSG1)
+			_SHANI_XOR(MSG3, MSG1)
+			_SHANI_ROUNDS(E0, E1, MSG2, 1) // Rounds 24 ~ 27
+			_SHANI_MSG2(MSG3, MSG2)
+			_SHANI_MSG1(MSG1, MSG2)
+			_SHANI_XOR(MSG0, MSG2)
+			_SHANI_ROUNDS(E1, E0, MSG3, 1) // Rounds 28 ~ 31
+			_SHANI_MSG2(MSG0, MSG3)
+			_SHANI_MSG1(MSG2, MSG3)
+			_SHANI_XOR(MSG1, MSG3)
+			_SHANI_ROUNDS(E0, E1, MSG0, 1) // Rounds 32 ~ 35
+			_SHANI_MSG2(MSG1, MSG0)
+			_SHANI_MSG1(MSG3, MSG0)
+			_SHANI_XOR(MSG2, MSG0)
+			_SHANI_ROUNDS(E1, E0, MSG1, 1) // Rounds 36 ~ 39
+			_SHANI_MSG2(MSG2, MSG1)
+			_SHANI_MSG1(MSG0, MSG1)
+			_SHANI_XOR(MSG3, MSG1)
+			_SHANI_ROUNDS(E0, E1, MSG2, 2) // Rounds 40 ~ 43
+			_SHANI_MSG2(MSG3, MSG2)
+			_SHANI_MSG1(MSG1, MSG2)
+			_SHANI_XOR(MSG0, MSG2)
+			_SHANI_ROUNDS(E1, E0, MSG3, 2) // Rounds 44 ~ 47
+			_SHANI_MSG2(MSG0, MSG3)
+			_SHANI_MSG1(MSG2, MSG3)
+			_SHANI_XOR(MSG1, MSG3)
+			_SHANI_ROUNDS(E0, E1, MSG0, 2) // Rounds 48 ~ 51
+			_SHANI_MSG2(MSG1, MSG0)
+			_SHANI_MSG1(MSG3, MSG0)
+			_SHANI_XOR(MSG2, MSG0)
+			_SHANI_ROUNDS(E1, E0, MSG1, 2) // Rounds 52 ~ 55
+			_SHANI_MSG2(MSG2, MSG1)
+			_SHANI_MSG1(MSG0, MSG1)
+			_SHANI_XOR(MSG3, MSG1)
+			_SHANI_ROUNDS(E0, E1, MSG2, 2) // Rounds 56 ~ 59
+			_SHANI_MSG2(MSG3, MSG2)
+			_SHANI_MSG1(MSG1, MSG2)
+			_SHANI_XOR(MSG0, MSG2)
+			_SHANI_ROUNDS(E1, E0, MSG3, 3) // Rounds 60 ~ 63
+			_SHANI_MSG2(MSG0, MSG3)
+			_SHANI_MSG1(MSG2, MSG3)
+			_SHANI_XOR(MSG1, MSG3)
+			_SHANI_ROUNDS(E0, E1, MSG0, 3) // Rounds 64 ~ 67
+			_SHANI_MSG2(MSG1, MSG0)
+			_SHANI_MSG1(MSG3, MSG0)
+			_SHANI_XOR(MSG2, MSG0)
+			_SHANI_ROUNDS(E1, E0, MSG1, 3) // Rounds 68 ~ 71
+			_SHANI_MSG2(MSG2, MSG1)
+			_SHANI_XOR(MSG3, MSG1)
+			_SHANI_ROUNDS(E0, E1, MSG2, 3) // Rounds 72 ~ 75
+			_SHANI_MSG2(MSG3, MSG2)
+			_SHANI_ROUNDS(E1, E0, MSG3, 3) // Rounds 76 ~ 79
+
+			E0 = _mm_sha1nexte_epu32(E0, E0_SAVE);
+			ABCD = _mm_add_epi32(ABCD, ABCD_SAVE);
+			input += 64;
+		}
+
+		_mm_storeu_si128((__m128i*)h, _mm_shuffle_epi32(ABCD, 0x1B));
+		h[4] = (sl_uint32)(_mm_extract_epi32(E0, 3));
+	}
+
+#elif defined(SHA1_SUPPORT_ARMV8)
+
+	static void _SHA1_process_ARMv8(sl_uint32* h, const sl_uint8* input, sl_size nBlocks)
+	{
+		static const sl_uint32 K[4] = {
+			0x5A827999ul, 0x6ED9EBA1ul, 0x8F1BBCDCul, 0xCA62C1D6ul
+		};
+		uint32x4_t ABCD = vld1q_u32(h);
+		sl_uint32 E = h[4];
+		uint32x4_t MSG[4];
+		for (; nBlocks; nBlocks--) {
+			uint32x4_t ABCD_SAVE = ABCD;
+			sl_uint32 E_SAVE = E;
+			for (sl_uint32 i = 0; i < 4; i++) {
+				MSG[i] = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(input + (i << 4))));
+			}
+			for (sl_uint32 i = 0; i < 20; i++) {
+				uint32x4_t& M = MSG[i & 3];
+				if (i >= 4) {
+					// W[i] = (W[i-3] ^ W[i-8] ^ W[i-14] ^ W[i-16]) <<< 1
+					M = vsha1su1q_u32(vsha1su0q_u32(M, MSG[(i + 1) & 3], MSG[(i + 2) & 3]), MSG[(i + 3) & 3]);
+				}
+				uint32x4_t T = vaddq_u32(M, vdupq_n_u32(K[i / 5]));
+				sl_uint32 E_NEXT = vsha1h_u32(vgetq_lane_u32(ABCD, 0));
+				if (i < 5) {
+					ABCD = vsha1cq_u32(ABCD, E, T);
+				} else if (i >= 10 && i < 15) {
+					ABCD = vsha1mq_u32(ABCD, E, T);
+				} else {
+					ABCD = vsha1pq_u32(ABCD, E, T);
+				}
+				E = E_NEXT;
+			}
+			ABCD = vaddq_u32(ABCD, ABCD_SAVE);
+			E += E_SAVE;
+			input += 64;
+		}
+		vst1q_u32(h, ABCD);
+		h[4] = E;
+	}
+
+#endif
+
+	static void _SHA1_process(sl_uint32* h, const sl_uint8* input, sl_size nBlocks)
+	{
+#if defined(SHA1_SUPPORT_SHANI)
+		if (_g_sha1_flagSHANI) {
+			_SHA1_process_SHANI(h, input, nBlocks);
+			return;
+		}
+#elif defined(SHA1_SUPPORT_ARMV8)
+		if (_g_sha1_flagARMv8) {
+			_SHA1_process_ARMv8(h, input, nBlocks);
+			return;
+		}
+#endif
+		_SHA1_process_Generic(h, input, nBlocks);
+	}
+
 	SHA1::SHA1()
 	{
 		rdata_len = 0;
@@ -63,10 +289,12 @@ namespace slib
 				}
 			}
 		}
-		while (sizeInput >= 64) {
-			_updateSection(input);
-			sizeInput -= 64;
-			input += 64;
+		if (sizeInput >= 64) {
+			sl_size nBlocks = sizeInput >> 6;
+			_SHA1_process(h, input, nBlocks);
+			nBlocks <<= 6;
+			sizeInput -= nBlocks;
+			input += nBlocks;
 		}
 		if (sizeInput) {
 			Base::copyMemory(rdata, input, sizeInput);
@@ -102,39 +330,7 @@ namespace slib
 
 	void SHA1::_updateSection(const sl_uint8* input)
 	{
-		static sl_uint32 K[4] = {
-			0x5A827999ul, 0x6ED9EBA1ul, 0x8F1BBCDCul, 0xCA62C1D6ul
-		};
-
-		sl_uint32 W[80];
-		sl_uint32 v[5];
-		sl_uint32 i;
-		for (i = 0; i < 16; i++) {
-			W[i] = MIO::readUint32BE(input + (i << 2));
-		}
-		for (i = 16; i < 80; i++) {
-			W[i] = Math::rotateLeft32(W[i - 3] ^ W[i - 8] ^ W[i - 14] ^ W[i - 16], 1);
-		}
-		for (i = 0; i < 5; i++) {
-			v[i] = h[i];
-		}
-		sl_uint32 f[4];
-		for (i = 0; i < 80; i++) {
-			sl_uint32 j = i / 20;
-			f[0] = v[3] ^ (v[1] & (v[2] ^ v[3]));
-			f[1] = v[1] ^ v[2] ^ v[3];
-			f[2] = (v[1] & v[2]) | (v[3] & (v[1] | v[2]));
-			f[3] = f[1];
-			sl_uint32 t = Math::rotateLeft32(v[0], 5) + f[j] + v[4] + K[j] + W[i];
-			v[4] = v[3];
-			v[3] = v[2];
-			v[2] = Math::rotateLeft32(v[1], 30);
-			v[1] = v[0];
-			v[0] = t;
-		}
-		for (i = 0; i < 5; i++) {
-			h[i] += v[i];
-		}
+		_SHA1_process(h, input, 1);
 	}
 
 }
@@ -11,10 +11,387 @@
 #include "../../../inc/slib/crypto/sha2.h"
 #include "../../../inc/slib/core/mio.h"
 #include "../../../inc/slib/core/math.h"
+#include "../../../inc/slib/core/scoped.h"
+#include "../../../inc/slib/core/cpu.h"
+
+#if defined(SLIB_CPU_USE_X86_EXTENSIONS)
+#	include <immintrin.h>
+#	define SHA256_SUPPORT_SHANI
+#	define SHA256_SUPPORT_AVX2
+#elif defined(SLIB_CPU_USE_ARMV8_CRYPTO)
+#	include <arm_neon.h>
+#	define SHA256_SUPPORT_ARMV8
+#endif
 
 namespace slib
 {
 
+	static const sl_uint32 _SHA256_K[64] = {
+		0x428a2f98ul, 0x71374491ul, 0xb5c0fbcful, 0xe9b5dba5ul,
+		0x3956c25bul, 0x59f111f1ul, 0x923f82a4ul, 0xab1c5ed5ul,
+		0xd807aa98ul, 0x12835b01ul, 0x243185beul, 0x550c7dc3ul,
+		0x72be5d74ul, 0x80deb1feul, 0x9bdc06a7ul, 0xc19bf174ul,
+		0xe49b69c1ul, 0xefbe4786ul, 0x0fc19dc6ul, 0x240ca1ccul,
+		0x2de92c6ful, 0x4a7484aaul, 0x5cb0a9dcul, 0x76f988daul,
+		0x983e5152ul, 0xa831c66dul, 0xb00327c8ul, 0xbf597fc7ul,
+		0xc6e00bf3ul, 0xd5a79147ul, 0x06ca6351ul, 0x14292967ul,
+		0x27b70a85ul, 0x2e1b2138ul, 0x4d2c6dfcul, 0x53380d13ul,
+		0x650a7354ul, 0x766a0abbul, 0x81c2c92eul, 0x92722c85ul,
+		0xa2bfe8a1ul, 0xa81a664bul, 0xc24b8b70ul, 0xc76c51a3ul,
+		0xd192e819ul, 0xd6990624ul, 0xf40e3585ul, 0x106aa070ul,
+		0x19a4c116ul, 0x1e376c08ul, 0x2748774cul, 0x34b0bcb5ul,
+		0x391c0cb3ul, 0x4ed8aa4aul, 0x5b9cca4ful, 0x682e6ff3ul,
+		0x748f82eeul, 0x78a5636ful, 0x84c87814ul, 0x8cc70208ul,
+		0x90befffaul, 0xa4506cebul, 0xbef9a3f7ul, 0xc67178f2ul,
+	};
+
+#if defined(SHA256_SUPPORT_SHANI)
+	static sl_bool _g_sha256_flagSHANI = Cpu::isSHANISupported() && Cpu::isSSE41Supported();
+#elif defined(SHA256_SUPPORT_ARMV8)
+	static sl_bool _g_sha256_flagARMv8 = Cpu::isARMv8SHA2Supported();
+#endif
+#if defined(SHA256_SUPPORT_AVX2)
+	static sl_bool _g_sha256_flagAVX2 = Cpu::isAVX2Supported();
+#endif
+
+	static void _SHA256_process_Generic(sl_uint32* h, const sl_uint8* input, sl_size nBlocks)
+	{
+		const sl_uint32* K = _SHA256_K;
+		sl_uint32 W[64];
+		sl_uint32 v[8];
+		sl_uint32 i;
+		for (; nBlocks; nBlocks--) {
+			for (i = 0; i < 16; i++) {
+				W[i] = MIO::readUint32BE(input + (i << 2));
+			}
+			for (i = 16; i < 64; i++) {
+				sl_uint32 s0 = Math::rotateRight32(W[i - 15], 7) ^ Math::rotateRight32(W[i - 15], 18) ^ (W[i - 15] >> 3);
+				sl_uint32 s1 = Math::rotateRight32(W[i - 2], 17) ^ Math::rotateRight32(W[i - 2], 19) ^ (W[i - 2] >> 10);
+				W[i] = W[i - 16] + s0 + W[i - 7] + s1;
+			}
+			for (i = 0; i < 8; i++) {
+				v[i] = h[i];
+			}
+			for (i = 0; i < 64; i++) {
+				sl_uint32 S1 = Math::rotateRight32(v[4], 6) ^ Math::rotateRight32(v[4], 11) ^ Math::rotateRight32(v[4], 25);
+				sl_uint32 ch = (v[4] & v[5]) ^ ((~v[4]) & v[6]);
+				sl_uint32 temp1 = v[7] + S1 + ch + K[i] + W[i];
+				sl_uint32 S0 = Math::rotateRight32(v[0], 2) ^ Math::rotateRight32(v[0], 13) ^ Math::rotateRight32(v[0], 22);
+				sl_uint32 maj = (v[0] & v[1]) ^ (v[0] & v[2]) ^ (v[1] & v[2]);
+				sl_uint32 temp2 = S0 + maj;
+				v[7] = v[6];
+				v[6] = v[5];
+				v[5] = v[4];
+				v[4] = v[3] + temp1;
+				v[3] = v[2];
+				v[2] = v[1];
+				v[1] = v[0];
+				v[0] = temp1 + temp2;
+			}
+			for (i = 0; i < 8; i++) {
+				h[i] += v[i];
+			}
+			input += 64;
+		}
+	}
+
+#if defined(SHA256_SUPPORT_SHANI)
+
+	// 4 rounds on the message words `MSG_CUR` (W[4i] ~ W[4i+3]); the message schedule is interleaved by _SHANI_MSG1, _SHANI_MSG2
+#define _SHANI_ROUNDS(i, MSG_CUR) \
+	MSG = _mm_add_epi32(MSG_CUR, _mm_loadu_si128((__m128i const*)(_SHA256_K + (i << 2)))); \
+	STATE1 = _mm_sha256rnds2_epu32(STATE1, STATE0, MSG); \
+	MSG = _mm_shuffle_epi32(MSG, 0x0E); \
+	STATE0 = _mm_sha256rnds2_epu32(STATE0, STATE1, MSG);
+
+#define _SHANI_MSG1(MSG_PREV, MSG_CUR) \
+	MSG_PREV = _mm_sha256msg1_epu32(MSG_PREV, MSG_CUR);
+
+#define _SHANI_MSG2(MSG_NEXT, MSG_CUR, MSG_PREV) \
+	MSG_NEXT = _mm_sha256msg2_epu32(_mm_add_epi32(MSG_NEXT, _mm_alignr_epi8(MSG_CUR, MSG_PREV, 4)), MSG_CUR);
+
+	SLIB_CPU_TARGET("sha,sse4.1") static void _SHA256_process_SHANI(sl_uint32* h, const sl_uint8* input, sl_size nBlocks)
+	{
+		const __m128i MASK = _mm_set_epi64x(SLIB_UINT64(0x0c0d0e0f08090a0b), SLIB_UINT64(0x0405060700010203));
+		__m128i STATE0, STATE1, MSG, TMP;
+		__m128i MSG0, MSG1, MSG2, MSG3;
+
+		// (A, B, C, D), (E, F, G, H) => (A, B, E, F), (C, D, G, H)
+		TMP = _mm_shuffle_epi32(_mm_loadu_si128((__m128i const*)h), 0xB1);
+		STATE1 = _mm_shuffle_epi32(_mm_loadu_si128((__m128i const*)(h + 4)), 0x1B);
+		STATE0 = _mm_alignr_epi8(TMP, STATE1, 8);
+		STATE1 = _mm_blend_epi16(STATE1, TMP, 0xF0);
+
+		for (; nBlocks; nBlocks--) {
+			__m128i ABEF = STATE0;
+			__m128i CDGH = STATE1;
+
+			MSG0 = _mm_shuffle_epi8(_mm_loadu_si128((__m128i const*)input), MASK);
+			MSG1 = _mm_shuffle_epi8(_mm_loadu_si128((__m128i const*)(input + 16)), MASK);
+			MSG2 = _mm_shuffle_epi8(_mm_loadu_si128((__m128i const*)(input + 32)), MASK);
+			MSG3 = _mm_shuffle_epi8(_mm_loadu_si128((__m128i const*)(input + 48)), MASK);
+
+			_SHANI_ROUNDS(0, MSG0)
+			_SHANI_ROUNDS(1, MSG1)
+			_SHANI_MSG1(MSG0, MSG1)
+			_SHANI_ROUNDS(2, MSG2)
+			_SHANI_MSG1(MSG1, MSG2)
+			_SHANI_ROUNDS(3, MSG3)
+			_SHANI_MSG2(MSG0, MSG3, MSG2)
+			_SHANI_MSG1(MSG2, MSG3)
+			_SHANI_ROUNDS(4, MSG0)
+			_SHANI_MSG2(MSG1, MSG0, MSG3)
+			_SHANI_MSG1(MSG3, MSG0)
+			_SHANI_ROUNDS(5, MSG1)
+			_SHANI_MSG2(MSG2, MSG1, MSG0)
+			_SHANI_MSG1(MSG0, MSG1)
+			_SHANI_ROUNDS(6, MSG2)
+			_SHANI_MSG2(MSG3, MSG2, MSG1)
+			_SHANI_MSG1(MSG1, MSG2)
+			_SHANI_ROUNDS(7, MSG3)
+			_SHANI_MSG2(MSG0, MSG3, MSG2)
+			_SHANI_MSG1(MSG2, MSG3)
+			_SHANI_ROUNDS(8, MSG0)
+			_SHANI_MSG2(MSG1, MSG0, MSG3)
+			_SHANI_MSG1(MSG3, MSG0)
+			_SHANI_ROUNDS(9, MSG1)
+			_SHANI_MSG2(MSG2, MSG1, MSG0)
+			_SHANI_MSG1(MSG0, MSG1)
+			_SHANI_ROUNDS(10, MSG2)
+			_SHANI_MSG2(MSG3, MSG2, MSG1)
+			_SHANI_MSG1(MSG1, MSG2)
+			_SHANI_ROUNDS(11, MSG3)
+			_SHANI_MSG2(MSG0, MSG3, MSG2)
+			_SHANI_MSG1(MSG2, MSG3)
+			_SHANI_ROUNDS(12, MSG0)
+			_SHANI_MSG2(MSG1, MSG0, MSG3)
+			_SHANI_MSG1(MSG3, MSG0)
+			_SHANI_ROUNDS(13, MSG1)
+			_SHANI_MSG2(MSG2, MSG1, MSG0)
+			_SHANI_ROUNDS(14, MSG2)
+			_SHANI_MSG2(MSG3, MSG2, MSG1)
+			_SHANI_ROUNDS(15, MSG3)
+
+			STATE0 = _mm_add_epi32(STATE0, ABEF);
+			STATE1 = _mm_add_epi32(STATE1, CDGH);
+			input += 64;
+		}
+
+		// (A, B, E, F), (C, D, G, H) => (A, B, C, D), (E, F, G, H)
+		TMP = _mm_shuffle_epi32(STATE0, 0x1B);
+		STATE1 = _mm_shuffle_epi32(STATE1, 0xB1);
+		STATE0 = _mm_blend_epi16(TMP, STATE1, 0xF0);
+		STATE1 = _mm_alignr_epi8(STATE1, TMP, 8);
+		_mm_storeu_si128((__m128i*)h, STATE0);
+		_mm_storeu_si128((__m128i*)(h + 4), STATE1);
+	}
+
+#elif defined(SHA256_SUPPORT_ARMV8)
+
+	static void _SHA256_process_ARMv8(sl_uint32* h, const sl_uint8* input, sl_size nBlocks)
+	{
+		uint32x4_t STATE0 = vld1q_u32(h);
+		uint32x4_t STATE1 = vld1q_u32(h + 4);
+		uint32x4_t MSG[4];
+		for (; nBlocks; nBlocks--) {
+			uint32x4_t ABCD = STATE0;
+			uint32x4_t EFGH = STATE1;
+			for (sl_uint32 i = 0; i < 4; i++) {
+				MSG[i] = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(input + (i << 4))));
+			}
+			for (sl_uint32 i = 0; i < 16; i++) {
+				uint32x4_t& M = MSG[i & 3];
+				uint32x4_t T = vaddq_u32(M, vld1q_u32(_SHA256_K + (i << 2)));
+				if (i < 12) {
+					M = vsha256su0q_u32(M, MSG[(i + 1) & 3]);
+				}
+				uint32x4_t S = STATE0;
+				STATE0 = vsha256hq_u32(STATE0, STATE1, T);
+				STATE1 = vsha256h2q_u32(STATE1, S, T);
+				if (i < 12) {
+					M = vsha256su1q_u32(M, MSG[(i + 2) & 3], MSG[(i + 3) & 3]);
+				}
+			}
+			STATE0 = vaddq_u32(STATE0, ABCD);
+			STATE1 = vaddq_u32(STATE1, EFGH);
+			input += 64;
+		}
+		vst1q_u32(h, STATE0);
+		vst1q_u32(h + 4, STATE1);
+	}
+
+#endif
+
+#if defined(SHA256_SUPPORT_AVX2)
+
+/*
+	Multi-buffer SHA-256
+
+	Each of the 8 lanes of the AVX2 registers hashes its own message. A lane is refilled with
+	the next message as soon as its message is finished, so that messages of different lengths
+	keep all the lanes busy.
+*/
+
+#define _SHA256_AVX2_ROTR(x, n) _mm256_or_si256(_mm256_srli_epi32(x, n), _mm256_slli_epi32(x, 32 - (n)))
+
+	// S[i][lane]: state word i of each lane
+	SLIB_CPU_TARGET("avx2") static void _SHA256_compress_AVX2(sl_uint32 S[8][8], const sl_uint8* const* blocks)
+	{
+		__m256i W[64];
+		sl_uint32 i;
+		for (i = 0; i < 16; i++) {
+			sl_uint32 k = i << 2;
+			W[i] = _mm256_set_epi32(
+				(int)(MIO::readUint32BE(blocks[7] + k)), (int)(MIO::readUint32BE(blocks[6] + k)),
+				(int)(MIO::readUint32BE(blocks[5] + k)), (int)(MIO::readUint32BE(blocks[4] + k)),
+				(int)(MIO::readUint32BE(blocks[3] + k)), (int)(MIO::readUint32BE(blocks[2] + k)),
+				(int)(MIO::readUint32BE(blocks[1] + k)), (int)(MIO::readUint32BE(blocks[0] + k)));
+		}
+		for (i = 16; i < 64; i++) {
+			__m256i w15 = W[i - 15];
+			__m256i w2 = W[i - 2];
+			__m256i s0 = _mm256_xor_si256(_mm256_xor_si256(_SHA256_AVX2_ROTR(w15, 7), _SHA256_AVX2_ROTR(w15, 18)), _mm256_srli_epi32(w15, 3));
+			__m256i s1 = _mm256_xor_si256(_mm256_xor_si256(_SHA256_AVX2_ROTR(w2, 17), _SHA256_AVX2_ROTR(w2, 19)), _mm256_srli_epi32(w2, 10));
+			W[i] = _mm256_add_epi32(_mm256_add_epi32(W[i - 16], s0), _mm256_add_epi32(W[i - 7], s1));
+		}
+		__m256i a = _mm256_loadu_si256((__m256i const*)(S[0]));
+		__m256i b = _mm256_loadu_si256((__m256i const*)(S[1]));
+		__m256i c = _mm256_loadu_si256((__m256i const*)(S[2]));
+		__m256i d = _mm256_loadu_si256((__m256i const*)(S[3]));
+		__m256i e = _mm256_loadu_si256((__m256i const*)(S[4]));
+		__m256i f = _mm256_loadu_si256((__m256i const*)(S[5]));
+		__m256i g = _mm256_loadu_si256((__m256i const*)(S[6]));
+		__m256i h = _mm256_loadu_si256((__m256i const*)(S[7]));
+		__m256i a0 = a, b0 = b, c0 = c, d0 = d, e0 = e, f0 = f, g0 = g, h0 = h;
+		for (i = 0; i < 64; i++) {
+			__m256i S1 = _mm256_xor_si256(_mm256_xor_si256(_SHA256_AVX2_ROTR(e, 6), _SHA256_AVX2_ROTR(e, 11)), _SHA256_AVX2_ROTR(e, 25));
+			__m256i ch = _mm256_xor_si256(_mm256_and_si256(e, f), _mm256_andnot_si256(e, g));
+			__m256i temp1 = _mm256_add_epi32(_mm256_add_epi32(_mm256_add_epi32(h, S1), _mm256_add_epi32(ch, W[i])), _mm256_set1_epi32((int)(_SHA256_K[i])));
+			__m256i S0 = _mm256_xor_si256(_mm256_xor_si256(_SHA256_AVX2_ROTR(a, 2), _SHA256_AVX2_ROTR(a, 13)), _SHA256_AVX2_ROTR(a, 22));
+			__m256i maj = _mm256_or_si256(_mm256_and_si256(a, b), _mm256_and_si256(c, _mm256_or_si256(a, b)));
+			h = g;
+			g = f;
+			f = e;
+			e = _mm256_add_epi32(d, temp1);
+			d = c;
+			c = b;
+			b = a;
+			a = _mm256_add_epi32(temp1, _mm256_add_epi32(S0, maj));
+		}
+		_mm256_storeu_si256((__m256i*)(S[0]), _mm256_add_epi32(a, a0));
+		_mm256_storeu_si256((__m256i*)(S[1]), _mm256_add_epi32(b, b0));
+		_mm256_storeu_si256((__m256i*)(S[2]), _mm256_add_epi32(c, c0));
+		_mm256_storeu_si256((__m256i*)(S[3]), _mm256_add_epi32(d, d0));
+		_mm256_storeu_si256((__m256i*)(S[4]), _mm256_add_epi32(e, e0));
+		_mm256_storeu_si256((__m256i*)(S[5]), _mm256_add_epi32(f, f0));
+		_mm256_storeu_si256((__m256i*)(S[6]), _mm256_add_epi32(g, g0));
+		_mm256_storeu_si256((__m256i*)(S[7]), _mm256_add_epi32(h, h0));
+	}
+
+	struct _SHA256_Lane
+	{
+		sl_bool flagActive;
+		sl_size indexMessage;
+		const sl_uint8* data;
+		sl_size nBlocksData;
+		sl_uint8 tail[128]; // padded last blocks
+		sl_uint32 nBlocksTail;
+		sl_uint32 indexTail;
+	};
+
+	static void _SHA256_hashBatch_AVX2(const void* const* inputs, const sl_size* sizes, void* const* outputs, sl_size count)
+	{
+		static const sl_uint32 IV[8] = {
+			0x6a09e667ul, 0xbb67ae85ul, 0x3c6ef372ul, 0xa54ff53aul,
+			0x510e527ful, 0x9b05688cul, 0x1f83d9abul, 0x5be0cd19ul
+		};
+		static const sl_uint8 zeroBlock[64] = { 0 };
+		sl_uint32 S[8][8];
+		_SHA256_Lane lanes[8];
+		const sl_uint8* blocks[8];
+		sl_uint32 i, k;
+		sl_size indexNext = 0;
+		for (k = 0; k < 8; k++) {
+			lanes[k].flagActive = sl_false;
+		}
+		for (;;) {
+			sl_uint32 nActive = 0;
+			for (k = 0; k < 8; k++) {
+				_SHA256_Lane& lane = lanes[k];
+				if (!(lane.flagActive) && indexNext < count) {
+					const sl_uint8* data = (const sl_uint8*)(inputs[indexNext]);
+					sl_size size = sizes[indexNext];
+					lane.flagActive = sl_true;
+					lane.indexMessage = indexNext;
+					lane.data = data;
+					lane.nBlocksData = size >> 6;
+					sl_uint32 n = (sl_uint32)(size & 63);
+					Base::copyMemory(lane.tail, data + (size - n), n);
+					lane.tail[n] = 0x80;
+					lane.nBlocksTail = n < 56 ? 1 : 2;
+					sl_uint32 sizeTail = lane.nBlocksTail << 6;
+					Base::zeroMemory(lane.tail + n + 1, sizeTail - 9 - n);
+					MIO::writeUint64BE(lane.tail + sizeTail - 8, ((sl_uint64)size) << 3);
+					lane.indexTail = 0;
+					for (i = 0; i < 8; i++) {
+						S[i][k] = IV[i];
+					}
+					indexNext++;
+				}
+				if (lane.flagActive) {
+					nActive++;
+					if (lane.nBlocksData) {
+						blocks[k] = lane.data;
+					} else {
+						blocks[k] = lane.tail + (lane.indexTail << 6);
+					}
+				} else {
+					blocks[k] = zeroBlock;
+				}
+			}
+			if (!nActive) {
+				break;
+			}
+			_SHA256_compress_AVX2(S, blocks);
+			for (k = 0; k < 8; k++) {
+				_SHA256_Lane& lane = lanes[k];
+				if (lane.flagActive) {
+					if (lane.nBlocksData) {
+						lane.nBlocksData--;
+						lane.data += 64;
+					} else {
+						lane.indexTail++;
+						if (lane.indexTail >= lane.nBlocksTail) {
+							sl_uint8* output = (sl_uint8*)(outputs[lane.indexMessage]);
+							for (i = 0; i < 8; i++) {
+								MIO::writeUint32BE(output + (i << 2), S[i][k]);
+							}
+							lane.flagActive = sl_false;
+						}
+					}
+				}
+			}
+		}
+	}
+
+#endif
+
+	static void _SHA256_process(sl_uint32* h, const sl_uint8* input, sl_size nBlocks)
+	{
+#if defined(SHA256_SUPPORT_SHANI)
+		if (_g_sha256_flagSHANI) {
+			_SHA256_process_SHANI(h, input, nBlocks);
+			return;
+		}
+#elif defined(SHA256_SUPPORT_ARMV8)
+		if (_g_sha256_flagARMv8) {
+			_SHA256_process_ARMv8(h, input, nBlocks);
+			return;
+		}
+#endif
+		_SHA256_process_Generic(h, input, nBlocks);
+	}
+
 	_SHA256Base::_SHA256Base()
 	{
 		rdata_len = 0;
@@ -57,10 +434,12 @@ namespace slib
 				}
 			}
 		}
-		while (sizeInput >= 64) {
-			_updateSection(input);
-			sizeInput -= 64;
-			input += 64;
+		if (sizeInput >= 64) {
+			sl_size nBlocks = sizeInput >> 6;
+			_SHA256_process(h, input, nBlocks);
+			nBlocks <<= 6;
+			sizeInput -= nBlocks;
+			input += nBlocks;
 		}
 		if (sizeInput) {
 			Base::copyMemory(rdata, input, sizeInput);
@@ -90,61 +469,9 @@ namespace slib
 
 	void _SHA256Base::_updateSection(const sl_uint8* input)
 	{
-		static sl_uint32 K[64] = {
-			0x428a2f98ul, 0x71374491ul, 0xb5c0fbcful, 0xe9b5dba5ul,
-			0x3956c25bul, 0x59f111f1ul, 0x923f82a4ul, 0xab1c5ed5ul,
-			0xd807aa98ul, 0x12835b01ul, 0x243185beul, 0x550c7dc3ul,
-			0x72be5d74ul, 0x80deb1feul, 0x9bdc06a7ul, 0xc19bf174ul,
-			0xe49b69c1ul, 0xefbe4786ul, 0x0fc19dc6ul, 0x240ca1ccul,
-			0x2de92c6ful, 0x4a7484aaul, 0x5cb0a9dcul, 0x76f988daul,
-			0x983e5152ul, 0xa831c66dul, 0xb00327c8ul, 0xbf597fc7ul,
-			0xc6e00bf3ul, 0xd5a79147ul, 0x06ca6351ul, 0x14292967ul,
-			0x27b70a85ul, 0x2e1b2138ul, 0x4d2c6dfcul, 0x53380d13ul,
-			0x650a7354ul, 0x766a0abbul, 0x81c2c92eul, 0x92722c85ul,
-			0xa2bfe8a1ul, 0xa81a664bul, 0xc24b8b70ul, 0xc76c51a3ul,
-			0xd192e819ul, 0xd6990624ul, 0xf40e3585ul, 0x106aa070ul,
-			0x19a4c116ul, 0x1e376c08ul, 0x2748774cul, 0x34b0bcb5ul,
-			0x391c0cb3ul, 0x4ed8aa4aul, 0x5b9cca4ful, 0x682e6ff3ul,
-			0x748f82eeul, 0x78a5636ful, 0x84c87814ul, 0x8cc70208ul,
-			0x90befffaul, 0xa4506cebul, 0xbef9a3f7ul, 0xc67178f2ul,
-		};
-
-		sl_uint32 W[64];
-		sl_uint32 v[8];
-		sl_uint32 i;
-		for (i = 0; i < 16; i++) {
-			W[i] = MIO::readUint32BE(input + (i << 2));
-		}
-		for (i = 16; i < 64; i++) {
-			sl_uint32 s0 = Math::rotateRight32(W[i - 15], 7) ^ Math::rotateRight32(W[i - 15], 18) ^ (W[i - 15] >> 3);
-			sl_uint32 s1 = Math::rotateRight32(W[i - 2], 17) ^ Math::rotateRight32(W[i - 2], 19) ^ (W[i - 2] >> 10);
-			W[i] = W[i - 16] + s0 + W[i - 7] + s1;
-		}
-		for (i = 0; i < 8; i++) {
-			v[i] = h[i];
-		}
-		for (i = 0; i < 64; i++) {
-			sl_uint32 S1 = Math::rotateRight32(v[4], 6) ^ Math::rotateRight32(v[4], 11) ^ Math::rotateRight32(v[4], 25);
-			sl_uint32 ch = (v[4] & v[5]) ^ ((~v[4]) & v[6]);
-			sl_uint32 temp1 = v[7] + S1 + ch + K[i] + W[i];
-			sl_uint32 S0 = Math::rotateRight32(v[0], 2) ^ Math::rotateRight32(v[0], 13) ^ Math::rotateRight32(v[0], 22);
-			sl_uint32 maj = (v[0] & v[1]) ^ (v[0] & v[2]) ^ (v[1] & v[2]);
-			sl_uint32 temp2 = S0 + maj;
-			v[7] = v[6];
-			v[6] = v[5];
-			v[5] = v[4];
-			v[4] = v[3] + temp1;
-			v[3] = v[2];
-			v[2] = v[1];
-			v[1] = v[0];
-			v[0] = temp1 + temp2;
-		}
-		for (i = 0; i < 8; i++) {
-			h[i] += v[i];
-		}
+		_SHA256_process(h, input, 1);
 	}
 
-
 	SHA224::SHA224()
 	{
 	}
@@ -412,4 +739,35 @@ namespace slib
 		return MIO::readUint32LE(hash);
 	}
 
+	void SHA256::hashBatch(const void* const* inputs, const sl_size* sizes, void* const* outputs, sl_size count)
+	{
+#if defined(SHA256_SUPPORT_AVX2)
+		// a single stream of SHA-NI is as fast as 8 lanes of AVX2, without transposing the messages
+		if (count >= 4 && _g_sha256_flagAVX2 && !_g_sha256_flagSHANI) {
+			_SHA256_hashBatch_AVX2(inputs, sizes, outputs, count);
+			return;
+		}
+#endif
+		for (sl_size i = 0; i < count; i++) {
+			hash(inputs[i], sizes[i], outputs[i]);
+		}
+	}
+
+	void SHA256::hashBatch(const Memory* inputs, void* _outputs, sl_size count)
+	{
+		SLIB_SCOPED_BUFFER(const void*, 64, listInput, count);
+		SLIB_SCOPED_BUFFER(sl_size, 64, listSize, count);
+		SLIB_SCOPED_BUFFER(void*, 64, listOutput, count);
+		if (!(listInput && listSize && listOutput)) {
+			return;
+		}
+		sl_uint8* outputs = (sl_uint8*)_outputs;
+		for (sl_size i = 0; i < count; i++) {
+			listInput[i] = inputs[i].getData();
+			listSize[i] = inputs[i].getSize();
+			listOutput[i] = outputs + (i << 5);
+		}
+		hashBatch(listInput, listSize, listOutput, count);
+	}
+
 }
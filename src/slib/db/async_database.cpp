@@ -0,0 +1,355 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "../../../inc/slib/db/async_database.h"
+
+#include "../../../inc/slib/core/queue.h"
+#include "../../../inc/slib/core/thread.h"
+#include "../../../inc/slib/core/event.h"
+#include "../../../inc/slib/core/time.h"
+
+namespace slib
+{
+
+	struct _AsyncDatabaseTask
+	{
+		Function<void(Database*)> task;
+		sl_int64 timeQueued;
+	};
+
+	class _AsyncDatabaseConnection : public Referable
+	{
+	public:
+		Ref<Database> db;
+		Ref<Thread> thread;
+		Ref<Event> event;
+		LinkedQueue<_AsyncDatabaseTask> tasks;
+		// queued and running tasks
+		sl_reg nTasks;
+
+	public:
+		_AsyncDatabaseConnection()
+		{
+			nTasks = 0;
+		}
+
+	};
+
+
+	AsyncDatabaseParam::AsyncDatabaseParam()
+	{
+		maxQueueSize = 0;
+	}
+
+	AsyncDatabaseParam::~AsyncDatabaseParam()
+	{
+	}
+
+
+	SLIB_DEFINE_OBJECT(AsyncDatabase, Object)
+
+	AsyncDatabase::AsyncDatabase()
+	{
+		m_maxQueueSize = 0;
+		m_flagRunning = sl_false;
+		m_nQueuedTasks = 0;
+		m_nCompletedTasks = 0;
+		m_sumLatency = 0;
+		m_maxLatency = 0;
+		m_sumQueueTime = 0;
+	}
+
+	AsyncDatabase::~AsyncDatabase()
+	{
+		release();
+	}
+
+	Ref<AsyncDatabase> AsyncDatabase::create(const AsyncDatabaseParam& param)
+	{
+		ListLocker< Ref<Database> > dbs(param.connections);
+		if (!(dbs.count)) {
+			return sl_null;
+		}
+		Array< Ref<_AsyncDatabaseConnection> > connections = Array< Ref<_AsyncDatabaseConnection> >::create(dbs.count);
+		if (connections.isNull()) {
+			return sl_null;
+		}
+		for (sl_size i = 0; i < dbs.count; i++) {
+			if (dbs[i].isNull()) {
+				return sl_null;
+			}
+			Ref<_AsyncDatabaseConnection> connection = new _AsyncDatabaseConnection;
+			if (connection.isNull()) {
+				return sl_null;
+			}
+			connection->db = dbs[i];
+			connection->event = Event::create();
+			if (connection->event.isNull()) {
+				return sl_null;
+			}
+			connections[i] = connection;
+		}
+		Ref<AsyncDatabase> ret = new AsyncDatabase;
+		if (ret.isNull()) {
+			return sl_null;
+		}
+		ret->m_connections = connections;
+		ret->m_dispatcher = param.dispatcher;
+		ret->m_maxQueueSize = param.maxQueueSize;
+		ret->m_flagRunning = sl_true;
+		// the workers do not keep the object alive while waiting for the tasks
+		WeakRef<AsyncDatabase> weak = ret;
+		for (sl_size i = 0; i < dbs.count; i++) {
+			Ref<_AsyncDatabaseConnection> connection = connections[i];
+			connection->thread = Thread::start([weak, connection]() {
+				_runWorker(weak, connection.get());
+			});
+			if (connection->thread.isNull()) {
+				ret->release();
+				return sl_null;
+			}
+		}
+		return ret;
+	}
+
+	Ref<AsyncDatabase> AsyncDatabase::create(const Ref<Database>& db, const Ref<Dispatcher>& dispatcher)
+	{
+		AsyncDatabaseParam param;
+		param.connections.add(db);
+		param.dispatcher = dispatcher;
+		return create(param);
+	}
+
+	void AsyncDatabase::release()
+	{
+		{
+			ObjectLocker lock(this);
+			if (!m_flagRunning) {
+				return;
+			}
+			m_flagRunning = sl_false;
+		}
+		// the workers exit after running the queued tasks
+		sl_size n = m_connections.getCount();
+		Ref<_AsyncDatabaseConnection>* connections = m_connections.getData();
+		for (sl_size i = 0; i < n; i++) {
+			if (connections[i]->thread.isNotNull()) {
+				connections[i]->thread->finish();
+			}
+			connections[i]->event->set();
+		}
+		// the last reference can be released by a task (or a callback) on a worker, which must not wait for itself
+		Thread* threadCurrent = Thread::getCurrent().get();
+		for (sl_size i = 0; i < n; i++) {
+			Ref<Thread>& thread = connections[i]->thread;
+			if (thread.isNotNull() && thread.get() != threadCurrent) {
+				thread->finishAndWait();
+			}
+		}
+	}
+
+	sl_bool AsyncDatabase::isRunning()
+	{
+		return m_flagRunning;
+	}
+
+	sl_uint32 AsyncDatabase::getConnectionsCount()
+	{
+		return (sl_uint32)(m_connections.getCount());
+	}
+
+	sl_bool AsyncDatabase::run(const Function<void(Database*)>& task, sl_int32 connectionIndex)
+	{
+		if (task.isNull()) {
+			return sl_false;
+		}
+		sl_size n = m_connections.getCount();
+		Ref<_AsyncDatabaseConnection>* connections = m_connections.getData();
+		_AsyncDatabaseConnection* connection;
+		if (connectionIndex >= 0) {
+			if ((sl_size)connectionIndex >= n) {
+				return sl_false;
+			}
+			connection = connections[connectionIndex].get();
+		} else {
+			connection = connections[0].get();
+			for (sl_size i = 1; i < n && connection->nTasks > 0; i++) {
+				if (connections[i]->nTasks < connection->nTasks) {
+					connection = connections[i].get();
+				}
+			}
+		}
+		_AsyncDatabaseTask item;
+		item.task = task;
+		item.timeQueued = Time::now().toInt();
+		{
+			ObjectLocker lock(this);
+			if (!m_flagRunning) {
+				return sl_false;
+			}
+			if (m_maxQueueSize && m_nQueuedTasks >= (sl_reg)m_maxQueueSize) {
+				return sl_false;
+			}
+			if (!(connection->tasks.push(item))) {
+				return sl_false;
+			}
+			Base::interlockedIncrement(&m_nQueuedTasks);
+			Base::interlockedIncrement(&(connection->nTasks));
+		}
+		connection->event->set();
+		return sl_true;
+	}
+
+	sl_bool AsyncDatabase::executeBy(const String& sql, const Variant* params, sl_uint32 nParams, const Function<void(sl_int64)>& callback)
+	{
+		Array<Variant> arr;
+		if (nParams) {
+			arr = Array<Variant>::create(params, nParams);
+			if (arr.isNull()) {
+				return sl_false;
+			}
+		}
+		return run([this, sql, arr, callback](Database* db) {
+			sl_int64 result = db->executeBy(sql, arr.getData(), (sl_uint32)(arr.getCount()));
+			if (callback.isNotNull()) {
+				_dispatchCallback([callback, result]() {
+					callback(result);
+				});
+			}
+		});
+	}
+
+	sl_bool AsyncDatabase::queryBy(const String& sql, const Variant* params, sl_uint32 nParams, const Function<void(List< Map<String, Variant> >&)>& callback)
+	{
+		Array<Variant> arr;
+		if (nParams) {
+			arr = Array<Variant>::create(params, nParams);
+			if (arr.isNull()) {
+				return sl_false;
+			}
+		}
+		return run([this, sql, arr, callback](Database* db) {
+			List< Map<String, Variant> > rows = db->getListForQueryResultBy(sql, arr.getData(), (sl_uint32)(arr.getCount()));
+			if (callback.isNotNull()) {
+				_dispatchCallback([callback, rows]() {
+					List< Map<String, Variant> > list = rows;
+					callback(list);
+				});
+			}
+		});
+	}
+
+	sl_bool AsyncDatabase::getValueForQueryResultBy(const String& sql, const Variant* params, sl_uint32 nParams, const Function<void(Variant&)>& callback)
+	{
+		Array<Variant> arr;
+		if (nParams) {
+			arr = Array<Variant>::create(params, nParams);
+			if (arr.isNull()) {
+				return sl_false;
+			}
+		}
+		return run([this, sql, arr, callback](Database* db) {
+			Variant value = db->getValueForQueryResultBy(sql, arr.getData(), (sl_uint32)(arr.getCount()));
+			if (callback.isNotNull()) {
+				_dispatchCallback([callback, value]() {
+					Variant v = value;
+					callback(v);
+				});
+			}
+		});
+	}
+
+	sl_uint32 AsyncDatabase::getQueueDepth()
+	{
+		return (sl_uint32)m_nQueuedTasks;
+	}
+
+	sl_uint64 AsyncDatabase::getCompletedTasksCount()
+	{
+		return m_nCompletedTasks;
+	}
+
+	double AsyncDatabase::getAverageLatency()
+	{
+		MutexLocker lock(&m_lockMetrics);
+		if (m_nCompletedTasks) {
+			return (double)m_sumLatency / (double)m_nCompletedTasks / 1000.0;
+		}
+		return 0;
+	}
+
+	double AsyncDatabase::getMaximumLatency()
+	{
+		return (double)m_maxLatency / 1000.0;
+	}
+
+	double AsyncDatabase::getAverageQueueTime()
+	{
+		MutexLocker lock(&m_lockMetrics);
+		if (m_nCompletedTasks) {
+			return (double)m_sumQueueTime / (double)m_nCompletedTasks / 1000.0;
+		}
+		return 0;
+	}
+
+	void AsyncDatabase::resetMetrics()
+	{
+		MutexLocker lock(&m_lockMetrics);
+		m_nCompletedTasks = 0;
+		m_sumLatency = 0;
+		m_maxLatency = 0;
+		m_sumQueueTime = 0;
+	}
+
+	void AsyncDatabase::_runWorker(const WeakRef<AsyncDatabase>& weak, _AsyncDatabaseConnection* connection)
+	{
+		Database* db = connection->db.get();
+		while (1) {
+			Ref<AsyncDatabase> object = weak;
+			if (object.isNull()) {
+				return;
+			}
+			_AsyncDatabaseTask item;
+			if (connection->tasks.pop(&item)) {
+				Base::interlockedDecrement(&(object->m_nQueuedTasks));
+				sl_int64 timeStart = Time::now().toInt();
+				item.task(db);
+				sl_int64 timeEnd = Time::now().toInt();
+				Base::interlockedDecrement(&(connection->nTasks));
+				sl_int64 latency = timeEnd - item.timeQueued;
+				MutexLocker lock(&(object->m_lockMetrics));
+				object->m_nCompletedTasks++;
+				object->m_sumLatency += latency;
+				object->m_sumQueueTime += timeStart - item.timeQueued;
+				if (latency > object->m_maxLatency) {
+					object->m_maxLatency = latency;
+				}
+			} else {
+				if (!(object->m_flagRunning) || Thread::isStoppingCurrent()) {
+					return;
+				}
+				object.setNull();
+				// auto-reset event, set by the tasks queued after the failed pop
+				connection->event->wait();
+			}
+		}
+	}
+
+	void AsyncDatabase::_dispatchCallback(const Function<void()>& callback)
+	{
+		Ref<Dispatcher> dispatcher = m_dispatcher;
+		if (dispatcher.isNotNull()) {
+			dispatcher->dispatch(callback);
+		} else {
+			callback();
+		}
+	}
+
+}
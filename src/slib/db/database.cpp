@@ -17,6 +17,9 @@ namespace slib
 
 	Database::Database()
 	{
+		m_capacityStatementCache = 0;
+		m_nStatementCacheHits = 0;
+		m_nStatementCacheMisses = 0;
 	}
 
 	Database::~Database()
@@ -25,7 +28,7 @@ namespace slib
 
 	sl_int64 Database::executeBy(const String& sql, const Variant* params, sl_uint32 nParams)
 	{
-		Ref<DatabaseStatement> statement = prepareStatement(sql);
+		Ref<DatabaseStatement> statement = prepareCachedStatement(sql);
 		if (statement.isNotNull()) {
 			return statement->executeBy(params, nParams);
 		}
@@ -34,7 +37,7 @@ namespace slib
 
 	Ref<DatabaseCursor> Database::queryBy(const String& sql, const Variant* params, sl_uint32 nParams)
 	{
-		Ref<DatabaseStatement> statement = prepareStatement(sql);
+		Ref<DatabaseStatement> statement = prepareCachedStatement(sql);
 		if (statement.isNotNull()) {
 			return statement->queryBy(params, nParams);
 		}
@@ -43,7 +46,7 @@ namespace slib
 
 	List< Map<String, Variant> > Database::getListForQueryResultBy(const String& sql, const Variant* params, sl_uint32 nParams)
 	{
-		Ref<DatabaseStatement> statement = prepareStatement(sql);
+		Ref<DatabaseStatement> statement = prepareCachedStatement(sql);
 		if (statement.isNotNull()) {
 			return statement->getListForQueryResultBy(params, nParams);
 		}
@@ -52,7 +55,7 @@ namespace slib
 
 	Map<String, Variant> Database::getRecordForQueryResultBy(const String& sql, const Variant* params, sl_uint32 nParams)
 	{
-		Ref<DatabaseStatement> statement = prepareStatement(sql);
+		Ref<DatabaseStatement> statement = prepareCachedStatement(sql);
 		if (statement.isNotNull()) {
 			return statement->getRecordForQueryResultBy(params, nParams);
 		}
@@ -61,7 +64,7 @@ namespace slib
 
 	Variant Database::getValueForQueryResultBy(const String& sql, const Variant* params, sl_uint32 nParams)
 	{
-		Ref<DatabaseStatement> statement = prepareStatement(sql);
+		Ref<DatabaseStatement> statement = prepareCachedStatement(sql);
 		if (statement.isNotNull()) {
 			return statement->getValueForQueryResultBy(params, nParams);
 		}
@@ -112,4 +115,155 @@ namespace slib
 		return sl_null;
 	}
 
+	sl_bool Database::beginTransaction()
+	{
+		return execute("BEGIN") >= 0;
+	}
+
+	sl_bool Database::commit()
+	{
+		return execute("COMMIT") >= 0;
+	}
+
+	sl_bool Database::rollback()
+	{
+		return execute("ROLLBACK") >= 0;
+	}
+
+	sl_bool Database::setTableChangeCallback(const Function<void(const String& table)>& callback)
+	{
+		return sl_false;
+	}
+
+	sl_uint32 Database::getStatementCacheCapacity()
+	{
+		return m_capacityStatementCache;
+	}
+
+	void Database::setStatementCacheCapacity(sl_uint32 capacity)
+	{
+		MutexLocker lock(&m_lockStatementCache);
+		m_capacityStatementCache = capacity;
+		while (m_listStatementCache.getCount() > capacity) {
+			_StatementCacheItem item;
+			if (m_listStatementCache.popBack_NoLock(&item)) {
+				m_mapStatementCache.remove_NoLock(item.sql);
+			}
+		}
+	}
+
+	sl_uint64 Database::getStatementCacheHitsCount()
+	{
+		return m_nStatementCacheHits;
+	}
+
+	sl_uint64 Database::getStatementCacheMissesCount()
+	{
+		return m_nStatementCacheMisses;
+	}
+
+	void Database::clearStatementCache()
+	{
+		MutexLocker lock(&m_lockStatementCache);
+		m_listStatementCache.removeAll_NoLock();
+		m_mapStatementCache.removeAll_NoLock();
+	}
+
+	Ref<DatabaseStatement> Database::prepareCachedStatement(const String& sql)
+	{
+		return prepareStatement(sql);
+	}
+
+	Ref<Referable> Database::takeCachedStatement(const String& sql)
+	{
+		MutexLocker lock(&m_lockStatementCache);
+		if (!m_capacityStatementCache) {
+			return sl_null;
+		}
+		Link<_StatementCacheItem>* link;
+		if (m_mapStatementCache.remove_NoLock(sql, &link)) {
+			Ref<Referable> handle = link->value.handle;
+			m_listStatementCache.removeItem_NoLock(link);
+			m_nStatementCacheHits++;
+			return handle;
+		}
+		m_nStatementCacheMisses++;
+		return sl_null;
+	}
+
+	void Database::putCachedStatement(const String& sql, const Ref<Referable>& handle)
+	{
+		MutexLocker lock(&m_lockStatementCache);
+		if (!m_capacityStatementCache || handle.isNull()) {
+			return;
+		}
+		if (m_mapStatementCache.getItemPointer(sql)) {
+			// another statement of the same SQL was given back while this one was in use
+			return;
+		}
+		_StatementCacheItem item;
+		item.sql = sql;
+		item.handle = handle;
+		Link<_StatementCacheItem>* link = m_listStatementCache.pushFront_NoLock(item);
+		if (link) {
+			if (m_mapStatementCache.put_NoLock(sql, link)) {
+				if (m_listStatementCache.getCount() > m_capacityStatementCache) {
+					if (m_listStatementCache.popBack_NoLock(&item)) {
+						m_mapStatementCache.remove_NoLock(item.sql);
+					}
+				}
+			} else {
+				m_listStatementCache.removeItem_NoLock(link);
+			}
+		}
+	}
+
+
+	DatabaseTransaction::DatabaseTransaction(const Ref<Database>& db)
+	{
+		m_db = db;
+		m_flagStarted = sl_false;
+		if (db.isNotNull()) {
+			db->lock();
+			if (db->beginTransaction()) {
+				m_flagStarted = sl_true;
+			} else {
+				db->unlock();
+			}
+		}
+	}
+
+	DatabaseTransaction::~DatabaseTransaction()
+	{
+		rollback();
+	}
+
+	sl_bool DatabaseTransaction::isStarted()
+	{
+		return m_flagStarted;
+	}
+
+	sl_bool DatabaseTransaction::commit()
+	{
+		if (!m_flagStarted) {
+			return sl_false;
+		}
+		if (m_db->commit()) {
+			m_flagStarted = sl_false;
+			m_db->unlock();
+			return sl_true;
+		}
+		rollback();
+		return sl_false;
+	}
+
+	void DatabaseTransaction::rollback()
+	{
+		if (m_flagStarted) {
+			m_db->rollback();
+			m_flagStarted = sl_false;
+			m_db->unlock();
+		}
+	}
+
 }
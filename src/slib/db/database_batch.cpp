@@ -0,0 +1,337 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "../../../inc/slib/db/database.h"
+
+#define BATCH_DATA_SIZE_MIN 1024
+
+namespace slib
+{
+
+	DatabaseBatch::DatabaseBatch()
+	{
+		m_nColumns = 0;
+		m_nRows = 0;
+		m_nRowsCapacity = 0;
+		m_types = sl_null;
+		m_ints = sl_null;
+		m_doubles = sl_null;
+		m_offsets = sl_null;
+		m_sizes = sl_null;
+		m_sizeData = 0;
+	}
+
+	DatabaseBatch::~DatabaseBatch()
+	{
+	}
+
+	Ref<DatabaseBatch> DatabaseBatch::create(const String* columnNames, sl_uint32 nColumns, sl_uint32 nRowsCapacity)
+	{
+		if (!nColumns || !nRowsCapacity) {
+			return sl_null;
+		}
+		Array<String> names = Array<String>::create(columnNames, nColumns);
+		if (names.isNull()) {
+			return sl_null;
+		}
+		sl_size nCells = (sl_size)nColumns * nRowsCapacity;
+		// 8-byte fields first, then the types
+		Memory memCells = Memory::create(nCells * (sizeof(sl_int64) + sizeof(double) + sizeof(sl_size) * 2 + 1));
+		if (memCells.isNull()) {
+			return sl_null;
+		}
+		Ref<DatabaseBatch> ret = new DatabaseBatch;
+		if (ret.isNotNull()) {
+			ret->m_columnNames = names;
+			ret->m_nColumns = nColumns;
+			ret->m_nRowsCapacity = nRowsCapacity;
+			sl_uint8* p = (sl_uint8*)(memCells.getData());
+			ret->m_ints = (sl_int64*)p;
+			p += nCells * sizeof(sl_int64);
+			ret->m_doubles = (double*)p;
+			p += nCells * sizeof(double);
+			ret->m_offsets = (sl_size*)p;
+			p += nCells * sizeof(sl_size);
+			ret->m_sizes = (sl_size*)p;
+			p += nCells * sizeof(sl_size);
+			ret->m_types = p;
+			Base::zeroMemory(ret->m_ints, nCells * sizeof(sl_int64));
+			Base::zeroMemory(ret->m_doubles, nCells * sizeof(double));
+			Base::zeroMemory(ret->m_types, nCells);
+			ret->m_memCells = memCells;
+		}
+		return ret;
+	}
+
+	sl_uint32 DatabaseBatch::getRowsCount()
+	{
+		return m_nRows;
+	}
+
+	sl_uint32 DatabaseBatch::getColumnsCount()
+	{
+		return m_nColumns;
+	}
+
+	String DatabaseBatch::getColumnName(sl_uint32 column)
+	{
+		if (column < m_nColumns) {
+			return m_columnNames[column];
+		}
+		return sl_null;
+	}
+
+	sl_int32 DatabaseBatch::getColumnIndex(const String& name)
+	{
+		String* names = m_columnNames.getData();
+		for (sl_uint32 i = 0; i < m_nColumns; i++) {
+			if (names[i] == name) {
+				return i;
+			}
+		}
+		return -1;
+	}
+
+#define BATCH_CELL(row, column) ((sl_size)(column) * m_nRowsCapacity + (row))
+
+	DatabaseColumnType DatabaseBatch::getType(sl_uint32 row, sl_uint32 column)
+	{
+		if (row < m_nRows && column < m_nColumns) {
+			return (DatabaseColumnType)(m_types[BATCH_CELL(row, column)]);
+		}
+		return DatabaseColumnType::Null;
+	}
+
+	sl_bool DatabaseBatch::isNull(sl_uint32 row, sl_uint32 column)
+	{
+		return getType(row, column) == DatabaseColumnType::Null;
+	}
+
+	sl_int64 DatabaseBatch::getInt64(sl_uint32 row, sl_uint32 column)
+	{
+		if (row < m_nRows && column < m_nColumns) {
+			return m_ints[BATCH_CELL(row, column)];
+		}
+		return 0;
+	}
+
+	double DatabaseBatch::getDouble(sl_uint32 row, sl_uint32 column)
+	{
+		if (row < m_nRows && column < m_nColumns) {
+			return m_doubles[BATCH_CELL(row, column)];
+		}
+		return 0;
+	}
+
+	const sl_char8* DatabaseBatch::getText(sl_uint32 row, sl_uint32 column, sl_size* outLength)
+	{
+		if (row < m_nRows && column < m_nColumns) {
+			sl_size cell = BATCH_CELL(row, column);
+			if (m_types[cell] == (sl_uint8)(DatabaseColumnType::Text)) {
+				if (outLength) {
+					*outLength = m_sizes[cell];
+				}
+				return (sl_char8*)(m_memData.getData()) + m_offsets[cell];
+			}
+		}
+		if (outLength) {
+			*outLength = 0;
+		}
+		return sl_null;
+	}
+
+	const void* DatabaseBatch::getBlobData(sl_uint32 row, sl_uint32 column, sl_size* outSize)
+	{
+		if (row < m_nRows && column < m_nColumns) {
+			sl_size cell = BATCH_CELL(row, column);
+			sl_uint8 type = m_types[cell];
+			if (type == (sl_uint8)(DatabaseColumnType::Text) || type == (sl_uint8)(DatabaseColumnType::Blob)) {
+				if (outSize) {
+					*outSize = m_sizes[cell];
+				}
+				return (sl_uint8*)(m_memData.getData()) + m_offsets[cell];
+			}
+		}
+		if (outSize) {
+			*outSize = 0;
+		}
+		return sl_null;
+	}
+
+	String DatabaseBatch::getString(sl_uint32 row, sl_uint32 column)
+	{
+		if (row < m_nRows && column < m_nColumns) {
+			sl_size cell = BATCH_CELL(row, column);
+			switch ((DatabaseColumnType)(m_types[cell])) {
+			case DatabaseColumnType::Integer:
+				return String::fromInt64(m_ints[cell]);
+			case DatabaseColumnType::Float:
+				return String::fromDouble(m_doubles[cell]);
+			case DatabaseColumnType::Text:
+				return String::fromUtf8((sl_char8*)(m_memData.getData()) + m_offsets[cell], m_sizes[cell]);
+			default:
+				break;
+			}
+		}
+		return sl_null;
+	}
+
+	Memory DatabaseBatch::getBlob(sl_uint32 row, sl_uint32 column)
+	{
+		if (row < m_nRows && column < m_nColumns) {
+			sl_size cell = BATCH_CELL(row, column);
+			sl_uint8 type = m_types[cell];
+			if (type == (sl_uint8)(DatabaseColumnType::Text) || type == (sl_uint8)(DatabaseColumnType::Blob)) {
+				if (m_sizes[cell] > 0) {
+					return m_memData.sub(m_offsets[cell], m_sizes[cell]);
+				}
+			}
+		}
+		return sl_null;
+	}
+
+	Variant DatabaseBatch::getValue(sl_uint32 row, sl_uint32 column)
+	{
+		if (row < m_nRows && column < m_nColumns) {
+			sl_size cell = BATCH_CELL(row, column);
+			switch ((DatabaseColumnType)(m_types[cell])) {
+			case DatabaseColumnType::Integer:
+				{
+					sl_int64 v64 = m_ints[cell];
+					sl_int32 v32 = (sl_int32)v64;
+					if (v64 == v32) {
+						return v32;
+					} else {
+						return v64;
+					}
+				}
+			case DatabaseColumnType::Float:
+				return m_doubles[cell];
+			case DatabaseColumnType::Text:
+				return String::fromUtf8((sl_char8*)(m_memData.getData()) + m_offsets[cell], m_sizes[cell]);
+			case DatabaseColumnType::Blob:
+				return getBlob(row, column);
+			default:
+				break;
+			}
+		}
+		return sl_null;
+	}
+
+	const sl_uint8* DatabaseBatch::getColumnTypes(sl_uint32 column)
+	{
+		if (column < m_nColumns) {
+			return m_types + BATCH_CELL(0, column);
+		}
+		return sl_null;
+	}
+
+	const sl_int64* DatabaseBatch::getInt64Column(sl_uint32 column)
+	{
+		if (column < m_nColumns) {
+			return m_ints + BATCH_CELL(0, column);
+		}
+		return sl_null;
+	}
+
+	const double* DatabaseBatch::getDoubleColumn(sl_uint32 column)
+	{
+		if (column < m_nColumns) {
+			return m_doubles + BATCH_CELL(0, column);
+		}
+		return sl_null;
+	}
+
+	sl_uint32 DatabaseBatch::getRowsCapacity()
+	{
+		return m_nRowsCapacity;
+	}
+
+	void DatabaseBatch::setInt64(sl_uint32 column, sl_int64 value)
+	{
+		if (m_nRows < m_nRowsCapacity && column < m_nColumns) {
+			sl_size cell = BATCH_CELL(m_nRows, column);
+			m_types[cell] = (sl_uint8)(DatabaseColumnType::Integer);
+			m_ints[cell] = value;
+			m_doubles[cell] = (double)value;
+		}
+	}
+
+	void DatabaseBatch::setDouble(sl_uint32 column, double value)
+	{
+		if (m_nRows < m_nRowsCapacity && column < m_nColumns) {
+			sl_size cell = BATCH_CELL(m_nRows, column);
+			m_types[cell] = (sl_uint8)(DatabaseColumnType::Float);
+			m_ints[cell] = (sl_int64)value;
+			m_doubles[cell] = value;
+		}
+	}
+
+	sl_bool DatabaseBatch::setText(sl_uint32 column, const void* text, sl_size length)
+	{
+		return _addData(column, (sl_uint8)(DatabaseColumnType::Text), text, length, sl_true);
+	}
+
+	sl_bool DatabaseBatch::setBlob(sl_uint32 column, const void* data, sl_size size)
+	{
+		return _addData(column, (sl_uint8)(DatabaseColumnType::Blob), data, size, sl_false);
+	}
+
+	sl_bool DatabaseBatch::addRow()
+	{
+		if (m_nRows < m_nRowsCapacity) {
+			m_nRows++;
+			return sl_true;
+		}
+		return sl_false;
+	}
+
+	sl_bool DatabaseBatch::_addData(sl_uint32 column, sl_uint8 type, const void* data, sl_size size, sl_bool flagNullTerminated)
+	{
+		if (m_nRows >= m_nRowsCapacity || column >= m_nColumns) {
+			return sl_false;
+		}
+		sl_size sizeNeeded = m_sizeData + size + (flagNullTerminated ? 1 : 0);
+		sl_size capacity = m_memData.getSize();
+		if (sizeNeeded > capacity) {
+			capacity = capacity * 2;
+			if (capacity < sizeNeeded) {
+				capacity = sizeNeeded;
+			}
+			if (capacity < BATCH_DATA_SIZE_MIN) {
+				capacity = BATCH_DATA_SIZE_MIN;
+			}
+			Memory mem = Memory::create(capacity);
+			if (mem.isNull()) {
+				return sl_false;
+			}
+			if (m_sizeData) {
+				Base::copyMemory(mem.getData(), m_memData.getData(), m_sizeData);
+			}
+			m_memData = mem;
+		}
+		sl_uint8* p = (sl_uint8*)(m_memData.getData()) + m_sizeData;
+		if (size) {
+			Base::copyMemory(p, data, size);
+		}
+		if (flagNullTerminated) {
+			p[size] = 0;
+		}
+		sl_size cell = BATCH_CELL(m_nRows, column);
+		m_types[cell] = type;
+		m_ints[cell] = 0;
+		m_doubles[cell] = 0;
+		m_offsets[cell] = m_sizeData;
+		m_sizes[cell] = size;
+		m_sizeData = sizeNeeded;
+		return sl_true;
+	}
+
+}
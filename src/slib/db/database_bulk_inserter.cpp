@@ -0,0 +1,250 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "../../../inc/slib/db/database_bulk_inserter.h"
+
+#include "../../../inc/slib/core/string_buffer.h"
+#include "../../../inc/slib/core/system.h"
+
+// SQLITE_MAX_VARIABLE_NUMBER of the versions before 3.32
+#define MAX_PARAMS_PER_STATEMENT 999
+#define DEFAULT_ROWS_PER_STATEMENT 64
+
+namespace slib
+{
+
+	DatabaseBulkInserterParam::DatabaseBulkInserterParam()
+	{
+		rowsPerStatement = 0;
+		rowsPerTransaction = 10000;
+		transactionInterval = 1000;
+	}
+
+	DatabaseBulkInserterParam::~DatabaseBulkInserterParam()
+	{
+	}
+
+
+	SLIB_DEFINE_OBJECT(DatabaseBulkInserter, Object)
+
+	DatabaseBulkInserter::DatabaseBulkInserter()
+	{
+		m_nColumns = 0;
+		m_rowsPerStatement = 1;
+		m_rowsPerTransaction = 0;
+		m_transactionInterval = 0;
+		m_nPendingRows = 0;
+		m_flagTransaction = sl_false;
+		m_tickTransactionBegan = 0;
+		m_nTransactionRows = 0;
+		m_nQueuedRows = 0;
+		m_nInsertedRows = 0;
+		m_nCommittedRows = 0;
+		m_indexFailedRow = -1;
+	}
+
+	DatabaseBulkInserter::~DatabaseBulkInserter()
+	{
+		flush();
+	}
+
+	static String _DatabaseBulkInserter_buildSql(const String& table, const String* columns, sl_uint32 nColumns, sl_uint32 nRows)
+	{
+		StringBuffer sb;
+		sb.addStatic("INSERT INTO ", 12);
+		sb.add(table);
+		sb.addStatic(" (", 2);
+		for (sl_uint32 i = 0; i < nColumns; i++) {
+			if (i) {
+				sb.addStatic(", ", 2);
+			}
+			sb.add(columns[i]);
+		}
+		sb.addStatic(") VALUES ", 9);
+		for (sl_uint32 k = 0; k < nRows; k++) {
+			if (k) {
+				sb.addStatic(", ", 2);
+			}
+			sb.addStatic("(", 1);
+			for (sl_uint32 i = 0; i < nColumns; i++) {
+				if (i) {
+					sb.addStatic(", ?", 3);
+				} else {
+					sb.addStatic("?", 1);
+				}
+			}
+			sb.addStatic(")", 1);
+		}
+		return sb.merge();
+	}
+
+	Ref<DatabaseBulkInserter> DatabaseBulkInserter::create(const DatabaseBulkInserterParam& param)
+	{
+		if (param.database.isNull() || param.table.isEmpty()) {
+			return sl_null;
+		}
+		ListLocker<String> columns(param.columns);
+		if (!(columns.count)) {
+			return sl_null;
+		}
+		sl_uint32 nColumns = (sl_uint32)(columns.count);
+		if (nColumns > MAX_PARAMS_PER_STATEMENT) {
+			return sl_null;
+		}
+		sl_uint32 rowsPerStatement = param.rowsPerStatement;
+		if (!rowsPerStatement) {
+			rowsPerStatement = DEFAULT_ROWS_PER_STATEMENT;
+			if (rowsPerStatement * nColumns > MAX_PARAMS_PER_STATEMENT) {
+				rowsPerStatement = MAX_PARAMS_PER_STATEMENT / nColumns;
+			}
+		}
+		Array<Variant> pending = Array<Variant>::create(rowsPerStatement * nColumns);
+		if (pending.isNull()) {
+			return sl_null;
+		}
+		Ref<DatabaseBulkInserter> ret = new DatabaseBulkInserter;
+		if (ret.isNotNull()) {
+			ret->m_db = param.database;
+			ret->m_nColumns = nColumns;
+			ret->m_rowsPerStatement = rowsPerStatement;
+			ret->m_rowsPerTransaction = param.rowsPerTransaction;
+			ret->m_transactionInterval = param.transactionInterval;
+			ret->m_sqlSingle = _DatabaseBulkInserter_buildSql(param.table, columns.data, nColumns, 1);
+			if (rowsPerStatement > 1) {
+				ret->m_sqlMulti = _DatabaseBulkInserter_buildSql(param.table, columns.data, nColumns, rowsPerStatement);
+			}
+			ret->m_pending = pending;
+		}
+		return ret;
+	}
+
+	sl_bool DatabaseBulkInserter::insertBy(const Variant* values, sl_uint32 nValues)
+	{
+		if (nValues != m_nColumns) {
+			return sl_false;
+		}
+		ObjectLocker lock(this);
+		if (!m_flagTransaction) {
+			if (!(m_db->beginTransaction())) {
+				return sl_false;
+			}
+			m_flagTransaction = sl_true;
+			m_tickTransactionBegan = System::getTickCount();
+			m_nTransactionRows = 0;
+		}
+		Variant* row = m_pending.getData() + m_nPendingRows * m_nColumns;
+		for (sl_uint32 i = 0; i < nValues; i++) {
+			row[i] = values[i];
+		}
+		m_nPendingRows++;
+		m_nQueuedRows++;
+		if (m_nPendingRows >= m_rowsPerStatement) {
+			if (!(_executePending())) {
+				return sl_false;
+			}
+		}
+		if (m_rowsPerTransaction && m_nTransactionRows + m_nPendingRows >= m_rowsPerTransaction) {
+			return _commit();
+		}
+		if (m_transactionInterval && System::getTickCount() - m_tickTransactionBegan >= m_transactionInterval) {
+			return _commit();
+		}
+		return sl_true;
+	}
+
+	sl_bool DatabaseBulkInserter::insertBy(const List<Variant>& _values)
+	{
+		ListLocker<Variant> values(_values);
+		return insertBy(values.data, (sl_uint32)(values.count));
+	}
+
+	sl_bool DatabaseBulkInserter::flush()
+	{
+		ObjectLocker lock(this);
+		if (m_flagTransaction) {
+			return _commit();
+		}
+		return sl_true;
+	}
+
+	sl_uint64 DatabaseBulkInserter::getInsertedRowsCount()
+	{
+		return m_nInsertedRows;
+	}
+
+	sl_uint64 DatabaseBulkInserter::getCommittedRowsCount()
+	{
+		return m_nCommittedRows;
+	}
+
+	sl_int64 DatabaseBulkInserter::getFailedRowIndex()
+	{
+		return m_indexFailedRow;
+	}
+
+	sl_bool DatabaseBulkInserter::_executePending()
+	{
+		sl_uint32 nRows = m_nPendingRows;
+		if (!nRows) {
+			return sl_true;
+		}
+		m_nPendingRows = 0;
+		Variant* values = m_pending.getData();
+		sl_uint32 nExecutedRows = 0;
+		if (nRows == m_rowsPerStatement && m_sqlMulti.isNotNull()) {
+			if (m_statementMulti.isNull()) {
+				m_statementMulti = m_db->prepareStatement(m_sqlMulti);
+			}
+			if (m_statementMulti.isNotNull() && m_statementMulti->executeBy(values, nRows * m_nColumns) >= 0) {
+				nExecutedRows = nRows;
+			}
+		}
+		if (nExecutedRows < nRows) {
+			// a failed multi-row statement has no effect, so its rows are retried one by one to find the failed row
+			if (m_statementSingle.isNull()) {
+				m_statementSingle = m_db->prepareStatement(m_sqlSingle);
+			}
+			if (m_statementSingle.isNotNull()) {
+				for (; nExecutedRows < nRows; nExecutedRows++) {
+					if (m_statementSingle->executeBy(values + nExecutedRows * m_nColumns, m_nColumns) < 0) {
+						break;
+					}
+				}
+			}
+		}
+		// releases the bound values such as the blobs
+		for (sl_uint32 i = 0; i < nRows * m_nColumns; i++) {
+			values[i].setNull();
+		}
+		m_nTransactionRows += nExecutedRows;
+		m_nInsertedRows += nExecutedRows;
+		if (nExecutedRows < nRows) {
+			// the pending rows are the last rows queued
+			m_indexFailedRow = (sl_int64)(m_nQueuedRows - nRows + nExecutedRows);
+			return sl_false;
+		}
+		return sl_true;
+	}
+
+	sl_bool DatabaseBulkInserter::_commit()
+	{
+		sl_bool flagSuccess = _executePending();
+		m_flagTransaction = sl_false;
+		if (m_db->commit()) {
+			m_nCommittedRows += m_nTransactionRows;
+		} else {
+			m_db->rollback();
+			flagSuccess = sl_false;
+		}
+		m_nTransactionRows = 0;
+		return flagSuccess;
+	}
+
+}
@@ -0,0 +1,993 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "../../../inc/slib/db/database_cache.h"
+
+#include "../../../inc/slib/core/system.h"
+
+#define ENTRY_OVERHEAD_SIZE 128
+#define TABLE_OVERHEAD_SIZE 48
+
+namespace slib
+{
+
+	enum class _DatabaseCache_StatementType
+	{
+		Read,
+		Write,
+		Transaction,
+		Other
+	};
+
+	/*
+		Serialized form of the results
+	*/
+
+	enum _DatabaseCache_ValueType
+	{
+		_DatabaseCache_Null = 0,
+		_DatabaseCache_Int = 1,
+		_DatabaseCache_Uint64 = 2,
+		_DatabaseCache_Double = 3,
+		_DatabaseCache_Boolean = 4,
+		_DatabaseCache_Time = 5,
+		_DatabaseCache_String = 6,
+		_DatabaseCache_Memory = 7
+	};
+
+	class _DatabaseCache_Writer
+	{
+	public:
+		Memory mem;
+		sl_uint8* buf;
+		sl_size size;
+		sl_size capacity;
+		sl_bool flagError;
+
+	public:
+		_DatabaseCache_Writer()
+		{
+			buf = sl_null;
+			size = 0;
+			capacity = 0;
+			flagError = sl_false;
+		}
+
+	public:
+		sl_bool reserve(sl_size n)
+		{
+			if (size + n <= capacity) {
+				return sl_true;
+			}
+			if (flagError) {
+				return sl_false;
+			}
+			sl_size c = capacity * 2;
+			if (c < size + n) {
+				c = size + n;
+			}
+			if (c < 256) {
+				c = 256;
+			}
+			Memory m = Memory::create(c);
+			if (m.isNull()) {
+				flagError = sl_true;
+				return sl_false;
+			}
+			if (size) {
+				Base::copyMemory(m.getData(), buf, size);
+			}
+			mem = m;
+			buf = (sl_uint8*)(m.getData());
+			capacity = c;
+			return sl_true;
+		}
+
+		void putByte(sl_uint8 v)
+		{
+			if (reserve(1)) {
+				buf[size++] = v;
+			}
+		}
+
+		void putCVLI(sl_uint64 v)
+		{
+			if (reserve(10)) {
+				while (v >= 0x80) {
+					buf[size++] = (sl_uint8)(v | 0x80);
+					v >>= 7;
+				}
+				buf[size++] = (sl_uint8)v;
+			}
+		}
+
+		void putBytes(const void* data, sl_size n)
+		{
+			putCVLI(n);
+			if (n && reserve(n)) {
+				Base::copyMemory(buf + size, data, n);
+				size += n;
+			}
+		}
+
+		void putString(const String& s)
+		{
+			putBytes(s.getData(), s.getLength());
+		}
+
+		void putVariant(const Variant& v)
+		{
+			switch (v.getType()) {
+				case VariantType::Null:
+					putByte(_DatabaseCache_Null);
+					return;
+				case VariantType::Int32:
+				case VariantType::Uint32:
+				case VariantType::Int64:
+					{
+						sl_int64 n = v.getInt64();
+						putByte(_DatabaseCache_Int);
+						// zigzag
+						putCVLI(((sl_uint64)n << 1) ^ (sl_uint64)(n >> 63));
+					}
+					return;
+				case VariantType::Uint64:
+					putByte(_DatabaseCache_Uint64);
+					putCVLI(v.getUint64());
+					return;
+				case VariantType::Float:
+				case VariantType::Double:
+					{
+						double d = v.getDouble();
+						putByte(_DatabaseCache_Double);
+						if (reserve(8)) {
+							Base::copyMemory(buf + size, &d, 8);
+							size += 8;
+						}
+					}
+					return;
+				case VariantType::Boolean:
+					putByte(_DatabaseCache_Boolean);
+					putByte(v.getBoolean() ? 1 : 0);
+					return;
+				case VariantType::Time:
+					{
+						sl_int64 n = v.getTime().toInt();
+						putByte(_DatabaseCache_Time);
+						putCVLI(((sl_uint64)n << 1) ^ (sl_uint64)(n >> 63));
+					}
+					return;
+				default:
+					break;
+			}
+			if (v.isMemory()) {
+				Memory m = v.getMemory();
+				putByte(_DatabaseCache_Memory);
+				putBytes(m.getData(), m.getSize());
+			} else {
+				putByte(_DatabaseCache_String);
+				putString(v.getString());
+			}
+		}
+
+		void putMap(const Map<String, Variant>& map, HashMap<String, sl_uint32>& names)
+		{
+			putCVLI(map.getCount());
+			Iterator< Pair<String, Variant> > iterator(map.toIterator());
+			Pair<String, Variant> pair;
+			while (iterator.next(&pair)) {
+				sl_uint32 nNames = (sl_uint32)(names.getCount());
+				sl_uint32 index = names.getValue_NoLock(pair.key, nNames);
+				// the index of the new name is followed by the name
+				putCVLI(index);
+				if (index == nNames) {
+					names.put_NoLock(pair.key, nNames);
+					putString(pair.key);
+				}
+				putVariant(pair.value);
+			}
+		}
+
+		Memory getData()
+		{
+			if (flagError) {
+				return sl_null;
+			}
+			return Memory::create(buf, size);
+		}
+
+	};
+
+	class _DatabaseCache_Reader
+	{
+	public:
+		const sl_uint8* p;
+		const sl_uint8* end;
+
+	public:
+		_DatabaseCache_Reader(const Memory& mem)
+		{
+			p = (const sl_uint8*)(mem.getData());
+			end = p + mem.getSize();
+		}
+
+	public:
+		sl_bool getByte(sl_uint8& v)
+		{
+			if (p < end) {
+				v = *(p++);
+				return sl_true;
+			}
+			return sl_false;
+		}
+
+		sl_bool getCVLI(sl_uint64& v)
+		{
+			v = 0;
+			for (sl_uint32 shift = 0; shift < 64; shift += 7) {
+				if (p >= end) {
+					return sl_false;
+				}
+				sl_uint8 b = *(p++);
+				v |= (sl_uint64)(b & 0x7F) << shift;
+				if (!(b & 0x80)) {
+					return sl_true;
+				}
+			}
+			return sl_false;
+		}
+
+		sl_bool getBytes(const sl_uint8*& data, sl_size& n)
+		{
+			sl_uint64 len;
+			if (!(getCVLI(len))) {
+				return sl_false;
+			}
+			if (len > (sl_uint64)(end - p)) {
+				return sl_false;
+			}
+			data = p;
+			n = (sl_size)len;
+			p += n;
+			return sl_true;
+		}
+
+		sl_bool getString(String& s)
+		{
+			const sl_uint8* data;
+			sl_size n;
+			if (getBytes(data, n)) {
+				s = String((const sl_char8*)data, n);
+				return sl_true;
+			}
+			return sl_false;
+		}
+
+		sl_bool getVariant(Variant& v)
+		{
+			sl_uint8 type;
+			if (!(getByte(type))) {
+				return sl_false;
+			}
+			switch (type) {
+				case _DatabaseCache_Null:
+					v.setNull();
+					return sl_true;
+				case _DatabaseCache_Int:
+				case _DatabaseCache_Time:
+					{
+						sl_uint64 u;
+						if (!(getCVLI(u))) {
+							return sl_false;
+						}
+						sl_int64 n = (sl_int64)(u >> 1) ^ -(sl_int64)(u & 1);
+						if (type == _DatabaseCache_Time) {
+							v = Time(n);
+						} else {
+							sl_int32 n32 = (sl_int32)n;
+							if (n == n32) {
+								v = n32;
+							} else {
+								v = n;
+							}
+						}
+					}
+					return sl_true;
+				case _DatabaseCache_Uint64:
+					{
+						sl_uint64 u;
+						if (!(getCVLI(u))) {
+							return sl_false;
+						}
+						v = u;
+					}
+					return sl_true;
+				case _DatabaseCache_Double:
+					{
+						if (end - p < 8) {
+							return sl_false;
+						}
+						double d;
+						Base::copyMemory(&d, p, 8);
+						p += 8;
+						v = d;
+					}
+					return sl_true;
+				case _DatabaseCache_Boolean:
+					{
+						sl_uint8 b;
+						if (!(getByte(b))) {
+							return sl_false;
+						}
+						v = (sl_bool)(b != 0);
+					}
+					return sl_true;
+				case _DatabaseCache_String:
+					{
+						String s;
+						if (!(getString(s))) {
+							return sl_false;
+						}
+						v = s;
+					}
+					return sl_true;
+				case _DatabaseCache_Memory:
+					{
+						const sl_uint8* data;
+						sl_size n;
+						if (!(getBytes(data, n))) {
+							return sl_false;
+						}
+						v = Memory::create(data, n);
+					}
+					return sl_true;
+			}
+			return sl_false;
+		}
+
+		sl_bool getMap(Map<String, Variant>& map, CList<String>& names)
+		{
+			sl_uint64 n;
+			if (!(getCVLI(n))) {
+				return sl_false;
+			}
+			map.initHash();
+			for (sl_uint64 i = 0; i < n; i++) {
+				sl_uint64 index;
+				if (!(getCVLI(index))) {
+					return sl_false;
+				}
+				sl_size nNames = names.getCount();
+				if (index == nNames) {
+					String name;
+					if (!(getString(name))) {
+						return sl_false;
+					}
+					names.add_NoLock(name);
+				} else if (index > nNames) {
+					return sl_false;
+				}
+				Variant value;
+				if (!(getVariant(value))) {
+					return sl_false;
+				}
+				map.put_NoLock(names.getData()[index], value);
+			}
+			return sl_true;
+		}
+
+	};
+
+	static Memory _DatabaseCache_serializeList(const List< Map<String, Variant> >& _list)
+	{
+		_DatabaseCache_Writer writer;
+		if (_list.isNull()) {
+			writer.putByte(0);
+		} else {
+			writer.putByte(1);
+			ListLocker< Map<String, Variant> > list(_list);
+			writer.putCVLI(list.count);
+			HashMap<String, sl_uint32> names;
+			for (sl_size i = 0; i < list.count; i++) {
+				writer.putMap(list[i], names);
+			}
+		}
+		return writer.getData();
+	}
+
+	static sl_bool _DatabaseCache_deserializeList(const Memory& mem, List< Map<String, Variant> >& list)
+	{
+		_DatabaseCache_Reader reader(mem);
+		sl_uint8 flag;
+		if (!(reader.getByte(flag))) {
+			return sl_false;
+		}
+		if (!flag) {
+			list.setNull();
+			return sl_true;
+		}
+		sl_uint64 n;
+		if (!(reader.getCVLI(n))) {
+			return sl_false;
+		}
+		list = List< Map<String, Variant> >::create();
+		if (list.isNull()) {
+			return sl_false;
+		}
+		CList<String> names;
+		for (sl_uint64 i = 0; i < n; i++) {
+			Map<String, Variant> row;
+			if (!(reader.getMap(row, names))) {
+				return sl_false;
+			}
+			list.add_NoLock(row);
+		}
+		return sl_true;
+	}
+
+	static Memory _DatabaseCache_serializeRecord(const Map<String, Variant>& record)
+	{
+		_DatabaseCache_Writer writer;
+		if (record.isNull()) {
+			writer.putByte(0);
+		} else {
+			writer.putByte(1);
+			HashMap<String, sl_uint32> names;
+			writer.putMap(record, names);
+		}
+		return writer.getData();
+	}
+
+	static sl_bool _DatabaseCache_deserializeRecord(const Memory& mem, Map<String, Variant>& record)
+	{
+		_DatabaseCache_Reader reader(mem);
+		sl_uint8 flag;
+		if (!(reader.getByte(flag))) {
+			return sl_false;
+		}
+		if (!flag) {
+			record.setNull();
+			return sl_true;
+		}
+		CList<String> names;
+		return reader.getMap(record, names);
+	}
+
+	static Memory _DatabaseCache_serializeValue(const Variant& value)
+	{
+		_DatabaseCache_Writer writer;
+		writer.putVariant(value);
+		return writer.getData();
+	}
+
+	static sl_bool _DatabaseCache_deserializeValue(const Memory& mem, Variant& value)
+	{
+		_DatabaseCache_Reader reader(mem);
+		return reader.getVariant(value);
+	}
+
+	static String _DatabaseCache_getKey(sl_char8 kind, const String& sql, const Variant* params, sl_uint32 nParams)
+	{
+		_DatabaseCache_Writer writer;
+		writer.putByte(kind);
+		writer.putString(sql);
+		writer.putCVLI(nParams);
+		for (sl_uint32 i = 0; i < nParams; i++) {
+			writer.putVariant(params[i]);
+		}
+		if (writer.flagError) {
+			return sl_null;
+		}
+		return String((const sl_char8*)(writer.buf), writer.size);
+	}
+
+	/*
+		Finds the table names following FROM, JOIN, INTO and UPDATE.
+		Not a full parser: the extra names (such as the aliases of the subqueries) only cause the extra invalidations.
+	*/
+
+	static sl_bool _DatabaseCache_isWordChar(sl_char8 c)
+	{
+		return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' || c == '$' || (sl_uint8)c >= 0x80;
+	}
+
+	// returns the words in lower case, and the other characters except the spaces, comments and literals
+	static void _DatabaseCache_tokenize(const String& sql, CList<String>& tokens)
+	{
+		const sl_char8* p = sql.getData();
+		const sl_char8* end = p + sql.getLength();
+		while (p < end) {
+			sl_char8 c = *p;
+			if (c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+				p++;
+			} else if (c == '-' && p + 1 < end && p[1] == '-') {
+				while (p < end && *p != '\n') {
+					p++;
+				}
+			} else if (c == '/' && p + 1 < end && p[1] == '*') {
+				p += 2;
+				while (p < end && !(*p == '*' && p + 1 < end && p[1] == '/')) {
+					p++;
+				}
+				p += 2;
+			} else if (c == '\'') {
+				// string literal, '' is the escaped quote
+				p++;
+				while (p < end) {
+					if (*p == '\'') {
+						if (p + 1 < end && p[1] == '\'') {
+							p += 2;
+							continue;
+						}
+						break;
+					}
+					p++;
+				}
+				p++;
+				tokens.add_NoLock("'");
+			} else if (c == '"' || c == '`' || c == '[') {
+				sl_char8 q = c == '[' ? ']' : c;
+				const sl_char8* start = ++p;
+				while (p < end && *p != q) {
+					p++;
+				}
+				tokens.add_NoLock(String::toLower(start, p - start));
+				p++;
+			} else if (_DatabaseCache_isWordChar(c)) {
+				const sl_char8* start = p;
+				while (p < end && _DatabaseCache_isWordChar(*p)) {
+					p++;
+				}
+				tokens.add_NoLock(String::toLower(start, p - start));
+			} else {
+				tokens.add_NoLock(String(p, 1));
+				p++;
+			}
+		}
+	}
+
+	static sl_bool _DatabaseCache_isName(const String& token)
+	{
+		return token.isNotEmpty() && _DatabaseCache_isWordChar(token.getData()[0]) && token != "select" && token != "set" && token != "values";
+	}
+
+	static _DatabaseCache_StatementType _DatabaseCache_parseStatement(const String& sql, List<String>& tables)
+	{
+		CList<String> listTokens;
+		_DatabaseCache_tokenize(sql, listTokens);
+		String* tokens = listTokens.getData();
+		sl_size n = listTokens.getCount();
+		if (!n) {
+			return _DatabaseCache_StatementType::Other;
+		}
+		// multiple statements
+		for (sl_size i = 0; i + 1 < n; i++) {
+			if (tokens[i] == ";") {
+				return _DatabaseCache_StatementType::Other;
+			}
+		}
+		_DatabaseCache_StatementType type;
+		String& first = tokens[0];
+		if (first == "select" || first == "with" || first == "values") {
+			type = _DatabaseCache_StatementType::Read;
+		} else if (first == "insert" || first == "replace" || first == "update" || first == "delete") {
+			type = _DatabaseCache_StatementType::Write;
+		} else if (first == "begin" || first == "start" || first == "commit" || first == "end" || first == "savepoint" || first == "release") {
+			return _DatabaseCache_StatementType::Transaction;
+		} else {
+			return _DatabaseCache_StatementType::Other;
+		}
+		tables = List<String>::create();
+		sl_size i = 0;
+		while (i < n) {
+			String& keyword = tokens[i++];
+			sl_bool flagFrom = keyword == "from";
+			if (!flagFrom && keyword != "join" && keyword != "into" && keyword != "update") {
+				continue;
+			}
+			while (i < n) {
+				// UPDATE OR IGNORE, INSERT OR REPLACE INTO
+				if (tokens[i] == "or") {
+					i += 2;
+					continue;
+				}
+				if (!(_DatabaseCache_isName(tokens[i]))) {
+					break;
+				}
+				String name = tokens[i++];
+				// schema.table
+				if (i + 1 < n && tokens[i] == "." && _DatabaseCache_isName(tokens[i + 1])) {
+					name = tokens[i + 1];
+					i += 2;
+				}
+				if (tables.indexOf_NoLock(name) < 0) {
+					tables.add_NoLock(name);
+				}
+				if (!flagFrom) {
+					break;
+				}
+				// FROM a [AS] x, b [AS] y
+				if (i < n && tokens[i] == "as") {
+					i++;
+				}
+				if (i < n && _DatabaseCache_isName(tokens[i]) && tokens[i] != "where" && tokens[i] != "join") {
+					i++;
+				}
+				if (i < n && tokens[i] == ",") {
+					i++;
+				} else {
+					break;
+				}
+			}
+		}
+		return type;
+	}
+
+
+	DatabaseCacheParam::DatabaseCacheParam()
+	{
+		expiringMilliseconds = 60000;
+		maxMemorySize = 64 * 1024 * 1024;
+		maxResultSize = 1024 * 1024;
+	}
+
+	DatabaseCacheParam::~DatabaseCacheParam()
+	{
+	}
+
+
+	SLIB_DEFINE_OBJECT(DatabaseCache, Database)
+
+	DatabaseCache::DatabaseCache()
+	{
+		m_expiringMilliseconds = 0;
+		m_maxMemorySize = 0;
+		m_maxResultSize = 0;
+		m_sizeMemory = 0;
+		m_nHits = 0;
+		m_nMisses = 0;
+		m_generationAll = 0;
+	}
+
+	DatabaseCache::~DatabaseCache()
+	{
+		if (m_db.isNotNull()) {
+			m_db->setTableChangeCallback(sl_null);
+		}
+	}
+
+	Ref<DatabaseCache> DatabaseCache::create(const DatabaseCacheParam& param)
+	{
+		if (param.database.isNull()) {
+			return sl_null;
+		}
+		Ref<DatabaseCache> ret = new DatabaseCache;
+		if (ret.isNotNull()) {
+			ret->m_db = param.database;
+			ret->m_expiringMilliseconds = param.expiringMilliseconds;
+			ret->m_maxMemorySize = param.maxMemorySize;
+			ret->m_maxResultSize = param.maxResultSize;
+			param.database->setTableChangeCallback(SLIB_FUNCTION_WEAKREF(DatabaseCache, _onTableChanged, ret));
+		}
+		return ret;
+	}
+
+	Ref<Database> DatabaseCache::getDatabase()
+	{
+		return m_db;
+	}
+
+	void DatabaseCache::setQueryTables(const String& sql, const List<String>& _tables)
+	{
+		List<String> tables = List<String>::create();
+		ListLocker<String> src(_tables);
+		for (sl_size i = 0; i < src.count; i++) {
+			tables.add_NoLock(src[i].toLower());
+		}
+		MutexLocker lock(&m_lockCache);
+		m_mapQueryTables.put_NoLock(sql, tables);
+	}
+
+	void DatabaseCache::invalidateTable(const String& _table)
+	{
+		String table = _table.toLower();
+		MutexLocker lock(&m_lockCache);
+		sl_uint64* p = m_mapTableGenerations.getItemPointer(table);
+		if (p) {
+			(*p)++;
+		} else {
+			m_mapTableGenerations.put_NoLock(table, 1);
+		}
+	}
+
+	void DatabaseCache::invalidateAll()
+	{
+		MutexLocker lock(&m_lockCache);
+		m_generationAll++;
+		m_listEntries.removeAll_NoLock();
+		m_mapEntries.removeAll_NoLock();
+		m_sizeMemory = 0;
+	}
+
+	sl_uint64 DatabaseCache::getHitsCount()
+	{
+		return m_nHits;
+	}
+
+	sl_uint64 DatabaseCache::getMissesCount()
+	{
+		return m_nMisses;
+	}
+
+	sl_size DatabaseCache::getEntriesCount()
+	{
+		return m_listEntries.getCount();
+	}
+
+	sl_size DatabaseCache::getMemorySize()
+	{
+		return m_sizeMemory;
+	}
+
+	Ref<DatabaseStatement> DatabaseCache::prepareStatement(const String& sql)
+	{
+		return m_db->prepareStatement(sql);
+	}
+
+	sl_int64 DatabaseCache::executeBy(const String& sql, const Variant* params, sl_uint32 nParams)
+	{
+		sl_int64 ret;
+		if (nParams) {
+			ret = m_db->executeBy(sql, params, nParams);
+		} else {
+			// keeps the behavior of the connection, such as executing multiple statements
+			ret = m_db->execute(sql);
+		}
+		// after the write, so that the queries running meanwhile are not cached with the old data
+		_invalidateForStatement(sql);
+		return ret;
+	}
+
+	Ref<DatabaseCursor> DatabaseCache::queryBy(const String& sql, const Variant* params, sl_uint32 nParams)
+	{
+		return m_db->queryBy(sql, params, nParams);
+	}
+
+	typedef List< Map<String, Variant> > _DatabaseCache_Rows;
+	typedef Map<String, Variant> _DatabaseCache_Record;
+
+#define DEFINE_DATABASE_CACHE_QUERY(TYPE, KIND, SERIALIZE, DESERIALIZE, QUERY, ...) \
+	{ \
+		List<String> tables; \
+		if (!(_getQueryTables(sql, tables))) { \
+			return m_db->QUERY(__VA_ARGS__); \
+		} \
+		String key = _DatabaseCache_getKey(KIND, sql, params, nParams); \
+		Memory data; \
+		if (_getCached(key, data)) { \
+			TYPE ret; \
+			if (DESERIALIZE(data, ret)) { \
+				return ret; \
+			} \
+		} \
+		sl_uint64 generationAll; \
+		List< Pair<String, sl_uint64> > generations = _getGenerations(tables, generationAll); \
+		TYPE ret = m_db->QUERY(__VA_ARGS__); \
+		data = SERIALIZE(ret); \
+		if (data.isNotNull()) { \
+			_putCached(key, data, generations, generationAll); \
+		} \
+		return ret; \
+	}
+
+	List< Map<String, Variant> > DatabaseCache::getListForQueryResult(const String& sql)
+	{
+		const Variant* params = sl_null;
+		sl_uint32 nParams = 0;
+		DEFINE_DATABASE_CACHE_QUERY(_DatabaseCache_Rows, 'l', _DatabaseCache_serializeList, _DatabaseCache_deserializeList, getListForQueryResult, sql)
+	}
+
+	Map<String, Variant> DatabaseCache::getRecordForQueryResult(const String& sql)
+	{
+		const Variant* params = sl_null;
+		sl_uint32 nParams = 0;
+		DEFINE_DATABASE_CACHE_QUERY(_DatabaseCache_Record, 'r', _DatabaseCache_serializeRecord, _DatabaseCache_deserializeRecord, getRecordForQueryResult, sql)
+	}
+
+	Variant DatabaseCache::getValueForQueryResult(const String& sql)
+	{
+		const Variant* params = sl_null;
+		sl_uint32 nParams = 0;
+		DEFINE_DATABASE_CACHE_QUERY(Variant, 'v', _DatabaseCache_serializeValue, _DatabaseCache_deserializeValue, getValueForQueryResult, sql)
+	}
+
+	List< Map<String, Variant> > DatabaseCache::getListForQueryResultBy(const String& sql, const Variant* params, sl_uint32 nParams)
+	{
+		DEFINE_DATABASE_CACHE_QUERY(_DatabaseCache_Rows, 'L', _DatabaseCache_serializeList, _DatabaseCache_deserializeList, getListForQueryResultBy, sql, params, nParams)
+	}
+
+	Map<String, Variant> DatabaseCache::getRecordForQueryResultBy(const String& sql, const Variant* params, sl_uint32 nParams)
+	{
+		DEFINE_DATABASE_CACHE_QUERY(_DatabaseCache_Record, 'R', _DatabaseCache_serializeRecord, _DatabaseCache_deserializeRecord, getRecordForQueryResultBy, sql, params, nParams)
+	}
+
+	Variant DatabaseCache::getValueForQueryResultBy(const String& sql, const Variant* params, sl_uint32 nParams)
+	{
+		DEFINE_DATABASE_CACHE_QUERY(Variant, 'V', _DatabaseCache_serializeValue, _DatabaseCache_deserializeValue, getValueForQueryResultBy, sql, params, nParams)
+	}
+
+	String DatabaseCache::getErrorMessage()
+	{
+		return m_db->getErrorMessage();
+	}
+
+	sl_bool DatabaseCache::beginTransaction()
+	{
+		return m_db->beginTransaction();
+	}
+
+	sl_bool DatabaseCache::commit()
+	{
+		return m_db->commit();
+	}
+
+	sl_bool DatabaseCache::rollback()
+	{
+		sl_bool ret = m_db->rollback();
+		// the results read in the transaction may include the reverted changes
+		invalidateAll();
+		return ret;
+	}
+
+	sl_bool DatabaseCache::_getQueryTables(const String& sql, List<String>& tables)
+	{
+		{
+			MutexLocker lock(&m_lockCache);
+			List<String>* p = m_mapQueryTables.getItemPointer(sql);
+			if (p) {
+				tables = *p;
+				return sl_true;
+			}
+		}
+		if (_DatabaseCache_parseStatement(sql, tables) != _DatabaseCache_StatementType::Read) {
+			return sl_false;
+		}
+		// no table to invalidate the result, such as SELECT last_insert_rowid()
+		return tables.getCount() > 0;
+	}
+
+	sl_bool DatabaseCache::_getCached(const String& key, Memory& data)
+	{
+		MutexLocker lock(&m_lockCache);
+		Link<_Entry>* link;
+		if (m_mapEntries.get_NoLock(key, &link)) {
+			if (_isValid(link->value)) {
+				data = link->value.data;
+				// moves to the front of the LRU list
+				if (link != m_listEntries.getFront()) {
+					Link<_Entry>* linkNew = m_listEntries.pushFront_NoLock(link->value);
+					if (linkNew) {
+						m_listEntries.removeItem_NoLock(link);
+						m_mapEntries.put_NoLock(key, linkNew);
+					}
+				}
+				m_nHits++;
+				return sl_true;
+			}
+			_removeEntry(link);
+		}
+		m_nMisses++;
+		return sl_false;
+	}
+
+	void DatabaseCache::_putCached(const String& key, const Memory& data, const List< Pair<String, sl_uint64> >& tables, sl_uint64 generationAll)
+	{
+		if (key.isNull() || data.getSize() > m_maxResultSize) {
+			return;
+		}
+		_Entry entry;
+		entry.key = key;
+		entry.data = data;
+		entry.timeCreated = System::getTickCount();
+		entry.generationAll = generationAll;
+		entry.tables = tables;
+		entry.size = ENTRY_OVERHEAD_SIZE + key.getLength() + data.getSize() + tables.getCount() * TABLE_OVERHEAD_SIZE;
+		if (entry.size > m_maxMemorySize) {
+			return;
+		}
+		MutexLocker lock(&m_lockCache);
+		// the tables may have changed while querying
+		if (!(_isValid(entry))) {
+			return;
+		}
+		Link<_Entry>* link;
+		if (m_mapEntries.get_NoLock(key, &link)) {
+			_removeEntry(link);
+		}
+		while (m_sizeMemory + entry.size > m_maxMemorySize) {
+			Link<_Entry>* back = m_listEntries.getBack();
+			if (!back) {
+				break;
+			}
+			_removeEntry(back);
+		}
+		link = m_listEntries.pushFront_NoLock(entry);
+		if (link) {
+			if (m_mapEntries.put_NoLock(key, link)) {
+				m_sizeMemory += entry.size;
+			} else {
+				m_listEntries.removeItem_NoLock(link);
+			}
+		}
+	}
+
+	List< Pair<String, sl_uint64> > DatabaseCache::_getGenerations(const List<String>& _tables, sl_uint64& generationAll)
+	{
+		List< Pair<String, sl_uint64> > ret;
+		ListLocker<String> tables(_tables);
+		MutexLocker lock(&m_lockCache);
+		generationAll = m_generationAll;
+		for (sl_size i = 0; i < tables.count; i++) {
+			ret.add_NoLock(Pair<String, sl_uint64>(tables[i], m_mapTableGenerations.getValue_NoLock(tables[i], 0)));
+		}
+		return ret;
+	}
+
+	sl_bool DatabaseCache::_isValid(_Entry& entry)
+	{
+		if (entry.generationAll != m_generationAll) {
+			return sl_false;
+		}
+		if (m_expiringMilliseconds && System::getTickCount() - entry.timeCreated >= m_expiringMilliseconds) {
+			return sl_false;
+		}
+		ListElements< Pair<String, sl_uint64> > tables(entry.tables);
+		for (sl_size i = 0; i < tables.count; i++) {
+			if (m_mapTableGenerations.getValue_NoLock(tables[i].key, 0) != tables[i].value) {
+				return sl_false;
+			}
+		}
+		return sl_true;
+	}
+
+	void DatabaseCache::_removeEntry(Link<_Entry>* link)
+	{
+		m_sizeMemory -= link->value.size;
+		m_mapEntries.remove_NoLock(link->value.key);
+		m_listEntries.removeItem_NoLock(link);
+	}
+
+	void DatabaseCache::_invalidateForStatement(const String& sql)
+	{
+		List<String> tables;
+		_DatabaseCache_StatementType type = _DatabaseCache_parseStatement(sql, tables);
+		if (type == _DatabaseCache_StatementType::Read || type == _DatabaseCache_StatementType::Transaction) {
+			return;
+		}
+		if (type == _DatabaseCache_StatementType::Write && tables.getCount() > 0) {
+			ListElements<String> list(tables);
+			for (sl_size i = 0; i < list.count; i++) {
+				invalidateTable(list[i]);
+			}
+		} else {
+			invalidateAll();
+		}
+	}
+
+	void DatabaseCache::_onTableChanged(const String& table)
+	{
+		if (table.isNull()) {
+			invalidateAll();
+		} else {
+			invalidateTable(table);
+		}
+	}
+
+}
@@ -28,6 +28,18 @@ namespace slib
 		return m_db;
 	}
 
+	sl_uint32 DatabaseCursor::getRowValues(Variant* values, sl_uint32 nValues)
+	{
+		sl_uint32 n = getColumnsCount();
+		if (n > nValues) {
+			n = nValues;
+		}
+		for (sl_uint32 i = 0; i < n; i++) {
+			values[i] = getValue(i);
+		}
+		return n;
+	}
+
 	Variant DatabaseCursor::getValue(sl_uint32 index)
 	{
 		return getString(index);
@@ -172,4 +184,64 @@ namespace slib
 		return sl_null;
 	}
 
+	const sl_char8* DatabaseCursor::getText(sl_uint32 index, sl_size* outLength)
+	{
+		m_strView = getString(index);
+		if (outLength) {
+			*outLength = m_strView.getLength();
+		}
+		if (m_strView.isNotNull()) {
+			return m_strView.getData();
+		}
+		return sl_null;
+	}
+
+	const void* DatabaseCursor::getBlobData(sl_uint32 index, sl_size* outSize)
+	{
+		m_memView = getBlob(index);
+		if (outSize) {
+			*outSize = m_memView.getSize();
+		}
+		return m_memView.getData();
+	}
+
+	Ref<DatabaseBatch> DatabaseCursor::fetchBatch(sl_uint32 nRows)
+	{
+		sl_uint32 nColumns = getColumnsCount();
+		if (!nColumns || !nRows) {
+			return sl_null;
+		}
+		if (!(moveNext())) {
+			return sl_null;
+		}
+		CList<String> names;
+		for (sl_uint32 i = 0; i < nColumns; i++) {
+			names.add_NoLock(getColumnName(i));
+		}
+		Ref<DatabaseBatch> batch = DatabaseBatch::create(names.getData(), nColumns, nRows);
+		if (batch.isNull()) {
+			return sl_null;
+		}
+		do {
+			for (sl_uint32 i = 0; i < nColumns; i++) {
+				Variant value = getValue(i);
+				if (value.isInteger() || value.isBoolean()) {
+					batch->setInt64(i, value.getInt64());
+				} else if (value.isNumber()) {
+					batch->setDouble(i, value.getDouble());
+				} else if (value.isMemory()) {
+					Memory mem = value.getMemory();
+					batch->setBlob(i, mem.getData(), mem.getSize());
+				} else if (value.isNotNull()) {
+					String str = value.getString();
+					batch->setText(i, str.getData(), str.getLength());
+				}
+			}
+			if (!(batch->addRow()) || batch->getRowsCount() >= nRows) {
+				break;
+			}
+		} while (moveNext());
+		return batch;
+	}
+
 }
@@ -0,0 +1,191 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "../../../inc/slib/db/database_pool.h"
+
+#include "../../../inc/slib/core/thread.h"
+
+#define MAX_READONLY_MAP_SIZE 4096
+
+namespace slib
+{
+
+	SLIB_DEFINE_OBJECT(DatabasePool, Database)
+
+	DatabasePool::DatabasePool()
+	{
+		m_flagTransaction = sl_false;
+	}
+
+	DatabasePool::~DatabasePool()
+	{
+	}
+
+	Ref<DatabasePool> DatabasePool::create(const Ref<Database>& writer, const List< Ref<Database> >& _readers)
+	{
+		if (writer.isNull()) {
+			return sl_null;
+		}
+		ListLocker< Ref<Database> > readers(_readers);
+		Array< Ref<Database> > arr = Array< Ref<Database> >::create(readers.count);
+		if (readers.count > 0 && arr.isNull()) {
+			return sl_null;
+		}
+		for (sl_size i = 0; i < readers.count; i++) {
+			if (readers[i].isNull()) {
+				return sl_null;
+			}
+			arr[i] = readers[i];
+		}
+		Ref<DatabasePool> ret = new DatabasePool;
+		if (ret.isNotNull()) {
+			ret->m_writer = writer;
+			ret->m_readers = arr;
+		}
+		return ret;
+	}
+
+	Ref<Database> DatabasePool::getWriter()
+	{
+		return m_writer;
+	}
+
+	Ref<Database> DatabasePool::getReader()
+	{
+		sl_size n = m_readers.getCount();
+		if (!n) {
+			return m_writer;
+		}
+		Ref<Database>* readers = m_readers.getData();
+		sl_size start = (sl_size)(Thread::getCurrentThreadUniqueId() % n);
+		// a connection referenced only by the pool is not used by any statement or cursor
+		sl_size indexBest = start;
+		sl_reg nRefBest = readers[start]->getReferenceCount();
+		for (sl_size i = 1; i < n && nRefBest > 1; i++) {
+			sl_size index = (start + i) % n;
+			sl_reg nRef = readers[index]->getReferenceCount();
+			if (nRef < nRefBest) {
+				indexBest = index;
+				nRefBest = nRef;
+			}
+		}
+		return readers[indexBest];
+	}
+
+	sl_uint32 DatabasePool::getReadersCount()
+	{
+		return (sl_uint32)(m_readers.getCount());
+	}
+
+	Ref<Database> DatabasePool::getConnection(const String& sql)
+	{
+		// the statements in the transaction should see its uncommitted changes
+		if (m_flagTransaction || !(m_readers.getCount())) {
+			return m_writer;
+		}
+		Ref<Database> reader = getReader();
+		if (_isReadOnly(reader, sql)) {
+			return reader;
+		}
+		return m_writer;
+	}
+
+	Ref<DatabaseStatement> DatabasePool::prepareStatement(const String& sql)
+	{
+		return getConnection(sql)->prepareStatement(sql);
+	}
+
+	sl_int64 DatabasePool::executeBy(const String& sql, const Variant* params, sl_uint32 nParams)
+	{
+		if (!nParams) {
+			// keeps the behavior of the connection, such as executing multiple statements
+			return m_writer->execute(sql);
+		}
+		return m_writer->executeBy(sql, params, nParams);
+	}
+
+	Ref<DatabaseCursor> DatabasePool::queryBy(const String& sql, const Variant* params, sl_uint32 nParams)
+	{
+		return getConnection(sql)->queryBy(sql, params, nParams);
+	}
+
+	List< Map<String, Variant> > DatabasePool::getListForQueryResultBy(const String& sql, const Variant* params, sl_uint32 nParams)
+	{
+		return getConnection(sql)->getListForQueryResultBy(sql, params, nParams);
+	}
+
+	Map<String, Variant> DatabasePool::getRecordForQueryResultBy(const String& sql, const Variant* params, sl_uint32 nParams)
+	{
+		return getConnection(sql)->getRecordForQueryResultBy(sql, params, nParams);
+	}
+
+	Variant DatabasePool::getValueForQueryResultBy(const String& sql, const Variant* params, sl_uint32 nParams)
+	{
+		return getConnection(sql)->getValueForQueryResultBy(sql, params, nParams);
+	}
+
+	String DatabasePool::getErrorMessage()
+	{
+		return m_writer->getErrorMessage();
+	}
+
+	sl_bool DatabasePool::beginTransaction()
+	{
+		if (m_writer->beginTransaction()) {
+			m_flagTransaction = sl_true;
+			return sl_true;
+		}
+		return sl_false;
+	}
+
+	sl_bool DatabasePool::commit()
+	{
+		if (m_writer->commit()) {
+			m_flagTransaction = sl_false;
+			return sl_true;
+		}
+		return sl_false;
+	}
+
+	sl_bool DatabasePool::rollback()
+	{
+		m_flagTransaction = sl_false;
+		return m_writer->rollback();
+	}
+
+	sl_bool DatabasePool::setTableChangeCallback(const Function<void(const String& table)>& callback)
+	{
+		return m_writer->setTableChangeCallback(callback);
+	}
+
+	sl_bool DatabasePool::_isReadOnly(const Ref<Database>& reader, const String& sql)
+	{
+		{
+			MutexLocker lock(&m_lockReadOnly);
+			sl_bool* p = m_mapReadOnly.getItemPointer(sql);
+			if (p) {
+				return *p;
+			}
+		}
+		// classified once by the reader, so that it does not wait for the long writes
+		Ref<DatabaseStatement> statement = reader->prepareStatement(sql);
+		if (statement.isNull()) {
+			return sl_false;
+		}
+		sl_bool flagReadOnly = statement->isReadOnly();
+		MutexLocker lock(&m_lockReadOnly);
+		if (m_mapReadOnly.getCount() >= MAX_READONLY_MAP_SIZE) {
+			m_mapReadOnly.removeAll_NoLock();
+		}
+		m_mapReadOnly.put_NoLock(sql, flagReadOnly);
+		return flagReadOnly;
+	}
+
+}
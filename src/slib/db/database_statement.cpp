@@ -63,4 +63,9 @@ namespace slib
 		return sl_null;
 	}
 
+	sl_bool DatabaseStatement::isReadOnly()
+	{
+		return sl_false;
+	}
+
 }
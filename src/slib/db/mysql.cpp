@@ -30,6 +30,7 @@ namespace slib
 		port = 0;
 		flagAutoReconnect = sl_true;
 		flagMultipleStatements = sl_true;
+		statementCacheCapacity = 64;
 	}
 
 	MySQL_Param::~MySQL_Param()
@@ -97,6 +98,26 @@ namespace slib
 		}
 	}
 
+	class _MySQL_Statement : public Referable
+	{
+	public:
+		MYSQL_STMT* m_statement;
+
+	public:
+		_MySQL_Statement(MYSQL_STMT* statement)
+		{
+			m_statement = statement;
+		}
+
+		~_MySQL_Statement()
+		{
+			if (m_statement) {
+				::mysql_stmt_close(m_statement);
+			}
+		}
+
+	};
+
 	class _MySQL_Database : public MySQL_Database
 	{
 	public:
@@ -110,6 +131,8 @@ namespace slib
 
 		~_MySQL_Database()
 		{
+			// the cached statements should be closed before the connection
+			clearStatementCache();
 			::mysql_close(m_mysql);
 		}
 
@@ -147,6 +170,7 @@ namespace slib
 					ret = new _MySQL_Database;
 					if (ret.isNotNull()) {
 						ret->m_mysql = mysql;
+						ret->setStatementCacheCapacity(param.statementCacheCapacity);
 						return ret;
 					}
 
@@ -300,6 +324,28 @@ namespace slib
 				return sl_null;
 			}
 
+			// override
+			const sl_char8* getText(sl_uint32 index, sl_size* outLength)
+			{
+				if (m_row && index < m_nColumnNames && m_row[index]) {
+					// the values of the row are null-terminated
+					if (outLength) {
+						*outLength = (sl_size)(m_lengths[index]);
+					}
+					return m_row[index];
+				}
+				if (outLength) {
+					*outLength = 0;
+				}
+				return sl_null;
+			}
+
+			// override
+			const void* getBlobData(sl_uint32 index, sl_size* outSize)
+			{
+				return getText(index, outSize);
+			}
+
 			// override
 			sl_bool moveNext()
 			{
@@ -899,6 +945,8 @@ namespace slib
 			String m_sql;
 			MYSQL* m_mysql;
 			MYSQL_STMT* m_statement;
+			// the native statement is given back to the cache
+			sl_bool m_flagCached;
 
 		public:
 			_DatabaseStatement(_MySQL_Database* db, const String& sql)
@@ -907,10 +955,18 @@ namespace slib
 				m_sql = sql;
 				m_mysql = db->m_mysql;
 				m_statement = sl_null;
+				m_flagCached = sl_false;
 			}
 
 			~_DatabaseStatement()
 			{
+				if (m_flagCached && m_statement) {
+					Ref<_MySQL_Statement> handle = new _MySQL_Statement(m_statement);
+					if (handle.isNotNull()) {
+						m_statement = sl_null;
+						((_MySQL_Database*)(m_db.get()))->putCachedStatement(m_sql, handle);
+					}
+				}
 				close();
 			}
 
@@ -1192,6 +1248,30 @@ namespace slib
 			return sl_null;
 		}
 
+		// override
+		Ref<DatabaseStatement> prepareCachedStatement(const String& sql)
+		{
+			if (!(getStatementCacheCapacity())) {
+				return prepareStatement(sql);
+			}
+			initThread();
+			Ref<_DatabaseStatement> ret = new _DatabaseStatement(this, sql);
+			if (ret.isNotNull()) {
+				Ref<_MySQL_Statement> handle = Ref<_MySQL_Statement>::from(takeCachedStatement(sql));
+				if (handle.isNotNull()) {
+					ret->m_statement = handle->m_statement;
+					handle->m_statement = sl_null;
+				} else {
+					if (!(ret->prepare())) {
+						return sl_null;
+					}
+				}
+				ret->m_flagCached = sl_true;
+				return ret;
+			}
+			return sl_null;
+		}
+
 		// override
 		String getErrorMessage()
 		{
@@ -13,10 +13,29 @@
 #include "../../../inc/slib/db/sqlite.h"
 
 #include "../../../inc/slib/core/file.h"
+#include "../../../inc/slib/core/cpu.h"
+
+// default threshold (in pages) of the automatic checkpoint
+#define WAL_AUTOCHECKPOINT 1000
 
 namespace slib
 {	
 
+	SQLite_Param::SQLite_Param()
+	{
+		flagReadOnly = sl_false;
+		flagWAL = sl_false;
+		mmapSize = 0;
+		cacheSize = 0;
+		busyTimeout = 0;
+		statementCacheCapacity = 64;
+	}
+
+	SQLite_Param::~SQLite_Param()
+	{
+	}
+
+
 	SLIB_DEFINE_OBJECT(SQLiteDatabase, Database)
 
 	SQLiteDatabase::SQLiteDatabase()
@@ -27,6 +46,24 @@ namespace slib
 	{
 	}
 
+	class _Sqlite3Statement : public Referable
+	{
+	public:
+		sqlite3_stmt* m_statement;
+
+	public:
+		_Sqlite3Statement(sqlite3_stmt* statement)
+		{
+			m_statement = statement;
+		}
+
+		~_Sqlite3Statement()
+		{
+			::sqlite3_finalize(m_statement);
+		}
+
+	};
+
 	class _Sqlite3Database : public SQLiteDatabase
 	{
 	public:
@@ -35,31 +72,64 @@ namespace slib
 		_Sqlite3Database()
 		{
 			m_db = sl_null;
+			m_nWalAutoCheckpoint = WAL_AUTOCHECKPOINT;
 		}
 
 		~_Sqlite3Database()
 		{
+			// the cached statements should be finalized before closing
+			clearStatementCache();
 			::sqlite3_close(m_db);
 		}
 
-		static Ref<_Sqlite3Database> connect(const String& filePath)
+		static Ref<_Sqlite3Database> connect(const SQLite_Param& param)
 		{
 			Ref<_Sqlite3Database> ret;
 			sqlite3* db = sl_null;
-			if (File::exists(filePath)) {
-				sl_int32 iResult = ::sqlite3_open(filePath.getData(), &db);
+			if (param.path == ":memory:" || File::exists(param.path)) {
+				int flags = param.flagReadOnly ? SQLITE_OPEN_READONLY : SQLITE_OPEN_READWRITE;
+				sl_int32 iResult = ::sqlite3_open_v2(param.path.getData(), &db, flags, sl_null);
 				if (SQLITE_OK == iResult) {
-					ret = new _Sqlite3Database();
-					if (ret.isNotNull()) {
-						ret->m_db = db;
-						return ret;
+					if (_initialize(db, param)) {
+						ret = new _Sqlite3Database();
+						if (ret.isNotNull()) {
+							ret->m_db = db;
+							ret->setStatementCacheCapacity(param.statementCacheCapacity);
+							return ret;
+						}
 					}
-					::sqlite3_close(db);
 				}
+				::sqlite3_close(db);
 			}
 			return ret;
 		}
 
+		static sl_bool _initialize(sqlite3* db, const SQLite_Param& param)
+		{
+			if (param.busyTimeout) {
+				::sqlite3_busy_timeout(db, (int)(param.busyTimeout));
+			}
+			if (param.flagWAL) {
+				// the journal mode is persistent, and only the writer can change it
+				if (!(param.flagReadOnly)) {
+					if (SQLITE_OK != ::sqlite3_exec(db, "PRAGMA journal_mode=WAL", 0, 0, 0)) {
+						return sl_false;
+					}
+				}
+				::sqlite3_exec(db, "PRAGMA synchronous=NORMAL", 0, 0, 0);
+			}
+			if (param.mmapSize) {
+				String sql = String::format("PRAGMA mmap_size=%d", param.mmapSize);
+				::sqlite3_exec(db, sql.getData(), 0, 0, 0);
+			}
+			if (param.cacheSize) {
+				// negative value is in kilobytes
+				String sql = String::format("PRAGMA cache_size=-%d", param.cacheSize);
+				::sqlite3_exec(db, sql.getData(), 0, 0, 0);
+			}
+			return sl_true;
+		}
+
 		// override
 		sl_int64 execute(const String& sql)
 		{
@@ -93,12 +163,14 @@ namespace slib
 			sl_uint32 m_nColumnNames;
 			String* m_columnNames;
 			HashMap<String, sl_int32> m_mapColumnIndexes;
+			sl_bool m_flagEnded;
 
 			_DatabaseCursor(Database* db, DatabaseStatement* statementObj, sqlite3_stmt* statement)
 			{
 				m_db = db;
 				m_statementObj = statementObj;
 				m_statement = statement;
+				m_flagEnded = sl_false;
 
 				sl_int32 cols = ::sqlite3_column_count(statement);
 				for (sl_int32 i = 0; i < cols; i++) {
@@ -154,6 +226,19 @@ namespace slib
 				return ret;
 			}
 
+			// override
+			sl_uint32 getRowValues(Variant* values, sl_uint32 nValues)
+			{
+				sl_uint32 n = m_nColumnNames;
+				if (n > nValues) {
+					n = nValues;
+				}
+				for (sl_uint32 index = 0; index < n; index++) {
+					values[index] = _getValue(index);
+				}
+				return n;
+			}
+
 			String _getString(sl_uint32 index)
 			{
 				int n = sqlite3_column_bytes(m_statement, index);
@@ -341,35 +426,134 @@ namespace slib
 				return sl_null;
 			}
 
+			// override
+			const sl_char8* getText(sl_uint32 index, sl_size* outLength)
+			{
+				if (index < m_nColumnNames) {
+					if (::sqlite3_column_type(m_statement, index) != SQLITE_NULL) {
+						// numbers are converted to the text in place
+						const sl_char8* text = (const sl_char8*)(::sqlite3_column_text(m_statement, index));
+						if (text) {
+							if (outLength) {
+								*outLength = (sl_size)(::sqlite3_column_bytes(m_statement, index));
+							}
+							return text;
+						}
+					}
+				}
+				if (outLength) {
+					*outLength = 0;
+				}
+				return sl_null;
+			}
+
+			// override
+			const void* getBlobData(sl_uint32 index, sl_size* outSize)
+			{
+				if (index < m_nColumnNames) {
+					int type = ::sqlite3_column_type(m_statement, index);
+					if (type == SQLITE_TEXT || type == SQLITE_BLOB) {
+						const void* data = ::sqlite3_column_blob(m_statement, index);
+						if (data) {
+							if (outSize) {
+								*outSize = (sl_size)(::sqlite3_column_bytes(m_statement, index));
+							}
+							return data;
+						}
+					}
+				}
+				if (outSize) {
+					*outSize = 0;
+				}
+				return sl_null;
+			}
+
 			// override
 			sl_bool moveNext()
 			{
+				// stepping after the end restarts the statement
+				if (m_flagEnded) {
+					return sl_false;
+				}
 				sl_int32 nRet = ::sqlite3_step(m_statement);
 				if (nRet == SQLITE_ROW) {
 					return sl_true;
 				}
+				m_flagEnded = sl_true;
 				return sl_false;
 			}
 
+			// override
+			Ref<DatabaseBatch> fetchBatch(sl_uint32 nRows)
+			{
+				if (!m_nColumnNames || !nRows) {
+					return sl_null;
+				}
+				if (!(moveNext())) {
+					return sl_null;
+				}
+				Ref<DatabaseBatch> batch = DatabaseBatch::create(m_columnNames, m_nColumnNames, nRows);
+				if (batch.isNull()) {
+					return sl_null;
+				}
+				do {
+					for (sl_uint32 index = 0; index < m_nColumnNames; index++) {
+						switch (::sqlite3_column_type(m_statement, index)) {
+						case SQLITE_INTEGER:
+							batch->setInt64(index, ::sqlite3_column_int64(m_statement, index));
+							break;
+						case SQLITE_FLOAT:
+							batch->setDouble(index, ::sqlite3_column_double(m_statement, index));
+							break;
+						case SQLITE_TEXT:
+							{
+								const void* text = ::sqlite3_column_text(m_statement, index);
+								batch->setText(index, text, (sl_size)(::sqlite3_column_bytes(m_statement, index)));
+							}
+							break;
+						case SQLITE_BLOB:
+							{
+								const void* data = ::sqlite3_column_blob(m_statement, index);
+								batch->setBlob(index, data, (sl_size)(::sqlite3_column_bytes(m_statement, index)));
+							}
+							break;
+						}
+					}
+					if (!(batch->addRow()) || batch->getRowsCount() >= nRows) {
+						break;
+					}
+				} while (moveNext());
+				return batch;
+			}
+
 		};
 
 		class _DatabaseStatement : public DatabaseStatement
 		{
 		public:
 			sqlite3* m_sqlite;
+			Ref<_Sqlite3Statement> m_handle;
 			sqlite3_stmt* m_statement;
 			Array<Variant> m_boundParams;
+			// not null when the native statement is given back to the cache
+			String m_sqlCached;
 
-			_DatabaseStatement(_Sqlite3Database* db, sqlite3_stmt* statement)
+			_DatabaseStatement(_Sqlite3Database* db, _Sqlite3Statement* handle, const String& sqlCached)
 			{
 				m_db = db;
 				m_sqlite = db->m_db;
-				m_statement = statement;
+				m_handle = handle;
+				m_statement = handle->m_statement;
+				m_sqlCached = sqlCached;
 			}
 
 			~_DatabaseStatement()
 			{
-				::sqlite3_finalize(m_statement);
+				if (m_sqlCached.isNotNull()) {
+					::sqlite3_reset(m_statement);
+					::sqlite3_clear_bindings(m_statement);
+					((_Sqlite3Database*)(m_db.get()))->putCachedStatement(m_sqlCached, m_handle);
+				}
 			}
 
 			sl_bool _execute(const Variant* _params, sl_uint32 nParams)
@@ -394,34 +578,34 @@ namespace slib
 							Variant& var = (params.getData())[i];
 							switch (var.getType()) {
 							case VariantType::Null:
-								iRet = ::sqlite3_bind_null(m_statement, i);
+								iRet = ::sqlite3_bind_null(m_statement, (int)i + 1);
 								break;
 							case VariantType::Boolean:
 							case VariantType::Int32:
-								iRet = ::sqlite3_bind_int(m_statement, i, var.getInt32());
+								iRet = ::sqlite3_bind_int(m_statement, (int)i + 1, var.getInt32());
 								break;
 							case VariantType::Uint32:
 							case VariantType::Int64:
 							case VariantType::Uint64:
-								iRet = ::sqlite3_bind_int64(m_statement, i, var.getInt64());
+								iRet = ::sqlite3_bind_int64(m_statement, (int)i + 1, var.getInt64());
 								break;
 							case VariantType::Float:
 							case VariantType::Double:
-								iRet = ::sqlite3_bind_double(m_statement, i, var.getDouble());
+								iRet = ::sqlite3_bind_double(m_statement, (int)i + 1, var.getDouble());
 								break;
 							default:
 								if (var.isMemory()) {
 									Memory mem = var.getMemory();
 									sl_size size = mem.getSize();
 									if (size > 0x7fffffff) {
-										iRet = ::sqlite3_bind_blob64(m_statement, i, mem.getData(), size, SQLITE_STATIC);
+										iRet = ::sqlite3_bind_blob64(m_statement, (int)i + 1, mem.getData(), size, SQLITE_STATIC);
 									} else {
-										iRet = ::sqlite3_bind_blob(m_statement, i, mem.getData(), (sl_uint32)size, SQLITE_STATIC);
+										iRet = ::sqlite3_bind_blob(m_statement, (int)i + 1, mem.getData(), (sl_uint32)size, SQLITE_STATIC);
 									}
 								} else {
 									String str = var.getString();
 									var = str;
-									iRet = ::sqlite3_bind_text(m_statement, i, str.getData(), (sl_uint32)(str.getLength()), SQLITE_STATIC);
+									iRet = ::sqlite3_bind_text(m_statement, (int)i + 1, str.getData(), (sl_uint32)(str.getLength()), SQLITE_STATIC);
 								}
 							}
 							if (iRet != SQLITE_OK) {
@@ -449,6 +633,12 @@ namespace slib
 				return -1;
 			}
 
+			// override
+			sl_bool isReadOnly()
+			{
+				return ::sqlite3_stmt_readonly(m_statement) != 0;
+			}
+
 			// override
 			Ref<DatabaseCursor> queryBy(const Variant* params, sl_uint32 nParams)
 			{
@@ -466,20 +656,44 @@ namespace slib
 			}
 		};
 
-		// override
-		Ref<DatabaseStatement> prepareStatement(const String& sql)
+		Ref<_Sqlite3Statement> _prepare(const String& sql)
 		{
 			ObjectLocker lock(this);
-			Ref<DatabaseStatement> ret;
 			sqlite3_stmt* statement = sl_null;
 			if (SQLITE_OK == ::sqlite3_prepare_v2(m_db, sql.getData(), -1, &statement, sl_null)) {
-				ret = new _DatabaseStatement(this, statement);
+				Ref<_Sqlite3Statement> ret = new _Sqlite3Statement(statement);
 				if (ret.isNotNull()) {
 					return ret;
 				}
 				::sqlite3_finalize(statement);
 			}
-			return ret;
+			return sl_null;
+		}
+
+		// override
+		Ref<DatabaseStatement> prepareStatement(const String& sql)
+		{
+			Ref<_Sqlite3Statement> handle = _prepare(sql);
+			if (handle.isNotNull()) {
+				return new _DatabaseStatement(this, handle.get(), sl_null);
+			}
+			return sl_null;
+		}
+
+		// override
+		Ref<DatabaseStatement> prepareCachedStatement(const String& sql)
+		{
+			if (!(getStatementCacheCapacity())) {
+				return prepareStatement(sql);
+			}
+			Ref<_Sqlite3Statement> handle = Ref<_Sqlite3Statement>::from(takeCachedStatement(sql));
+			if (handle.isNull()) {
+				handle = _prepare(sql);
+				if (handle.isNull()) {
+					return sl_null;
+				}
+			}
+			return new _DatabaseStatement(this, handle.get(), sql);
 		}
 
 		// override
@@ -487,11 +701,137 @@ namespace slib
 		{
 			return ::sqlite3_errmsg(m_db);
 		}
+
+		// override
+		sl_bool setTableChangeCallback(const Function<void(const String& table)>& callback)
+		{
+			ObjectLocker lock(this);
+			sl_bool flagHooked = m_callbackTableChange.isNotNull();
+			m_callbackTableChange = callback;
+			m_listChangedTables.removeAll_NoLock();
+			if (callback.isNotNull()) {
+				if (!flagHooked) {
+					// the WAL hook replaces the automatic checkpoint, which is done by _onWalCommit() at the same threshold
+					m_nWalAutoCheckpoint = _getWalAutoCheckpoint();
+				}
+				::sqlite3_update_hook(m_db, &_onUpdate, this);
+				::sqlite3_rollback_hook(m_db, &_onRollback, this);
+				::sqlite3_wal_hook(m_db, &_onWalCommit, this);
+			} else if (flagHooked) {
+				::sqlite3_update_hook(m_db, sl_null, sl_null);
+				::sqlite3_rollback_hook(m_db, sl_null, sl_null);
+				::sqlite3_wal_autocheckpoint(m_db, m_nWalAutoCheckpoint);
+			}
+			return sl_true;
+		}
+
+		sl_int32 _getWalAutoCheckpoint()
+		{
+			sl_int32 n = WAL_AUTOCHECKPOINT;
+			sqlite3_stmt* statement = sl_null;
+			if (SQLITE_OK == ::sqlite3_prepare_v2(m_db, "PRAGMA wal_autocheckpoint", -1, &statement, sl_null)) {
+				if (::sqlite3_step(statement) == SQLITE_ROW) {
+					n = ::sqlite3_column_int(statement, 0);
+				}
+				::sqlite3_finalize(statement);
+			}
+			return n;
+		}
+
+		static void _onUpdate(void* user, int op, const char* dbName, const char* table, sqlite3_int64 rowid)
+		{
+			_Sqlite3Database* p = (_Sqlite3Database*)user;
+			if (p->m_callbackTableChange.isNull()) {
+				return;
+			}
+			// avoids the allocation for the rows changed in the same table
+			if (p->m_lastChangedTable != table) {
+				p->m_lastChangedTable = String::fromUtf8(table);
+			}
+			if (p->m_listChangedTables.indexOf_NoLock(p->m_lastChangedTable) < 0) {
+				p->m_listChangedTables.add_NoLock(p->m_lastChangedTable);
+			}
+			p->m_callbackTableChange(p->m_lastChangedTable);
+		}
+
+		static void _onRollback(void* user)
+		{
+			_Sqlite3Database* p = (_Sqlite3Database*)user;
+			p->m_listChangedTables.removeAll_NoLock();
+			if (p->m_callbackTableChange.isNotNull()) {
+				p->m_callbackTableChange(String::null());
+			}
+		}
+
+		// called after the commit in WAL mode, where the readers on the other connections see the changes
+		static int _onWalCommit(void* user, sqlite3* db, const char* dbName, int nFrames)
+		{
+			_Sqlite3Database* p = (_Sqlite3Database*)user;
+			if (p->m_callbackTableChange.isNotNull()) {
+				ListElements<String> tables(p->m_listChangedTables);
+				for (sl_size i = 0; i < tables.count; i++) {
+					p->m_callbackTableChange(tables[i]);
+				}
+			}
+			p->m_listChangedTables.removeAll_NoLock();
+			// replaces the default hook doing the automatic checkpoint
+			if (p->m_nWalAutoCheckpoint > 0 && nFrames >= p->m_nWalAutoCheckpoint) {
+				::sqlite3_wal_checkpoint(db, dbName);
+			}
+			return SQLITE_OK;
+		}
+
+	private:
+		Function<void(const String& table)> m_callbackTableChange;
+		CList<String> m_listChangedTables;
+		String m_lastChangedTable;
+		sl_int32 m_nWalAutoCheckpoint;
+
 	};
 
+	Ref<SQLiteDatabase> SQLiteDatabase::connect(const SQLite_Param& param)
+	{
+		return _Sqlite3Database::connect(param);
+	}
+
 	Ref<SQLiteDatabase> SQLiteDatabase::connect(const String& path)
 	{
-		return _Sqlite3Database::connect(path);
+		SQLite_Param param;
+		param.path = path;
+		return _Sqlite3Database::connect(param);
+	}
+
+	Ref<DatabasePool> SQLiteDatabase::connectPool(const SQLite_Param& _param, sl_uint32 nReaders)
+	{
+		SQLite_Param param = _param;
+		param.flagWAL = sl_true;
+		if (!(param.mmapSize)) {
+			param.mmapSize = 256 * 1024 * 1024;
+		}
+		if (!(param.cacheSize)) {
+			param.cacheSize = 8192;
+		}
+		if (!(param.busyTimeout)) {
+			param.busyTimeout = 5000;
+		}
+		if (!nReaders) {
+			nReaders = Cpu::getCoresCount();
+		}
+		param.flagReadOnly = sl_false;
+		Ref<SQLiteDatabase> writer = connect(param);
+		if (writer.isNull()) {
+			return sl_null;
+		}
+		param.flagReadOnly = sl_true;
+		List< Ref<Database> > readers;
+		for (sl_uint32 i = 0; i < nReaders; i++) {
+			Ref<SQLiteDatabase> reader = connect(param);
+			if (reader.isNull()) {
+				return sl_null;
+			}
+			readers.add_NoLock(reader);
+		}
+		return DatabasePool::create(writer, readers);
 	}
 
 }
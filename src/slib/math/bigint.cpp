@@ -335,6 +335,423 @@ namespace slib
 		return 0;
 	}
 
+/*
+	Limb arithmetic for multiplication and modular exponentiation
+
+	The 32-bit elements are packed into 64-bit limbs when the compiler provides
+	128-bit integers, so that a single limb product covers four element products.
+	Operands of CBIGINT_KARATSUBA_THRESHOLD limbs or more are multiplied by Karatsuba.
+*/
+#if defined(SLIB_ARCH_IS_64BIT) && defined(__SIZEOF_INT128__)
+#	define CBIGINT_LIMB_BITS 64
+	typedef sl_uint64 _cbigint_limb;
+	typedef unsigned __int128 _cbigint_dlimb;
+#else
+#	define CBIGINT_LIMB_BITS 32
+	typedef sl_uint32 _cbigint_limb;
+	typedef sl_uint64 _cbigint_dlimb;
+#endif
+
+#define CBIGINT_LIMB_ELEMENTS (CBIGINT_LIMB_BITS / 32)
+#define CBIGINT_KARATSUBA_THRESHOLD (1024 / CBIGINT_LIMB_BITS)
+#define CBIGINT_KARATSUBA_SQR_THRESHOLD (1536 / CBIGINT_LIMB_BITS)
+
+	// scratch limbs used by the Karatsuba recursion on `n` limbs
+#define CBIGINT_KARATSUBA_SCRATCH(n) (6 * (n) + 64)
+
+	SLIB_INLINE static sl_size _cbigint_limbs_count(sl_size nElements)
+	{
+		return (nElements + CBIGINT_LIMB_ELEMENTS - 1) / CBIGINT_LIMB_ELEMENTS;
+	}
+
+	// fills `nl` limbs, padding with zero
+	static void _cbigint_limbs_from_elements(_cbigint_limb* l, sl_size nl, const sl_uint32* e, sl_size ne)
+	{
+		for (sl_size i = 0; i < nl; i++) {
+#if CBIGINT_LIMB_BITS == 64
+			sl_size k = i << 1;
+			sl_uint64 lo = k < ne ? e[k] : 0;
+			sl_uint64 hi = k + 1 < ne ? e[k + 1] : 0;
+			l[i] = lo | (hi << 32);
+#else
+			l[i] = i < ne ? e[i] : 0;
+#endif
+		}
+	}
+
+	static void _cbigint_limbs_to_elements(sl_uint32* e, const _cbigint_limb* l, sl_size nl)
+	{
+		for (sl_size i = 0; i < nl; i++) {
+#if CBIGINT_LIMB_BITS == 64
+			e[i << 1] = (sl_uint32)(l[i]);
+			e[(i << 1) + 1] = (sl_uint32)(l[i] >> 32);
+#else
+			e[i] = l[i];
+#endif
+		}
+	}
+
+	// fills `nl` limbs from the big-endian bytes, returns false when the value does not fit
+	static sl_bool _cbigint_limbs_from_bytesBE(_cbigint_limb* l, sl_size nl, const sl_uint8* b, sl_size nb)
+	{
+		sl_size nMax = nl * sizeof(_cbigint_limb);
+		while (nb > nMax) {
+			if (*b) {
+				return sl_false;
+			}
+			b++;
+			nb--;
+		}
+		Base::zeroMemory(l, nl * sizeof(_cbigint_limb));
+		for (sl_size i = 0; i < nb; i++) {
+			l[i / sizeof(_cbigint_limb)] |= ((_cbigint_limb)(b[nb - 1 - i])) << ((i % sizeof(_cbigint_limb)) << 3);
+		}
+		return sl_true;
+	}
+
+	// writes `nb` big-endian bytes padding with zero, returns false when the value does not fit
+	static sl_bool _cbigint_limbs_to_bytesBE(sl_uint8* b, sl_size nb, const _cbigint_limb* l, sl_size nl)
+	{
+		sl_size nMax = nl * sizeof(_cbigint_limb);
+		for (sl_size i = nb; i < nMax; i++) {
+			if ((l[i / sizeof(_cbigint_limb)] >> ((i % sizeof(_cbigint_limb)) << 3)) & 0xFF) {
+				return sl_false;
+			}
+		}
+		for (sl_size i = 0; i < nb; i++) {
+			if (i < nMax) {
+				b[nb - 1 - i] = (sl_uint8)(l[i / sizeof(_cbigint_limb)] >> ((i % sizeof(_cbigint_limb)) << 3));
+			} else {
+				b[nb - 1 - i] = 0;
+			}
+		}
+		return sl_true;
+	}
+
+	// c = a + b, returns carry
+	SLIB_INLINE static _cbigint_limb _cbigint_limbs_add(_cbigint_limb* c, const _cbigint_limb* a, const _cbigint_limb* b, sl_size n)
+	{
+		_cbigint_limb carry = 0;
+		for (sl_size i = 0; i < n; i++) {
+			_cbigint_limb s = a[i] + carry;
+			carry = s < carry;
+			_cbigint_limb t = s + b[i];
+			carry += t < s;
+			c[i] = t;
+		}
+		return carry;
+	}
+
+	// c = a - b, returns borrow
+	SLIB_INLINE static _cbigint_limb _cbigint_limbs_sub(_cbigint_limb* c, const _cbigint_limb* a, const _cbigint_limb* b, sl_size n)
+	{
+		_cbigint_limb borrow = 0;
+		for (sl_size i = 0; i < n; i++) {
+			_cbigint_limb x = a[i];
+			_cbigint_limb d = x - b[i];
+			_cbigint_limb b1 = x < b[i];
+			_cbigint_limb r = d - borrow;
+			borrow = b1 | (d < borrow);
+			c[i] = r;
+		}
+		return borrow;
+	}
+
+	// c += v, returns carry
+	SLIB_INLINE static _cbigint_limb _cbigint_limbs_inc(_cbigint_limb* c, sl_size n, _cbigint_limb v)
+	{
+		for (sl_size i = 0; i < n && v; i++) {
+			_cbigint_limb s = c[i] + v;
+			v = s < v;
+			c[i] = s;
+		}
+		return v;
+	}
+
+	// c -= v, returns borrow
+	SLIB_INLINE static _cbigint_limb _cbigint_limbs_dec(_cbigint_limb* c, sl_size n, _cbigint_limb v)
+	{
+		for (sl_size i = 0; i < n && v; i++) {
+			_cbigint_limb x = c[i];
+			c[i] = x - v;
+			v = x < v;
+		}
+		return v;
+	}
+
+	// c += a * b, returns carry
+	SLIB_INLINE static _cbigint_limb _cbigint_limbs_muladd(_cbigint_limb* c, const _cbigint_limb* a, sl_size n, _cbigint_limb b)
+	{
+		_cbigint_limb carry = 0;
+		for (sl_size i = 0; i < n; i++) {
+			_cbigint_dlimb t = (_cbigint_dlimb)(a[i]) * b + c[i] + carry;
+			c[i] = (_cbigint_limb)t;
+			carry = (_cbigint_limb)(t >> CBIGINT_LIMB_BITS);
+		}
+		return carry;
+	}
+
+	// c = |a - b| (`a` and `b` are zero-padded to `n` limbs), returns sl_true when a < b
+	static sl_bool _cbigint_limbs_absdiff(_cbigint_limb* c, const _cbigint_limb* a, sl_size na, const _cbigint_limb* b, sl_size nb, sl_size n)
+	{
+		sl_bool flagLess = sl_false;
+		for (sl_size i = n; i > 0; i--) {
+			_cbigint_limb x = i <= na ? a[i - 1] : 0;
+			_cbigint_limb y = i <= nb ? b[i - 1] : 0;
+			if (x != y) {
+				flagLess = x < y;
+				break;
+			}
+		}
+		if (flagLess) {
+			Swap(a, b);
+			Swap(na, nb);
+		}
+		_cbigint_limb borrow = 0;
+		for (sl_size i = 0; i < n; i++) {
+			_cbigint_limb x = i < na ? a[i] : 0;
+			_cbigint_limb y = i < nb ? b[i] : 0;
+			_cbigint_limb d = x - y;
+			_cbigint_limb b1 = x < y;
+			c[i] = d - borrow;
+			borrow = b1 | (d < borrow);
+		}
+		return flagLess;
+	}
+
+	// r = a * b (na + nb limbs), `r` must not overlap the operands
+	static void _cbigint_limbs_mul_basecase(_cbigint_limb* r, const _cbigint_limb* a, sl_size na, const _cbigint_limb* b, sl_size nb)
+	{
+		Base::zeroMemory(r, na * sizeof(_cbigint_limb));
+		for (sl_size j = 0; j < nb; j++) {
+			r[na + j] = _cbigint_limbs_muladd(r + j, a, na, b[j]);
+		}
+	}
+
+	// r = a * a (2n limbs): the cross products are computed once and doubled
+	static void _cbigint_limbs_sqr_basecase(_cbigint_limb* r, const _cbigint_limb* a, sl_size n)
+	{
+		sl_size i;
+		Base::zeroMemory(r, 2 * n * sizeof(_cbigint_limb));
+		for (i = 0; i + 1 < n; i++) {
+			r[n + i] = _cbigint_limbs_muladd(r + 2 * i + 1, a + i + 1, n - 1 - i, a[i]);
+		}
+		_cbigint_limb high = 0;
+		for (i = 0; i < 2 * n; i++) {
+			_cbigint_limb x = r[i];
+			r[i] = (x << 1) | high;
+			high = x >> (CBIGINT_LIMB_BITS - 1);
+		}
+		_cbigint_limb carry = 0;
+		for (i = 0; i < n; i++) {
+			_cbigint_dlimb t = (_cbigint_dlimb)(a[i]) * a[i];
+			_cbigint_dlimb s = (_cbigint_dlimb)(r[2 * i]) + (_cbigint_limb)t + carry;
+			r[2 * i] = (_cbigint_limb)s;
+			s = (_cbigint_dlimb)(r[2 * i + 1]) + (_cbigint_limb)(t >> CBIGINT_LIMB_BITS) + (_cbigint_limb)(s >> CBIGINT_LIMB_BITS);
+			r[2 * i + 1] = (_cbigint_limb)s;
+			carry = (_cbigint_limb)(s >> CBIGINT_LIMB_BITS);
+		}
+	}
+
+	static void _cbigint_limbs_mul_n(_cbigint_limb* r, const _cbigint_limb* a, const _cbigint_limb* b, sl_size n, _cbigint_limb* scratch);
+
+	static void _cbigint_limbs_sqr_n(_cbigint_limb* r, const _cbigint_limb* a, sl_size n, _cbigint_limb* scratch);
+
+	/*
+		Adds the middle term of Karatsuba into r (2n limbs) holding z0 = a0*b0 and z2 = a1*b1:
+			r += (z0 + z2 - z1) * 2^(h*LIMB_BITS)  (flagAdd: z0 + z2 + z1)
+	*/
+	static void _cbigint_limbs_karatsuba_middle(_cbigint_limb* r, sl_size n, sl_size h, const _cbigint_limb* z1, sl_bool flagAdd, _cbigint_limb* t)
+	{
+		sl_size l = n - h;
+		sl_size nt = 2 * h + 1;
+		Base::copyMemory(t, r, 2 * h * sizeof(_cbigint_limb));
+		t[2 * h] = 0;
+		_cbigint_limb c = _cbigint_limbs_add(t, t, r + 2 * h, 2 * l);
+		_cbigint_limbs_inc(t + 2 * l, nt - 2 * l, c);
+		if (flagAdd) {
+			c = _cbigint_limbs_add(t, t, z1, 2 * h);
+			_cbigint_limbs_inc(t + 2 * h, 1, c);
+		} else {
+			c = _cbigint_limbs_sub(t, t, z1, 2 * h);
+			_cbigint_limbs_dec(t + 2 * h, 1, c);
+		}
+		sl_size m = 2 * n - h;
+		if (nt > m) {
+			nt = m;
+		}
+		c = _cbigint_limbs_add(r + h, r + h, t, nt);
+		_cbigint_limbs_inc(r + h + nt, m - nt, c);
+	}
+
+	/*
+		a * b = z0 + (z0 + z2 + (a0 - a1)(b1 - b0)) * B^h + z2 * B^2h
+	*/
+	static void _cbigint_limbs_mul_karatsuba(_cbigint_limb* r, const _cbigint_limb* a, const _cbigint_limb* b, sl_size n, _cbigint_limb* scratch)
+	{
+		sl_size h = (n + 1) >> 1;
+		sl_size l = n - h;
+		_cbigint_limb* da = scratch;
+		_cbigint_limb* db = da + h;
+		_cbigint_limb* z1 = db + h;
+		_cbigint_limb* next = z1 + 2 * h;
+		sl_bool flagNegativeA = _cbigint_limbs_absdiff(da, a, h, a + h, l, h);
+		sl_bool flagNegativeB = _cbigint_limbs_absdiff(db, b + h, l, b, h, h);
+		_cbigint_limbs_mul_n(r, a, b, h, next);
+		_cbigint_limbs_mul_n(r + 2 * h, a + h, b + h, l, next);
+		_cbigint_limbs_mul_n(z1, da, db, h, next);
+		_cbigint_limbs_karatsuba_middle(r, n, h, z1, flagNegativeA == flagNegativeB, next);
+	}
+
+	/*
+		a * a = z0 + (z0 + z2 - (a0 - a1)^2) * B^h + z2 * B^2h
+	*/
+	static void _cbigint_limbs_sqr_karatsuba(_cbigint_limb* r, const _cbigint_limb* a, sl_size n, _cbigint_limb* scratch)
+	{
+		sl_size h = (n + 1) >> 1;
+		sl_size l = n - h;
+		_cbigint_limb* da = scratch;
+		_cbigint_limb* z1 = da + 2 * h;
+		_cbigint_limb* next = z1 + 2 * h;
+		_cbigint_limbs_absdiff(da, a, h, a + h, l, h);
+		_cbigint_limbs_sqr_n(r, a, h, next);
+		_cbigint_limbs_sqr_n(r + 2 * h, a + h, l, next);
+		_cbigint_limbs_sqr_n(z1, da, h, next);
+		_cbigint_limbs_karatsuba_middle(r, n, h, z1, sl_false, next);
+	}
+
+	// r = a * b (2n limbs), `scratch` must have CBIGINT_KARATSUBA_SCRATCH(n) limbs
+	static void _cbigint_limbs_mul_n(_cbigint_limb* r, const _cbigint_limb* a, const _cbigint_limb* b, sl_size n, _cbigint_limb* scratch)
+	{
+		if (n < CBIGINT_KARATSUBA_THRESHOLD) {
+			_cbigint_limbs_mul_basecase(r, a, n, b, n);
+		} else {
+			_cbigint_limbs_mul_karatsuba(r, a, b, n, scratch);
+		}
+	}
+
+	static void _cbigint_limbs_sqr_n(_cbigint_limb* r, const _cbigint_limb* a, sl_size n, _cbigint_limb* scratch)
+	{
+		if (n < CBIGINT_KARATSUBA_SQR_THRESHOLD) {
+			_cbigint_limbs_sqr_basecase(r, a, n);
+		} else {
+			_cbigint_limbs_sqr_karatsuba(r, a, n, scratch);
+		}
+	}
+
+	// r = a * b (na + nb limbs, na >= nb): the longer operand is split into pieces of nb limbs for Karatsuba
+	static sl_bool _cbigint_limbs_mul(_cbigint_limb* r, const _cbigint_limb* a, sl_size na, const _cbigint_limb* b, sl_size nb)
+	{
+		if (nb < CBIGINT_KARATSUBA_THRESHOLD) {
+			_cbigint_limbs_mul_basecase(r, a, na, b, nb);
+			return sl_true;
+		}
+		sl_size nBuf = 2 * nb + CBIGINT_KARATSUBA_SCRATCH(nb);
+		SLIB_SCOPED_BUFFER(_cbigint_limb, STACK_BUFFER_SIZE, buf, nBuf);
+		if (!buf) {
+			return sl_false;
+		}
+		_cbigint_limb* t = buf;
+		_cbigint_limb* scratch = buf + 2 * nb;
+		Base::zeroMemory(r, (na + nb) * sizeof(_cbigint_limb));
+		for (sl_size k = 0; k < na; k += nb) {
+			sl_size m = na - k;
+			if (m >= nb) {
+				_cbigint_limbs_mul_n(t, a + k, b, nb, scratch);
+				m = nb;
+			} else {
+				if (!(_cbigint_limbs_mul(t, b, nb, a + k, m))) {
+					return sl_false;
+				}
+			}
+			_cbigint_limb c = _cbigint_limbs_add(r + k, r + k, t, nb + m);
+			_cbigint_limbs_inc(r + k + nb + m, na - k - m, c);
+		}
+		return sl_true;
+	}
+
+	static sl_bool _cbigint_limbs_sqr(_cbigint_limb* r, const _cbigint_limb* a, sl_size n)
+	{
+		if (n < CBIGINT_KARATSUBA_SQR_THRESHOLD) {
+			_cbigint_limbs_sqr_basecase(r, a, n);
+			return sl_true;
+		}
+		SLIB_SCOPED_BUFFER(_cbigint_limb, STACK_BUFFER_SIZE, scratch, CBIGINT_KARATSUBA_SCRATCH(n));
+		if (!scratch) {
+			return sl_false;
+		}
+		_cbigint_limbs_sqr_karatsuba(r, a, n, scratch);
+		return sl_true;
+	}
+
+/*
+	Montgomery reduction on limbs: r = t * R^-1 mod m  (R = 2^(n*LIMB_BITS), t < m * R has 2n limbs and is destroyed)
+
+	The final subtraction is selected by masking, so that the timing does not depend on the value.
+*/
+	static void _cbigint_limbs_mont_reduce(_cbigint_limb* r, _cbigint_limb* t, const _cbigint_limb* m, sl_size n, _cbigint_limb mi)
+	{
+		_cbigint_limb carry = 0;
+		sl_size i;
+		for (i = 0; i < n; i++) {
+			_cbigint_limb u = t[i] * mi;
+			_cbigint_limb c = _cbigint_limbs_muladd(t + i, m, n, u);
+			_cbigint_dlimb s = (_cbigint_dlimb)(t[i + n]) + c + carry;
+			t[i + n] = (_cbigint_limb)s;
+			carry = (_cbigint_limb)(s >> CBIGINT_LIMB_BITS);
+		}
+		_cbigint_limb borrow = _cbigint_limbs_sub(r, t + n, m, n);
+		_cbigint_limb mask = (_cbigint_limb)0 - (carry | (borrow ^ 1));
+		for (i = 0; i < n; i++) {
+			r[i] = (r[i] & mask) | (t[i + n] & ~mask);
+		}
+	}
+
+	struct _cbigint_mont
+	{
+		const _cbigint_limb* m;
+		sl_size n;
+		_cbigint_limb mi;
+		_cbigint_limb* t; // 2n limbs
+		_cbigint_limb* scratch; // CBIGINT_KARATSUBA_SCRATCH(n) limbs
+
+		// r = a * b * R^-1 mod m, `r` may be `a` or `b`
+		void mul(_cbigint_limb* r, const _cbigint_limb* a, const _cbigint_limb* b)
+		{
+			_cbigint_limbs_mul_n(t, a, b, n, scratch);
+			_cbigint_limbs_mont_reduce(r, t, m, n, mi);
+		}
+
+		void sqr(_cbigint_limb* r, const _cbigint_limb* a)
+		{
+			_cbigint_limbs_sqr_n(t, a, n, scratch);
+			_cbigint_limbs_mont_reduce(r, t, m, n, mi);
+		}
+
+		// r = a * R^-1 mod m
+		void reduce(_cbigint_limb* r, const _cbigint_limb* a)
+		{
+			Base::copyMemory(t, a, n * sizeof(_cbigint_limb));
+			Base::zeroMemory(t + n, n * sizeof(_cbigint_limb));
+			_cbigint_limbs_mont_reduce(r, t, m, n, mi);
+		}
+
+	};
+
+	// reads every entry of the table, so that the memory access pattern does not depend on `index`
+	static void _cbigint_limbs_select(_cbigint_limb* r, const _cbigint_limb* table, sl_size nEntries, sl_size n, sl_uint32 index)
+	{
+		Base::zeroMemory(r, n * sizeof(_cbigint_limb));
+		for (sl_uint32 k = 0; k < nEntries; k++) {
+			sl_uint32 x = k ^ index;
+			_cbigint_limb mask = (_cbigint_limb)0 - (_cbigint_limb)(1 ^ ((x | (0 - x)) >> 31));
+			const _cbigint_limb* entry = table + k * n;
+			for (sl_size i = 0; i < n; i++) {
+				r[i] |= entry[i] & mask;
+			}
+		}
+	}
+
 
 	SLIB_DEFINE_ROOT_OBJECT(CBigInt)
 
@@ -1427,35 +1844,42 @@ namespace slib
 		} else {
 			nd = getMostSignificantElements();
 		}
-		sl_size n = na + nb;
-		SLIB_SCOPED_BUFFER(sl_uint64, STACK_BUFFER_SIZE, out, n);
-		if (!out) {
+		sl_bool flagSquare = a.elements == b.elements && na == nb;
+		const sl_uint32* ea = a.elements;
+		const sl_uint32* eb = b.elements;
+		if (na < nb) {
+			Swap(ea, eb);
+			Swap(na, nb);
+		}
+		sl_size la = _cbigint_limbs_count(na);
+		sl_size lb = _cbigint_limbs_count(nb);
+		sl_size lo = la + lb;
+		SLIB_SCOPED_BUFFER(_cbigint_limb, STACK_BUFFER_SIZE, buf, la + lb + lo);
+		if (!buf) {
 			return sl_false;
 		}
-		Base::zeroMemory(out, 8 * n);
-		for (sl_size ib = 0; ib < nb; ib++) {
-			for (sl_size ia = 0; ia < na; ia++) {
-				sl_uint64 c = a.elements[ia];
-				c *= b.elements[ib];
-				out[ia + ib] += (sl_uint32)c;
-				out[ia + ib + 1] += (sl_uint32)(c >> 32);
+		_cbigint_limb* A = buf;
+		_cbigint_limb* B = A + la;
+		_cbigint_limb* out = B + lb;
+		_cbigint_limbs_from_elements(A, la, ea, na);
+		if (flagSquare) {
+			if (!(_cbigint_limbs_sqr(out, A, la))) {
+				return sl_false;
 			}
-		}
-		sl_uint32 o = 0;
-		sl_size i;
-		sl_size m = 0;
-		for (i = 0; i < n; i++) {
-			sl_uint64 c = out[i] + o;
-			sl_uint32 t = (sl_uint32)c;
-			out[i] = t;
-			if (t) {
-				m = i;
+		} else {
+			_cbigint_limbs_from_elements(B, lb, eb, nb);
+			if (!(_cbigint_limbs_mul(out, A, la, B, lb))) {
+				return sl_false;
 			}
-			o = (sl_uint32)(c >> 32);
 		}
-		if (growLength(m + 1)) {
-			for (i = 0; i <= m; i++) {
-				elements[i] = (sl_uint32)(out[i]);
+		// the elements of the product are written over the limbs of the operands, which are no longer used
+		sl_uint32* e = (sl_uint32*)buf;
+		_cbigint_limbs_to_elements(e, out, lo);
+		sl_size m = _cbigint_mse(e, lo * CBIGINT_LIMB_ELEMENTS);
+		if (growLength(m)) {
+			sl_size i;
+			for (i = 0; i < m; i++) {
+				elements[i] = e[i];
 			}
 			for (; i < nd; i++) {
 				elements[i] = 0;
@@ -2003,56 +2427,132 @@ namespace slib
 	}
 
 /*
-	Montgomery multiplication: A = A * B * R^-1 mod M
+	Montgomery exponentiation with a fixed window
+
+	The window table is read in full for every window, and a multiplication is done even for
+	zero windows, so that neither the memory access pattern nor the operation sequence depends
+	on the bits of the exponent. Exponents of up to 64 bits (public exponents) use the plain
+	binary method instead.
 */
-	static sl_bool _cbigint_mont_mul(CBigInt& A, const CBigInt& B, const CBigInt& M, sl_uint32 MI)
+	SLIB_INLINE static sl_uint32 _cbigint_get_window(const sl_uint32* e, sl_size ne, sl_size pos, sl_uint32 w)
 	{
-		sl_size nM = M.length;
-		sl_size nB = Math::min(nM, B.length);
-		
-		sl_size nOut = nM * 2 + 1;
-		SLIB_SCOPED_BUFFER(sl_uint32, STACK_BUFFER_SIZE, out, nOut);
-		if (!out) {
-			return sl_false;
+		sl_size k = pos >> 5;
+		sl_uint32 b = (sl_uint32)(pos & 31);
+		sl_uint64 v = e[k];
+		if (k + 1 < ne) {
+			v |= ((sl_uint64)(e[k + 1])) << 32;
+		}
+		return (sl_uint32)(v >> b) & ((1 << w) - 1);
+	}
+
+	// -(M0^-1) mod 2^LIMB_BITS, by Newton's iteration doubling the correct low bits (3 bits at the start)
+	static _cbigint_limb _cbigint_limbs_mont_inverse(_cbigint_limb M0)
+	{
+		_cbigint_limb K = M0;
+		for (sl_uint32 i = 0; i < 5; i++) {
+			K *= 2 - M0 * K;
+		}
+		return 0 - K;
+	}
+
+	/*
+		out = A^E mod M (n limbs)
+			r2, r3: R^2 mod M, R^3 mod M (`r3` can be null when `na` <= n)
+			a: A in na limbs (na <= 2n)
+	*/
+	static sl_bool _cbigint_limbs_mont_pow(_cbigint_limb* out, const _cbigint_limb* m, sl_size n, _cbigint_limb mi, const _cbigint_limb* r2, const _cbigint_limb* r3, const _cbigint_limb* a, sl_size na, const sl_uint32* E, sl_size nE)
+	{
+		sl_size nbE = _cbigint_msbits(E, nE);
+		sl_uint32 w;
+		if (nbE > 768) {
+			w = 6;
+		} else if (nbE > 240) {
+			w = 5;
+		} else if (nbE > 64) {
+			w = 4;
+		} else {
+			w = 1;
 		}
-		Base::zeroMemory(out, nOut * 4);
-		for (sl_size i = 0; i < nM; i++) {
-			// T = (T + cB*B + cM*M) / 2^(32*nM)
-			sl_uint32 cB = i < A.length ? A.elements[i] : 0;
-			sl_uint32 cM = (out[0] + cB * B.elements[0]) * MI;
-			_cbigint_muladd_uint32(out, out, nOut, B.elements, nB, cB, 0);
-			_cbigint_muladd_uint32(out, out, nOut, M.elements, nM, cM, 0);
-			*out = cB;
-			nOut--;
-			out++;
-		}
-		if (!A.setValueFromElements(out, nM + 1)) {
+		sl_size nTable = (sl_size)1 << w;
+
+		sl_size nBuf = n * (nTable + 4) + CBIGINT_KARATSUBA_SCRATCH(n);
+		SLIB_SCOPED_BUFFER(_cbigint_limb, STACK_BUFFER_SIZE, buf, nBuf);
+		if (!buf) {
 			return sl_false;
 		}
-		if (A.compareAbs(M) >= 0) {
-			if (!A.subAbs(A, M)) {
-				return sl_false;
+		_cbigint_limb* entry = buf;
+		_cbigint_limb* table = entry + n;
+		_cbigint_mont mont;
+		mont.m = m;
+		mont.n = n;
+		mont.mi = mi;
+		mont.t = table + n * nTable;
+		mont.scratch = mont.t + 2 * n;
+
+		// table[0] = R mod M (1 in Montgomery form), table[1] = A * R mod M
+		_cbigint_limb* one = table;
+		_cbigint_limb* base = table + n;
+		mont.reduce(one, r2);
+		if (na > n) {
+			// A = AH * R + AL, A * R = AH * R^3 * R^-1 + AL * R^2 * R^-1
+			Base::copyMemory(entry, a + n, (na - n) * sizeof(_cbigint_limb));
+			Base::zeroMemory(entry + (na - n), (2 * n - na) * sizeof(_cbigint_limb));
+			mont.mul(out, entry, r3);
+			mont.mul(base, a, r2);
+			_cbigint_limb carry = _cbigint_limbs_add(base, base, out, n);
+			_cbigint_limb borrow = _cbigint_limbs_sub(entry, base, m, n);
+			_cbigint_limb mask = (_cbigint_limb)0 - (carry | (borrow ^ 1));
+			for (sl_size i = 0; i < n; i++) {
+				base[i] = (entry[i] & mask) | (base[i] & ~mask);
+			}
+		} else {
+			Base::copyMemory(entry, a, na * sizeof(_cbigint_limb));
+			Base::zeroMemory(entry + na, (n - na) * sizeof(_cbigint_limb));
+			mont.mul(base, entry, r2);
+		}
+
+		if (w == 1) {
+			Base::copyMemory(out, one, n * sizeof(_cbigint_limb));
+			for (sl_size ib = nbE; ib > 0; ib--) {
+				mont.sqr(out, out);
+				if ((E[(ib - 1) >> 5] >> ((ib - 1) & 31)) & 1) {
+					mont.mul(out, out, base);
+				}
+			}
+		} else {
+			sl_size i;
+			for (i = 2; i < nTable; i++) {
+				mont.mul(table + i * n, table + (i - 1) * n, base);
+			}
+			sl_size nWindows = (nbE + w - 1) / w;
+			sl_size k = nWindows - 1;
+			_cbigint_limbs_select(out, table, nTable, n, _cbigint_get_window(E, nE, k * w, w));
+			while (k > 0) {
+				k--;
+				for (i = 0; i < w; i++) {
+					mont.sqr(out, out);
+				}
+				_cbigint_limbs_select(entry, table, nTable, n, _cbigint_get_window(E, nE, k * w, w));
+				mont.mul(out, out, entry);
 			}
 		}
+		mont.reduce(out, out);
 		return sl_true;
 	}
 
-/*
-	Montgomery reduction: A = A * R^-1 mod M
-*/
-	SLIB_INLINE static sl_bool _cbigint_mont_reduction(CBigInt& A, const CBigInt& M, sl_uint32 MI)
+	// (-A)^E = M - A^E mod M for odd E
+	static void _cbigint_limbs_mont_negate(_cbigint_limb* r, const _cbigint_limb* m, sl_size n)
 	{
-		CBIGINT_UINT32(o, 1);
-		return _cbigint_mont_mul(A, o, M, MI);
+		for (sl_size i = 0; i < n; i++) {
+			if (r[i]) {
+				_cbigint_limbs_sub(r, m, r, n);
+				return;
+			}
+		}
 	}
 
-	sl_bool CBigInt::pow_montgomery(const CBigInt& A, const CBigInt& _E, const CBigInt& _M)
+	sl_bool CBigInt::pow_montgomery(const CBigInt& A, const CBigInt& E, const CBigInt& M)
 	{
-		CBigInt M;
-		M.copyFrom(_M);
-		if (!M.compact()) {
-			return sl_false;
-		}
 		sl_size nM = M.getMostSignificantElements();
 		if (nM == 0) {
 			return sl_false;
@@ -2060,17 +2560,10 @@ namespace slib
 		if (M.sign < 0) {
 			return sl_false;
 		}
-		const CBigInt* pE;
-		CBigInt __E;
-		if (&_E == this) {
-			pE = &__E;
-			if (!__E.copyFrom(_E)) {
-				return sl_false;
-			}
-		} else {
-			pE = &_E;
+		if (!(M.elements[0] & 1)) {
+			// Montgomery form requires an odd modulus
+			return pow(A, E, &M);
 		}
-		const CBigInt& E = *pE;
 		sl_size nE = E.getMostSignificantElements();
 		if (nE == 0) {
 			if (!setValue((sl_uint32)1)) {
@@ -2087,79 +2580,49 @@ namespace slib
 			setZero();
 			return sl_true;
 		}
+		sl_bool flagNegative = A.sign < 0 && (E.elements[0] & 1);
 
-		// MI = -(M0^-1) mod (2^32)
-		sl_uint32 MI;
-		// initialize montgomery
-		{
-			sl_uint32 M0 = M.elements[0];
-			sl_uint32 K = M0;
-			K += ((M0 + 2) & 4) << 1;
-			for (sl_uint32 i = 32; i >= 8; i /= 2) {
-				K *= (2 - (M0 * K));
-			}
-			MI = 0 - K;
-		}
+		sl_size n = _cbigint_limbs_count(nM);
 
-		// pre-compute R^2 mod M
-		// R = 2^(nM*32)
+		// R^2 mod M, R = 2^(n*LIMB_BITS)
 		CBigInt R2;
-		{
-			if (!R2.setValue((sl_uint32)1)) {
-				return sl_false;
-			}
-			if (!R2.shiftLeft(nM * 64)) {
-				return sl_false;
-			}
-			if (!CBigInt::divAbs(R2, M, sl_null, &R2)) {
-				return sl_false;
-			}
-		}
-
-		sl_bool flagNegative = A.sign < 0;
-		// T = A * R^2 * R^-1 mod M = A * R mod M
-		CBigInt T;
-		if (!CBigInt::divAbs(A, M, sl_null, &T)) {
+		if (!R2.setValue((sl_uint32)1)) {
 			return sl_false;
 		}
-		if (!_cbigint_mont_mul(T, R2, M, MI)) {
+		if (!R2.shiftLeft(n * CBIGINT_LIMB_BITS * 2)) {
 			return sl_false;
 		}
-
-		// C = R^2 * R^-1 mod M = R mod M
-		if (!copyFrom(R2)) {
+		if (!CBigInt::divAbs(R2, M, sl_null, &R2)) {
 			return sl_false;
 		}
-		if (!_cbigint_mont_reduction(*this, M, MI)) {
+		CBigInt T;
+		if (!CBigInt::divAbs(A, M, sl_null, &T)) {
 			return sl_false;
 		}
 
-		sl_size nbE = E.getMostSignificantBits();
-		for (sl_size ib = 0; ib < nbE; ib++) {
-			sl_size ke = ib >> 5;
-			sl_uint32 kb = (sl_uint32)(ib & 31);
-			if (((E.elements[ke]) >> kb) & 1) {
-				// C = C * T * R^-1 mod M
-				if (!_cbigint_mont_mul(*this, T, M, MI)) {
-					return sl_false;
-				}
-			}
-			// T = T * T * R^-1 mod M
-			if (!_cbigint_mont_mul(T, T, M, MI)) {
-				return sl_false;
-			}
+		SLIB_SCOPED_BUFFER(_cbigint_limb, 1024, buf, 4 * n);
+		if (!buf) {
+			return sl_false;
 		}
-		if (!_cbigint_mont_reduction(*this, M, MI)) {
+		_cbigint_limb* lm = buf;
+		_cbigint_limb* r2 = lm + n;
+		_cbigint_limb* a = r2 + n;
+		_cbigint_limb* out = a + n;
+		_cbigint_limbs_from_elements(lm, n, M.elements, nM);
+		_cbigint_limbs_from_elements(r2, n, R2.elements, Math::min(R2.length, n * CBIGINT_LIMB_ELEMENTS));
+		_cbigint_limbs_from_elements(a, n, T.elements, Math::min(T.length, n * CBIGINT_LIMB_ELEMENTS));
+		if (!(_cbigint_limbs_mont_pow(out, lm, n, _cbigint_limbs_mont_inverse(lm[0]), r2, sl_null, a, n, E.elements, nE))) {
 			return sl_false;
 		}
-		if (flagNegative && (E.elements[0] & 1) != 0) {
-			sign = -1;
-			if (!add(M)) {
-				return sl_false;
-			}
-		} else {
-			sign = 1;
+		if (flagNegative) {
+			_cbigint_limbs_mont_negate(out, lm, n);
+		}
+		sl_uint32* e = (sl_uint32*)a;
+		_cbigint_limbs_to_elements(e, out, n);
+		if (!setValueFromElements(e, nM)) {
+			return sl_false;
 		}
+		sign = 1;
 		return sl_true;
 	}
 
@@ -4778,4 +5241,207 @@ namespace slib
 		return BigInt::shiftRight(a, n);
 	}
 
+
+	BigIntMontgomery::BigIntMontgomery()
+	{
+		m_nLimbs = 0;
+		m_MI = 0;
+	}
+
+	BigIntMontgomery::~BigIntMontgomery()
+	{
+	}
+
+	sl_bool BigIntMontgomery::setModulus(const BigInt& _M)
+	{
+		m_M.setNull();
+		m_limbs.setNull();
+		m_nLimbs = 0;
+		m_MI = 0;
+		CBigInt* pM = _M.ref._ptr;
+		if (!pM) {
+			return sl_false;
+		}
+		CBigInt& M = *pM;
+		sl_size nM = M.getMostSignificantElements();
+		if (nM == 0) {
+			return sl_false;
+		}
+		if (M.sign < 0) {
+			return sl_false;
+		}
+		if (!(M.elements[0] & 1)) {
+			return sl_false;
+		}
+		sl_size n = _cbigint_limbs_count(nM);
+		CBigInt R2;
+		if (!R2.setValue((sl_uint32)1)) {
+			return sl_false;
+		}
+		if (!R2.shiftLeft(n * CBIGINT_LIMB_BITS * 2)) {
+			return sl_false;
+		}
+		if (!CBigInt::divAbs(R2, M, sl_null, &R2)) {
+			return sl_false;
+		}
+		Memory mem = Memory::create(3 * n * sizeof(_cbigint_limb));
+		if (mem.isNull()) {
+			return sl_false;
+		}
+		_cbigint_limb* lm = (_cbigint_limb*)(mem.getData());
+		_cbigint_limb* r2 = lm + n;
+		_cbigint_limb* r3 = r2 + n;
+		_cbigint_limbs_from_elements(lm, n, M.elements, nM);
+		_cbigint_limbs_from_elements(r2, n, R2.elements, Math::min(R2.length, n * CBIGINT_LIMB_ELEMENTS));
+
+		SLIB_SCOPED_BUFFER(_cbigint_limb, STACK_BUFFER_SIZE, buf, 2 * n + CBIGINT_KARATSUBA_SCRATCH(n));
+		if (!buf) {
+			return sl_false;
+		}
+		_cbigint_mont mont;
+		mont.m = lm;
+		mont.n = n;
+		mont.mi = _cbigint_limbs_mont_inverse(lm[0]);
+		mont.t = buf;
+		mont.scratch = buf + 2 * n;
+		// R^3 mod M = R^2 * R^2 * R^-1 mod M
+		mont.mul(r3, r2, r2);
+
+		m_M = _M;
+		m_limbs = mem;
+		m_nLimbs = n;
+		m_MI = mont.mi;
+		return sl_true;
+	}
+
+	const BigInt& BigIntMontgomery::getModulus() const
+	{
+		return m_M;
+	}
+
+	sl_bool BigIntMontgomery::isNull() const
+	{
+		return m_nLimbs == 0;
+	}
+
+	sl_bool BigIntMontgomery::isNotNull() const
+	{
+		return m_nLimbs != 0;
+	}
+
+	sl_bool BigIntMontgomery::pow(CBigInt& C, const CBigInt& _A, const CBigInt& E) const
+	{
+		sl_size n = m_nLimbs;
+		if (!n) {
+			return sl_false;
+		}
+		if (E.sign < 0) {
+			return sl_false;
+		}
+		const _cbigint_limb* lm = (const _cbigint_limb*)(m_limbs.getData());
+		CBigInt& M = *(m_M.ref._ptr);
+		sl_size nM = M.getMostSignificantElements();
+		sl_size nE = E.getMostSignificantElements();
+		if (nE == 0) {
+			if (!C.setValue((sl_uint32)1)) {
+				return sl_false;
+			}
+			C.sign = 1;
+			return sl_true;
+		}
+		sl_size nA = _A.getMostSignificantElements();
+		if (nA == 0) {
+			C.setZero();
+			return sl_true;
+		}
+		sl_bool flagNegative = _A.sign < 0 && (E.elements[0] & 1);
+		const CBigInt* pA = &_A;
+		CBigInt T;
+		if (_cbigint_limbs_count(nA) > 2 * n) {
+			if (!CBigInt::divAbs(_A, M, sl_null, &T)) {
+				return sl_false;
+			}
+			pA = &T;
+			nA = T.getMostSignificantElements();
+		}
+		sl_size na = _cbigint_limbs_count(nA);
+
+		SLIB_SCOPED_BUFFER(_cbigint_limb, 1024, buf, 3 * n);
+		if (!buf) {
+			return sl_false;
+		}
+		_cbigint_limb* a = buf;
+		_cbigint_limb* out = a + 2 * n;
+		_cbigint_limbs_from_elements(a, na, pA->elements, nA);
+		if (!(_cbigint_limbs_mont_pow(out, lm, n, (_cbigint_limb)m_MI, lm + n, lm + 2 * n, a, na, E.elements, nE))) {
+			return sl_false;
+		}
+		if (flagNegative) {
+			_cbigint_limbs_mont_negate(out, lm, n);
+		}
+		sl_uint32* e = (sl_uint32*)a;
+		_cbigint_limbs_to_elements(e, out, n);
+		if (!C.setValueFromElements(e, nM)) {
+			return sl_false;
+		}
+		C.sign = 1;
+		return sl_true;
+	}
+
+	BigInt BigIntMontgomery::pow(const BigInt& A, const BigInt& E) const
+	{
+		CBigInt* a = A.ref._ptr;
+		CBigInt* e = E.ref._ptr;
+		if (!e || e->isZero()) {
+			return BigInt::fromInt32(1);
+		}
+		if (!a) {
+			return sl_null;
+		}
+		CBigInt* r = new CBigInt;
+		if (r) {
+			if (pow(*r, *a, *e)) {
+				return r;
+			}
+			delete r;
+		}
+		return sl_null;
+	}
+
+	sl_bool BigIntMontgomery::powBytesBE(const void* A, sl_size sizeA, const BigInt& _E, void* output, sl_size sizeOutput) const
+	{
+		sl_size n = m_nLimbs;
+		if (!n) {
+			return sl_false;
+		}
+		CBigInt* pE = _E.ref._ptr;
+		if (!pE) {
+			return sl_false;
+		}
+		CBigInt& E = *pE;
+		if (E.sign < 0) {
+			return sl_false;
+		}
+		sl_size nE = E.getMostSignificantElements();
+		if (nE == 0) {
+			_cbigint_limb one = 1;
+			return _cbigint_limbs_to_bytesBE((sl_uint8*)output, sizeOutput, &one, 1);
+		}
+		const _cbigint_limb* lm = (const _cbigint_limb*)(m_limbs.getData());
+		SLIB_SCOPED_BUFFER(_cbigint_limb, 1024, buf, 3 * n);
+		if (!buf) {
+			return sl_false;
+		}
+		_cbigint_limb* a = buf;
+		_cbigint_limb* out = a + 2 * n;
+		sl_size na = Math::min((sizeA + sizeof(_cbigint_limb) - 1) / sizeof(_cbigint_limb), 2 * n);
+		if (!(_cbigint_limbs_from_bytesBE(a, na, (const sl_uint8*)A, sizeA))) {
+			return sl_false;
+		}
+		if (!(_cbigint_limbs_mont_pow(out, lm, n, (_cbigint_limb)m_MI, lm + n, lm + 2 * n, a, na, E.elements, nE))) {
+			return sl_false;
+		}
+		return _cbigint_limbs_to_bytesBE((sl_uint8*)output, sizeOutput, out, n);
+	}
+
 }
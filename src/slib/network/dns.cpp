@@ -11,9 +11,11 @@
 #include "../../../inc/slib/network/dns.h"
 
 #include "../../../inc/slib/network/event.h"
+#include "../../../inc/slib/crypto/sha2.h"
 #include "../../../inc/slib/core/scoped.h"
 #include "../../../inc/slib/core/mio.h"
 #include "../../../inc/slib/core/log.h"
+#include "../../../inc/slib/core/math.h"
 
 #define _MAX_NAME SLIB_NETWORK_DNS_NAME_MAX_LENGTH
 
@@ -817,6 +819,7 @@ namespace slib
 		portDns = SLIB_NETWORK_DNS_PORT;
 
 		portEncryption = 0;
+		flagUseChaCha20Poly1305 = sl_false;
 
 		flagProxy = sl_false;
 
@@ -835,6 +838,7 @@ namespace slib
 		portDns = (sl_uint16)conf.getItem("dns_port").getUint32(SLIB_NETWORK_DNS_PORT);
 		portEncryption = (sl_uint16)conf.getItem("secure_port").getUint32(0);
 		encryptionKey = conf.getItem("secure_key").getString();
+		flagUseChaCha20Poly1305 = conf.getItem("secure_aead").getString() == "chacha20-poly1305";
 
 		flagProxy = conf.getItem("is_proxy").getBoolean(sl_false);
 
@@ -854,6 +858,7 @@ namespace slib
 		m_lastForwardId = 0;
 
 		m_flagEncryptDefaultForward = sl_false;
+		m_flagUseChaCha20Poly1305 = sl_false;
 		m_flagProxy = sl_false;
 	}
 
@@ -895,7 +900,12 @@ namespace slib
 				ret->m_udpDns = socketDns;
 				ret->m_udpEncrypt = socketEncrypt;
 
-				ret->m_encrypt.setKey_SHA256(param.encryptionKey);
+				if (param.flagUseChaCha20Poly1305) {
+					SHA256::hash(param.encryptionKey, ret->m_keyAEAD);
+					ret->m_flagUseChaCha20Poly1305 = sl_true;
+				} else {
+					ret->m_encrypt.setKey_SHA256(param.encryptionKey);
+				}
 
 				ret->m_flagProxy = param.flagProxy;
 
@@ -1094,7 +1104,7 @@ namespace slib
 		header->setId(idForward);
 		Memory packet = Memory::create(data, size);
 		if (m_flagEncryptDefaultForward) {
-			packet = m_encrypt.encrypt_CBC_PKCS7Padding(packet);
+			packet = _encryptPacket(packet.getData(), packet.getSize());
 		}
 		if (packet.isEmpty()) {
 			return;
@@ -1118,7 +1128,7 @@ namespace slib
 			header->setId(fe.requestedId);
 			Memory packet = Memory::create(data, size);
 			if (fe.flagEncrypted) {
-				packet = m_encrypt.encrypt_CBC_PKCS7Padding(packet);
+				packet = _encryptPacket(packet.getData(), packet.getSize());
 			}
 			if (packet.isEmpty()) {
 				return;
@@ -1147,7 +1157,7 @@ namespace slib
 	{
 		Memory mem = DnsPacket::buildQuestionPacket(id, host);
 		if (flagEncrypt) {
-			return m_encrypt.encrypt_CBC_PKCS7Padding(mem);
+			return _encryptPacket(mem.getData(), mem.getSize());
 		}
 		return mem;
 	}
@@ -1156,18 +1166,62 @@ namespace slib
 	{
 		Memory mem = DnsPacket::buildHostAddressAnswerPacket(id, hostName, hostAddress);
 		if (flagEncrypt) {
-			return m_encrypt.encrypt_CBC_PKCS7Padding(mem);
+			return _encryptPacket(mem.getData(), mem.getSize());
 		}
 		return mem;
 	}
 
+#define DNS_AEAD_NONCE_SIZE 12
+#define DNS_AEAD_TAG_SIZE 16
+
+	Memory DnsServer::_encryptPacket(const void* data, sl_size size)
+	{
+		if (m_flagUseChaCha20Poly1305) {
+			Memory mem = Memory::create(DNS_AEAD_NONCE_SIZE + size + DNS_AEAD_TAG_SIZE);
+			if (mem.isNull()) {
+				return sl_null;
+			}
+			sl_uint8* p = (sl_uint8*)(mem.getData());
+			Math::randomMemory(p, DNS_AEAD_NONCE_SIZE);
+			ChaCha20_Poly1305 aead;
+			aead.setKey(m_keyAEAD);
+			aead.encrypt(p, DNS_AEAD_NONCE_SIZE, sl_null, 0, data, p + DNS_AEAD_NONCE_SIZE, size, p + DNS_AEAD_NONCE_SIZE + size, DNS_AEAD_TAG_SIZE);
+			return mem;
+		} else {
+			return m_encrypt.encrypt_CBC_PKCS7Padding(data, size);
+		}
+	}
+
+	Memory DnsServer::_decryptPacket(const void* data, sl_size size)
+	{
+		if (m_flagUseChaCha20Poly1305) {
+			if (size <= DNS_AEAD_NONCE_SIZE + DNS_AEAD_TAG_SIZE) {
+				return sl_null;
+			}
+			const sl_uint8* p = (const sl_uint8*)data;
+			sl_size n = size - DNS_AEAD_NONCE_SIZE - DNS_AEAD_TAG_SIZE;
+			Memory mem = Memory::create(n);
+			if (mem.isNull()) {
+				return sl_null;
+			}
+			ChaCha20_Poly1305 aead;
+			aead.setKey(m_keyAEAD);
+			if (aead.decrypt(p, DNS_AEAD_NONCE_SIZE, sl_null, 0, p + DNS_AEAD_NONCE_SIZE, mem.getData(), n, p + DNS_AEAD_NONCE_SIZE + n, DNS_AEAD_TAG_SIZE)) {
+				return mem;
+			}
+			return sl_null;
+		} else {
+			return m_encrypt.decrypt_CBC_PKCS7Padding(data, size);
+		}
+	}
+
 	void DnsServer::onReceiveFrom(AsyncUdpSocket* socket, const SocketAddress& addressFrom, void* data, sl_uint32 size)
 	{
 		sl_bool flagEncrypted = sl_false;
 		Memory memDecrypt;
 		if (socket == m_udpEncrypt) {
 			flagEncrypted = sl_true;
-			memDecrypt = m_encrypt.decrypt_CBC_PKCS7Padding(data, size);
+			memDecrypt = _decryptPacket(data, size);
 			if (memDecrypt.isEmpty()) {
 				return;
 			}
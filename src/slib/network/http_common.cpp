@@ -1444,7 +1444,18 @@ namespace slib
 
 	sl_bool HttpContentReader::setDecompressing()
 	{
-		if (m_zlib.start()) {
+		Ref<ZlibDecompress> zlib = new ZlibDecompress;
+		if (zlib.isNotNull() && zlib->start()) {
+			return setDecompressing(zlib);
+		}
+		m_flagDecompressing = sl_false;
+		return sl_false;
+	}
+
+	sl_bool HttpContentReader::setDecompressing(const Ref<Decompressor>& decompressor)
+	{
+		if (decompressor.isNotNull() && decompressor->isStarted()) {
+			m_decompressor = decompressor;
 			m_flagDecompressing = sl_true;
 			return sl_true;
 		} else {
@@ -1456,7 +1467,7 @@ namespace slib
 	Memory HttpContentReader::decompressData(void* data, sl_uint32 size, Referable* refData)
 	{
 		if (m_flagDecompressing) {
-			return m_zlib.decompress(data, size);
+			return m_decompressor->decompress(data, size);
 		} else {
 			return Memory::createStatic(data, size, refData);
 		}
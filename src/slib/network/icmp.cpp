@@ -59,11 +59,24 @@ namespace slib
 		return checksum == 0;
 	}
 
-	sl_bool IcmpHeaderFormat::check(sl_uint32 sizeContent) const
+	void IcmpHeaderFormat::adjustChecksum(sl_uint16 valueOld, sl_uint16 valueNew)
+	{
+		setChecksum(TCP_IP::adjustChecksum(getChecksum(), valueOld, valueNew));
+	}
+
+	sl_bool IcmpHeaderFormat::checkHeader(sl_uint32 sizeContent) const
 	{
 		if (sizeContent < sizeof(IcmpHeaderFormat)) {
 			return sl_false;
 		}
+		return sl_true;
+	}
+
+	sl_bool IcmpHeaderFormat::check(sl_uint32 sizeContent) const
+	{
+		if (!(checkHeader(sizeContent))) {
+			return sl_false;
+		}
 		if (!(checkChecksum(sizeContent))) {
 			return sl_false;
 		}
@@ -11,6 +11,10 @@
 #include "../../../inc/slib/network/nat.h"
 
 #include "../../../inc/slib/core/new_helper.h"
+#include "../../../inc/slib/core/system.h"
+#include "../../../inc/slib/core/hash.h"
+
+#include <atomic>
 
 namespace slib
 {
@@ -26,6 +30,9 @@ namespace slib
 		udpPortEnd = 60000;
 
 		icmpEchoIdentifier = 30000;
+
+		tcpTimeout = 7440000;
+		udpTimeout = 300000;
 	}
 
 	NatTableParam::~NatTableParam()
@@ -50,8 +57,8 @@ namespace slib
 	{
 		ObjectLocker lock(this);
 		m_param = param;
-		m_mappingTcp.setup(param.tcpPortBegin, param.tcpPortEnd);
-		m_mappingUdp.setup(param.udpPortBegin, param.udpPortEnd);
+		m_mappingTcp.setup(param.tcpPortBegin, param.tcpPortEnd, param.tcpTimeout);
+		m_mappingUdp.setup(param.udpPortBegin, param.udpPortEnd, param.udpTimeout);
 	}
 
 	sl_bool NatTable::translateOutgoingPacket(IPv4Packet* ipHeader, void* ipContent, sl_uint32 sizeContent)
@@ -60,33 +67,47 @@ namespace slib
 		if (addressTarget.isZero()) {
 			return sl_false;
 		}
+		// only the first fragment has the transport header, so the fragments can not be translated consistently. reassemble them before translating
+		if (ipHeader->isMF() || ipHeader->getFragmentOffset()) {
+			return sl_false;
+		}
+		/*
+			The checksums are adjusted for the rewritten fields (RFC 1624) instead of being verified and recalculated over the payload,
+			so the cost does not depend on the payload size, and the corrupted packets still fail the checksum at the receiver.
+		*/
 		if (ipHeader->isTCP()) {
 			TcpSegment* tcp = (TcpSegment*)(ipContent);
-			if (tcp->check(ipHeader, sizeContent)) {
+			if (tcp->checkHeader(sizeContent)) {
+				IPv4Address addressSource = ipHeader->getSourceAddress();
+				sl_uint16 sourcePort = tcp->getSourcePort();
 				sl_uint16 targetPort;
-				if (m_mappingTcp.mapToExternalPort(SocketAddress(ipHeader->getSourceAddress(), tcp->getSourcePort()), targetPort)) {
+				if (m_mappingTcp.mapToExternalPort(SocketAddress(addressSource, sourcePort), targetPort)) {
 					tcp->setSourcePort(targetPort);
 					ipHeader->setSourceAddress(addressTarget);
-					tcp->updateChecksum(ipHeader, sizeContent);
-					ipHeader->updateChecksum();
+					tcp->adjustChecksum(sourcePort, targetPort);
+					tcp->adjustChecksum(addressSource, addressTarget);
+					ipHeader->adjustChecksum(addressSource, addressTarget);
 					return sl_true;
 				}
 			}
 		} else if (ipHeader->isUDP()) {
 			UdpDatagram* udp = (UdpDatagram*)(ipContent);
-			if (udp->check(ipHeader, sizeContent)) {
+			if (udp->checkHeader(sizeContent)) {
+				IPv4Address addressSource = ipHeader->getSourceAddress();
+				sl_uint16 sourcePort = udp->getSourcePort();
 				sl_uint16 targetPort;
-				if (m_mappingUdp.mapToExternalPort(SocketAddress(ipHeader->getSourceAddress(), udp->getSourcePort()), targetPort)) {
+				if (m_mappingUdp.mapToExternalPort(SocketAddress(addressSource, sourcePort), targetPort)) {
 					udp->setSourcePort(targetPort);
 					ipHeader->setSourceAddress(addressTarget);
-					udp->updateChecksum(ipHeader);
-					ipHeader->updateChecksum();
+					udp->adjustChecksum(sourcePort, targetPort);
+					udp->adjustChecksum(addressSource, addressTarget);
+					ipHeader->adjustChecksum(addressSource, addressTarget);
 					return sl_true;
 				}
 			}
 		} else if (ipHeader->isICMP()) {
 			IcmpHeaderFormat* icmp = (IcmpHeaderFormat*)(ipContent);
-			if (icmp->check(sizeContent)) {
+			if (icmp->checkHeader(sizeContent)) {
 				if (icmp->getType() == IcmpType::Echo) {
 					IcmpEchoAddress address;
 					address.ip = ipHeader->getSourceAddress();
@@ -96,8 +117,9 @@ namespace slib
 					icmp->setEchoIdentifier(m_param.icmpEchoIdentifier);
 					icmp->setEchoSequenceNumber(sn);
 					ipHeader->setSourceAddress(addressTarget);
-					icmp->updateChecksum(sizeContent);
-					ipHeader->updateChecksum();
+					icmp->adjustChecksum(address.identifier, m_param.icmpEchoIdentifier);
+					icmp->adjustChecksum(address.sequenceNumber, sn);
+					ipHeader->adjustChecksum(address.ip, addressTarget);
 					return sl_true;
 				}
 			}
@@ -114,50 +136,62 @@ namespace slib
 		if (ipHeader->getDestinationAddress() != addressTarget) {
 			return sl_false;
 		}
+		if (ipHeader->isMF() || ipHeader->getFragmentOffset()) {
+			return sl_false;
+		}
 		if (ipHeader->isTCP()) {
 			TcpSegment* tcp = (TcpSegment*)(ipContent);
-			if (tcp->check(ipHeader, sizeContent)) {
+			if (tcp->checkHeader(sizeContent)) {
+				sl_uint16 targetPort = tcp->getDestinationPort();
 				SocketAddress addressSource;
-				if (m_mappingTcp.mapToInternalAddress(tcp->getDestinationPort(), addressSource)) {
-					ipHeader->setDestinationAddress(addressSource.ip.getIPv4());
+				if (m_mappingTcp.mapToInternalAddress(targetPort, addressSource)) {
+					IPv4Address ip = addressSource.ip.getIPv4();
+					ipHeader->setDestinationAddress(ip);
 					tcp->setDestinationPort(addressSource.port);
-					tcp->updateChecksum(ipHeader, sizeContent);
-					ipHeader->updateChecksum();
+					tcp->adjustChecksum(targetPort, addressSource.port);
+					tcp->adjustChecksum(addressTarget, ip);
+					ipHeader->adjustChecksum(addressTarget, ip);
 					return sl_true;
 				}
 			}
 		} else if (ipHeader->isUDP()) {
-			UdpDatagram* udp = (UdpDatagram*)(ipHeader->getContent());
-			if (udp->check(ipHeader, sizeContent)) {
+			UdpDatagram* udp = (UdpDatagram*)(ipContent);
+			if (udp->checkHeader(sizeContent)) {
+				sl_uint16 targetPort = udp->getDestinationPort();
 				SocketAddress addressSource;
-				if (m_mappingUdp.mapToInternalAddress(udp->getDestinationPort(), addressSource)) {
-					ipHeader->setDestinationAddress(addressSource.ip.getIPv4());
+				if (m_mappingUdp.mapToInternalAddress(targetPort, addressSource)) {
+					IPv4Address ip = addressSource.ip.getIPv4();
+					ipHeader->setDestinationAddress(ip);
 					udp->setDestinationPort(addressSource.port);
-					udp->updateChecksum(ipHeader);
-					ipHeader->updateChecksum();
+					udp->adjustChecksum(targetPort, addressSource.port);
+					udp->adjustChecksum(addressTarget, ip);
+					ipHeader->adjustChecksum(addressTarget, ip);
 					return sl_true;
 				}
 			}
 		} else if (ipHeader->isICMP()) {
 			IcmpHeaderFormat* icmp = (IcmpHeaderFormat*)(ipContent);
-			if (icmp->check(sizeContent)) {
+			if (icmp->checkHeader(sizeContent)) {
 				IcmpType type = icmp->getType();
 				if (type == IcmpType::EchoReply) {
 					if (icmp->getEchoIdentifier() == m_param.icmpEchoIdentifier) {
 						IcmpEchoElement element;
-						if (m_mapIcmpEchoIncoming.get(icmp->getEchoSequenceNumber(), &element)) {
+						sl_uint16 sn = icmp->getEchoSequenceNumber();
+						if (m_mapIcmpEchoIncoming.get(sn, &element)) {
 							ipHeader->setDestinationAddress(element.addressSource.ip);
 							icmp->setEchoIdentifier(element.addressSource.identifier);
 							icmp->setEchoSequenceNumber(element.addressSource.sequenceNumber);
-							icmp->updateChecksum(sizeContent);
-							ipHeader->updateChecksum();
+							icmp->adjustChecksum(m_param.icmpEchoIdentifier, element.addressSource.identifier);
+							icmp->adjustChecksum(sn, element.addressSource.sequenceNumber);
+							ipHeader->adjustChecksum(addressTarget, element.addressSource.ip);
 							return sl_true;
 						}
 					}
 				} else if (type == IcmpType::DestinationUnreachable || type == IcmpType::TimeExceeded) {
 					IPv4Packet* ipOrig = (IPv4Packet*)(icmp->getContent());
 					sl_uint32 sizeOrig = sizeContent - sizeof(IcmpHeaderFormat);
-					if (sizeOrig == sizeof(IPv4Packet)+8 && IPv4Packet::checkHeader(ipOrig, sizeOrig) && ipOrig->getDestinationAddress() == addressTarget) {
+					// the error message is small, so its checksum is verified and recalculated
+					if (sizeOrig == sizeof(IPv4Packet)+8 && icmp->checkChecksum(sizeContent) && IPv4Packet::checkHeader(ipOrig, sizeOrig) && ipOrig->getDestinationAddress() == addressTarget) {
 						if (ipOrig->isTCP()) {
 							TcpSegment* tcp = (TcpSegment*)(ipOrig->getContent());
 							SocketAddress addressSource;
@@ -193,6 +227,7 @@ namespace slib
 
 	sl_uint16 NatTable::getMappedIcmpEchoSequenceNumber(const IcmpEchoAddress& address)
 	{
+		ObjectLocker lock(this);
 		IcmpEchoElement element;
 		if (m_mapIcmpEchoOutgoing.get(address, &element)) {
 			return element.sequenceNumberTarget;
@@ -208,132 +243,374 @@ namespace slib
 		return sn;
 	}
 
-	_NatTablePort::_NatTablePort()
+	void NatTable::sweep()
 	{
-		flagActive = sl_false;
-		timeLastAccess.setZero();
+		m_mappingTcp.sweep(0xFFFFFFFF);
+		m_mappingUdp.sweep(0xFFFFFFFF);
 	}
 
-	_NatTablePort::~_NatTablePort()
+	sl_uint32 NatTable::getTcpMappingsCount()
+	{
+		return m_mappingTcp.getMappingsCount();
+	}
+
+	sl_uint32 NatTable::getUdpMappingsCount()
+	{
+		return m_mappingUdp.getMappingsCount();
+	}
+
+	struct _NatTablePort
+	{
+		// (ip << 16) | port of the internal endpoint, 0 when the port is free
+		std::atomic<sl_uint64> endpoint;
+		// tick count in milliseconds
+		std::atomic<sl_uint32> timeLastAccess;
+
+		_NatTablePort(): endpoint(0), timeLastAccess(0) {}
+	};
+
+	struct _NatTableSlot
+	{
+		// (endpoint << 16) | index of the port, or _NAT_TABLE_SLOT_EMPTY, _NAT_TABLE_SLOT_DELETED
+		std::atomic<sl_uint64> value;
+
+		_NatTableSlot(): value(0) {}
+	};
+
+#define _NAT_TABLE_SLOT_EMPTY 0
+#define _NAT_TABLE_SLOT_DELETED 1
+#define _NAT_TABLE_SWEEP_PORTS_PER_MAPPING 16
+
+	SLIB_INLINE static sl_uint64 _NatTable_getEndpoint(const SocketAddress& address)
 	{
+		if (address.ip.isIPv4()) {
+			return ((sl_uint64)(address.ip.getIPv4().getInt()) << 16) | address.port;
+		}
+		return 0;
 	}
 
 	_NatTableMapping::_NatTableMapping()
 	{
 		m_ports = sl_null;
 		m_nPorts = 0;
-		m_pos = 0;
-
 		m_portBegin = 0;
 		m_portEnd = 0;
+		m_timeout = 0;
+
+		m_slots = sl_null;
+		m_maskSlots = 0;
+		m_nDeletedSlots = 0;
+
+		m_freePorts = sl_null;
+		m_posFree = 0;
+		m_nFreePorts = 0;
+		m_posSweep = 0;
 	}
 
 	_NatTableMapping::~_NatTableMapping()
 	{
-		NewHelper<_NatTablePort>::free(m_ports, m_nPorts);
+		_free();
 	}
 
-	void _NatTableMapping::setup(sl_uint16 portBegin, sl_uint16 portEnd)
+	void _NatTableMapping::_free()
 	{
-		ObjectLocker lock(this);
-
-		m_mapPorts.removeAll_NoLock();
-
 		if (m_ports) {
 			NewHelper<_NatTablePort>::free(m_ports, m_nPorts);
 			m_ports = sl_null;
 		}
-		m_pos = 0;
+		if (m_slots) {
+			NewHelper<_NatTableSlot>::free(m_slots, m_maskSlots + 1);
+			m_slots = sl_null;
+		}
+		if (m_freePorts) {
+			NewHelper<sl_uint16>::free(m_freePorts, m_nPorts);
+			m_freePorts = sl_null;
+		}
 		m_nPorts = 0;
+		m_maskSlots = 0;
+		m_nDeletedSlots = 0;
+		m_posFree = 0;
+		m_nFreePorts = 0;
+		m_posSweep = 0;
+	}
+
+	void _NatTableMapping::setup(sl_uint16 portBegin, sl_uint16 portEnd, sl_uint32 timeout)
+	{
+		MutexLocker lock(&m_lockWrite);
+
+		_free();
 
 		m_portBegin = portBegin;
 		m_portEnd = portEnd;
-		if (portEnd >= portBegin) {
-			m_nPorts = portEnd - portBegin + 1;
-			m_ports = NewHelper<_NatTablePort>::create(m_nPorts);
+		m_timeout = timeout;
+		if (portEnd < portBegin) {
+			return;
 		}
+		sl_uint32 n = (sl_uint32)(portEnd - portBegin) + 1;
+		// at most half of the slots are used, so that the probe sequences are short
+		sl_uint32 nSlots = 16;
+		while (nSlots < n * 2) {
+			nSlots <<= 1;
+		}
+		_NatTablePort* ports = NewHelper<_NatTablePort>::create(n);
+		_NatTableSlot* slots = NewHelper<_NatTableSlot>::create(nSlots);
+		sl_uint16* freePorts = NewHelper<sl_uint16>::create(n);
+		if (!ports || !slots || !freePorts) {
+			if (ports) {
+				NewHelper<_NatTablePort>::free(ports, n);
+			}
+			if (slots) {
+				NewHelper<_NatTableSlot>::free(slots, nSlots);
+			}
+			if (freePorts) {
+				NewHelper<sl_uint16>::free(freePorts, n);
+			}
+			return;
+		}
+		for (sl_uint32 i = 0; i < n; i++) {
+			freePorts[i] = (sl_uint16)i;
+		}
+		m_ports = ports;
+		m_slots = slots;
+		m_freePorts = freePorts;
+		m_nPorts = n;
+		m_maskSlots = nSlots - 1;
+		m_nFreePorts = n;
 	}
 
-	sl_bool _NatTableMapping::mapToExternalPort(const SocketAddress& address, sl_uint16& _port)
+	sl_bool _NatTableMapping::mapToExternalPort(const SocketAddress& address, sl_uint16& port)
 	{
-		ObjectLocker lock(this);
+		if (!m_nPorts) {
+			return sl_false;
+		}
+		sl_uint64 endpoint = _NatTable_getEndpoint(address);
+		if (!endpoint) {
+			return sl_false;
+		}
+		sl_uint32 now = System::getTickCount();
+		sl_uint32 index;
+		if (_findSlot(endpoint, index)) {
+			_NatTablePort& p = m_ports[index];
+			if (p.endpoint.load(std::memory_order_acquire) == endpoint) {
+				// avoids writing the shared cache line on every packet
+				if (p.timeLastAccess.load(std::memory_order_relaxed) != now) {
+					p.timeLastAccess.store(now, std::memory_order_relaxed);
+				}
+				port = (sl_uint16)(m_portBegin + index);
+				return sl_true;
+			}
+		}
+		MutexLocker lock(&m_lockWrite);
+		if (_findSlot(endpoint, index)) {
+			_NatTablePort& p = m_ports[index];
+			p.timeLastAccess.store(now, std::memory_order_relaxed);
+			port = (sl_uint16)(m_portBegin + index);
+			return sl_true;
+		}
+		_sweep(_NAT_TABLE_SWEEP_PORTS_PER_MAPPING, now);
+		return _allocatePort(endpoint, now, port);
+	}
 
-		if (!m_ports) {
+	sl_bool _NatTableMapping::mapToInternalAddress(sl_uint16 port, SocketAddress& address)
+	{
+		if (!m_nPorts) {
 			return sl_false;
 		}
-		sl_uint32 n = m_nPorts;
-		if (!n) {
+		if (port < m_portBegin || port > m_portEnd) {
 			return sl_false;
 		}
+		_NatTablePort& p = m_ports[port - m_portBegin];
+		sl_uint64 endpoint = p.endpoint.load(std::memory_order_acquire);
+		if (!endpoint) {
+			return sl_false;
+		}
+		sl_uint32 now = System::getTickCount();
+		sl_uint32 t = p.timeLastAccess.load(std::memory_order_relaxed);
+		if (t != now) {
+			// the expired mappings are not revived by the incoming packets
+			if (m_timeout && now - t >= m_timeout) {
+				return sl_false;
+			}
+			p.timeLastAccess.store(now, std::memory_order_relaxed);
+		}
+		address.ip = IPv4Address((sl_uint32)(endpoint >> 16));
+		address.port = (sl_uint16)endpoint;
+		return sl_true;
+	}
+
+	void _NatTableMapping::sweep(sl_uint32 nPorts)
+	{
+		MutexLocker lock(&m_lockWrite);
+		_sweep(nPorts, System::getTickCount());
+	}
+
+	sl_uint32 _NatTableMapping::getMappingsCount()
+	{
+		MutexLocker lock(&m_lockWrite);
+		return m_nPorts - m_nFreePorts;
+	}
 
-		sl_uint16 port;
-		if (m_mapPorts.get_NoLock(address, &port)) {
-			if (port >= m_portBegin && port <= m_portEnd) {
-				m_ports[port - m_portBegin].timeLastAccess = Time::now();
-				_port = port;
+	sl_bool _NatTableMapping::_findSlot(sl_uint64 endpoint, sl_uint32& index)
+	{
+		sl_uint32 mask = m_maskSlots;
+		sl_uint32 pos = Hash64(endpoint) & mask;
+		for (sl_uint32 i = 0; i <= mask; i++) {
+			sl_uint64 value = m_slots[pos].value.load(std::memory_order_acquire);
+			if (value == _NAT_TABLE_SLOT_EMPTY) {
+				return sl_false;
+			}
+			if ((value >> 16) == endpoint) {
+				index = (sl_uint32)(value & 0xFFFF);
 				return sl_true;
-			} else {
-				m_mapPorts.remove_NoLock(address);
 			}
+			pos = (pos + 1) & mask;
 		}
+		return sl_false;
+	}
 
-		sl_uint16 pos = m_pos;
-		n *= 2;
-		sl_int64 timeAccessMin = 0;
-		sl_int64 timeAccessMax = 0;
-		for (sl_uint32 i = 0; i < n; i++) {
-			if (!(m_ports[pos].flagActive)) {
-				port = pos + m_portBegin;
-				m_ports[pos].flagActive = sl_true;
-				m_ports[pos].addressSource = address;
-				m_ports[pos].timeLastAccess = Time::now();
-				m_mapPorts.put_NoLock(address, port);
-				_port = port;
-				m_pos = (pos + 1) % m_nPorts;
-				return sl_true;
-			} else {
-				sl_int64 t = m_ports[pos].timeLastAccess.toInt();
-				if (t > timeAccessMax) {
-					timeAccessMax = t;
-				}
-				if (timeAccessMin == 0 || t < timeAccessMin) {
-					timeAccessMin = t;
+	sl_bool _NatTableMapping::_allocatePort(sl_uint64 endpoint, sl_uint32 now, sl_uint16& port)
+	{
+		if (!m_nFreePorts) {
+			_sweep(m_nPorts, now);
+			if (!m_nFreePorts) {
+				_evictOldest(now);
+				if (!m_nFreePorts) {
+					return sl_false;
 				}
 			}
-			pos = (pos + 1) % m_nPorts;
-			if (i == m_nPorts) {
-				sl_int64 mid = (timeAccessMin + timeAccessMax) / 2;
-				for (sl_uint16 k = 0; k < m_nPorts; k++) {
-					if (m_ports[k].flagActive) {
-						if (m_ports[k].timeLastAccess.toInt() <= mid) {
-							m_ports[k].flagActive = sl_false;
-							m_mapPorts.remove_NoLock(m_ports[k].addressSource);
-						}
+		}
+		sl_uint32 index = m_freePorts[m_posFree];
+		m_posFree = (m_posFree + 1) % m_nPorts;
+		m_nFreePorts--;
+
+		_NatTablePort& p = m_ports[index];
+		p.timeLastAccess.store(now, std::memory_order_relaxed);
+		p.endpoint.store(endpoint, std::memory_order_release);
+		_insertSlot(endpoint, index);
+
+		port = (sl_uint16)(m_portBegin + index);
+		return sl_true;
+	}
+
+	void _NatTableMapping::_releasePort(sl_uint32 indexPort)
+	{
+		_NatTablePort& p = m_ports[indexPort];
+		sl_uint64 endpoint = p.endpoint.load(std::memory_order_relaxed);
+		if (!endpoint) {
+			return;
+		}
+		p.endpoint.store(0, std::memory_order_release);
+
+		sl_uint32 mask = m_maskSlots;
+		sl_uint32 pos = Hash64(endpoint) & mask;
+		for (sl_uint32 i = 0; i <= mask; i++) {
+			sl_uint64 value = m_slots[pos].value.load(std::memory_order_relaxed);
+			if (value == _NAT_TABLE_SLOT_EMPTY) {
+				break;
+			}
+			if ((value >> 16) == endpoint) {
+				if (m_slots[(pos + 1) & mask].value.load(std::memory_order_relaxed) == _NAT_TABLE_SLOT_EMPTY) {
+					// no probe sequence passes this slot, so the preceding tombstones are also cleared
+					m_slots[pos].value.store(_NAT_TABLE_SLOT_EMPTY, std::memory_order_release);
+					pos = (pos - 1) & mask;
+					while (m_slots[pos].value.load(std::memory_order_relaxed) == _NAT_TABLE_SLOT_DELETED) {
+						m_slots[pos].value.store(_NAT_TABLE_SLOT_EMPTY, std::memory_order_release);
+						m_nDeletedSlots--;
+						pos = (pos - 1) & mask;
 					}
+				} else {
+					m_slots[pos].value.store(_NAT_TABLE_SLOT_DELETED, std::memory_order_release);
+					m_nDeletedSlots++;
 				}
+				break;
 			}
+			pos = (pos + 1) & mask;
+		}
+
+		m_freePorts[(m_posFree + m_nFreePorts) % m_nPorts] = (sl_uint16)indexPort;
+		m_nFreePorts++;
+
+		if (m_nDeletedSlots > (m_maskSlots >> 2)) {
+			_rebuildSlots();
 		}
-		return sl_false;
 	}
 
-	sl_bool _NatTableMapping::mapToInternalAddress(sl_uint16 port, SocketAddress& address)
+	void _NatTableMapping::_insertSlot(sl_uint64 endpoint, sl_uint32 indexPort)
 	{
-		ObjectLocker lock(this);
-		if (!m_ports) {
-			return sl_false;
+		// the endpoint is not in the table, so the first reusable slot is taken
+		sl_uint32 mask = m_maskSlots;
+		sl_uint32 pos = Hash64(endpoint) & mask;
+		for (;;) {
+			sl_uint64 value = m_slots[pos].value.load(std::memory_order_relaxed);
+			if (value == _NAT_TABLE_SLOT_EMPTY) {
+				break;
+			}
+			if (value == _NAT_TABLE_SLOT_DELETED) {
+				m_nDeletedSlots--;
+				break;
+			}
+			pos = (pos + 1) & mask;
 		}
-		if (!m_nPorts) {
-			return sl_false;
+		m_slots[pos].value.store((endpoint << 16) | indexPort, std::memory_order_release);
+	}
+
+	void _NatTableMapping::_rebuildSlots()
+	{
+		sl_uint32 nSlots = m_maskSlots + 1;
+		for (sl_uint32 i = 0; i < nSlots; i++) {
+			m_slots[i].value.store(_NAT_TABLE_SLOT_EMPTY, std::memory_order_release);
 		}
-		if (port >= m_portBegin && port <= m_portEnd) {
-			sl_uint32 k = port - m_portBegin;
-			if (m_ports[k].flagActive) {
-				m_ports[k].timeLastAccess = Time::now();
-				address = m_ports[k].addressSource;
-				return sl_true;
+		m_nDeletedSlots = 0;
+		for (sl_uint32 i = 0; i < m_nPorts; i++) {
+			sl_uint64 endpoint = m_ports[i].endpoint.load(std::memory_order_relaxed);
+			if (endpoint) {
+				_insertSlot(endpoint, i);
+			}
+		}
+	}
+
+	void _NatTableMapping::_sweep(sl_uint32 nPorts, sl_uint32 now)
+	{
+		if (!m_timeout || !m_nPorts) {
+			return;
+		}
+		if (nPorts > m_nPorts) {
+			nPorts = m_nPorts;
+		}
+		for (sl_uint32 i = 0; i < nPorts; i++) {
+			sl_uint32 index = m_posSweep;
+			m_posSweep = (index + 1) % m_nPorts;
+			_NatTablePort& p = m_ports[index];
+			if (p.endpoint.load(std::memory_order_relaxed)) {
+				if (now - p.timeLastAccess.load(std::memory_order_relaxed) >= m_timeout) {
+					_releasePort(index);
+				}
+			}
+		}
+	}
+
+	void _NatTableMapping::_evictOldest(sl_uint32 now)
+	{
+		// releases the mappings idle for at least half of the longest idle time
+		sl_uint32 ageMax = 0;
+		for (sl_uint32 i = 0; i < m_nPorts; i++) {
+			_NatTablePort& p = m_ports[i];
+			if (p.endpoint.load(std::memory_order_relaxed)) {
+				sl_uint32 age = now - p.timeLastAccess.load(std::memory_order_relaxed);
+				if (age > ageMax) {
+					ageMax = age;
+				}
+			}
+		}
+		sl_uint32 ageMid = ageMax / 2;
+		for (sl_uint32 i = 0; i < m_nPorts; i++) {
+			_NatTablePort& p = m_ports[i];
+			if (p.endpoint.load(std::memory_order_relaxed)) {
+				if (now - p.timeLastAccess.load(std::memory_order_relaxed) >= ageMid) {
+					_releasePort(i);
+				}
 			}
 		}
-		return sl_false;
 	}
 	
 }
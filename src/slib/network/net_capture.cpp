@@ -48,6 +48,13 @@ namespace slib
 	INetCaptureListener::~INetCaptureListener()
 	{
 	}
+	
+	void INetCaptureListener::onCapturePackets(NetCapture* capture, NetCapturePacket* packets, sl_uint32 nPackets)
+	{
+		for (sl_uint32 i = 0; i < nPackets; i++) {
+			onCapturePacket(capture, packets + i);
+		}
+	}
 
 	NetCaptureParam::NetCaptureParam()
 	{
@@ -57,6 +64,13 @@ namespace slib
 		
 		preferedLinkDeviceType = NetworkLinkDeviceType::Ethernet;
 		
+		ringBlockSize = 0x100000; // 1MB
+		ringBlocksCount = 64;
+		ringFrameSize = 2048;
+		ringSendFramesCount = 256;
+		threadsCount = 1;
+		fanoutGroupId = 0;
+		
 		flagAutoStart = sl_true;
 	}
 	
@@ -80,6 +94,16 @@ namespace slib
 		return sl_false;
 	}
 	
+	sl_uint32 NetCapture::sendPackets(const NetCapturePacket* packets, sl_uint32 nPackets)
+	{
+		for (sl_uint32 i = 0; i < nPackets; i++) {
+			if (!(sendPacket(packets[i].data, packets[i].length))) {
+				return i;
+			}
+		}
+		return nPackets;
+	}
+	
 	String NetCapture::getLastErrorMessage()
 	{
 		return sl_null;
@@ -89,6 +113,7 @@ namespace slib
 	{
 		m_listener = param.listener;
 		m_onCapturePacket = param.onCapturePacket;
+		m_onCapturePackets = param.onCapturePackets;
 	}
 	
 	void NetCapture::_onCapturePacket(NetCapturePacket* packet)
@@ -98,6 +123,21 @@ namespace slib
 			listener->onCapturePacket(this, packet);
 		}
 		m_onCapturePacket(this, packet);
+		m_onCapturePackets(this, packet, 1);
+	}
+	
+	void NetCapture::_onCapturePackets(NetCapturePacket* packets, sl_uint32 nPackets)
+	{
+		PtrLocker<INetCaptureListener> listener(m_listener);
+		if (listener.isNotNull()) {
+			listener->onCapturePackets(this, packets, nPackets);
+		}
+		if (m_onCapturePacket.isNotNull()) {
+			for (sl_uint32 i = 0; i < nPackets; i++) {
+				m_onCapturePacket(this, packets + i);
+			}
+		}
+		m_onCapturePackets(this, packets, nPackets);
 	}
 	
 	
@@ -0,0 +1,555 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "../../../inc/slib/network/capture.h"
+
+#if defined(SLIB_PLATFORM_IS_LINUX)
+
+#include "../../../inc/slib/network/os.h"
+#include "../../../inc/slib/network/socket.h"
+#include "../../../inc/slib/network/event.h"
+#include "../../../inc/slib/network/ethernet.h"
+
+#include "../../../inc/slib/core/thread.h"
+#include "../../../inc/slib/core/array.h"
+#include "../../../inc/slib/core/log.h"
+
+#include <sys/socket.h>
+#include <sys/mman.h>
+#include <linux/if_packet.h>
+#include <linux/if_ether.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <poll.h>
+#include <errno.h>
+
+#define TAG "NetCapture"
+
+// packets delivered by a callback at most
+#define MAX_PACKETS_PER_CALLBACK 256
+
+#define TX_DATA_OFFSET (TPACKET_ALIGN(sizeof(struct tpacket3_hdr)))
+
+// milliseconds waiting for a free frame in TX ring
+#define TX_WAIT_TIMEOUT 100
+
+namespace slib
+{
+
+	static sl_int32 _g_netPacketRing_fanoutGroupCounter = 0;
+
+	/*
+		One socket with its RX ring (and TX ring for the first one), read by one thread.
+		The blocks of RX ring are owned by the kernel until `block_status` has TP_STATUS_USER,
+		and are returned by storing TP_STATUS_KERNEL after the callbacks.
+	*/
+	class _NetPacketRing : public Referable
+	{
+	public:
+		Ref<Socket> socket;
+		Ref<Thread> thread;
+
+		sl_uint8* mem;
+		sl_size sizeMem;
+
+		sl_uint8* rx;
+		sl_uint32 rxBlockSize;
+		sl_uint32 rxBlocksCount;
+
+		sl_uint8* tx;
+		sl_uint32 txFrameSize;
+		sl_uint32 txFramesCount;
+		sl_uint32 txIndex;
+
+	public:
+		_NetPacketRing()
+		{
+			mem = sl_null;
+			sizeMem = 0;
+			rx = sl_null;
+			rxBlockSize = 0;
+			rxBlocksCount = 0;
+			tx = sl_null;
+			txFrameSize = 0;
+			txFramesCount = 0;
+			txIndex = 0;
+		}
+
+		~_NetPacketRing()
+		{
+			close();
+		}
+
+	public:
+		static Ref<_NetPacketRing> create(const NetCaptureParam& param, NetworkLinkDeviceType deviceType, sl_uint32 iface, sl_bool flagTx, sl_uint16 fanoutGroupId)
+		{
+			Ref<Socket> socket;
+			if (deviceType == NetworkLinkDeviceType::Raw) {
+				socket = Socket::openPacketDatagram(NetworkLinkProtocol::All);
+			} else {
+				socket = Socket::openPacketRaw(NetworkLinkProtocol::All);
+			}
+			if (socket.isNull()) {
+				LogError(TAG, "Failed to create Packet socket");
+				return sl_null;
+			}
+			int fd = (int)(socket->getHandle());
+
+			int version = TPACKET_V3;
+			if (setsockopt(fd, SOL_PACKET, PACKET_VERSION, &version, sizeof(version))) {
+				LogError(TAG, "TPACKET_V3 is not supported");
+				return sl_null;
+			}
+
+			sl_uint32 pageSize = (sl_uint32)(getpagesize());
+			sl_uint32 blockSize = param.ringBlockSize;
+			blockSize = (blockSize + pageSize - 1) / pageSize * pageSize;
+			if (!blockSize) {
+				blockSize = pageSize;
+			}
+			sl_uint32 nBlocks = param.ringBlocksCount;
+			if (!nBlocks) {
+				nBlocks = 1;
+			}
+			sl_uint32 frameSize = param.ringFrameSize;
+			frameSize = TPACKET_ALIGN(frameSize);
+			if (frameSize < TPACKET_ALIGN(TPACKET3_HDRLEN) || blockSize % frameSize) {
+				frameSize = TPACKET_ALIGNMENT << 7; // 2048
+			}
+
+			if (flagTx && param.ringSendFramesCount) {
+				// discards the malformed frames instead of leaving them in TP_STATUS_WRONG_FORMAT, which would stall TX ring. must be set before the rings
+				int loss = 1;
+				if (setsockopt(fd, SOL_PACKET, PACKET_LOSS, &loss, sizeof(loss))) {
+					Log(TAG, "PACKET_LOSS is not supported, sending by the socket");
+					flagTx = sl_false;
+				}
+			}
+
+			tpacket_req3 req;
+			Base::zeroMemory(&req, sizeof(req));
+			req.tp_block_size = blockSize;
+			req.tp_block_nr = nBlocks;
+			req.tp_frame_size = frameSize;
+			req.tp_frame_nr = blockSize / frameSize * nBlocks;
+			req.tp_retire_blk_tov = param.timeoutRead;
+			if (setsockopt(fd, SOL_PACKET, PACKET_RX_RING, &req, sizeof(req))) {
+				LogError(TAG, "Failed to setup RX ring: %d", errno);
+				return sl_null;
+			}
+			sl_size sizeRx = (sl_size)blockSize * nBlocks;
+			sl_size sizeTx = 0;
+			sl_uint32 nTxFrames = 0;
+			if (flagTx && param.ringSendFramesCount) {
+				// TX ring of TPACKET_V3 has fixed-size frames (linux 4.11)
+				sl_uint32 framesPerBlock = blockSize / frameSize;
+				sl_uint32 nTxBlocks = (param.ringSendFramesCount + framesPerBlock - 1) / framesPerBlock;
+				Base::zeroMemory(&req, sizeof(req));
+				req.tp_block_size = blockSize;
+				req.tp_block_nr = nTxBlocks;
+				req.tp_frame_size = frameSize;
+				req.tp_frame_nr = framesPerBlock * nTxBlocks;
+				if (setsockopt(fd, SOL_PACKET, PACKET_TX_RING, &req, sizeof(req))) {
+					Log(TAG, "TX ring is not supported, sending by the socket");
+				} else {
+					nTxFrames = req.tp_frame_nr;
+					sizeTx = (sl_size)blockSize * nTxBlocks;
+				}
+			}
+
+			if (iface) {
+				sockaddr_ll addr;
+				Base::zeroMemory(&addr, sizeof(addr));
+				addr.sll_family = AF_PACKET;
+				addr.sll_protocol = htons(ETH_P_ALL);
+				addr.sll_ifindex = (int)iface;
+				if (bind(fd, (sockaddr*)&addr, sizeof(addr))) {
+					LogError(TAG, "Failed to bind the network device: %s", param.deviceName);
+					return sl_null;
+				}
+				if (param.flagPromiscuous) {
+					if (!(socket->setPromiscuousMode(param.deviceName, sl_true))) {
+						Log(TAG, "Failed to set promiscuous mode to the network device: %s", param.deviceName);
+					}
+				}
+			}
+
+			if (fanoutGroupId) {
+				// hashed by flow, fragments are defragmented to be hashed by the ports
+				int fanout = (int)fanoutGroupId | ((PACKET_FANOUT_HASH | PACKET_FANOUT_FLAG_DEFRAG) << 16);
+				if (setsockopt(fd, SOL_PACKET, PACKET_FANOUT, &fanout, sizeof(fanout))) {
+					LogError(TAG, "Failed to join fanout group: %d", (sl_uint32)fanoutGroupId);
+					return sl_null;
+				}
+			}
+
+			sl_size sizeMem = sizeRx + sizeTx;
+			void* mem = mmap(sl_null, sizeMem, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+			if (mem == MAP_FAILED) {
+				LogError(TAG, "Failed to map the packet ring: %d", errno);
+				return sl_null;
+			}
+
+			Ref<_NetPacketRing> ret = new _NetPacketRing;
+			if (ret.isNull()) {
+				munmap(mem, sizeMem);
+				return sl_null;
+			}
+			ret->socket = socket;
+			ret->mem = (sl_uint8*)mem;
+			ret->sizeMem = sizeMem;
+			ret->rx = (sl_uint8*)mem;
+			ret->rxBlockSize = blockSize;
+			ret->rxBlocksCount = nBlocks;
+			if (nTxFrames) {
+				ret->tx = (sl_uint8*)mem + sizeRx;
+				ret->txFrameSize = frameSize;
+				ret->txFramesCount = nTxFrames;
+			}
+			return ret;
+		}
+
+		void close()
+		{
+			if (mem) {
+				munmap(mem, sizeMem);
+				mem = sl_null;
+			}
+			socket.setNull();
+		}
+
+		void run(NetCapture* capture, sl_int32 timeout)
+		{
+			socket->setNonBlockingMode(sl_true);
+			Ref<SocketEvent> event = SocketEvent::createRead(socket);
+			if (event.isNull()) {
+				return;
+			}
+			NetCapturePacket packets[MAX_PACKETS_PER_CALLBACK];
+			sl_uint32 indexBlock = 0;
+			while (Thread::isNotStoppingCurrent()) {
+				tpacket_block_desc* block = (tpacket_block_desc*)(rx + (sl_size)indexBlock * rxBlockSize);
+				if (!(__atomic_load_n(&(block->hdr.bh1.block_status), __ATOMIC_ACQUIRE) & TP_STATUS_USER)) {
+					event->wait(timeout);
+					continue;
+				}
+				sl_uint32 nPackets = block->hdr.bh1.num_pkts;
+				tpacket3_hdr* hdr = (tpacket3_hdr*)((sl_uint8*)block + block->hdr.bh1.offset_to_first_pkt);
+				sl_uint32 n = 0;
+				for (sl_uint32 i = 0; i < nPackets; i++) {
+					NetCapturePacket& packet = packets[n];
+					packet.data = (sl_uint8*)hdr + hdr->tp_mac;
+					packet.length = hdr->tp_snaplen;
+					packet.time = (sl_int64)(hdr->tp_sec) * 1000000 + hdr->tp_nsec / 1000;
+					n++;
+					if (n == MAX_PACKETS_PER_CALLBACK) {
+						_dispatch(capture, packets, n);
+						n = 0;
+					}
+					hdr = (tpacket3_hdr*)((sl_uint8*)hdr + hdr->tp_next_offset);
+				}
+				if (n) {
+					_dispatch(capture, packets, n);
+				}
+				__atomic_store_n(&(block->hdr.bh1.block_status), TP_STATUS_KERNEL, __ATOMIC_RELEASE);
+				indexBlock = (indexBlock + 1) % rxBlocksCount;
+			}
+		}
+
+		void _dispatch(NetCapture* capture, NetCapturePacket* packets, sl_uint32 n);
+
+		// returns sl_false when TX ring is full
+		sl_bool queue(const void* buf, sl_uint32 size)
+		{
+			if (size > txFrameSize - TX_DATA_OFFSET) {
+				return sl_false;
+			}
+			tpacket3_hdr* hdr = (tpacket3_hdr*)(tx + (sl_size)txIndex * txFrameSize);
+			if (__atomic_load_n(&(hdr->tp_status), __ATOMIC_ACQUIRE) != TP_STATUS_AVAILABLE) {
+				// flushes the queued frames, and checks again after the kernel has released the frame
+				flush();
+				if (__atomic_load_n(&(hdr->tp_status), __ATOMIC_ACQUIRE) != TP_STATUS_AVAILABLE) {
+					pollfd fd;
+					fd.fd = (int)(socket->getHandle());
+					fd.events = POLLOUT;
+					fd.revents = 0;
+					poll(&fd, 1, TX_WAIT_TIMEOUT);
+					if (__atomic_load_n(&(hdr->tp_status), __ATOMIC_ACQUIRE) != TP_STATUS_AVAILABLE) {
+						return sl_false;
+					}
+				}
+			}
+			Base::copyMemory((sl_uint8*)hdr + TX_DATA_OFFSET, buf, size);
+			hdr->tp_next_offset = 0;
+			hdr->tp_len = size;
+			hdr->tp_snaplen = size;
+			__atomic_store_n(&(hdr->tp_status), TP_STATUS_SEND_REQUEST, __ATOMIC_RELEASE);
+			txIndex = (txIndex + 1) % txFramesCount;
+			return sl_true;
+		}
+
+		sl_bool flush()
+		{
+			// hands the queued frames to the kernel without waiting for the completion (the socket is shared with the nonblocking RX loop)
+			if (send((int)(socket->getHandle()), sl_null, 0, MSG_DONTWAIT) >= 0) {
+				return sl_true;
+			}
+			return errno == EAGAIN || errno == EWOULDBLOCK;
+		}
+
+	};
+
+	class _NetPacketRingCapture : public NetCapture
+	{
+	public:
+		Array< Ref<_NetPacketRing> > m_rings;
+		NetworkLinkDeviceType m_deviceType;
+		sl_uint32 m_ifaceIndex;
+		sl_int32 m_timeoutRead;
+		Mutex m_lockSend;
+
+		sl_bool m_flagInit;
+		sl_bool m_flagRunning;
+
+	public:
+		_NetPacketRingCapture()
+		{
+			m_deviceType = NetworkLinkDeviceType::Ethernet;
+			m_ifaceIndex = 0;
+			m_timeoutRead = 100;
+
+			m_flagInit = sl_false;
+			m_flagRunning = sl_false;
+		}
+
+		~_NetPacketRingCapture()
+		{
+			release();
+		}
+
+	public:
+		static Ref<_NetPacketRingCapture> create(const NetCaptureParam& param)
+		{
+			sl_uint32 iface = 0;
+			String deviceName = param.deviceName;
+			if (deviceName.isNotEmpty()) {
+				iface = Network::getInterfaceIndexFromName(deviceName);
+				if (iface == 0) {
+					LogError(TAG, "Failed to find the interface index of device: %s", deviceName);
+					return sl_null;
+				}
+			}
+			NetworkLinkDeviceType deviceType = param.preferedLinkDeviceType;
+			if (deviceType != NetworkLinkDeviceType::Raw) {
+				deviceType = NetworkLinkDeviceType::Ethernet;
+			}
+			sl_uint32 nThreads = param.threadsCount;
+			if (!nThreads) {
+				nThreads = 1;
+			}
+			sl_uint16 fanoutGroupId = param.fanoutGroupId;
+			if (!fanoutGroupId && nThreads > 1) {
+				fanoutGroupId = (sl_uint16)((getpid() << 4) + Base::interlockedIncrement32(&_g_netPacketRing_fanoutGroupCounter));
+				if (!fanoutGroupId) {
+					fanoutGroupId = 1;
+				}
+			}
+			Array< Ref<_NetPacketRing> > rings = Array< Ref<_NetPacketRing> >::create(nThreads);
+			if (rings.isNull()) {
+				return sl_null;
+			}
+			// TX ring is used only for Ethernet frames on a device, because the kernel does not build the link header without the destination
+			sl_bool flagTx = iface != 0 && deviceType == NetworkLinkDeviceType::Ethernet;
+			for (sl_uint32 i = 0; i < nThreads; i++) {
+				rings[i] = _NetPacketRing::create(param, deviceType, iface, flagTx && i == 0, fanoutGroupId);
+				if (rings[i].isNull()) {
+					return sl_null;
+				}
+			}
+			Ref<_NetPacketRingCapture> ret = new _NetPacketRingCapture;
+			if (ret.isNull()) {
+				return sl_null;
+			}
+			ret->_initWithParam(param);
+			ret->m_rings = rings;
+			ret->m_deviceType = deviceType;
+			ret->m_ifaceIndex = iface;
+			ret->m_timeoutRead = param.timeoutRead ? (sl_int32)(param.timeoutRead) : -1;
+			_NetPacketRingCapture* capture = ret.get();
+			for (sl_uint32 i = 0; i < nThreads; i++) {
+				_NetPacketRing* ring = rings[i].get();
+				ring->thread = Thread::create([capture, ring]() {
+					ring->run(capture, capture->m_timeoutRead);
+				});
+				if (ring->thread.isNull()) {
+					LogError(TAG, "Failed to create thread");
+					return sl_null;
+				}
+			}
+			ret->m_flagInit = sl_true;
+			if (param.flagAutoStart) {
+				ret->start();
+			}
+			return ret;
+		}
+
+		void release()
+		{
+			ObjectLocker lock(this);
+			if (!m_flagInit) {
+				return;
+			}
+			m_flagInit = sl_false;
+
+			m_flagRunning = sl_false;
+			sl_size n = m_rings.getCount();
+			Ref<_NetPacketRing>* rings = m_rings.getData();
+			for (sl_size i = 0; i < n; i++) {
+				if (rings[i]->thread.isNotNull()) {
+					rings[i]->thread->finish();
+				}
+			}
+			for (sl_size i = 0; i < n; i++) {
+				if (rings[i]->thread.isNotNull()) {
+					rings[i]->thread->finishAndWait();
+					rings[i]->thread.setNull();
+				}
+			}
+			MutexLocker lockSend(&m_lockSend);
+			for (sl_size i = 0; i < n; i++) {
+				rings[i]->close();
+			}
+		}
+
+		void start()
+		{
+			ObjectLocker lock(this);
+			if (!m_flagInit) {
+				return;
+			}
+			if (m_flagRunning) {
+				return;
+			}
+			sl_size n = m_rings.getCount();
+			Ref<_NetPacketRing>* rings = m_rings.getData();
+			for (sl_size i = 0; i < n; i++) {
+				if (rings[i]->thread.isNotNull()) {
+					if (rings[i]->thread->start()) {
+						m_flagRunning = sl_true;
+					}
+				}
+			}
+		}
+
+		sl_bool isRunning()
+		{
+			return m_flagRunning;
+		}
+
+		NetworkLinkDeviceType getLinkType()
+		{
+			return m_deviceType;
+		}
+
+		sl_bool sendPacket(const void* buf, sl_uint32 size)
+		{
+			NetCapturePacket packet;
+			packet.data = (sl_uint8*)buf;
+			packet.length = size;
+			return sendPackets(&packet, 1) == 1;
+		}
+
+		// queues the packets to TX ring, and sends them by a system call
+		sl_uint32 sendPackets(const NetCapturePacket* packets, sl_uint32 nPackets)
+		{
+			if (m_ifaceIndex == 0) {
+				return 0;
+			}
+			MutexLocker lock(&m_lockSend);
+			if (!m_flagInit) {
+				return 0;
+			}
+			_NetPacketRing* ring = m_rings[0].get();
+			if (!(ring->tx)) {
+				// keeps the socket alive after unlocking, because release() closes it under the lock
+				Ref<Socket> socket = ring->socket;
+				lock.unlock();
+				return _sendPacketsBySocket(socket, packets, nPackets);
+			}
+			sl_uint32 n = 0;
+			for (; n < nPackets; n++) {
+				if (!(ring->queue(packets[n].data, packets[n].length))) {
+					break;
+				}
+			}
+			if (n) {
+				if (!(ring->flush())) {
+					return 0;
+				}
+			}
+			return n;
+		}
+
+		sl_uint32 _sendPacketsBySocket(const Ref<Socket>& socket, const NetCapturePacket* packets, sl_uint32 nPackets)
+		{
+			for (sl_uint32 i = 0; i < nPackets; i++) {
+				L2PacketInfo info;
+				info.type = L2PacketType::OutGoing;
+				info.iface = m_ifaceIndex;
+				if (m_deviceType == NetworkLinkDeviceType::Ethernet) {
+					EthernetFrame* frame = (EthernetFrame*)(packets[i].data);
+					if (packets[i].length < EthernetFrame::HeaderSize) {
+						return i;
+					}
+					info.protocol = frame->getProtocol();
+					info.setMacAddress(frame->getDestinationAddress());
+				} else {
+					info.protocol = NetworkLinkProtocol::IPv4;
+					info.clearAddress();
+				}
+				if (socket->sendPacket(packets[i].data, packets[i].length, info) != (sl_int32)(packets[i].length)) {
+					return i;
+				}
+			}
+			return nPackets;
+		}
+
+		void _dispatch(NetCapturePacket* packets, sl_uint32 n)
+		{
+			_onCapturePackets(packets, n);
+		}
+
+	};
+
+	void _NetPacketRing::_dispatch(NetCapture* capture, NetCapturePacket* packets, sl_uint32 n)
+	{
+		((_NetPacketRingCapture*)capture)->_dispatch(packets, n);
+	}
+
+	Ref<NetCapture> NetCapture::createPacketRing(const NetCaptureParam& param)
+	{
+		return _NetPacketRingCapture::create(param);
+	}
+
+}
+
+#else
+
+namespace slib
+{
+
+	Ref<NetCapture> NetCapture::createPacketRing(const NetCaptureParam& param)
+	{
+		return sl_null;
+	}
+
+}
+
+#endif
@@ -0,0 +1,437 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "../../../inc/slib/network/packet_pipeline.h"
+
+#include "../../../inc/slib/network/ethernet.h"
+
+#if defined(SLIB_COMPILER_IS_GCC)
+#	define _NET_PACKET_PREFETCH(p) __builtin_prefetch(p)
+#else
+#	define _NET_PACKET_PREFETCH(p)
+#endif
+
+// number of the packets prefetched ahead of the current packet
+#define _NET_PACKET_PREFETCH_DISTANCE 4
+
+// descriptors constructed on the stack for the small calls (such as onCapturePacket)
+#define _NET_PACKET_SMALL_BATCH 8
+
+// frames passed to NetCapture::sendPackets() at once
+#define _NET_PACKET_TRANSMIT_CHUNK 32
+
+namespace slib
+{
+
+	NetPacketDescriptor::NetPacketDescriptor()
+	{
+		frame = sl_null;
+		sizeFrame = 0;
+		sizeLinkHeader = 0;
+		ip = sl_null;
+		sizeIp = 0;
+		flagDropped = sl_false;
+	}
+
+	NetPacketDescriptor::~NetPacketDescriptor()
+	{
+	}
+
+	sl_bool NetPacketDescriptor::isDetached() const
+	{
+		return memory.isNotNull();
+	}
+
+
+	NetPacketBatch::NetPacketBatch()
+	{
+		capture = sl_null;
+		linkType = NetworkLinkDeviceType::Ethernet;
+		packets = sl_null;
+		count = 0;
+	}
+
+	NetPacketBatch::~NetPacketBatch()
+	{
+	}
+
+	sl_uint32 NetPacketBatch::getActiveCount() const
+	{
+		sl_uint32 n = 0;
+		for (sl_uint32 i = 0; i < count; i++) {
+			if (!(packets[i].flagDropped)) {
+				n++;
+			}
+		}
+		return n;
+	}
+
+
+	NetPacketStage::NetPacketStage()
+	{
+	}
+
+	NetPacketStage::~NetPacketStage()
+	{
+	}
+
+
+	NetPacketParseStage::NetPacketParseStage()
+	{
+	}
+
+	NetPacketParseStage::~NetPacketParseStage()
+	{
+	}
+
+	void NetPacketParseStage::processBatch(NetPacketBatch& batch)
+	{
+		sl_uint32 n = batch.count;
+		NetPacketDescriptor* packets = batch.packets;
+		sl_uint32 sizeLinkHeader;
+		switch (batch.linkType) {
+			case NetworkLinkDeviceType::Ethernet:
+				sizeLinkHeader = EthernetFrame::HeaderSize;
+				break;
+			case NetworkLinkDeviceType::Linux:
+				sizeLinkHeader = LinuxCookedFrame::HeaderSize;
+				break;
+			case NetworkLinkDeviceType::Raw:
+				sizeLinkHeader = 0;
+				break;
+			default:
+				for (sl_uint32 i = 0; i < n; i++) {
+					packets[i].flagDropped = sl_true;
+				}
+				return;
+		}
+		for (sl_uint32 i = 0; i < n && i < _NET_PACKET_PREFETCH_DISTANCE; i++) {
+			_NET_PACKET_PREFETCH(packets[i].frame);
+		}
+		for (sl_uint32 i = 0; i < n; i++) {
+			if (i + _NET_PACKET_PREFETCH_DISTANCE < n) {
+				_NET_PACKET_PREFETCH(packets[i + _NET_PACKET_PREFETCH_DISTANCE].frame);
+			}
+			NetPacketDescriptor& packet = packets[i];
+			if (packet.flagDropped) {
+				continue;
+			}
+			if (packet.sizeFrame <= sizeLinkHeader) {
+				packet.flagDropped = sl_true;
+				continue;
+			}
+			if (batch.linkType == NetworkLinkDeviceType::Ethernet) {
+				if (((EthernetFrame*)(packet.frame))->getProtocol() != NetworkLinkProtocol::IPv4) {
+					packet.flagDropped = sl_true;
+					continue;
+				}
+			} else if (batch.linkType == NetworkLinkDeviceType::Linux) {
+				if (((LinuxCookedFrame*)(packet.frame))->getProtocolType() != NetworkLinkProtocol::IPv4) {
+					packet.flagDropped = sl_true;
+					continue;
+				}
+			}
+			IPv4Packet* ip = (IPv4Packet*)(packet.frame + sizeLinkHeader);
+			if (!(IPv4Packet::check(ip, packet.sizeFrame - sizeLinkHeader))) {
+				packet.flagDropped = sl_true;
+				continue;
+			}
+			packet.sizeLinkHeader = sizeLinkHeader;
+			packet.ip = ip;
+			// excludes the padding of the frame
+			packet.sizeIp = ip->getTotalSize();
+		}
+	}
+
+
+	NetPacketReassembleStage::NetPacketReassembleStage(const Ref<IPv4Fragmentation>& fragmentation)
+	{
+		m_fragmentation = fragmentation;
+	}
+
+	NetPacketReassembleStage::~NetPacketReassembleStage()
+	{
+	}
+
+	void NetPacketReassembleStage::processBatch(NetPacketBatch& batch)
+	{
+		IPv4Fragmentation* fragmentation = m_fragmentation.get();
+		if (!fragmentation) {
+			return;
+		}
+		sl_uint32 n = batch.count;
+		NetPacketDescriptor* packets = batch.packets;
+		for (sl_uint32 i = 0; i < n; i++) {
+			NetPacketDescriptor& packet = packets[i];
+			if (packet.flagDropped || !(packet.ip)) {
+				continue;
+			}
+			if (!(IPv4Fragmentation::isNeededCombine(packet.ip, packet.sizeIp, sl_true))) {
+				continue;
+			}
+			Memory mem = fragmentation->combineFragment(packet.ip, packet.sizeIp, sl_true);
+			if (mem.isNull()) {
+				// held until the other fragments arrive
+				packet.flagDropped = sl_true;
+				continue;
+			}
+			packet.memory = mem;
+			packet.ip = (IPv4Packet*)(mem.getData());
+			packet.sizeIp = (sl_uint32)(mem.getSize());
+		}
+	}
+
+
+	NetPacketNatStage::NetPacketNatStage(const Ref<NatTable>& nat, sl_bool flagOutgoing)
+	{
+		m_nat = nat;
+		m_flagOutgoing = flagOutgoing;
+	}
+
+	NetPacketNatStage::~NetPacketNatStage()
+	{
+	}
+
+	void NetPacketNatStage::processBatch(NetPacketBatch& batch)
+	{
+		NatTable* nat = m_nat.get();
+		if (!nat) {
+			return;
+		}
+		sl_uint32 n = batch.count;
+		NetPacketDescriptor* packets = batch.packets;
+		for (sl_uint32 i = 0; i < n; i++) {
+			if (i + _NET_PACKET_PREFETCH_DISTANCE < n) {
+				// the transport header usually shares the cache line of the IP header
+				_NET_PACKET_PREFETCH(packets[i + _NET_PACKET_PREFETCH_DISTANCE].ip);
+			}
+			NetPacketDescriptor& packet = packets[i];
+			if (packet.flagDropped || !(packet.ip)) {
+				continue;
+			}
+			IPv4Packet* ip = packet.ip;
+			sl_uint32 sizeHeader = ip->getHeaderSize();
+			sl_bool flagTranslated;
+			if (m_flagOutgoing) {
+				flagTranslated = nat->translateOutgoingPacket(ip, (sl_uint8*)ip + sizeHeader, packet.sizeIp - sizeHeader);
+			} else {
+				flagTranslated = nat->translateIncomingPacket(ip, (sl_uint8*)ip + sizeHeader, packet.sizeIp - sizeHeader);
+			}
+			if (!flagTranslated) {
+				packet.flagDropped = sl_true;
+			}
+		}
+	}
+
+
+	NetPacketFilterStage::NetPacketFilterStage(const Function<sl_bool(NetPacketDescriptor&)>& filter)
+	{
+		m_filter = filter;
+	}
+
+	NetPacketFilterStage::~NetPacketFilterStage()
+	{
+	}
+
+	void NetPacketFilterStage::processBatch(NetPacketBatch& batch)
+	{
+		Function<sl_bool(NetPacketDescriptor&)> filter = m_filter;
+		if (filter.isNull()) {
+			return;
+		}
+		sl_uint32 n = batch.count;
+		NetPacketDescriptor* packets = batch.packets;
+		for (sl_uint32 i = 0; i < n; i++) {
+			NetPacketDescriptor& packet = packets[i];
+			if (packet.flagDropped) {
+				continue;
+			}
+			if (!(filter(packet))) {
+				packet.flagDropped = sl_true;
+			}
+		}
+	}
+
+
+	NetPacketTransmitStage::NetPacketTransmitStage(const Ref<NetCapture>& capture, sl_uint32 mtu)
+	{
+		m_capture = capture;
+		m_mtu = mtu;
+		m_nSentPackets = 0;
+	}
+
+	NetPacketTransmitStage::~NetPacketTransmitStage()
+	{
+	}
+
+	static sl_bool _NetPacketTransmitStage_sendFrame(NetCapture* capture, const NetPacketDescriptor& packet, const void* ip, sl_uint32 sizeIp)
+	{
+		Memory mem = Memory::create(packet.sizeLinkHeader + sizeIp);
+		if (mem.isNull()) {
+			return sl_false;
+		}
+		sl_uint8* buf = (sl_uint8*)(mem.getData());
+		Base::copyMemory(buf, packet.frame, packet.sizeLinkHeader);
+		Base::copyMemory(buf + packet.sizeLinkHeader, ip, sizeIp);
+		return capture->sendPacket(buf, (sl_uint32)(mem.getSize()));
+	}
+
+	void NetPacketTransmitStage::processBatch(NetPacketBatch& batch)
+	{
+		NetCapture* capture = m_capture.get();
+		if (!capture) {
+			return;
+		}
+		sl_uint32 n = batch.count;
+		NetPacketDescriptor* packets = batch.packets;
+		NetCapturePacket frames[_NET_PACKET_TRANSMIT_CHUNK];
+		sl_uint32 nFrames = 0;
+		sl_uint32 nSent = 0;
+		for (sl_uint32 i = 0; i < n; i++) {
+			NetPacketDescriptor& packet = packets[i];
+			if (packet.flagDropped) {
+				continue;
+			}
+			if (!(packet.isDetached())) {
+				frames[nFrames].data = packet.frame;
+				frames[nFrames].length = packet.ip ? packet.sizeLinkHeader + packet.sizeIp : packet.sizeFrame;
+				nFrames++;
+				if (nFrames == _NET_PACKET_TRANSMIT_CHUNK) {
+					nSent += capture->sendPackets(frames, nFrames);
+					nFrames = 0;
+				}
+			} else {
+				// keeps the order of the packets
+				if (nFrames) {
+					nSent += capture->sendPackets(frames, nFrames);
+					nFrames = 0;
+				}
+				if (packet.sizeIp <= m_mtu) {
+					if (_NetPacketTransmitStage_sendFrame(capture, packet, packet.ip, packet.sizeIp)) {
+						nSent++;
+					}
+				} else {
+					IPv4Packet* ip = packet.ip;
+					sl_uint32 sizeHeader = ip->getHeaderSize();
+					ListElements<Memory> fragments(IPv4Fragmentation::makeFragments(ip, ip->getIdentification(), (sl_uint8*)ip + sizeHeader, packet.sizeIp - sizeHeader, m_mtu));
+					for (sl_size k = 0; k < fragments.count; k++) {
+						if (_NetPacketTransmitStage_sendFrame(capture, packet, fragments[k].getData(), (sl_uint32)(fragments[k].getSize()))) {
+							nSent++;
+						}
+					}
+				}
+			}
+		}
+		if (nFrames) {
+			nSent += capture->sendPackets(frames, nFrames);
+		}
+		if (nSent) {
+			Base::interlockedAdd64(&m_nSentPackets, nSent);
+		}
+	}
+
+	sl_uint64 NetPacketTransmitStage::getSentPacketsCount()
+	{
+		return m_nSentPackets;
+	}
+
+
+	SLIB_DEFINE_OBJECT(NetPacketPipeline, Object)
+
+	NetPacketPipeline::NetPacketPipeline()
+	{
+		m_nProcessedPackets = 0;
+		m_nDroppedPackets = 0;
+	}
+
+	NetPacketPipeline::~NetPacketPipeline()
+	{
+	}
+
+	void NetPacketPipeline::addStage(const Ref<NetPacketStage>& stage)
+	{
+		if (stage.isNotNull()) {
+			m_stages.add(stage);
+		}
+	}
+
+	List< Ref<NetPacketStage> > NetPacketPipeline::getStages()
+	{
+		return m_stages.duplicate();
+	}
+
+	void NetPacketPipeline::processPackets(NetCapture* capture, NetCapturePacket* packets, sl_uint32 nPackets)
+	{
+		if (!capture || !nPackets) {
+			return;
+		}
+		if (nPackets <= _NET_PACKET_SMALL_BATCH) {
+			NetPacketDescriptor descriptors[_NET_PACKET_SMALL_BATCH];
+			_processPackets(capture, packets, nPackets, descriptors, _NET_PACKET_SMALL_BATCH);
+		} else {
+			NetPacketDescriptor descriptors[NetPacketBatch::MaxCount];
+			_processPackets(capture, packets, nPackets, descriptors, NetPacketBatch::MaxCount);
+		}
+	}
+
+	void NetPacketPipeline::processBatch(NetPacketBatch& batch)
+	{
+		sl_size nStages = m_stages.getCount();
+		Ref<NetPacketStage>* stages = m_stages.getData();
+		for (sl_size i = 0; i < nStages; i++) {
+			stages[i]->processBatch(batch);
+		}
+		sl_uint32 nDropped = batch.count - batch.getActiveCount();
+		Base::interlockedAdd64(&m_nProcessedPackets, batch.count);
+		if (nDropped) {
+			Base::interlockedAdd64(&m_nDroppedPackets, nDropped);
+		}
+	}
+
+	void NetPacketPipeline::_processPackets(NetCapture* capture, NetCapturePacket* packets, sl_uint32 nPackets, NetPacketDescriptor* descriptors, sl_uint32 nDescriptors)
+	{
+		NetPacketBatch batch;
+		batch.capture = capture;
+		batch.linkType = capture->getLinkType();
+		batch.packets = descriptors;
+		while (nPackets) {
+			sl_uint32 n = nPackets;
+			if (n > nDescriptors) {
+				n = nDescriptors;
+			}
+			for (sl_uint32 i = 0; i < n; i++) {
+				NetPacketDescriptor& descriptor = descriptors[i];
+				descriptor.frame = packets[i].data;
+				descriptor.sizeFrame = packets[i].length;
+				descriptor.sizeLinkHeader = 0;
+				descriptor.ip = sl_null;
+				descriptor.sizeIp = 0;
+				descriptor.memory.setNull();
+				descriptor.time = packets[i].time;
+				descriptor.flagDropped = sl_false;
+			}
+			batch.count = n;
+			processBatch(batch);
+			packets += n;
+			nPackets -= n;
+		}
+	}
+
+	sl_uint64 NetPacketPipeline::getProcessedPacketsCount()
+	{
+		return m_nProcessedPackets;
+	}
+
+	sl_uint64 NetPacketPipeline::getDroppedPacketsCount()
+	{
+		return m_nDroppedPackets;
+	}
+
+}
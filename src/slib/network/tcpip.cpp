@@ -12,30 +12,87 @@
 
 #include "../../../inc/slib/network/icmp.h"
 #include "../../../inc/slib/core/mio.h"
+#include "../../../inc/slib/core/endian.h"
+#include "../../../inc/slib/core/cpu.h"
+
+#if defined(SLIB_CPU_USE_SSE2)
+#	include <emmintrin.h>
+#elif defined(SLIB_CPU_USE_NEON)
+#	include <arm_neon.h>
+#endif
 
 namespace slib
 {
 
-	sl_uint16 TCP_IP::calculateOneComplementSum(const void* data, sl_size size, sl_uint32 add)
-	{
-		sl_uint32 sum = add;
-		sl_uint8* p = (sl_uint8*)data;
-		while (size > 1) {
-			sl_uint16 w = *((sl_uint8*)(p));
-			w = (w << 8) | *((sl_uint8*)(p + 1));
-			sum += w; // can be computed in either byte order
-			p += 2;
-			size -= 2;
+	/*
+		One's complement sum is independent of the byte order (RFC 1071), so the native words are summed
+		and the result is swapped on little endian systems. Summing the 32-bit words into 64-bit accumulators
+		never overflows for the packet sizes, and folding to 16 bits gives the sum of the 16-bit words.
+	*/
+	static sl_uint64 _TCP_IP_sumWords(const sl_uint8* p, sl_size size)
+	{
+		sl_uint64 sum = 0;
+#if defined(SLIB_CPU_USE_SSE2)
+		if (size >= 32) {
+			__m128i zero = _mm_setzero_si128();
+			__m128i acc1 = zero;
+			__m128i acc2 = zero;
+			do {
+				__m128i v1 = _mm_loadu_si128((__m128i const*)p);
+				__m128i v2 = _mm_loadu_si128((__m128i const*)(p + 16));
+				acc1 = _mm_add_epi64(acc1, _mm_unpacklo_epi32(v1, zero));
+				acc2 = _mm_add_epi64(acc2, _mm_unpackhi_epi32(v1, zero));
+				acc1 = _mm_add_epi64(acc1, _mm_unpacklo_epi32(v2, zero));
+				acc2 = _mm_add_epi64(acc2, _mm_unpackhi_epi32(v2, zero));
+				p += 32;
+				size -= 32;
+			} while (size >= 32);
+			sl_uint64 t[2];
+			_mm_storeu_si128((__m128i*)t, _mm_add_epi64(acc1, acc2));
+			sum = t[0] + t[1];
+		}
+#elif defined(SLIB_CPU_USE_NEON)
+		if (size >= 32) {
+			uint64x2_t acc1 = vdupq_n_u64(0);
+			uint64x2_t acc2 = vdupq_n_u64(0);
+			do {
+				acc1 = vpadalq_u32(acc1, vreinterpretq_u32_u8(vld1q_u8(p)));
+				acc2 = vpadalq_u32(acc2, vreinterpretq_u32_u8(vld1q_u8(p + 16)));
+				p += 32;
+				size -= 32;
+			} while (size >= 32);
+			acc1 = vaddq_u64(acc1, acc2);
+			sum = vgetq_lane_u64(acc1, 0) + vgetq_lane_u64(acc1, 1);
+		}
+#endif
+		while (size >= 8) {
+			sl_uint64 v;
+			Base::copyMemory(&v, p, 8);
+			sum += (v & 0xFFFFFFFF) + (v >> 32);
+			p += 8;
+			size -= 8;
 		}
 		if (size) {
-			sl_uint16 w = *((sl_uint8*)p);
-			w = w << 8;
-			sum += w;
+			// the last odd byte is padded by zero
+			sl_uint64 v = 0;
+			Base::copyMemory(&v, p, size);
+			sum += (v & 0xFFFFFFFF) + (v >> 32);
 		}
+		return sum;
+	}
+
+	sl_uint16 TCP_IP::calculateOneComplementSum(const void* data, sl_size size, sl_uint32 add)
+	{
+		sl_uint64 sum = _TCP_IP_sumWords((const sl_uint8*)data, size);
+		sum = (sum >> 32) + (sum & 0xFFFFFFFF);
+		sum = (sum >> 16) + (sum & 0xFFFF);
+		sum = (sum >> 16) + (sum & 0xFFFF);
+		sum = (sum >> 16) + (sum & 0xFFFF);
+		sum = (sl_uint64)(Endian::swap16LE((sl_uint16)sum)) + add;
 		while (sum >> 16) {
-			sum = (sum >> 16) + (sum & 0xffff); // 1's complement sum
+			sum = (sum >> 16) + (sum & 0xFFFF); // 1's complement sum
 		}
-		return sum;
+		return (sl_uint16)sum;
 	}
 	
 	// Referenced from RFC 1071
@@ -45,6 +102,27 @@ namespace slib
 		return (sl_uint16)(~sum); // 1's complement
 	}
 	
+	// Referenced from RFC 1624, Eqn. 3: HC' = ~(~HC + ~m + m')
+	sl_uint16 TCP_IP::adjustChecksum(sl_uint16 checksum, sl_uint16 valueOld, sl_uint16 valueNew)
+	{
+		sl_uint32 sum = (sl_uint32)((sl_uint16)(~checksum)) + (sl_uint32)((sl_uint16)(~valueOld)) + valueNew;
+		sum = (sum >> 16) + (sum & 0xFFFF);
+		sum = (sum >> 16) + (sum & 0xFFFF);
+		return (sl_uint16)(~sum);
+	}
+	
+	sl_uint16 TCP_IP::adjustChecksum(sl_uint16 checksum, const IPv4Address& addressOld, const IPv4Address& addressNew)
+	{
+		sl_uint32 sum = (sl_uint32)((sl_uint16)(~checksum));
+		sum += (sl_uint16)(~SLIB_MAKE_WORD(addressOld.a, addressOld.b));
+		sum += (sl_uint16)(~SLIB_MAKE_WORD(addressOld.c, addressOld.d));
+		sum += SLIB_MAKE_WORD(addressNew.a, addressNew.b);
+		sum += SLIB_MAKE_WORD(addressNew.c, addressNew.d);
+		sum = (sum >> 16) + (sum & 0xFFFF);
+		sum = (sum >> 16) + (sum & 0xFFFF);
+		return (sl_uint16)(~sum);
+	}
+	
 	
 	sl_uint32 IPv4Packet::getVersion() const
 	{
@@ -160,6 +238,16 @@ namespace slib
 		return checksum == 0;
 	}
 	
+	void IPv4Packet::adjustChecksum(sl_uint16 valueOld, sl_uint16 valueNew)
+	{
+		setChecksum(TCP_IP::adjustChecksum(getChecksum(), valueOld, valueNew));
+	}
+	
+	void IPv4Packet::adjustChecksum(const IPv4Address& addressOld, const IPv4Address& addressNew)
+	{
+		setChecksum(TCP_IP::adjustChecksum(getChecksum(), addressOld, addressNew));
+	}
+	
 	const sl_uint8* IPv4Packet::getOptions() const
 	{
 		return (const sl_uint8*)(this) + sizeof(IPv4Packet);
@@ -394,7 +482,17 @@ namespace slib
 		return checksum == 0;
 	}
 	
-	sl_bool TcpSegment::check(IPv4Packet* ip, sl_uint32 sizeTcp) const
+	void TcpSegment::adjustChecksum(sl_uint16 valueOld, sl_uint16 valueNew)
+	{
+		setChecksum(TCP_IP::adjustChecksum(getChecksum(), valueOld, valueNew));
+	}
+	
+	void TcpSegment::adjustChecksum(const IPv4Address& addressOld, const IPv4Address& addressNew)
+	{
+		setChecksum(TCP_IP::adjustChecksum(getChecksum(), addressOld, addressNew));
+	}
+	
+	sl_bool TcpSegment::checkHeader(sl_uint32 sizeTcp) const
 	{
 		if (sizeTcp < sizeof(TcpSegment)) {
 			return sl_false;
@@ -402,6 +500,14 @@ namespace slib
 		if (sizeTcp < getHeaderSize()) {
 			return sl_false;
 		}
+		return sl_true;
+	}
+	
+	sl_bool TcpSegment::check(IPv4Packet* ip, sl_uint32 sizeTcp) const
+	{
+		if (!(checkHeader(sizeTcp))) {
+			return sl_false;
+		}
 		if (!(checkChecksum(ip, sizeTcp))) {
 			return sl_false;
 		}
@@ -459,7 +565,33 @@ namespace slib
 		return checksum == 0 || checksum == 0xFFFF;
 	}
 	
-	sl_bool UdpDatagram::check(IPv4Packet* ip, sl_uint32 sizeUdp) const
+	void UdpDatagram::adjustChecksum(sl_uint16 valueOld, sl_uint16 valueNew)
+	{
+		sl_uint16 checksum = getChecksum();
+		if (checksum == 0) {
+			return;
+		}
+		checksum = TCP_IP::adjustChecksum(checksum, valueOld, valueNew);
+		if (checksum == 0) {
+			checksum = 0xFFFF;
+		}
+		setChecksum(checksum);
+	}
+	
+	void UdpDatagram::adjustChecksum(const IPv4Address& addressOld, const IPv4Address& addressNew)
+	{
+		sl_uint16 checksum = getChecksum();
+		if (checksum == 0) {
+			return;
+		}
+		checksum = TCP_IP::adjustChecksum(checksum, addressOld, addressNew);
+		if (checksum == 0) {
+			checksum = 0xFFFF;
+		}
+		setChecksum(checksum);
+	}
+	
+	sl_bool UdpDatagram::checkHeader(sl_uint32 sizeUdp) const
 	{
 		if (sizeUdp < HeaderSize) {
 			return sl_false;
@@ -467,6 +599,14 @@ namespace slib
 		if (sizeUdp != getTotalSize()) {
 			return sl_false;
 		}
+		return sl_true;
+	}
+	
+	sl_bool UdpDatagram::check(IPv4Packet* ip, sl_uint32 sizeUdp) const
+	{
+		if (!(checkHeader(sizeUdp))) {
+			return sl_false;
+		}
 		if (!(checkChecksum(ip))) {
 			return sl_false;
 		}
@@ -579,7 +719,6 @@ namespace slib
 			}
 			IPv4Packet* headerNew = (IPv4Packet*)(packet->header.getData());
 			headerNew->setMF(sl_false);
-			headerNew->updateChecksum();
 			packet->sizeAccumulated = 0;
 			packet->sizeContent = 0;
 			packet->fragments.removeAll();
@@ -633,9 +772,16 @@ namespace slib
 		// check completed
 		if (packet->sizeContent > 0 && packet->sizeAccumulated == packet->sizeContent) {
 			m_packets.remove(id);
-			Memory mem = Memory::create(packet->header.getSize() + packet->sizeContent);
+			sl_size sizeTotal = packet->header.getSize() + packet->sizeContent;
+			if (sizeTotal > 65535) {
+				return sl_null;
+			}
+			Memory mem = Memory::create(sizeTotal);
 			if (mem.isNotEmpty()) {
 				Base::copyMemory(mem.getData(), packet->header.getData(), packet->header.getSize());
+				IPv4Packet* headerNew = (IPv4Packet*)(mem.getData());
+				headerNew->setTotalSize((sl_uint16)sizeTotal);
+				headerNew->updateChecksum();
 				data = (sl_uint8*)(mem.getData()) + packet->header.getSize();
 				ListLocker<IPv4Fragment> fragments(packet->fragments);
 				for (sl_size i = 0; i < fragments.count; i++) {